@@ -318,9 +318,10 @@ enum overlay_options {
 };
 
 enum bitmap_drawing_options {
-	B_FILTER_BITMAP_BILINEAR	= 0x00000100,
+	B_FILTER_BITMAP_BILINEAR		= 0x00000100,
+	B_FILTER_BITMAP_AREA_AVERAGE	= 0x00000200,
 
-	B_WAIT_FOR_RETRACE			= 0x00000800
+	B_WAIT_FOR_RETRACE				= 0x00000800
 };
 
 
@@ -343,6 +343,7 @@ private:
 			bool				IsFilePanel() const;
 
 			void				_CreateTopView();
+			void				_InitDrawingRing();
 			void				_AdoptResize();
 			void				_SetFocus(BView* focusView,
 									bool notifyIputServer = false);
@@ -378,7 +379,7 @@ private:
 			BView*				fTopView;
 			BView*				fFocus;
 			BView*				fLastMouseMovedView;
-			uint32				_unused1;
+			area_id				fDrawingRingArea;
 			BMenuBar*			fKeyMenuBar;
 			BButton*			fDefaultButton;
 			void*				fShortcuts;
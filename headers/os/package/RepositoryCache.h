@@ -32,6 +32,9 @@ public:
 
 			status_t			GetPackageInfos(GetPackageInfosCallback callback, void* context) const;
 
+			status_t			ApplyDelta(const BEntry& deltaEntry,
+									const BEntry& targetEntry) const;
+
 private:
 			struct RepositoryContentHandler;
 
@@ -103,6 +103,15 @@ enum {
 };
 
 
+// heap chunk sizes (powers of two) and compression dictionary size limit
+enum {
+	B_HPKG_MIN_HEAP_CHUNK_SIZE			= 4 * 1024,
+	B_HPKG_MAX_HEAP_CHUNK_SIZE			= 64 * 1024,
+	B_HPKG_DEFAULT_HEAP_CHUNK_SIZE		= B_HPKG_MAX_HEAP_CHUNK_SIZE,
+	B_HPKG_MAX_HEAP_DICTIONARY_SIZE		= 32 * 1024
+};
+
+
 // file types (B_HPKG_ATTRIBUTE_ID_FILE_TYPE)
 enum {
 	B_HPKG_FILE_TYPE_FILE		= 0,
@@ -46,8 +46,15 @@ public:
 class BPackageWriterParameters {
 public:
 								BPackageWriterParameters();
+								BPackageWriterParameters(
+									const BPackageWriterParameters& other);
 								~BPackageWriterParameters();
 
+			BPackageWriterParameters& operator=(
+									const BPackageWriterParameters& other);
+
+			status_t			InitCheck() const;
+
 			uint32				Flags() const;
 			void				SetFlags(uint32 flags);
 
@@ -57,6 +64,16 @@ public:
 			int32				CompressionLevel() const;
 			void				SetCompressionLevel(int32 compressionLevel);
 
+			int32				CompressionThreadCount() const;
+			status_t			SetCompressionThreadCount(
+									int32 threadCount);
+
+			uint32				ChunkSize() const;
+			status_t			SetChunkSize(uint32 chunkSize);
+
+			uint32				CompressionDictionarySize() const;
+			status_t			SetCompressionDictionarySize(uint32 size);
+
 private:
 			uint32				fFlags;
 			uint32				fCompression;
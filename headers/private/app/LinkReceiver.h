@@ -19,6 +19,7 @@ class BGradient;
 class BString;
 class BRegion;
 class BShape;
+struct link_ring;
 
 
 namespace BPrivate {
@@ -31,6 +32,9 @@ class LinkReceiver {
 		void SetPort(port_id port);
 		port_id	Port(void) const { return fReceivePort; }
 
+		status_t SetRing(void* ring, size_t size);
+		sem_id RingSemaphore() const { return fRingSemaphore; }
+
 		status_t GetNextMessage(int32& code, bigtime_t timeout = B_INFINITE_TIMEOUT);
 		bool HasMessages() const;
 		bool NeedsReply() const;
@@ -53,6 +57,11 @@ class LinkReceiver {
 		virtual status_t ReadFromPort(bigtime_t timeout);
 		virtual status_t AdjustReplyBuffer(bigtime_t timeout);
 		void ResetBuffer();
+		status_t ReadMessageFromPort(bigtime_t timeout);
+		status_t ReadFromRing(bigtime_t timeout);
+		status_t ReadRingBatch();
+		bool RingIsEmpty() const;
+		void WakeUpRingSender();
 
 		port_id fReceivePort;
 
@@ -65,6 +74,12 @@ class LinkReceiver {
 		int32	fReplySize;	//size of current reply message
 
 		status_t fReadError;	//Read failed for current message
+
+		link_ring* fRing;
+		uint8*	fRingData;
+		uint32	fRingSize;
+		uint32	fRingTail;	//our own copy, the shared one is not trusted
+		sem_id	fRingSemaphore;	//the sender waits on it for room in the ring
 };
 
 }	// namespace BPrivate
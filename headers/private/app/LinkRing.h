@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _LINK_RING_H
+#define _LINK_RING_H
+
+
+#include <SupportDefs.h>
+
+
+// A LinkSender can also hand its messages to the receiver through a ring
+// buffer in shared memory, and only write kLinkRingCode messages without
+// any data to the port to wake up the receiver.
+// The data of the ring directly follows the header, and its size must be a
+// power of two. It is filled with batches of messages, each preceded by its
+// size as int32 and padded to a multiple of 4 bytes. A batch size of
+// kLinkRingWrapMarker means that the next batch starts at the beginning of
+// the ring.
+// Batches too large for the ring are written to the port instead. The
+// sender doesn't add anything to the ring before the receiver has read all
+// of them, so that the messages stay in order.
+// A sender waiting for the receiver to make room or read a batch from the
+// port blocks on a semaphore the receiver creates along with the ring.
+struct link_ring {
+	int32	head;
+		// bytes ever written by the sender
+	int32	tail;
+		// bytes ever read by the receiver
+	int32	port_batches;
+		// batches ever read from the port by the receiver
+	int32	receiver_waiting;
+		// set when the receiver needs to be woken up through the port
+	int32	sender_waiting;
+		// set when the sender needs to be woken up through the semaphore
+	int32	reserved;
+};
+
+static const int32 kLinkRingCode = '_PTW';
+static const int32 kLinkRingWrapMarker = -1;
+
+
+#endif	// _LINK_RING_H
@@ -18,6 +18,7 @@
 class BGradient;
 class BRegion;
 class BShape;
+struct link_ring;
 
 
 namespace BPrivate {
@@ -33,6 +34,8 @@ class LinkSender {
 		team_id TargetTeam() const;
 		void SetTargetTeam(team_id team);
 
+		status_t SetRing(void* ring, size_t size, sem_id semaphore);
+
 		status_t StartMessage(int32 code, size_t minSize = 0);
 		void CancelMessage(void);
 		status_t EndMessage(bool needsReply = false);
@@ -60,10 +63,20 @@ class LinkSender {
 
 		status_t AdjustBuffer(size_t newBufferSize, char **_oldBuffer = NULL);
 		status_t FlushCompleted(size_t newBufferSize);
+		status_t FlushToPort(bigtime_t timeout);
+		status_t FlushToRing(bigtime_t timeout);
+		status_t WaitForRing(uint32 maxUsed, bigtime_t timeout);
+		bool RingHasRoom(uint32 maxUsed) const;
 
 		port_id	fPort;
 		team_id fTargetTeam;
 
+		link_ring* fRing;
+		uint8*	fRingData;
+		uint32	fRingSize;
+		sem_id	fRingSemaphore;
+		uint32	fRingPortBatches;	// batches written to the port
+
 		char	*fBuffer;
 		size_t	fBufferSize;
 
@@ -210,6 +210,8 @@ enum {
 	AS_GET_DECORATOR_SETTINGS,
 	AS_GET_SHOW_ALL_DRAGGERS,
 	AS_SET_SHOW_ALL_DRAGGERS,
+	AS_GET_RETAIN_WINDOW_CONTENTS,
+	AS_SET_RETAIN_WINDOW_CONTENTS,
 
 	// Subpixel antialiasing & hinting
 	AS_SET_SUBPIXEL_ANTIALIASING,
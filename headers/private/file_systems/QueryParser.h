@@ -258,6 +258,10 @@ public:
 
 	virtual	void		CalculateScore(Index &index);
 	virtual	int32		Score() const { return fScore; }
+			bool		HasEstimate() const { return fHasEstimate; }
+
+			void		SetIntersection(Equation<QueryPolicy>* other);
+			status_t	PrepareIntersection(Context* context);
 
 	virtual	bool		NeedsEntry();
 
@@ -274,6 +278,12 @@ private:
 			bool		CompareTo(const uint8* value, size_t size);
 			uint8*		Value() const { return (uint8*)&fValue; }
 
+			int32		_EstimateMatches(Index& index);
+			void		_CalculateTrigramScore(Index& index);
+			status_t	_CollectNodeIDs(Context* context, ino_t*& _ids,
+							int32& _count);
+			bool		_IsInIntersection(ino_t id) const;
+
 			char*		fAttribute;
 			char*		fString;
 			union value<QueryPolicy> fValue;
@@ -282,7 +292,14 @@ private:
 			bool		fIsPattern;
 
 			int32		fScore;
+			bool		fHasEstimate;
 			bool		fHasIndex;
+			bool		fUsesTrigrams;
+			uint8		fTrigram[3];
+
+			Equation<QueryPolicy>* fIntersectWith;
+			ino_t*		fIntersection;
+			int32		fIntersectionCount;
 };
 
 
@@ -373,7 +390,12 @@ Equation<QueryPolicy>::Equation(const char** expr)
 	fType(0),
 	fSize(0),
 	fIsPattern(false),
-	fScore(INT32_MAX)
+	fScore(INT32_MAX),
+	fHasEstimate(false),
+	fUsesTrigrams(false),
+	fIntersectWith(NULL),
+	fIntersection(NULL),
+	fIntersectionCount(0)
 {
 	const char* string = *expr;
 	const char* start = string;
@@ -502,6 +524,7 @@ Equation<QueryPolicy>::~Equation()
 {
 	free(fAttribute);
 	free(fString);
+	free(fIntersection);
 }
 
 
@@ -764,9 +787,13 @@ Equation<QueryPolicy>::CalculateScore(Index &index)
 	// As always, these values could be tuned and refined.
 	// And the code could also need some real world testing :-)
 
+	fHasEstimate = false;
+	fUsesTrigrams = false;
+
 	// do we have to operate on a "foreign" index?
 	if (QueryPolicy::IndexSetTo(index, fAttribute) != B_OK) {
 		fScore = INT32_MAX;
+		_CalculateTrigramScore(index);
 		return;
 	}
 
@@ -776,6 +803,16 @@ Equation<QueryPolicy>::CalculateScore(Index &index)
 		return;
 	}
 
+	// If the index keeps statistics, the score is the estimated number of
+	// index entries we will have to look at
+	int32 estimate = _EstimateMatches(index);
+	if (estimate >= 0) {
+		fScore = estimate;
+		fHasEstimate = true;
+		_CalculateTrigramScore(index);
+		return;
+	}
+
 	fScore = QueryPolicy::IndexGetSize(index);
 
 	if (Term<QueryPolicy>::fOp == OP_UNEQUAL) {
@@ -790,6 +827,8 @@ Equation<QueryPolicy>::CalculateScore(Index &index)
 		// Guess how much of the index we will be able to skip.
 		const int32 divisor = (firstSymbolIndex > 3) ? 4 : (firstSymbolIndex + 1);
 		fScore /= divisor;
+
+		_CalculateTrigramScore(index);
 	} else {
 		// Score by operator
 		if (Term<QueryPolicy>::fOp == OP_EQUAL
@@ -808,11 +847,240 @@ Equation<QueryPolicy>::CalculateScore(Index &index)
 }
 
 
+/*!	Asks the index for an estimate of the number of entries this equation
+	will have to visit. Returns -1 if the index cannot provide one.
+	You have to call ConvertValue() before this one.
+*/
+template<typename QueryPolicy>
+int32
+Equation<QueryPolicy>::_EstimateMatches(Index& index)
+{
+	int8 op = Term<QueryPolicy>::fOp;
+	if (op == OP_UNEQUAL) {
+		// this will have to scan the whole "name" index
+		return -1;
+	}
+
+	size_t size = fSize;
+	if (fIsPattern) {
+		// we can only make use of the part in front of the first pattern
+		// symbol, and estimate the whole range of keys starting with it
+		int32 prefixLength = getFirstPatternSymbol(fString);
+		size = prefixLength > 0 ? prefixLength : 0;
+	}
+
+	return QueryPolicy::IndexEstimateMatches(index, op, Value(), size,
+		fIsPattern);
+}
+
+
+/*!	Checks if a trigram index for our attribute could be used to find the
+	entries matching our pattern faster than the current score suggests.
+	If so, the trigram of the pattern with the least matches is chosen, and
+	PrepareQuery() will iterate over the nodes containing it instead.
+*/
+template<typename QueryPolicy>
+void
+Equation<QueryPolicy>::_CalculateTrigramScore(Index& index)
+{
+	const int32 kMaxTrigrams = 32;
+
+	if (!fIsPattern || Term<QueryPolicy>::fOp != OP_EQUAL
+		|| QueryPolicy::IndexSetToTrigrams(index, fAttribute) != B_OK)
+		return;
+
+	uint8 trigrams[kMaxTrigrams * 3];
+	int32 count = getPatternTrigrams(fString, trigrams, kMaxTrigrams);
+	if (count == 0)
+		return;
+
+	// choose the most selective trigram; without statistics, any will do
+	int32 best = 0;
+	int32 bestEstimate = QueryPolicy::IndexEstimateMatches(index, OP_EQUAL,
+		trigrams, 3, false);
+	bool hasEstimate = bestEstimate >= 0;
+
+	for (int32 i = 1; hasEstimate && i < count; i++) {
+		int32 estimate = QueryPolicy::IndexEstimateMatches(index, OP_EQUAL,
+			trigrams + i * 3, 3, false);
+		if (estimate >= 0 && estimate < bestEstimate) {
+			best = i;
+			bestEstimate = estimate;
+		}
+	}
+	if (!hasEstimate)
+		bestEstimate = QueryPolicy::IndexGetSize(index);
+
+	if (bestEstimate >= fScore)
+		return;
+
+	fScore = bestEstimate;
+	fHasEstimate = hasEstimate;
+	fUsesTrigrams = true;
+	memcpy(fTrigram, trigrams + best * 3, 3);
+}
+
+
+/*!	Lets this equation skip all index entries that do not also match
+	\a other, which needs to be a sibling of this equation in an "and"
+	operation. The node IDs matching \a other are collected from its index
+	in PrepareIntersection(), so that we do not have to load each node to
+	evaluate \a other for it.
+*/
+template<typename QueryPolicy>
+void
+Equation<QueryPolicy>::SetIntersection(Equation<QueryPolicy>* other)
+{
+	fIntersectWith = other;
+}
+
+
+template<typename QueryPolicy>
+status_t
+Equation<QueryPolicy>::PrepareIntersection(Context* context)
+{
+	free(fIntersection);
+	fIntersection = NULL;
+	fIntersectionCount = 0;
+
+	if (fIntersectWith == NULL)
+		return B_OK;
+
+	ino_t* ids;
+	int32 count;
+	status_t status = fIntersectWith->_CollectNodeIDs(context, ids, count);
+	if (status != B_OK) {
+		// we can still just evaluate the other equation for every entry
+		return status;
+	}
+
+	std::sort(ids, ids + count);
+
+	fIntersection = ids;
+	fIntersectionCount = count;
+	return B_OK;
+}
+
+
+/*!	Collects the IDs of all nodes that match this equation by iterating
+	over its index. Fails if there is no index, or if there are more
+	matches than kMaxIntersectionCount.
+*/
+template<typename QueryPolicy>
+status_t
+Equation<QueryPolicy>::_CollectNodeIDs(Context* context, ino_t*& _ids,
+	int32& _count)
+{
+	const int32 kMaxIntersectionCount = 65536;
+
+	Index index(context);
+	IndexIterator* iterator = NULL;
+	status_t status = PrepareQuery(context, index, &iterator, false);
+	if (status == B_OK && !fHasIndex)
+		status = B_ENTRY_NOT_FOUND;
+	if (status != B_OK) {
+		QueryPolicy::IndexIteratorDelete(iterator);
+		QueryPolicy::IndexUnset(index);
+		return status;
+	}
+
+	ino_t* ids = NULL;
+	int32 count = 0;
+	int32 capacity = 0;
+
+	while (true) {
+		union value<QueryPolicy> indexValue;
+		size_t keyLength;
+		size_t duplicate = 0;
+
+		status = QueryPolicy::IndexIteratorFetchNextEntry(iterator,
+			&indexValue, &keyLength, (size_t)sizeof(indexValue), &duplicate);
+		if (status != B_OK) {
+			status = B_OK;
+			break;
+		}
+
+		// see GetNextMatching() for how the index is traversed
+		if (duplicate < 2 && !CompareTo((uint8*)&indexValue, keyLength)) {
+			if (Term<QueryPolicy>::fOp == OP_LESS_THAN
+				|| Term<QueryPolicy>::fOp == OP_LESS_THAN_OR_EQUAL
+				|| (Term<QueryPolicy>::fOp == OP_EQUAL && !fIsPattern))
+				break;
+
+			if (duplicate > 0)
+				QueryPolicy::IndexIteratorSkipDuplicates(iterator);
+			continue;
+		}
+
+		if (count == capacity) {
+			if (capacity == kMaxIntersectionCount) {
+				status = B_BUFFER_OVERFLOW;
+				break;
+			}
+
+			int32 newCapacity = capacity == 0 ? 1024 : capacity * 2;
+			ino_t* newIDs = (ino_t*)realloc(ids, newCapacity * sizeof(ino_t));
+			if (newIDs == NULL) {
+				status = B_NO_MEMORY;
+				break;
+			}
+			ids = newIDs;
+			capacity = newCapacity;
+		}
+
+		ids[count++] = QueryPolicy::IndexIteratorGetNodeID(iterator);
+	}
+
+	QueryPolicy::IndexIteratorDelete(iterator);
+	QueryPolicy::IndexUnset(index);
+
+	if (status != B_OK) {
+		free(ids);
+		return status;
+	}
+
+	_ids = ids;
+	_count = count;
+	return B_OK;
+}
+
+
+template<typename QueryPolicy>
+bool
+Equation<QueryPolicy>::_IsInIntersection(ino_t id) const
+{
+	if (fIntersection == NULL)
+		return true;
+
+	return std::binary_search(fIntersection,
+		fIntersection + fIntersectionCount, id);
+}
+
+
 template<typename QueryPolicy>
 status_t
 Equation<QueryPolicy>::PrepareQuery(Context* /*context*/, Index& index,
 	IndexIterator** iterator, bool queryNonIndexed)
 {
+	if (fUsesTrigrams) {
+		if (QueryPolicy::IndexSetToTrigrams(index, fAttribute) == B_OK) {
+			// Iterate over all nodes containing the chosen trigram; since
+			// this is a superset of the matching nodes, they still need to
+			// be checked via Match()
+			fHasIndex = false;
+
+			*iterator = QueryPolicy::IndexCreateIterator(index);
+			if (*iterator == NULL)
+				return B_NO_MEMORY;
+
+			return QueryPolicy::IndexIteratorFind(*iterator, fTrigram,
+				sizeof(fTrigram));
+		}
+
+		// the trigram index has been removed in the mean time
+		fUsesTrigrams = false;
+	}
+
 	status_t status = QueryPolicy::IndexSetTo(index, fAttribute);
 
 	// if we should query attributes without an index, we can just proceed here
@@ -917,6 +1185,13 @@ Equation<QueryPolicy>::GetNextMatching(Context* context,
 		if (status != B_OK)
 			return status;
 
+		// when iterating over a trigram index, we are done with the last
+		// node containing our trigram
+		if (fUsesTrigrams && duplicate < 2
+			&& (keyLength != sizeof(fTrigram)
+				|| memcmp(&indexValue, fTrigram, sizeof(fTrigram)) != 0))
+			return B_ENTRY_NOT_FOUND;
+
 		// only compare against the index entry when this is the correct
 		// index for the equation
 		if (fHasIndex && duplicate < 2 && !CompareTo((uint8*)&indexValue, keyLength)) {
@@ -934,6 +1209,11 @@ Equation<QueryPolicy>::GetNextMatching(Context* context,
 			continue;
 		}
 
+		// if the node cannot match our "and" sibling, we don't need to
+		// load it at all
+		if (!_IsInIntersection(QueryPolicy::IndexIteratorGetNodeID(iterator)))
+			continue;
+
 		Entry* entry = NULL;
 		status = QueryPolicy::IndexIteratorGetEntry(context, iterator,
 			nodeHolder, &entry);
@@ -1502,6 +1782,12 @@ Query<QueryPolicy>::Rewind()
 	fIterator = NULL;
 	fCurrent = NULL;
 
+	// Using an intersection pays off if the equation we iterate over has
+	// enough entries that loading all of their nodes is more expensive than
+	// scanning the sibling's index for its matching node IDs
+	const int32 kMinIntersectionScore = 256;
+	const int32 kIntersectionCostFactor = 16;
+
 	// put the whole expression on the stack
 
 	Stack<Term<QueryPolicy>*> stack;
@@ -1518,10 +1804,26 @@ Query<QueryPolicy>::Rewind()
 			} else {
 				// For OP_AND, we can use the scoring system to decide which
 				// path to add
-				if (op->Right()->Score() < op->Left()->Score())
-					stack.Push(op->Right());
-				else
-					stack.Push(op->Left());
+				Term<QueryPolicy>* chosen = op->Left();
+				Term<QueryPolicy>* other = op->Right();
+				if (other->Score() < chosen->Score())
+					std::swap(chosen, other);
+
+				stack.Push(chosen);
+
+				if (chosen->Op() < OP_EQUAL || other->Op() < OP_EQUAL)
+					continue;
+
+				Equation<QueryPolicy>* equation
+					= (Equation<QueryPolicy>*)chosen;
+				Equation<QueryPolicy>* sibling = (Equation<QueryPolicy>*)other;
+				if (equation->HasEstimate() && sibling->HasEstimate()
+					&& equation->Score() >= kMinIntersectionScore
+					&& sibling->Score() / kIntersectionCostFactor
+						<= equation->Score()) {
+					equation->SetIntersection(sibling);
+				} else
+					equation->SetIntersection(NULL);
 			}
 		} else if (term->Op() == OP_EQUATION
 				|| fStack.Push((Equation<QueryPolicy>*)term) != B_OK)
@@ -1695,6 +1997,9 @@ Query<QueryPolicy>::_GetNextEntry(struct dirent* dirent, size_t size)
 
 			if (status != B_OK)
 				return status;
+
+			// failing to intersect is not an error, it's just slower
+			fCurrent->PrepareIntersection(fContext);
 		}
 		if (fCurrent == NULL)
 			QUERY_RETURN_ERROR(B_ERROR);
@@ -48,6 +48,8 @@ int			compareKeys(uint32 type, const void* key1, size_t length1,
 				const void* key2, size_t length2);
 uint32		utf8ToUnicode(const char** string);
 int32		getFirstPatternSymbol(const char* string);
+int32		getPatternTrigrams(const char* pattern, uint8* trigrams,
+				int32 maxCount);
 status_t	isValidPattern(const char* pattern);
 status_t	matchString(const char* pattern, const char* string);
 
@@ -62,6 +64,18 @@ isPattern(char* string)
 }
 
 
+/*!	Trigram indices ignore the case of ASCII letters; all other bytes,
+	including those of multi-byte UTF-8 characters, are used as is.
+*/
+static inline uint8
+foldTrigramCharacter(uint8 c)
+{
+	if (c >= 'A' && c <= 'Z')
+		return c - 'A' + 'a';
+	return c;
+}
+
+
 }	// namespace QueryParser
 
 
@@ -29,6 +29,9 @@ void		set_workspaces_layout(uint32 columns, uint32 rows);
 bool		get_control_look(BString& path);
 status_t	set_control_look(const BString& path);
 
+status_t	get_retain_window_contents(bool& retain);
+void		set_retain_window_contents(bool retain);
+
 }	// namespace BPrivate
 
 
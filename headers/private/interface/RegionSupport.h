@@ -105,6 +105,15 @@ class BRegion::Support {
 									clipping_rect* r, clipping_rect* rEnd,
 									int top, int bottom);
 
+	static	void				miSetRect(BRegion* pReg,
+									const clipping_rect& rect);
+	static	void				miSubtractRect(BRegion* regD,
+									const clipping_rect& m,
+									const clipping_rect& s);
+	static	void				miUnionSeparated(BRegion* newReg,
+									const BRegion* upper,
+									const BRegion* lower);
+
 
 
 	typedef	int (*overlapProcp)(
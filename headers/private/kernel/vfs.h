@@ -184,6 +184,9 @@ int			_user_open_dir_entry_ref(dev_t device, ino_t inode,
 				const char *name);
 int			_user_open_dir(int fd, const char *path);
 int			_user_open_parent_dir(int fd, char *name, size_t nameLength);
+ssize_t		_user_read_dir_plus(int fd, const char* const* attributes,
+				uint32 attributeCount, void *buffer, size_t bufferSize,
+				uint32 maxCount);
 status_t	_user_fcntl(int fd, int op, size_t argument);
 status_t	_user_fsync(int fd, bool dataOnly);
 status_t	_user_flock(int fd, int op);
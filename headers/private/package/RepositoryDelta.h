@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__PRIVATE__REPOSITORY_DELTA_H_
+#define _PACKAGE__PRIVATE__REPOSITORY_DELTA_H_
+
+
+#include <Entry.h>
+#include <ObjectList.h>
+#include <String.h>
+#include <StringList.h>
+
+#include <package/PackageInfo.h>
+#include <package/RepositoryInfo.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+	class BRepositoryWriterListener;
+}
+
+
+namespace BPrivate {
+
+
+/*!	The changes between two versions of a repository file: the packages that
+	were removed (by canonical file name, i.e. name, version, and
+	architecture) and the ones that were added, plus the new repository info. A delta applies only to the repository file whose
+	checksum it records as base checksum.
+*/
+class RepositoryDelta {
+public:
+								RepositoryDelta();
+								~RepositoryDelta();
+
+			status_t			SetTo(const BEntry& deltaEntry);
+			status_t			SetTo(const BEntry& baseRepositoryEntry,
+									const BEntry& repositoryEntry);
+
+			status_t			WriteToFile(const BEntry& deltaEntry) const;
+
+			status_t			Apply(const BEntry& baseRepositoryEntry,
+									const BEntry& repositoryEntry,
+									BHPKG::BRepositoryWriterListener* listener
+										= NULL) const;
+
+			const BString&		BaseChecksum() const
+									{ return fBaseChecksum; }
+			const BRepositoryInfo& RepositoryInfo() const
+									{ return fRepositoryInfo; }
+			int32				CountAddedPackages() const
+									{ return fAddedPackages.CountItems(); }
+			int32				CountRemovedPackages() const
+									{ return fRemovedPackages.CountStrings(); }
+
+private:
+			typedef BObjectList<BPackageInfo, true> PackageInfoList;
+
+			void				_Unset();
+
+	static	status_t			_ReadPackageInfos(const BEntry& entry,
+									BRepositoryInfo* _repositoryInfo,
+									PackageInfoList& _packageInfos);
+	static	bool				_AddPackageInfo(void* context,
+									const BPackageInfo& info);
+
+private:
+			BString				fBaseChecksum;
+			BRepositoryInfo		fRepositoryInfo;
+			PackageInfoList		fAddedPackages;
+			BStringList			fRemovedPackages;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BPackageKit
+
+
+#endif // _PACKAGE__PRIVATE__REPOSITORY_DELTA_H_
@@ -6,6 +6,7 @@
 #define _PACKAGE__HPKG__PRIVATE__HAIKU_PACKAGE_H_
 
 
+#include <ByteOrder.h>
 #include <SupportDefs.h>
 
 #include <package/hpkg/HPKGDefs.h>
@@ -18,6 +19,15 @@ namespace BHPKG {
 namespace BPrivate {
 
 
+// Package files whose heap uses a chunk size other than the default, or a
+// compression dictionary, are written with this version instead of
+// B_HPKG_VERSION, since readers of the latter would not decode their heap
+// correctly. The format is the same otherwise.
+enum {
+	B_HPKG_HEAP_FEATURES_VERSION	= 3
+};
+
+
 // package file header
 struct hpkg_header {
 	uint32	magic;							// "hpkg"
@@ -36,7 +46,10 @@ struct hpkg_header {
 	uint32	attributes_length;
 	uint32	attributes_strings_length;
 	uint32	attributes_strings_count;
-	uint32	reserved1;
+	uint32	heap_dictionary_size;
+		// size of the heap compression dictionary, which directly follows
+		// the header (header_size includes it); 0 for none. Only used as of
+		// B_HPKG_HEAP_FEATURES_VERSION.
 
 	// TOC section
 	uint64	toc_length;
@@ -70,6 +83,51 @@ struct hpkg_repo_header {
 };
 
 
+// the version of files that use the extended heap features, 0 for none
+static inline uint16
+heap_features_version(const hpkg_header& header)
+{
+	return B_HPKG_HEAP_FEATURES_VERSION;
+}
+
+
+static inline uint16
+heap_features_version(const hpkg_repo_header& header)
+{
+	return 0;
+}
+
+
+// the version a package file with the given heap parameters is written with
+static inline uint16
+package_file_version(uint32 chunkSize, uint32 dictionarySize)
+{
+	if (chunkSize != B_HPKG_DEFAULT_HEAP_CHUNK_SIZE || dictionarySize > 0)
+		return B_HPKG_HEAP_FEATURES_VERSION;
+	return B_HPKG_VERSION;
+}
+
+
+// size of the heap compression dictionary following the header
+static inline uint32
+heap_dictionary_size(const hpkg_header& header)
+{
+	// the field was unused and not necessarily zeroed before
+	if (B_BENDIAN_TO_HOST_INT16(header.version)
+			!= B_HPKG_HEAP_FEATURES_VERSION) {
+		return 0;
+	}
+	return B_BENDIAN_TO_HOST_INT32(header.heap_dictionary_size);
+}
+
+
+static inline uint32
+heap_dictionary_size(const hpkg_repo_header& header)
+{
+	return 0;
+}
+
+
 // attribute tag arithmetics
 // (using 7 bits for id, 3 for type, 1 for hasChildren and 2 for encoding)
 static inline uint16
@@ -12,6 +12,7 @@
 
 #include <CompressionAlgorithm.h>
 #include <package/hpkg/DataReader.h>
+#include <package/hpkg/HPKGDefs.h>
 
 
 namespace BPackageKit {
@@ -74,7 +75,8 @@ public:
 									BErrorOutput* errorOutput,
 									BPositionIO* file, off_t heapOffset,
 									DecompressionAlgorithmOwner*
-										decompressionAlgorithm);
+										decompressionAlgorithm,
+									size_t chunkSize);
 	virtual						~PackageFileHeapAccessorBase();
 
 			off_t				HeapOffset() const
@@ -84,7 +86,7 @@ public:
 			uint64				UncompressedHeapSize() const
 									{ return fUncompressedHeapSize; }
 			size_t				ChunkSize() const
-									{ return kChunkSize; }
+									{ return fChunkSize; }
 
 			// normally used after cloning a PackageFileHeapReader only
 			void				SetErrorOutput(BErrorOutput* errorOutput)
@@ -96,8 +98,13 @@ public:
 	virtual	status_t			ReadDataToOutput(off_t offset,
 									size_t size, BDataIO* output);
 
+	static	bool				IsValidChunkSize(size_t chunkSize);
+
 public:
-	static	const size_t		kChunkSize = 64 * 1024;
+	static	const size_t		kMinChunkSize = B_HPKG_MIN_HEAP_CHUNK_SIZE;
+	static	const size_t		kMaxChunkSize = B_HPKG_MAX_HEAP_CHUNK_SIZE;
+	static	const size_t		kDefaultChunkSize
+									= B_HPKG_DEFAULT_HEAP_CHUNK_SIZE;
 #if defined(_KERNEL_MODE)
 	static	void*				sQuadChunkCache;
 	static	void*				sQuadChunkFallbackBuffer;
@@ -126,6 +133,7 @@ protected:
 			off_t				fHeapOffset;
 			uint64				fCompressedHeapSize;
 			uint64				fUncompressedHeapSize;
+			size_t				fChunkSize;
 			DecompressionAlgorithmOwner* fDecompressionAlgorithm;
 };
 
@@ -141,11 +149,12 @@ protected:
 	- The chunk offsets that don't fit in a 32 bit number use two elements in
 	  the offsets array.
 	Memory use is one pointer, if the chunk count is <= 1 (uncompressed heap size
-	<= 64 KiB). Afterwards it's one pointer plus 32 bit per chunk as long as the
+	<= chunk size). Afterwards it's one pointer plus 32 bit per chunk as long as the
 	last offset still fits 32 bit (compressed heap size < 4GiB). For any further
 	chunks it is 64 bit per chunk. So, for the common case we use sizeof(void*)
-	plus 1 KiB per 16 MiB of uncompressed heap, or about 64 KiB per 1 GiB. Which
-	seems reasonable for packagefs to keep in memory.
+	plus 1 KiB per 16 MiB of uncompressed heap, or about 64 KiB per 1 GiB, with
+	the default chunk size of 64 KiB. Which seems reasonable for packagefs to
+	keep in memory.
  */
 class PackageFileHeapAccessorBase::OffsetArray {
 public:
@@ -153,7 +162,7 @@ public:
 								~OffsetArray();
 
 			bool				InitUncompressedChunksOffsets(
-									size_t totalChunkCount);
+									size_t totalChunkCount, size_t chunkSize);
 			bool				InitChunksOffsets(size_t totalChunkCount,
 									size_t baseIndex, const uint16* chunkSizes,
 									size_t chunkCount);
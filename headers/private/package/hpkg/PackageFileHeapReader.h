@@ -29,13 +29,19 @@ public:
 									off_t compressedHeapSize,
 									uint64 uncompressedHeapSize,
 									DecompressionAlgorithmOwner*
-										decompressionAlgorithm);
+										decompressionAlgorithm,
+									size_t chunkSize);
 								~PackageFileHeapReader();
 
 			status_t			Init();
 
 			PackageFileHeapReader* Clone() const;
 
+#if !defined(_KERNEL_MODE)
+			status_t			SetReadAhead(int32 threadCount);
+									// 0 disables read-ahead
+#endif
+
 			const OffsetArray&	Offsets() const
 									{ return fOffsets; }
 
@@ -45,8 +51,19 @@ protected:
 									void* uncompressedDataBuffer,
 									iovec* scratchBuffer = NULL);
 
+private:
+			struct ReadAheadJob;
+			struct ReadAheadPipeline;
+			friend struct ReadAheadPipeline;
+
+private:
+			void				_GetChunkLocation(size_t chunkIndex,
+									uint64& _offset, size_t& _compressedSize,
+									size_t& _uncompressedSize) const;
+
 private:
 			OffsetArray			fOffsets;
+			ReadAheadPipeline*	fReadAheadPipeline;
 };
 
 
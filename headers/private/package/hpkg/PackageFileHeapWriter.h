@@ -39,12 +39,18 @@ public:
 									CompressionAlgorithmOwner*
 										compressionAlgorithm,
 									DecompressionAlgorithmOwner*
-										decompressionAlgorithm);
+										decompressionAlgorithm,
+									size_t chunkSize);
 								~PackageFileHeapWriter();
 
-			void				Init();
+			void				Init(int32 compressionThreadCount = 1);
 			void				Reinit(PackageFileHeapReader* heapReader);
 
+			status_t			SetCompressionDictionary(
+									const void* dictionary, size_t size);
+			void				SetHeapOffset(off_t heapOffset);
+									// both only before adding any data
+
 			status_t			AddData(BDataReader& dataReader, off_t size,
 									uint64& _offset);
 			void				AddDataThrows(const void* buffer, size_t size);
@@ -64,15 +70,23 @@ private:
 			struct Chunk;
 			struct ChunkSegment;
 			struct ChunkBuffer;
+			struct CompressionJob;
+			struct CompressionPipeline;
 
 			friend struct ChunkBuffer;
+			friend struct CompressionPipeline;
 
 private:
 			void				_Uninit();
 
 			status_t			_FlushPendingData();
+			status_t			_WriteFirstQueuedChunk();
+			status_t			_WriteQueuedChunks();
 			status_t			_WriteChunk(const void* data, size_t size,
 									bool mayCompress);
+			status_t			_CompressData(const void* data, size_t size,
+									void* compressedDataBuffer,
+									size_t& _compressedSize) const;
 			status_t			_WriteDataCompressed(const void* data,
 									size_t size);
 			status_t			_WriteDataUncompressed(const void* data,
@@ -88,6 +102,7 @@ private:
 			size_t				fPendingDataSize;
 			Array<uint64>		fOffsets;
 			CompressionAlgorithmOwner* fCompressionAlgorithm;
+			CompressionPipeline* fCompressionPipeline;
 };
 
 
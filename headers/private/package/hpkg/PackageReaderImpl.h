@@ -26,6 +26,22 @@ struct hpkg_header;
 class PackageWriterImpl;
 
 
+/*!	Can be passed to PackageReaderImpl::ParseContent() to skip the children of
+	directory entries. The children can later be parsed via
+	PackageReaderImpl::ParseEntryChildren().
+*/
+class DeferredEntryHandler {
+public:
+	virtual						~DeferredEntryHandler();
+
+	virtual	bool				DeferEntryChildren(BPackageEntry* entry,
+									uint64 childrenOffset) = 0;
+									// called once for each directory entry
+									// with children, after HandleEntry();
+									// returns whether to skip the children
+};
+
+
 class PackageReaderImpl : public ReaderImplBase {
 	typedef	ReaderImplBase		inherited;
 public:
@@ -40,6 +56,13 @@ public:
 									BPackageContentHandler* contentHandler);
 			status_t			ParseContent(BLowLevelPackageContentHandler*
 										contentHandler);
+			status_t			ParseContent(
+									BPackageContentHandler* contentHandler,
+									DeferredEntryHandler* deferredHandler);
+			status_t			ParseEntryChildren(
+									BPackageContentHandler* contentHandler,
+									BPackageEntry* entry,
+									uint64 childrenOffset);
 
 			BPositionIO*		PackageFile() const;
 
@@ -60,8 +83,10 @@ protected:
 									AttributeValue& _value);
 
 private:
+			struct EntryHandlerContext;
 			struct AttributeAttributeHandler;
 			struct EntryAttributeHandler;
+			struct EntryChildrenAttributeHandler;
 			struct RootAttributeHandler;
 
 			friend class PackageWriterImpl;
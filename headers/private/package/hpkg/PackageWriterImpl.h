@@ -64,6 +64,7 @@ private:
 			struct Entry;
 			struct SubPathAdder;
 			struct HeapAttributeOffsetter;
+			struct DictionarySamples;
 
 			typedef DoublyLinkedList<Entry> EntryList;
 
@@ -101,6 +102,11 @@ private:
 									uint32& _stringsLengthUncompressed,
 									uint32& _attributesLengthUncompressed);
 
+			void				_InitHeapDictionary();
+			void				_CollectDictionarySamples(int dirFD,
+									Entry* entry, const char* fileName,
+									DictionarySamples& samples);
+
 			void				_AddEntry(int dirFD, Entry* entry,
 									const char* fileName, char* pathBuffer);
 			void				_AddDirectoryChildren(Entry* entry, int fd,
@@ -128,6 +134,8 @@ private:
 
 			off_t				fHeapOffset;
 			uint16				fHeaderSize;
+			void*				fHeapDictionary;
+			uint32				fHeapDictionarySize;
 
 			::BPrivate::RangeArray<uint64>* fHeapRangesToRemove;
 
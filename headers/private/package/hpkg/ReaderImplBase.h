@@ -128,7 +128,9 @@ protected:
 			status_t			InitHeapReader(uint32 compression,
 									uint32 chunkSize, off_t offset,
 									uint64 compressedSize,
-									uint64 uncompressedSize);
+									uint64 uncompressedSize,
+									off_t dictionaryOffset = 0,
+									uint32 dictionarySize = 0);
 	virtual	status_t			CreateCachedHeapReader(
 									PackageFileHeapReader* heapReader,
 									BAbstractBufferedDataReader*&
@@ -482,15 +484,24 @@ ReaderImplBase::Init(BPositionIO* file, bool keepFile, Header& header, uint32 fl
 	}
 
 	// version
-	if (B_BENDIAN_TO_HOST_INT16(header.version) != kVersion) {
+	uint16 version = B_BENDIAN_TO_HOST_INT16(header.version);
+	if (version != kVersion
+		&& (version == 0 || version != heap_features_version(header))) {
 		if ((flags & B_HPKG_READER_DONT_PRINT_VERSION_MISMATCH_MESSAGE) == 0) {
 			ErrorOutput()->PrintError("Error: Invalid/unsupported %s file "
-				"version (%d)\n", fFileType,
-				B_BENDIAN_TO_HOST_INT16(header.version));
+				"version (%d)\n", fFileType, version);
 		}
 		return B_MISMATCHED_VALUES;
 	}
 
+	// only files of the heap features version may use another chunk size
+	uint32 chunkSize = B_BENDIAN_TO_HOST_INT32(header.heap_chunk_size);
+	if (version == kVersion && chunkSize != B_HPKG_DEFAULT_HEAP_CHUNK_SIZE) {
+		ErrorOutput()->PrintError("Error: Invalid %s file: Invalid heap "
+			"chunk size (%" B_PRIu32 ")\n", fFileType, chunkSize);
+		return B_BAD_DATA;
+	}
+
 	fMinorFormatVersion = B_BENDIAN_TO_HOST_INT16(header.minor_version);
 	fCurrentMinorFormatVersion = kMinorVersion;
 
@@ -502,6 +513,15 @@ ReaderImplBase::Init(BPositionIO* file, bool keepFile, Header& header, uint32 fl
 		return B_BAD_DATA;
 	}
 
+	// heap compression dictionary
+	uint32 dictionarySize = heap_dictionary_size(header);
+	if (dictionarySize > B_HPKG_MAX_HEAP_DICTIONARY_SIZE
+		|| heapOffset - sizeof(header) < dictionarySize) {
+		ErrorOutput()->PrintError("Error: Invalid %s file: Invalid heap "
+			"dictionary size (%" B_PRIu32 ")\n", fFileType, dictionarySize);
+		return B_BAD_DATA;
+	}
+
 	// total size
 	uint64 totalSize = B_BENDIAN_TO_HOST_INT64(header.total_size);
 	if (fileSize >= 0 && totalSize != (uint64)fileSize) {
@@ -524,10 +544,10 @@ ReaderImplBase::Init(BPositionIO* file, bool keepFile, Header& header, uint32 fl
 	}
 
 	error = InitHeapReader(
-		B_BENDIAN_TO_HOST_INT16(header.heap_compression),
-		B_BENDIAN_TO_HOST_INT32(header.heap_chunk_size), heapOffset,
-		compressedHeapSize,
-		B_BENDIAN_TO_HOST_INT64(header.heap_size_uncompressed));
+		B_BENDIAN_TO_HOST_INT16(header.heap_compression), chunkSize,
+		heapOffset, compressedHeapSize,
+		B_BENDIAN_TO_HOST_INT64(header.heap_size_uncompressed),
+		sizeof(header), dictionarySize);
 	if (error != B_OK)
 		return error;
 
@@ -56,6 +56,11 @@ private:
 									uint64& _length);
 			void				_WritePackageAttributes(
 									hpkg_repo_header& header, uint64& _length);
+			void				_SortPackageAttributes();
+
+	static	bool				_PackageAttributeNameLess(
+									const PackageAttribute* a,
+									const PackageAttribute* b);
 
 			struct PackageNameSet;
 
@@ -7,6 +7,7 @@
 
 
 #include <new>
+#include <string.h>
 
 #include <String.h>
 #include <util/OpenHashTable.h>
@@ -81,7 +82,11 @@ typedef BOpenHashTable<CachedStringHashDefinition> CachedStringTable;
 struct CachedStringUsageGreater {
 	bool operator()(const CachedString* a, const CachedString* b)
 	{
-		return a->usageCount > b->usageCount;
+		// Order equally used strings by value, so that the written string
+		// table doesn't depend on the order in which the strings were added.
+		if (a->usageCount != b->usageCount)
+			return a->usageCount > b->usageCount;
+		return strcmp(a->string, b->string) < 0;
 	}
 };
 
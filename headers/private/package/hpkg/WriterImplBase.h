@@ -107,6 +107,7 @@ protected:
 			status_t			InitHeapReader(size_t headerSize);
 
 			void				SetCompression(uint32 compression);
+			void				SetChunkSize(uint32 chunkSize);
 
 			void				RegisterPackageInfo(
 									PackageAttributeList& attributeList,
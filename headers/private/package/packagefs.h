@@ -104,4 +104,61 @@ struct PackageFSActivationChangeRequest {
 };
 
 
+// string table
+//
+// Written by the package daemon to the packages administrative directory
+// whenever the activated packages change. packagefs maps it read-only at
+// mount time and uses its strings instead of allocating its own copies.
+// The file must only be read on the machine it was written on.
+
+#define PACKAGE_FS_STRING_TABLE_FILE_NAME	"packagefs-strings"
+
+enum {
+	PACKAGE_FS_STRING_TABLE_MAGIC					= 'PfSt',
+	PACKAGE_FS_STRING_TABLE_VERSION					= 1,
+	PACKAGE_FS_STRING_TABLE_STATIC_REFERENCE_COUNT	= 0x7fffffff
+};
+
+struct PackageFSStringTableHeader {
+	uint32	magic;
+	uint32	version;
+	uint32	headerSize;
+	uint32	stringCount;
+	uint32	bucketCount;
+		// power of two
+	uint32	reserved;
+	uint64	tableSize;
+		// size of the complete table
+	// followed by:
+	// uint32	buckets[bucketCount];
+	//	offsets of the entries relative to the start of the table, 0 for
+	//	empty buckets; collisions are resolved by linear probing
+	// entries, each aligned to sizeof(void*)
+};
+
+struct PackageFSStringTableEntry {
+	void*	reserved;
+		// must be NULL
+	int32	referenceCount;
+		// must be PACKAGE_FS_STRING_TABLE_STATIC_REFERENCE_COUNT
+	uint32	hash;
+		// package_fs_string_hash() of the string
+	char	string[];
+};
+
+
+static inline uint32
+package_fs_string_hash(const char* _string, size_t length)
+{
+	// must match the kernel's hash_hash_string_part()
+	const uint8* string = (const uint8*)_string;
+
+	uint32 h = 5381;
+	char c;
+	while (length-- > 0 && (c = *string++) != 0)
+		h = (h * 33) + c;
+	return h;
+}
+
+
 #endif	// _PACKAGE__PRIVATE__PACKAGE_FS_H_
@@ -32,9 +32,18 @@ public:
 			size_t				BufferSize() const;
 			void				SetBufferSize(size_t size);
 
+			status_t			SetDictionary(const void* dictionary,
+									size_t size);
+			bool				HasDictionary() const;
+
+private:
+			friend class BZstdCompressionAlgorithm;
+
 private:
 			int32				fCompressionLevel;
 			size_t				fBufferSize;
+			void*				fDictionary;
+									// ZSTD_CDict*
 };
 
 
@@ -46,8 +55,17 @@ public:
 			size_t				BufferSize() const;
 			void				SetBufferSize(size_t size);
 
+			status_t			SetDictionary(const void* dictionary,
+									size_t size);
+			bool				HasDictionary() const;
+
+private:
+			friend class BZstdCompressionAlgorithm;
+
 private:
 			size_t				fBufferSize;
+			void*				fDictionary;
+									// ZSTD_DDict*
 };
 
 
@@ -76,6 +94,11 @@ public:
 									const BDecompressionParameters* parameters = NULL,
 									iovec* scratch = NULL);
 
+	static	status_t			TrainDictionary(const void* samples,
+									const size_t* sampleSizes,
+									uint32 sampleCount, void* dictionary,
+									size_t& _size);
+
 private:
 			struct CompressionStrategy;
 			struct DecompressionStrategy;
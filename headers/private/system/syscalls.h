@@ -341,6 +341,9 @@ extern ssize_t		_kern_writev(int fd, off_t pos, const struct iovec *vecs,
 extern status_t		_kern_ioctl(int fd, uint32 cmd, void *data, size_t length);
 extern ssize_t		_kern_read_dir(int fd, struct dirent *buffer,
 						size_t bufferSize, uint32 maxCount);
+extern ssize_t		_kern_read_dir_plus(int fd,
+						const char* const* attributes, uint32 attributeCount,
+						void *buffer, size_t bufferSize, uint32 maxCount);
 extern status_t		_kern_rewind_dir(int fd);
 extern status_t		_kern_read_stat(int fd, const char *path, bool traverseLink,
 						struct stat *stat, size_t statSize);
@@ -10,6 +10,7 @@
 #define _SYSTEM_VFS_DEFS_H
 
 
+#include <dirent.h>
 #include <limits.h>
 #include <sys/stat.h>
 
@@ -37,4 +38,58 @@ struct fd_info {
 #endif
 
 
+/* _kern_read_dir_plus() returns a dirent_plus for each directory entry read.
+   Each is followed by the actual dirent, and then by one attr_plus for each
+   of the requested attributes, in the order they were requested. All of
+   them start at an 8 byte aligned offset, their size fields include the
+   padding. */
+
+#define READ_DIR_PLUS_MAX_ATTRIBUTES	16
+
+struct dirent_plus {
+	uint32		size;			/* size of the whole entry, including the
+								   dirent and attributes */
+	status_t	stat_status;	/* stat is only valid if this is B_OK */
+	struct stat	stat;
+};
+
+struct attr_plus {
+	uint32		size;			/* size of this attr_plus, including data */
+	status_t	status;			/* B_OK if the data follows, B_BUFFER_OVERFLOW
+								   if the attribute was too large, or another
+								   error */
+	uint32		type;
+	uint32		data_size;		/* the full size of the attribute */
+};
+
+#define DIRENT_PLUS_ALIGN(size)	(((size) + 7) & ~(size_t)7)
+
+static inline struct dirent*
+dirent_plus_entry(struct dirent_plus* entry)
+{
+	return (struct dirent*)((uint8*)entry
+		+ DIRENT_PLUS_ALIGN(sizeof(struct dirent_plus)));
+}
+
+static inline struct attr_plus*
+dirent_plus_first_attr(struct dirent_plus* entry)
+{
+	struct dirent* dirent = dirent_plus_entry(entry);
+	return (struct attr_plus*)((uint8*)dirent
+		+ DIRENT_PLUS_ALIGN(dirent->d_reclen));
+}
+
+static inline struct attr_plus*
+dirent_plus_next_attr(struct attr_plus* attr)
+{
+	return (struct attr_plus*)((uint8*)attr + attr->size);
+}
+
+static inline struct dirent_plus*
+dirent_plus_next(struct dirent_plus* entry)
+{
+	return (struct dirent_plus*)((uint8*)entry + entry->size);
+}
+
+
 #endif	/* _SYSTEM_VFS_DEFS_H */
@@ -485,6 +485,17 @@ CheckVisitor::_CheckInodeBlocks(Inode* inode, const char* name)
 
 	data_stream* data = &inode->Node().data;
 
+	if (inode->HasInlineData()) {
+		// files with inline data must not have a data stream
+		if (!inode->IsFile() || !GetVolume()->HasInlineData()
+			|| data->max_direct_range != 0 || !data->direct[0].IsZero()
+			|| data->max_indirect_range != 0
+			|| data->max_double_indirect_range != 0)
+			return B_BAD_DATA;
+
+		return B_OK;
+	}
+
 	// check the direct range
 
 	if (data->max_direct_range) {
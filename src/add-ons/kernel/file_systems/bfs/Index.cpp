@@ -11,12 +11,52 @@
 
 #include <file_systems/QueryParserUtils.h>
 
+#include "bfs_control.h"
 #include "Debug.h"
 #include "Volume.h"
 #include "Inode.h"
+#include "IndexStatistics.h"
 #include "BPlusTree.h"
 
 
+/*!	Fills \a trigrams with the distinct, case folded trigrams of the given
+	key in ascending order, each packed into a single integer. The key is
+	treated as a string, ie. it ends at the first null byte. \a trigrams
+	must have room for at least \a length entries. Returns the number of
+	trigrams.
+*/
+static uint32
+collect_trigrams(const uint8* key, uint16 length, uint32* trigrams)
+{
+	if (key == NULL)
+		return 0;
+
+	uint32 count = 0;
+	uint32 trigram = 0;
+	for (uint16 i = 0; i < length && key[i] != '\0'; i++) {
+		trigram = ((trigram << 8)
+			| QueryParser::foldTrigramCharacter(key[i])) & 0xffffff;
+		if (i >= 2)
+			trigrams[count++] = trigram;
+	}
+
+	std::sort(trigrams, trigrams + count);
+	return std::unique(trigrams, trigrams + count) - trigrams;
+}
+
+
+static inline void
+trigram_to_key(uint32 trigram, uint8* key)
+{
+	key[0] = trigram >> 16;
+	key[1] = trigram >> 8;
+	key[2] = trigram;
+}
+
+
+//	#pragma mark -
+
+
 Index::Index(Volume* volume)
 	:
 	fVolume(volume),
@@ -197,6 +237,11 @@ Index::Create(Transaction& transaction, const char* name, uint32 type)
 			return B_BAD_TYPE;
 	}
 
+	// trigram indices only work on strings
+	bool isTrigramIndex = IsTrigramIndex(name);
+	if (isTrigramIndex && mode != S_STR_INDEX)
+		return B_BAD_TYPE;
+
 	// do we need to create the index directory first?
 	if (fVolume->IndicesNode() == NULL) {
 		status_t status = fVolume->CreateIndicesRoot(transaction);
@@ -204,9 +249,17 @@ Index::Create(Transaction& transaction, const char* name, uint32 type)
 			RETURN_ERROR(status);
 	}
 
+	// a previously removed index of the same name might have left its
+	// statistics behind
+	fVolume->RemoveIndexStatistics(name);
+
 	// Inode::Create() will keep the inode locked for us
-	return Inode::Create(transaction, fVolume->IndicesNode(), name,
+	status_t status = Inode::Create(transaction, fVolume->IndicesNode(), name,
 		S_INDEX_DIR | S_DIRECTORY | mode, 0, type, NULL, NULL, &fNode);
+	if (status == B_OK && isTrigramIndex)
+		fVolume->AddTrigramIndex();
+
+	return status;
 }
 
 
@@ -248,6 +301,12 @@ Index::Update(Transaction& transaction, const char* name, int32 type,
 			newKey, newLength);
 	}
 
+	if (type == B_STRING_TYPE && fVolume->HasTrigramIndices()
+		&& !IsTrigramIndex(name)) {
+		_UpdateTrigrams(transaction, name, oldKey, oldLength, newKey,
+			newLength, inode);
+	}
+
 	if (((name != fName || strcmp(name, fName)) && SetTo(name) != B_OK)
 		|| fNode == NULL)
 		return B_BAD_INDEX;
@@ -268,6 +327,7 @@ Index::Update(Transaction& transaction, const char* name, int32 type,
 		if (status == B_ENTRY_NOT_FOUND) {
 			// That's not nice, but no reason to let the whole thing fail
 			INFORM(("Could not find value in index \"%s\"!\n", name));
+			oldKey = NULL;
 		} else if (status != B_OK)
 			return status;
 	}
@@ -277,8 +337,12 @@ Index::Update(Transaction& transaction, const char* name, int32 type,
 	if (newKey != NULL) {
 		status = tree->Insert(transaction, (const uint8*)newKey, newLength,
 			inode->ID());
+		if (status != B_OK)
+			newKey = NULL;
 	}
 
+	_UpdateStatistics(type, oldKey, oldLength, newKey, newLength);
+
 	RETURN_ERROR(status);
 }
 
@@ -417,3 +481,217 @@ Index::UpdateNodeID(Transaction& transaction, const uint8* key, uint16 length,
 	return tree->Insert(transaction, key, length, newInodeID);
 }
 
+
+/*!	Returns whether or not the index with the given name is a trigram index,
+	see BFS_TRIGRAM_INDEX_PREFIX. Instead of the attribute values, such an
+	index contains all of their (case folded) trigrams, so that queries can
+	find substrings in them.
+*/
+/*static*/ bool
+Index::IsTrigramIndex(const char* name)
+{
+	return strncmp(name, BFS_TRIGRAM_INDEX_PREFIX,
+		strlen(BFS_TRIGRAM_INDEX_PREFIX)) == 0;
+}
+
+
+/*!	Returns the number of entries in the index, or -1 if that number is not
+	known.
+*/
+int64
+Index::CountEntries()
+{
+	MutexLocker locker;
+	IndexStatistics* statistics = _LockStatistics(locker);
+	if (statistics == NULL)
+		return -1;
+
+	return statistics->CountEntries();
+}
+
+
+/*!	Returns an estimate of the number of entries with the given \a key, or
+	-1 if no estimate is available.
+*/
+int64
+Index::EstimateEqual(const uint8* key, uint16 length)
+{
+	MutexLocker locker;
+	IndexStatistics* statistics = _LockStatistics(locker);
+	if (statistics == NULL)
+		return -1;
+
+	return statistics->EstimateEqual(key, length);
+}
+
+
+/*!	Returns an estimate of the number of entries between the \a lower and
+	\a upper keys, or -1 if no estimate is available. Either key may be
+	\c NULL to leave the range open on that side.
+*/
+int64
+Index::EstimateRange(const uint8* lower, uint16 lowerLength,
+	const uint8* upper, uint16 upperLength)
+{
+	MutexLocker locker;
+	IndexStatistics* statistics = _LockStatistics(locker);
+	if (statistics == NULL)
+		return -1;
+
+	return statistics->EstimateRange(lower, lowerLength, upper, upperLength);
+}
+
+
+/*!	Returns the statistics of this index with the volume's statistics lock
+	held by \a locker. If the statistics do not exist yet, they are created
+	by scanning the whole index once; from then on, Update() keeps them
+	current. Returns \c NULL if no statistics are available (yet).
+*/
+IndexStatistics*
+Index::_LockStatistics(MutexLocker& locker)
+{
+	if (fNode == NULL || fName == NULL)
+		return NULL;
+
+	locker.SetTo(fVolume->IndexStatisticsLock(), false);
+
+	IndexStatistics* statistics = fVolume->FindIndexStatistics(fName);
+	if (statistics != NULL)
+		return statistics->IsScanning() ? NULL : statistics;
+
+	BPlusTree* tree = fNode->Tree();
+	if (tree == NULL)
+		return NULL;
+
+	IndexStatistics* scanned = new(std::nothrow) IndexStatistics(Type());
+	if (scanned == NULL)
+		return NULL;
+	ObjectDeleter<IndexStatistics> scannedDeleter(scanned);
+
+	// Publish a stand-in first, so that Update() tells us about any change
+	// made while we scan the index
+	statistics = new(std::nothrow) IndexStatistics(Type());
+	if (statistics == NULL || statistics->SetName(fName) != B_OK) {
+		delete statistics;
+		return NULL;
+	}
+	statistics->StartScan();
+	fVolume->AddIndexStatistics(statistics);
+	locker.Unlock();
+
+	TreeIterator iterator(tree);
+	uint8 key[MAX_INDEX_KEY_LENGTH + 1];
+	uint16 keyLength;
+	off_t value;
+	while (iterator.GetNextEntry(key, &keyLength, sizeof(key), &value)
+			== B_OK) {
+		scanned->Add(key, keyLength);
+	}
+
+	// Update() changes the index and then the statistics with the node write
+	// locked, so it must be locked to see all updates made during the scan.
+	// The stand-in may have been removed with the index in the mean time.
+	rw_lock_write_lock(&fNode->Lock());
+	locker.Lock();
+
+	statistics = fVolume->FindIndexStatistics(fName);
+	if (statistics != NULL && statistics->IsScanning()
+		&& !statistics->FinishScan(*scanned)) {
+		// the scan result is off, try again next time
+		fVolume->RemoveIndexStatistics(statistics);
+		statistics = NULL;
+	}
+
+	rw_lock_write_unlock(&fNode->Lock());
+	return statistics;
+}
+
+
+void
+Index::_UpdateStatistics(int32 type, const uint8* oldKey, uint16 oldLength,
+	const uint8* newKey, uint16 newLength)
+{
+	if (oldKey == NULL && newKey == NULL)
+		return;
+
+	MutexLocker locker(fVolume->IndexStatisticsLock());
+
+	IndexStatistics* statistics = fVolume->FindIndexStatistics(fName);
+	if (statistics == NULL || statistics->Type() != (type_code)type)
+		return;
+
+	if (statistics->IsScanning()) {
+		statistics->MissedUpdate();
+		return;
+	}
+
+	if (oldKey != NULL)
+		statistics->Remove(oldKey, oldLength);
+	if (newKey != NULL)
+		statistics->Add(newKey, newLength);
+}
+
+
+/*!	Updates the trigram index of the attribute \a name, if there is one.
+	Only the trigrams that were actually added or removed by the change are
+	touched in the index.
+*/
+void
+Index::_UpdateTrigrams(Transaction& transaction, const char* name,
+	const uint8* oldKey, uint16 oldLength, const uint8* newKey,
+	uint16 newLength, Inode* inode)
+{
+	char indexName[B_FILE_NAME_LENGTH];
+	if (snprintf(indexName, sizeof(indexName), "%s%s",
+			BFS_TRIGRAM_INDEX_PREFIX, name) >= (int)sizeof(indexName)) {
+		return;
+	}
+
+	Index index(fVolume);
+	if (index.SetTo(indexName) != B_OK)
+		return;
+
+	BPlusTree* tree = index.Node()->Tree();
+	if (tree == NULL)
+		return;
+
+	uint32* oldTrigrams = (uint32*)malloc(
+		sizeof(uint32) * ((uint32)oldLength + newLength));
+	if (oldTrigrams == NULL)
+		return;
+	MemoryDeleter trigramsDeleter(oldTrigrams);
+	uint32* newTrigrams = oldTrigrams + oldLength;
+
+	uint32 oldCount = collect_trigrams(oldKey, oldLength, oldTrigrams);
+	uint32 newCount = collect_trigrams(newKey, newLength, newTrigrams);
+
+	index.Node()->WriteLockInTransaction(transaction);
+
+	// Walk both sorted lists, and only update the differences
+	uint32 oldIndex = 0;
+	uint32 newIndex = 0;
+	while (oldIndex < oldCount || newIndex < newCount) {
+		uint8 key[3];
+		if (newIndex == newCount || (oldIndex < oldCount
+				&& oldTrigrams[oldIndex] < newTrigrams[newIndex])) {
+			trigram_to_key(oldTrigrams[oldIndex++], key);
+			if (tree->Remove(transaction, key, sizeof(key), inode->ID())
+					== B_OK) {
+				index._UpdateStatistics(B_STRING_TYPE, key, sizeof(key),
+					NULL, 0);
+			}
+		} else if (oldIndex == oldCount
+			|| newTrigrams[newIndex] < oldTrigrams[oldIndex]) {
+			trigram_to_key(newTrigrams[newIndex++], key);
+			if (tree->Insert(transaction, key, sizeof(key), inode->ID())
+					== B_OK) {
+				index._UpdateStatistics(B_STRING_TYPE, NULL, 0, key,
+					sizeof(key));
+			}
+		} else {
+			// the trigram is part of both
+			oldIndex++;
+			newIndex++;
+		}
+	}
+}
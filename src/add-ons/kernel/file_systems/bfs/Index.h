@@ -9,6 +9,7 @@
 #include "system_dependencies.h"
 
 
+class IndexStatistics;
 class Transaction;
 class Volume;
 class Inode;
@@ -57,6 +58,24 @@ public:
 			status_t		UpdateNodeID(Transaction& transaction, const uint8* key, uint16 length,
 								off_t oldInodeID, off_t newInodeID);
 
+	static	bool			IsTrigramIndex(const char* name);
+
+			int64			CountEntries();
+			int64			EstimateEqual(const uint8* key, uint16 length);
+			int64			EstimateRange(const uint8* lower,
+								uint16 lowerLength, const uint8* upper,
+								uint16 upperLength);
+
+private:
+			IndexStatistics* _LockStatistics(MutexLocker& locker);
+			void			_UpdateStatistics(int32 type, const uint8* oldKey,
+								uint16 oldLength, const uint8* newKey,
+								uint16 newLength);
+			void			_UpdateTrigrams(Transaction& transaction,
+								const char* name, const uint8* oldKey,
+								uint16 oldLength, const uint8* newKey,
+								uint16 newLength, Inode* inode);
+
 private:
 							Index(const Index& other);
 							Index& operator=(const Index& other);
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+//! Approximate key statistics of an index, used for query planning
+
+
+#include "IndexStatistics.h"
+
+
+static inline uint32
+bit_length(uint64 value)
+{
+	uint32 length = 0;
+	while (value != 0) {
+		value >>= 1;
+		length++;
+	}
+	return length;
+}
+
+
+/*!	Maps a signed value to one of 128 buckets while keeping the order of
+	the values intact: negative values go below 64, positive values above.
+*/
+static inline uint32
+signed_bucket(int64 value)
+{
+	if (value < 0)
+		return 63 - bit_length(~(uint64)value);
+	return 64 + bit_length((uint64)value);
+}
+
+
+/*!	Maps IEEE floating point bits to an unsigned value with the same order,
+	and returns its top 8 bits. This avoids using the FPU in the kernel.
+*/
+static inline uint32
+float_bucket(uint64 bits, uint32 size)
+{
+	const uint64 signBit = 1ULL << (size * 8 - 1);
+	if ((bits & signBit) != 0)
+		bits = ~bits;
+	else
+		bits |= signBit;
+
+	return (bits >> (size * 8 - 8)) & 0xff;
+}
+
+
+//	#pragma mark -
+
+
+IndexStatistics::IndexStatistics(type_code type)
+	:
+	fName(NULL),
+	fType(type),
+	fEntries(0),
+	fScanning(false),
+	fMissedUpdates(0)
+{
+	memset(fRangeCounts, 0, sizeof(fRangeCounts));
+	memset(fKeyCounts, 0, sizeof(fKeyCounts));
+}
+
+
+IndexStatistics::~IndexStatistics()
+{
+	free(fName);
+}
+
+
+status_t
+IndexStatistics::SetName(const char* name)
+{
+	char* copy = strdup(name);
+	if (copy == NULL)
+		return B_NO_MEMORY;
+
+	free(fName);
+	fName = copy;
+	return B_OK;
+}
+
+
+void
+IndexStatistics::Add(const uint8* key, uint16 length)
+{
+	fEntries++;
+	fRangeCounts[_RangeBucket(key, length)]++;
+	fKeyCounts[_KeyBucket(key, length)]++;
+}
+
+
+void
+IndexStatistics::Remove(const uint8* key, uint16 length)
+{
+	fEntries--;
+	fRangeCounts[_RangeBucket(key, length)]--;
+	fKeyCounts[_KeyBucket(key, length)]--;
+}
+
+
+/*!	Marks the statistics as a stand-in for the result of an index scan
+	that is about to start.
+*/
+void
+IndexStatistics::StartScan()
+{
+	fScanning = true;
+	fMissedUpdates = 0;
+}
+
+
+/*!	Takes over the counts of the  scanned statistics, unless the index
+	has been updated since StartScan(), in which case the scan may or may
+	not have seen the changes, and \c false is returned.
+*/
+bool
+IndexStatistics::FinishScan(const IndexStatistics& scanned)
+{
+	if (fMissedUpdates != 0)
+		return false;
+
+	fEntries = scanned.fEntries;
+	memcpy(fRangeCounts, scanned.fRangeCounts, sizeof(fRangeCounts));
+	memcpy(fKeyCounts, scanned.fKeyCounts, sizeof(fKeyCounts));
+	fScanning = false;
+	return true;
+}
+
+
+/*!	Returns an upper bound estimate of the number of entries with exactly
+	the given key.
+*/
+int64
+IndexStatistics::EstimateEqual(const uint8* key, uint16 length) const
+{
+	int32 keyCount = fKeyCounts[_KeyBucket(key, length)];
+	int32 rangeCount = fRangeCounts[_RangeBucket(key, length)];
+
+	// The statistics are only approximate (an aborted transaction does not
+	// revert them, for example), so the counts could be off
+	return max_c(min_c(keyCount, rangeCount), 0);
+}
+
+
+/*!	Estimates the number of entries with keys between \a lower and \a upper
+	(both inclusive). Passing \c NULL for either of them leaves the range
+	open on that side.
+	Only half of the boundary buckets are accounted for, as we do not know
+	where in the bucket the boundary is.
+*/
+int64
+IndexStatistics::EstimateRange(const uint8* lower, uint16 lowerLength,
+	const uint8* upper, uint16 upperLength) const
+{
+	uint32 first = lower != NULL ? _RangeBucket(lower, lowerLength) : 0;
+	uint32 last = upper != NULL
+		? _RangeBucket(upper, upperLength) : kRangeBuckets - 1;
+	if (first > last)
+		return 0;
+
+	int64 count = 0;
+	for (uint32 i = first; i <= last; i++)
+		count += fRangeCounts[i];
+
+	if (lower != NULL)
+		count -= fRangeCounts[first] / 2;
+	if (upper != NULL && (lower == NULL || first != last))
+		count -= fRangeCounts[last] / 2;
+
+	return max_c(count, 0);
+}
+
+
+uint32
+IndexStatistics::_RangeBucket(const uint8* key, uint16 length) const
+{
+	switch (fType) {
+		case B_STRING_TYPE:
+			return length > 0 ? key[0] : 0;
+
+		case B_INT32_TYPE:
+			return signed_bucket(*(int32*)key);
+		case B_UINT32_TYPE:
+			return bit_length(*(uint32*)key);
+		case B_INT64_TYPE:
+			return signed_bucket(*(int64*)key);
+		case B_UINT64_TYPE:
+			return bit_length(*(uint64*)key);
+		case B_FLOAT_TYPE:
+			return float_bucket(*(uint32*)key, sizeof(uint32));
+		case B_DOUBLE_TYPE:
+			return float_bucket(*(uint64*)key, sizeof(uint64));
+	}
+
+	return 0;
+}
+
+
+uint32
+IndexStatistics::_KeyBucket(const uint8* key, uint16 length) const
+{
+	// FNV-1a
+	uint32 hash = 2166136261U;
+	for (uint16 i = 0; i < length; i++) {
+		hash ^= key[i];
+		hash *= 16777619U;
+	}
+
+	return hash % kKeyBuckets;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+#ifndef INDEX_STATISTICS_H
+#define INDEX_STATISTICS_H
+
+
+#include "system_dependencies.h"
+
+
+/*!	Keeps approximate statistics about the keys stored in an index, so that
+	the query planner can estimate how many entries an equation will visit.
+
+	The statistics consist of an order preserving histogram (by first byte
+	for strings, and by magnitude for numeric types), used for range
+	estimates, and a small counting hash table over the full keys, used for
+	equality estimates. Both can be updated incrementally on insertion and
+	removal of keys.
+
+	While the index is scanned to create them, a published object only
+	stands in for the statistics to come, and counts the updates the scan
+	might have missed instead.
+*/
+class IndexStatistics : public DoublyLinkedListLinkImpl<IndexStatistics> {
+public:
+								IndexStatistics(type_code type);
+								~IndexStatistics();
+
+			status_t			SetName(const char* name);
+			const char*			Name() const { return fName; }
+			type_code			Type() const { return fType; }
+
+			void				Add(const uint8* key, uint16 length);
+			void				Remove(const uint8* key, uint16 length);
+
+			void				StartScan();
+			bool				IsScanning() const { return fScanning; }
+			void				MissedUpdate() { fMissedUpdates++; }
+			bool				FinishScan(const IndexStatistics& scanned);
+
+			int64				CountEntries() const
+									{ return max_c(fEntries, 0); }
+			int64				EstimateEqual(const uint8* key,
+									uint16 length) const;
+			int64				EstimateRange(const uint8* lower,
+									uint16 lowerLength, const uint8* upper,
+									uint16 upperLength) const;
+
+private:
+			uint32				_RangeBucket(const uint8* key,
+									uint16 length) const;
+			uint32				_KeyBucket(const uint8* key,
+									uint16 length) const;
+
+private:
+	static	const uint32		kRangeBuckets = 256;
+	static	const uint32		kKeyBuckets = 512;
+
+			char*				fName;
+			type_code			fType;
+			int64				fEntries;
+			bool				fScanning;
+			int32				fMissedUpdates;
+			int32				fRangeCounts[kRangeBuckets];
+			int32				fKeyCounts[kKeyBuckets];
+};
+
+typedef DoublyLinkedList<IndexStatistics> IndexStatisticsList;
+
+
+#endif	// INDEX_STATISTICS_H
@@ -344,7 +344,8 @@ Inode::Inode(Volume* volume, ino_t id)
 	fTree(NULL),
 	fAttributes(NULL),
 	fCache(NULL),
-	fMap(NULL)
+	fMap(NULL),
+	fFirstBlockLogged(0)
 {
 	PRINT(("Inode::Inode(volume = %p, id = %" B_PRIdINO ") @ %p\n",
 		volume, id, this));
@@ -378,7 +379,8 @@ Inode::Inode(Volume* volume, Transaction& transaction, ino_t id, mode_t mode,
 	fTree(NULL),
 	fAttributes(NULL),
 	fCache(NULL),
-	fMap(NULL)
+	fMap(NULL),
+	fFirstBlockLogged(0)
 {
 	PRINT(("Inode::Inode(volume = %p, transaction = %p, id = %" B_PRIdINO
 		") @ %p\n", volume, &transaction, id, this));
@@ -568,7 +570,9 @@ Inode::_MakeSpaceForSmallData(Transaction& transaction, bfs_inode* node,
 		int32 index = 0, maxIndex = 0;
 		for (; !item->IsLast(node); item = item->Next(), index++) {
 			// should not remove those
-			if (*item->Name() == FILE_NAME_NAME || !strcmp(name, item->Name()))
+			if (*item->Name() == FILE_NAME_NAME
+				|| *item->Name() == FILE_DATA_NAME
+				|| !strcmp(name, item->Name()))
 				continue;
 
 			if (max == NULL || max->Size() < item->Size()) {
@@ -998,7 +1002,8 @@ Inode::_RemoveAttribute(Transaction& transaction, const char* name,
 	// update index
 	if (index != NULL) {
 		Inode* attribute;
-		if ((hasIndex || fVolume->CheckForLiveQuery(name))
+		if ((hasIndex || fVolume->HasTrigramIndices()
+				|| fVolume->CheckForLiveQuery(name))
 			&& GetAttribute(name, &attribute) == B_OK) {
 			uint8 data[MAX_INDEX_KEY_LENGTH];
 			size_t length = MAX_INDEX_KEY_LENGTH;
@@ -1171,7 +1176,8 @@ Inode::WriteAttribute(Transaction& transaction, const char* name, int32 type,
 	if (attribute != NULL) {
 		WriteLocker writeLocker(attribute->fLock);
 
-		if (hasIndex || fVolume->CheckForLiveQuery(name)) {
+		if (hasIndex || fVolume->HasTrigramIndices()
+			|| fVolume->CheckForLiveQuery(name)) {
 			// Save the old attribute data (if this fails, oldLength will
 			// reflect it)
 			while (attribute->Size() > 0) {
@@ -1601,8 +1607,9 @@ Inode::WriteAt(Transaction& transaction, off_t pos, const uint8* buffer,
 
 	locker.Unlock();
 
-	// the transaction doesn't have to be started already
-	if (changeSize && !transaction.IsStarted())
+	// The transaction doesn't have to be started already; inline data is
+	// part of the inode, though, and is therefore always written in one
+	if ((changeSize || HasInlineData()) && !transaction.IsStarted())
 		transaction.Start(fVolume, BlockNumber());
 
 	WriteLocker writeLocker(fLock);
@@ -1640,6 +1647,22 @@ Inode::WriteAt(Transaction& transaction, off_t pos, const uint8* buffer,
 		}
 	}
 
+	if (HasInlineData()) {
+		// The data still fits into the inode, and is written as part of the
+		// transaction. The file cache gets it as well to stay coherent; its
+		// pages then usually don't need a transaction to be written back.
+		status_t status = WriteInlineData(transaction, pos, buffer, _length);
+		writeLocker.Unlock();
+
+		if (status == B_OK && *_length > 0) {
+			status = file_cache_write(FileCache(), NULL, pos, buffer,
+				_length);
+		}
+
+		WriteLockInTransaction(transaction);
+		return status;
+	}
+
 	writeLocker.Unlock();
 
 	if (oldSize < pos)
@@ -1686,6 +1709,270 @@ Inode::FillGapWithZeros(off_t pos, off_t newSize)
 }
 
 
+/*!	Reads from the contents of a file that keeps its data inline in the
+	small_data section. Nothing is read beyond the end of the file;
+	\a _length is set to the number of bytes actually read.
+	You need to hold the inode's read lock when calling this method.
+*/
+status_t
+Inode::ReadInlineData(off_t pos, uint8* buffer, size_t* _length)
+{
+	if (!HasInlineData() || pos < 0)
+		return B_BAD_VALUE;
+
+	size_t length = *_length;
+	*_length = 0;
+
+	if (pos >= Size())
+		return B_OK;
+
+	NodeGetter node(fVolume);
+	status_t status = node.SetTo(this);
+	if (status != B_OK)
+		return status;
+
+	RecursiveLocker locker(fSmallDataLock);
+
+	const char dataTag[2] = {FILE_DATA_NAME, 0};
+	small_data* item = FindSmallData(node.Node(), dataTag);
+	if (item == NULL || item->DataSize() != Size())
+		RETURN_ERROR(B_BAD_DATA);
+
+	if ((uint64)pos + length > (uint64)item->DataSize())
+		length = item->DataSize() - pos;
+
+	memcpy(buffer, item->Data() + pos, length);
+	*_length = length;
+	return B_OK;
+}
+
+
+/*!	Writes to the contents of a file that keeps its data inline in the
+	small_data section. \a buffer may be a userland buffer. Anything beyond
+	the end of the file is ignored, use SetFileSize() to change the file
+	size first.
+	You need to hold the inode's write lock when calling this method.
+*/
+status_t
+Inode::WriteInlineData(Transaction& transaction, off_t pos,
+	const uint8* buffer, size_t* _length)
+{
+	if (!HasInlineData() || pos < 0)
+		return B_BAD_VALUE;
+
+	size_t size = Size();
+	size_t length = *_length;
+	if ((uint64)pos >= size)
+		return B_OK;
+	if ((uint64)pos + length > size)
+		length = size - pos;
+
+	uint8* data = (uint8*)malloc(size);
+	if (data == NULL)
+		return B_NO_MEMORY;
+
+	MemoryDeleter dataDeleter(data);
+
+	NodeGetter node(fVolume);
+	status_t status = node.SetToWritable(transaction, this);
+	if (status != B_OK)
+		return status;
+
+	const char dataTag[2] = {FILE_DATA_NAME, 0};
+
+	{
+		RecursiveLocker locker(fSmallDataLock);
+
+		small_data* item = FindSmallData(node.Node(), dataTag);
+		if (item == NULL || item->DataSize() != size)
+			RETURN_ERROR(B_BAD_DATA);
+
+		memcpy(data, item->Data(), size);
+	}
+
+	status = user_memcpy(data + pos, buffer, length);
+	if (status != B_OK)
+		return status;
+
+	status = _AddSmallData(transaction, node, dataTag, FILE_DATA_TYPE, 0, data,
+		size);
+	if (status == B_OK)
+		*_length = length;
+
+	return status;
+}
+
+
+/*!	Returns the maximum file size that can be kept inline. The space needed
+	for the longest possible name is reserved, so that renaming the file never
+	needs to move its data out of the inode.
+*/
+size_t
+Inode::_InlineDataCapacity() const
+{
+	size_t reserved = 2 * (sizeof(small_data) + 3 + 1)
+		+ FILE_NAME_NAME_LENGTH + B_FILE_NAME_LENGTH + FILE_DATA_NAME_LENGTH;
+
+	return fVolume->InodeSize() - sizeof(bfs_inode) - reserved;
+}
+
+
+/*!	Changes the size of the inline data item, and the file size with it.
+	Returns B_DEVICE_FULL if the data does not fit into the small_data
+	section anymore.
+*/
+status_t
+Inode::_SetInlineDataSize(Transaction& transaction, off_t size)
+{
+	if (size > (off_t)_InlineDataCapacity())
+		return B_DEVICE_FULL;
+
+	NodeGetter node(fVolume);
+	status_t status = node.SetToWritable(transaction, this);
+	if (status != B_OK)
+		return status;
+
+	const char dataTag[2] = {FILE_DATA_NAME, 0};
+
+	if (size == 0) {
+		status = _RemoveSmallData(transaction, node, dataTag);
+		if (status != B_OK && status != B_ENTRY_NOT_FOUND)
+			return status;
+	} else {
+		uint8* data = (uint8*)calloc(1, size);
+		if (data == NULL)
+			return B_NO_MEMORY;
+
+		MemoryDeleter dataDeleter(data);
+
+		{
+			RecursiveLocker locker(fSmallDataLock);
+
+			small_data* item = FindSmallData(node.Node(), dataTag);
+			if (item != NULL)
+				memcpy(data, item->Data(), min_c(item->DataSize(), size));
+		}
+
+		status = _AddSmallData(transaction, node, dataTag, FILE_DATA_TYPE, 0,
+			data, size);
+		if (status != B_OK)
+			return status;
+	}
+
+	Node().data.size = HOST_ENDIAN_TO_BFS_INT64(size);
+
+	file_cache_set_size(FileCache(), size);
+	file_map_set_size(Map(), size);
+
+	return WriteBack(transaction);
+}
+
+
+/*!	Converts a file with inline data into a regular one with a data stream.
+	The data is written to the newly allocated first block as part of the
+	transaction, so that it cannot get lost. Since the file cache accesses
+	the disk directly, the block cache must let go of the block before the
+	file is read or written, see ReleaseLoggedFirstBlock().
+*/
+status_t
+Inode::_MoveInlineDataToStream(Transaction& transaction)
+{
+	off_t size = Size();
+	uint32 blockSize = fVolume->BlockSize();
+
+	uint8* block = (uint8*)calloc(1, blockSize);
+	if (block == NULL)
+		return B_NO_MEMORY;
+
+	MemoryDeleter blockDeleter(block);
+
+	NodeGetter node(fVolume);
+	status_t status = node.SetToWritable(transaction, this);
+	if (status != B_OK)
+		return status;
+
+	const char dataTag[2] = {FILE_DATA_NAME, 0};
+
+	{
+		RecursiveLocker locker(fSmallDataLock);
+
+		small_data* item = FindSmallData(node.Node(), dataTag);
+		if (item != NULL) {
+			memcpy(block, item->Data(),
+				min_c(min_c(item->DataSize(), size), blockSize));
+		}
+	}
+
+	status = _RemoveSmallData(transaction, node, dataTag);
+	if (status != B_OK && status != B_ENTRY_NOT_FOUND)
+		return status;
+
+	Node().flags &= ~HOST_ENDIAN_TO_BFS_INT32(INODE_INLINE_DATA);
+	Node().data.size = 0;
+
+	if (size == 0)
+		return WriteBack(transaction);
+
+	status = _GrowStream(transaction, size);
+	if (status != B_OK)
+		return status;
+
+	block_run run;
+	off_t offset;
+	status = FindBlockRun(0, run, offset);
+	if (status != B_OK)
+		return status;
+
+	status = transaction.WriteBlocks(fVolume->ToBlock(run), block);
+	if (status != B_OK)
+		return status;
+
+	atomic_set(&fFirstBlockLogged, 1);
+	return WriteBack(transaction);
+}
+
+
+/*!	Hands the first block of a file that has just been moved out of its
+	inode over from the block cache to the file cache: the block is written
+	to its location on disk, so that the file cache can read it, and is then
+	removed from the block cache, so that it cannot overwrite anything the
+	file cache writes later on.
+	Writing the block before its transaction has been written to the log is
+	safe, as it is not in use before the transaction is.
+	You need to hold the inode's read lock when calling this method.
+*/
+void
+Inode::ReleaseLoggedFirstBlock()
+{
+	if (atomic_get(&fFirstBlockLogged) == 0)
+		return;
+
+	RecursiveLocker locker(fSmallDataLock);
+
+	if (fFirstBlockLogged == 0)
+		return;
+
+	block_run run;
+	off_t offset;
+	if (FindBlockRun(0, run, offset) == B_OK) {
+		CachedBlock cached(fVolume);
+		if (cached.SetTo(run) == B_OK) {
+			if (write_pos(fVolume->Device(), fVolume->ToOffset(run),
+					cached.Block(), fVolume->BlockSize())
+					!= (ssize_t)fVolume->BlockSize()) {
+				// leave it to the block cache, and try again later
+				return;
+			}
+		}
+		cached.Unset();
+
+		block_cache_discard(fVolume->BlockCache(), fVolume->ToBlock(run), 1);
+	}
+
+	atomic_set(&fFirstBlockLogged, 0);
+}
+
+
 /*!	Allocates \a length blocks, and clears their contents. Growing
 	the indirect and double indirect range uses this method.
 	The allocated block_run is saved in "run"
@@ -2308,6 +2595,11 @@ Inode::_ShrinkStream(Transaction& transaction, off_t size)
 			size, offset, *maxDirect);
 		if (status != B_OK)
 			return status;
+
+		if (size == 0) {
+			// the first block is gone, and will be discarded once reused
+			atomic_set(&fFirstBlockLogged, 0);
+		}
 	}
 
 	data->size = HOST_ENDIAN_TO_BFS_INT64(size);
@@ -2328,8 +2620,20 @@ Inode::SetFileSize(Transaction& transaction, off_t size)
 
 	T(Resize(this, oldSize, size, false));
 
-	// should the data stream grow or shrink?
 	status_t status;
+	if (HasInlineData()) {
+		status = _SetInlineDataSize(transaction, size);
+		if (status != B_DEVICE_FULL)
+			return status;
+
+		// the file has outgrown its inode
+		status = _MoveInlineDataToStream(transaction);
+		if (status != B_OK)
+			return status;
+
+	}
+
+	// should the data stream grow or shrink?
 	if (size > oldSize) {
 		status = _GrowStream(transaction, size);
 		if (status < B_OK) {
@@ -2790,6 +3094,11 @@ Inode::Create(Transaction& transaction, Inode* parent, const char* name,
 
 	node->type = HOST_ENDIAN_TO_BFS_INT32(type);
 
+	if (inode->IsFile() && volume->HasInlineData()) {
+		// the data is kept in the inode until the file outgrows it
+		node->flags |= HOST_ENDIAN_TO_BFS_INT32(INODE_INLINE_DATA);
+	}
+
 	inode->WriteBack(transaction);
 		// make sure the initialized node is available to others
 
@@ -2968,8 +3277,10 @@ AttributeIterator::GetNext(char* name, size_t* _length, uint32* _type,
 
 		int32 index = 0;
 		for (; !item->IsLast(node); item = item->Next(), index++) {
-			if (item->NameSize() == FILE_NAME_NAME_LENGTH
-				&& *item->Name() == FILE_NAME_NAME)
+			if ((item->NameSize() == FILE_NAME_NAME_LENGTH
+					&& *item->Name() == FILE_NAME_NAME)
+				|| (item->NameSize() == FILE_DATA_NAME_LENGTH
+					&& *item->Name() == FILE_DATA_NAME))
 				continue;
 
 			if (index >= fCurrentSmallData)
@@ -75,6 +75,9 @@ public:
 			bool				IsLongSymLink() const
 									{ return (Flags() & INODE_LONG_SYMLINK)
 										!= 0; }
+			bool				HasInlineData() const
+									{ return (Flags() & INODE_INLINE_DATA)
+										!= 0; }
 
 			bool				HasUserAccessableStream() const
 									{ return IsFile(); }
@@ -150,6 +153,14 @@ public:
 									const uint8* buffer, size_t* length);
 			status_t			FillGapWithZeros(off_t oldSize, off_t newSize);
 
+			// inline data (the inode must be locked)
+			status_t			ReadInlineData(off_t pos, uint8* buffer,
+									size_t* _length);
+			status_t			WriteInlineData(Transaction& transaction,
+									off_t pos, const uint8* buffer,
+									size_t* _length);
+			void				ReleaseLoggedFirstBlock();
+
 			status_t			SetFileSize(Transaction& transaction,
 									off_t size);
 			status_t			Append(Transaction& transaction, off_t bytes);
@@ -239,6 +250,12 @@ private:
 									const char* name, bool hasIndex,
 									Index* index);
 
+			size_t				_InlineDataCapacity() const;
+			status_t			_SetInlineDataSize(Transaction& transaction,
+									off_t size);
+			status_t			_MoveInlineDataToStream(
+									Transaction& transaction);
+
 			void				_AddIterator(AttributeIterator* iterator);
 			void				_RemoveIterator(AttributeIterator* iterator);
 
@@ -278,6 +295,9 @@ private:
 
 			mutable recursive_lock fSmallDataLock;
 			SinglyLinkedList<AttributeIterator> fIterators;
+			int32				fFirstBlockLogged;
+				// the first block still belongs to the block cache, see
+				// ReleaseLoggedFirstBlock()
 };
 
 
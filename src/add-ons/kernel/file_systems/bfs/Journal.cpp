@@ -71,10 +71,8 @@ public:
 			uint32			Start() const { return fStart; }
 			uint32			Length() const { return fLength; }
 
-#ifdef BFS_DEBUGGER_COMMANDS
 			void			SetTransactionID(int32 id) { fTransactionID = id; }
 			int32			TransactionID() const { return fTransactionID; }
-#endif
 
 			Journal*		GetJournal() { return fJournal; }
 
@@ -82,9 +80,7 @@ private:
 			Journal*		fJournal;
 			uint32			fStart;
 			uint32			fLength;
-#ifdef BFS_DEBUGGER_COMMANDS
 			int32			fTransactionID;
-#endif
 };
 
 
@@ -140,6 +136,15 @@ private:
 #endif
 
 
+static const uint32 kMinLogSize = 512;
+static const uint32 kMaxLogSize = 65535;
+	// the length of a block_run is only 16 bit wide
+static const uint32 kMaxAutomaticLogSize = 16384;
+static const int32 kLogStallsUntilGrowth = 8;
+	// how often transactions have to wait for the log to be written back,
+	// before the log is grown automatically
+
+
 //	#pragma mark -
 
 
@@ -164,6 +169,33 @@ add_to_iovec(iovec* vecs, int32& index, int32 max, const void* address,
 }
 
 
+/*!	Puts the parts of \a run that are not covered by \a other into
+	\a runs, and returns their number (0 to 2). Both runs must be in the same
+	allocation group.
+*/
+static int32
+subtract_log_runs(block_run run, block_run other, block_run* runs)
+{
+	int32 start = run.Start();
+	int32 end = start + run.Length();
+	int32 otherStart = other.Start();
+	int32 otherEnd = otherStart + other.Length();
+	int32 count = 0;
+
+	if (start < otherStart) {
+		runs[count++] = block_run::Run(run.AllocationGroup(), start,
+			min_c(end, otherStart) - start);
+	}
+	if (end > otherEnd) {
+		int32 first = max_c(start, otherEnd);
+		runs[count++] = block_run::Run(run.AllocationGroup(), first,
+			end - first);
+	}
+
+	return count;
+}
+
+
 //	#pragma mark - LogEntry
 
 
@@ -171,7 +203,8 @@ LogEntry::LogEntry(Journal* journal, uint32 start, uint32 length)
 	:
 	fJournal(journal),
 	fStart(start),
-	fLength(length)
+	fLength(length),
+	fTransactionID(-1)
 {
 }
 
@@ -407,10 +440,15 @@ Journal::Journal(Volume* volume)
 	fUsed(0),
 	fUnwrittenTransactions(0),
 	fHasSubtransaction(false),
-	fSeparateSubTransactions(false)
+	fSeparateSubTransactions(false),
+	fLogStalls(0),
+	fGrowLog(0),
+	fWriteBackLog(0),
+	fAutomaticLogGrowth(false)
 {
 	recursive_lock_init(&fLock, "bfs journal");
 	mutex_init(&fEntriesLock, "bfs journal entries");
+	mutex_init(&fResizeLock, "bfs journal resize");
 
 	fLogFlusherSem = create_sem(0, "bfs log flusher");
 	fLogFlusher = spawn_kernel_thread(&Journal::_LogFlusher, "bfs log flusher",
@@ -422,15 +460,12 @@ Journal::Journal(Volume* volume)
 
 Journal::~Journal()
 {
+	StopLogFlusher();
 	FlushLogAndBlocks();
 
 	recursive_lock_destroy(&fLock);
 	mutex_destroy(&fEntriesLock);
-
-	sem_id logFlusher = fLogFlusherSem;
-	fLogFlusherSem = -1;
-	delete_sem(logFlusher);
-	wait_for_thread(fLogFlusher, NULL);
+	mutex_destroy(&fResizeLock);
 }
 
 
@@ -441,6 +476,22 @@ Journal::InitCheck()
 }
 
 
+/*!	Stops the log flusher thread. Since it may resize the log, this must be
+	done before the block allocator is uninitialized.
+*/
+void
+Journal::StopLogFlusher()
+{
+	sem_id logFlusher = fLogFlusherSem;
+	if (logFlusher < 0)
+		return;
+
+	fLogFlusherSem = -1;
+	delete_sem(logFlusher);
+	wait_for_thread(fLogFlusher, NULL);
+}
+
+
 /*!	\brief Does a very basic consistency check of the run array.
 	It will check the maximum run count as well as if all of the runs fall
 	within a the volume.
@@ -713,6 +764,29 @@ Journal::_LogFlusher(void* _journal)
 		if (acquire_sem(journal->fLogFlusherSem) != B_OK)
 			continue;
 
+		if (atomic_test_and_set(&journal->fGrowLog, 0, 1) != 0) {
+			uint32 length = min_c(2 * journal->fLogSize, kMaxAutomaticLogSize);
+			status_t status = journal->ResizeLog(length);
+			if (status != B_OK) {
+				// the blocks after the log won't become free by themselves
+				journal->fAutomaticLogGrowth = false;
+				FATAL(("could not grow log to %" B_PRIu32 " blocks: %s\n",
+					length, strerror(status)));
+			}
+		}
+
+		if (atomic_test_and_set(&journal->fWriteBackLog, 0, 1) != 0) {
+			// Write back the oldest log entries until half of the log is
+			// free again, so that transactions do not have to wait for
+			// this in _MakeLogSpace()
+			int32 transactionID
+				= journal->_LastEntryToWriteBack(journal->fLogSize / 2);
+			if (transactionID >= 0) {
+				cache_sync_transaction(journal->fVolume->BlockCache(),
+					transactionID);
+			}
+		}
+
 		journal->_FlushLog(false, false);
 	}
 	return B_OK;
@@ -789,7 +863,7 @@ Journal::_WriteTransactionToLog()
 	// If necessary, flush the log, so that we have enough space for this
 	// transaction
 	if (runArrays.LogEntryLength() > FreeLogBlocks()) {
-		cache_sync_transaction(fVolume->BlockCache(), fTransactionID);
+		_MakeLogSpace(runArrays.LogEntryLength());
 		if (runArrays.LogEntryLength() > FreeLogBlocks()) {
 			panic("no space in log after sync (%ld for %ld blocks)!",
 				(long)FreeLogBlocks(), (long)runArrays.LogEntryLength());
@@ -874,9 +948,7 @@ Journal::_WriteTransactionToLog()
 		return B_NO_MEMORY;
 	}
 
-#ifdef BFS_DEBUGGER_COMMANDS
 	logEntry->SetTransactionID(fTransactionID);
-#endif
 
 	// Update the log end pointer in the superblock
 
@@ -919,6 +991,12 @@ Journal::_WriteTransactionToLog()
 		fUnwrittenTransactions = 0;
 	}
 
+	if (FreeLogBlocks() < fLogSize / 2
+		&& atomic_test_and_set(&fWriteBackLog, 1, 0) == 0) {
+		// let the log flusher make room in the background
+		release_sem(fLogFlusherSem);
+	}
+
 	return status;
 }
 
@@ -995,6 +1073,29 @@ Journal::Lock(Transaction* owner, bool separateSubTransactions)
 	if (status != B_OK)
 		return status;
 
+	return _Locked(owner, separateSubTransactions);
+}
+
+
+/*!	Like Lock(), but fails with \c B_WOULD_BLOCK instead of waiting when
+	another thread currently owns the journal.
+*/
+status_t
+Journal::TryLock(Transaction* owner)
+{
+	if (recursive_lock_trylock(&fLock) != B_OK)
+		return B_WOULD_BLOCK;
+
+	return _Locked(owner, false);
+}
+
+
+/*!	Starts the transaction of \a owner, or joins the current one, after the
+	journal lock has been acquired.
+*/
+status_t
+Journal::_Locked(Transaction* owner, bool separateSubTransactions)
+{
 	if (!fSeparateSubTransactions && recursive_lock_get_recursion(&fLock) > 1) {
 		// we'll just use the current transaction again
 		return B_OK;
@@ -1087,6 +1188,61 @@ Journal::_TransactionSize() const
 }
 
 
+/*!	Returns the ID of the transaction of the newest log entry that has to be
+	written back so that \a length blocks of the log are free, or -1 if there
+	is enough space already.
+*/
+int32
+Journal::_LastEntryToWriteBack(uint32 length)
+{
+	int32 transactionID = -1;
+
+	MutexLocker locker(fEntriesLock);
+
+	uint32 freeBlocks = FreeLogBlocks();
+	LogEntryList::Iterator iterator = fEntries.GetIterator();
+	while (freeBlocks < length && iterator.HasNext()) {
+		LogEntry* entry = iterator.Next();
+		freeBlocks += entry->Length();
+		transactionID = entry->TransactionID();
+	}
+
+	return transactionID;
+}
+
+
+/*!	Makes room for \a length blocks in the log. Instead of writing back all
+	pending transactions, only as many of the oldest log entries as needed
+	are written back.
+	The log flusher usually does this in the background long before the log
+	runs full, see _WriteTransactionToLog(). If it could not keep up, there
+	is no way around waiting for the blocks to be written here, as a log
+	entry must not overwrite entries whose blocks are still unwritten.
+	If this happens regularly, and the volume has been mounted with the
+	"grow_log" option, the log flusher is asked to grow the log.
+*/
+void
+Journal::_MakeLogSpace(uint32 length)
+{
+	int32 transactionID = _LastEntryToWriteBack(length);
+	if (transactionID >= 0)
+		cache_sync_transaction(fVolume->BlockCache(), transactionID);
+	if (length > FreeLogBlocks())
+		cache_sync_transaction(fVolume->BlockCache(), fTransactionID);
+
+	if (++fLogStalls >= kLogStallsUntilGrowth) {
+		fLogStalls = 0;
+
+		if (fAutomaticLogGrowth && fLogSize < kMaxAutomaticLogSize
+			&& 2 * fLogSize <= fVolume->NumBlocks() / 64
+			&& !fVolume->IsInitializing()) {
+			atomic_set(&fGrowLog, 1);
+			release_sem(fLogFlusherSem);
+		}
+	}
+}
+
+
 status_t
 Journal::_TransactionDone(bool success)
 {
@@ -1109,7 +1265,7 @@ Journal::_TransactionDone(bool success)
 		// Flush the log from time to time, so that we have enough space
 		// for this transaction
 		if (size > FreeLogBlocks())
-			cache_sync_transaction(fVolume->BlockCache(), fTransactionID);
+			_MakeLogSpace(size);
 
 		fUnwrittenTransactions++;
 		return B_OK;
@@ -1143,23 +1299,21 @@ Journal::MoveLog(block_run newLog)
 		return B_BAD_VALUE;
 
 	status_t status;
-	block_run allocatedRun = {};
+	block_run allocatedRuns[2];
+	int32 allocatedCount = subtract_log_runs(newLog, oldLog, allocatedRuns);
 
 	BlockAllocator& allocator = fVolume->Allocator();
 
 	// allocate blocks if necessary
-	if (newEnd > oldEnd) {
-		if (oldEnd > newLog.Start())
-			allocatedRun.SetTo(newLog.AllocationGroup(), oldEnd, newEnd - oldEnd);
-		else
-			allocatedRun = newLog;
-
+	if (allocatedCount > 0) {
 		Transaction transaction(fVolume, 0);
 
-		status = allocator.AllocateBlockRun(transaction, allocatedRun);
-		if (status != B_OK) {
-			FATAL(("MoveLog: Could not allocate space to move log area!\n"));
-			return status;
+		for (int32 i = 0; i < allocatedCount; i++) {
+			status = allocator.AllocateBlockRun(transaction, allocatedRuns[i]);
+			if (status != B_OK) {
+				FATAL(("MoveLog: Could not allocate space to move log area!\n"));
+				return status;
+			}
 		}
 
 		status = transaction.Done();
@@ -1173,18 +1327,28 @@ Journal::MoveLog(block_run newLog)
 	if (status != B_OK)
 		return status;
 
+	// make sure all log entries are gone, so that the log can be restarted
+	// at its new location
+	cache_sync_transaction(fVolume->BlockCache(), fTransactionID);
+
 	// update references to the log location and size
-	fVolume->SuperBlock().log_blocks = newLog;
+	disk_super_block& superBlock = fVolume->SuperBlock();
+	superBlock.log_blocks = newLog;
+	superBlock.log_start = superBlock.log_end = 0;
 	status = fVolume->WriteSuperBlock();
 	if (status != B_OK) {
-		fVolume->SuperBlock().log_blocks = oldLog;
+		superBlock.log_blocks = oldLog;
+		superBlock.log_start = HOST_ENDIAN_TO_BFS_INT64(fVolume->LogStart());
+		superBlock.log_end = HOST_ENDIAN_TO_BFS_INT64(fVolume->LogEnd());
 
 		Unlock(NULL, true);
 
 		// if we had to allocate some blocks, try to free them
-		if (!allocatedRun.IsZero()) {
+		if (allocatedCount > 0) {
 			Transaction transaction(fVolume, 0);
-			status_t freeStatus = allocator.Free(transaction, allocatedRun);
+			status_t freeStatus = B_OK;
+			for (int32 i = 0; i < allocatedCount && freeStatus == B_OK; i++)
+				freeStatus = allocator.Free(transaction, allocatedRuns[i]);
 			if (freeStatus == B_OK)
 				freeStatus = transaction.Done();
 
@@ -1196,8 +1360,11 @@ Journal::MoveLog(block_run newLog)
 		return status;
 	}
 
+	fVolume->LogStart() = 0;
+	fVolume->LogEnd() = 0;
 	fLogSize = newLog.Length();
 	fMaxTransactionSize = fLogSize / 2 - 5;
+	fLogStalls = 0;
 
 	Unlock(NULL, true);
 	volumeLock.Unlock();
@@ -1205,12 +1372,14 @@ Journal::MoveLog(block_run newLog)
 	// at this point, the log is moved and functional in its new location
 
 	// free blocks if necessary
-	if (newEnd < oldEnd) {
-		block_run runToFree = block_run::Run(0, newEnd, oldEnd - newEnd);
-
+	block_run freedRuns[2];
+	int32 freedCount = subtract_log_runs(oldLog, newLog, freedRuns);
+	if (freedCount > 0) {
 		Transaction transaction(fVolume, 0);
 
-		status = allocator.Free(transaction, runToFree);
+		status = B_OK;
+		for (int32 i = 0; i < freedCount && status == B_OK; i++)
+			status = allocator.Free(transaction, freedRuns[i]);
 		if (status == B_OK)
 			status = transaction.Done();
 
@@ -1224,6 +1393,56 @@ Journal::MoveLog(block_run newLog)
 }
 
 
+/*!	Changes the size of the log area to \a length blocks. The log grows in
+	place if the blocks after it are free, otherwise it is moved to the first
+	free range large enough within the first allocation group.
+	Like MoveLog(), this must not be called with the journal locked.
+*/
+status_t
+Journal::ResizeLog(uint32 length)
+{
+	if (length < kMinLogSize || length > kMaxLogSize)
+		return B_BAD_VALUE;
+	if (fVolume->IsReadOnly())
+		return B_READ_ONLY_DEVICE;
+
+	MutexLocker resizeLocker(fResizeLock);
+
+	block_run oldLog = fVolume->Log();
+	if (length == oldLog.Length())
+		return B_OK;
+
+	block_run newLog = block_run::Run(0, oldLog.Start(), length);
+
+	if (length > oldLog.Length()) {
+		off_t oldEnd = oldLog.Start() + oldLog.Length();
+		off_t groupEnd = min_c(1LL << fVolume->AllocationGroupShift(),
+			fVolume->NumBlocks());
+
+		// The log must fit into the first allocation group, and must not
+		// take away the last free blocks of the volume
+		if (length > groupEnd - 1 - fVolume->NumBitmapBlocks())
+			return B_BAD_VALUE;
+		if (length - oldLog.Length() > fVolume->FreeBlocks() / 2)
+			return B_DEVICE_FULL;
+
+		// Everything up to the end of the log is reserved, so the log can
+		// only grow into the free blocks right after it; moving it further
+		// would put the blocks in between out of reach of the allocator.
+		if (oldLog.Start() + length > groupEnd
+			|| fVolume->Allocator().CheckBlocks(oldEnd,
+				length - oldLog.Length(), false) != B_OK) {
+			return B_DEVICE_FULL;
+		}
+	}
+
+	INFORM(("resizing log from %u to %" B_PRIu32 " blocks\n",
+		oldLog.Length(), length));
+
+	return MoveLog(newLog);
+}
+
+
 //	#pragma mark - debugger commands
 
 
@@ -1239,6 +1458,7 @@ Journal::Dump()
 	kprintf("  owner:                %p\n", fOwner);
 	kprintf("  log size:             %" B_PRIu32 "\n", fLogSize);
 	kprintf("  max transaction size: %" B_PRIu32 "\n", fMaxTransactionSize);
+	kprintf("  log stalls:           %" B_PRId32 "\n", fLogStalls);
 	kprintf("  used:                 %" B_PRIu32 "\n", fUsed);
 	kprintf("  unwritten:            %" B_PRId32 "\n", fUnwrittenTransactions);
 	kprintf("  timestamp:            %" B_PRId64 "\n", fTimestamp);
@@ -1310,6 +1530,28 @@ Transaction::Start(Volume* volume, off_t refBlock)
 }
 
 
+/*!	Like Start(), but does not wait if another thread is currently running
+	a transaction; \c B_WOULD_BLOCK is returned in this case.
+*/
+status_t
+Transaction::TryStart(Volume* volume, off_t refBlock)
+{
+	// has it already been started?
+	if (fJournal != NULL)
+		return B_OK;
+
+	fJournal = volume->GetJournal(refBlock);
+	if (fJournal == NULL)
+		return B_ERROR;
+
+	status_t status = fJournal->TryLock(this);
+	if (status != B_OK)
+		fJournal = NULL;
+
+	return status;
+}
+
+
 void
 Transaction::AddListener(TransactionListener* listener)
 {
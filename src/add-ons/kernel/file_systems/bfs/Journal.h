@@ -24,9 +24,11 @@ public:
 							~Journal();
 
 			status_t		InitCheck();
+			void			StopLogFlusher();
 
 			status_t		Lock(Transaction* owner,
 								bool separateSubTransactions);
+			status_t		TryLock(Transaction* owner);
 			status_t		Unlock(Transaction* owner, bool success);
 			void			AssertLocked() { ASSERT_LOCKED_RECURSIVE(&fLock); }
 
@@ -44,6 +46,9 @@ public:
 	inline	uint32			FreeLogBlocks() const;
 
 			status_t		MoveLog(block_run newLog);
+			status_t		ResizeLog(uint32 length);
+			void			SetAutomaticLogGrowth(bool enabled)
+								{ fAutomaticLogGrowth = enabled; }
 
 #ifdef BFS_DEBUGGER_COMMANDS
 			void			Dump();
@@ -53,9 +58,13 @@ private:
 			bool			_HasSubTransaction() const
 								{ return fHasSubtransaction; }
 
+			status_t		_Locked(Transaction* owner,
+								bool separateSubTransactions);
 			status_t		_FlushLog(bool canWait, bool flushBlocks,
 								bool alreadyLocked = false);
 			uint32			_TransactionSize() const;
+			int32			_LastEntryToWriteBack(uint32 length);
+			void			_MakeLogSpace(uint32 length);
 			status_t		_WriteTransactionToLog();
 			status_t		_CheckRunArray(const run_array* array);
 			status_t		_ReplayRunArray(int32* start);
@@ -76,11 +85,16 @@ private:
 			uint32			fUsed;
 			int32			fUnwrittenTransactions;
 			mutex			fEntriesLock;
+			mutex			fResizeLock;
 			LogEntryList	fEntries;
 			bigtime_t		fTimestamp;
 			int32			fTransactionID;
 			bool			fHasSubtransaction;
 			bool			fSeparateSubTransactions;
+			int32			fLogStalls;
+			int32			fGrowLog;
+			int32			fWriteBackLog;
+			bool			fAutomaticLogGrowth;
 
 			thread_id		fLogFlusher;
 			sem_id			fLogFlusherSem;
@@ -141,6 +155,7 @@ public:
 	}
 
 	status_t Start(Volume* volume, off_t refBlock);
+	status_t TryStart(Volume* volume, off_t refBlock);
 	bool IsStarted() const { return fJournal != NULL; }
 
 	status_t Done()
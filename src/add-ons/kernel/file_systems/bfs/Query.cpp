@@ -9,6 +9,7 @@
 
 #include "BPlusTree.h"
 #include "bfs.h"
+#include "bfs_control.h"
 #include "Debug.h"
 #include "Index.h"
 #include "Inode.h"
@@ -26,11 +27,15 @@ struct Query::QueryPolicy {
 	typedef ::Inode Node;
 
 	struct Index : ::Index {
+		Volume* volume;
 		bool isSpecialTime;
+		char trigramName[B_FILE_NAME_LENGTH];
+			// ::Index::SetTo() only stores the name pointer
 
 		Index(Context* context)
 			:
 			::Index(context->fVolume),
+			volume(context->fVolume),
 			isSpecialTime(false)
 		{
 		}
@@ -116,6 +121,21 @@ struct Query::QueryPolicy {
 		return status;
 	}
 
+	static status_t IndexSetToTrigrams(Index& index, const char* attribute)
+	{
+		if (!index.volume->HasTrigramIndices())
+			return B_ENTRY_NOT_FOUND;
+
+		if (snprintf(index.trigramName, sizeof(index.trigramName), "%s%s",
+				BFS_TRIGRAM_INDEX_PREFIX, attribute)
+					>= (int)sizeof(index.trigramName)) {
+			return B_NAME_TOO_LONG;
+		}
+
+		index.isSpecialTime = false;
+		return index.SetTo(index.trigramName);
+	}
+
 	static void IndexUnset(Index& index)
 	{
 		index.Unset();
@@ -129,6 +149,45 @@ struct Query::QueryPolicy {
 		return size;
 	}
 
+	static int32 IndexEstimateMatches(Index& index, int32 op,
+		const void* value, size_t size, bool isPrefix)
+	{
+		int64 shiftedTime;
+		if (index.isSpecialTime && !isPrefix) {
+			// int64 time index; convert value.
+			shiftedTime = *(int64*)value << INODE_TIME_SHIFT;
+			value = &shiftedTime;
+		}
+
+		const uint8* key = (const uint8*)value;
+		int64 estimate;
+		if (isPrefix) {
+			estimate = size == 0 ? index.CountEntries()
+				: index.EstimateRange(key, size, key, size);
+		} else {
+			switch (op) {
+				case QueryParser::OP_EQUAL:
+					estimate = index.EstimateEqual(key, size);
+					break;
+				case QueryParser::OP_LESS_THAN:
+				case QueryParser::OP_LESS_THAN_OR_EQUAL:
+					estimate = index.EstimateRange(NULL, 0, key, size);
+					break;
+				case QueryParser::OP_GREATER_THAN:
+				case QueryParser::OP_GREATER_THAN_OR_EQUAL:
+					estimate = index.EstimateRange(key, size, NULL, 0);
+					break;
+				default:
+					estimate = index.CountEntries();
+					break;
+			}
+		}
+
+		if (estimate > INT32_MAX)
+			return INT32_MAX;
+		return estimate;
+	}
+
 	static type_code IndexGetType(Index& index)
 	{
 		return index.Type();
@@ -205,6 +264,11 @@ struct Query::QueryPolicy {
 		return B_OK;
 	}
 
+	static ino_t IndexIteratorGetNodeID(IndexIterator* iterator)
+	{
+		return iterator->offset;
+	}
+
 	static void IndexIteratorSkipDuplicates(IndexIterator* iterator)
 	{
 		iterator->SkipDuplicates();
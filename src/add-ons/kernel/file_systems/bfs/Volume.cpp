@@ -8,6 +8,8 @@
 
 
 #include "Attribute.h"
+#include "bfs_control.h"
+#include "BPlusTree.h"
 #include "CheckVisitor.h"
 #include "Debug.h"
 #include "file_systems/DeviceOpener.h"
@@ -35,7 +37,8 @@ static const int32 kDesiredAllocationGroups = 56;
 bool
 disk_super_block::IsMagicValid() const
 {
-	return Magic1() == (int32)SUPER_BLOCK_MAGIC1
+	return (Magic1() == (int32)SUPER_BLOCK_MAGIC1
+			|| Magic1() == (int32)SUPER_BLOCK_MAGIC1_FEATURES)
 		&& Magic2() == (int32)SUPER_BLOCK_MAGIC2
 		&& Magic3() == (int32)SUPER_BLOCK_MAGIC3;
 }
@@ -122,6 +125,19 @@ disk_super_block::Initialize(const char* diskName, off_t numBlocks,
 }
 
 
+/*!	Sets the incompatible features the volume uses. As soon as there are
+	any, the volume gets a different magic, so that implementations that do
+	not know about features at all refuse to mount it.
+*/
+void
+disk_super_block::SetFeatures(uint32 newFeatures)
+{
+	magic1 = HOST_ENDIAN_TO_BFS_INT32(newFeatures != 0
+		? SUPER_BLOCK_MAGIC1_FEATURES : SUPER_BLOCK_MAGIC1);
+	features = HOST_ENDIAN_TO_BFS_INT32(newFeatures);
+}
+
+
 //	#pragma mark -
 
 
@@ -132,17 +148,23 @@ Volume::Volume(fs_volume* volume)
 	fRootNode(NULL),
 	fIndicesNode(NULL),
 	fDirtyCachedBlocks(0),
+	fTrigramIndices(0),
 	fFlags(0),
 	fCheckingThread(-1),
 	fCheckVisitor(NULL)
 {
 	mutex_init(&fLock, "bfs volume");
 	mutex_init(&fQueryLock, "bfs queries");
+	mutex_init(&fIndexStatisticsLock, "bfs index statistics");
 }
 
 
 Volume::~Volume()
 {
+	while (IndexStatistics* statistics = fIndexStatistics.RemoveHead())
+		delete statistics;
+
+	mutex_destroy(&fIndexStatisticsLock);
 	mutex_destroy(&fQueryLock);
 	mutex_destroy(&fLock);
 }
@@ -199,6 +221,11 @@ Volume::Mount(const char* deviceName, uint32 flags)
 		FATAL(("invalid superblock!\n"));
 		return B_BAD_VALUE;
 	}
+	if ((fSuperBlock.Features() & ~SUPER_BLOCK_FEATURES_SUPPORTED) != 0) {
+		FATAL(("unsupported file system features: %#" B_PRIx32 "\n",
+			fSuperBlock.Features() & ~SUPER_BLOCK_FEATURES_SUPPORTED));
+		return B_NOT_SUPPORTED;
+	}
 
 	// initialize short hands to the superblock (to save byte swapping)
 	fBlockSize = fSuperBlock.BlockSize();
@@ -276,6 +303,7 @@ Volume::Mount(const char* deviceName, uint32 flags)
 				}
 			} else {
 				// we don't use the vnode layer to access the indices node
+				_CountTrigramIndices();
 			}
 		} else {
 			FATAL(("could not create root node: publish_vnode() failed!\n"));
@@ -302,6 +330,7 @@ Volume::Unmount()
 {
 	put_vnode(fVolume, ToVnode(Root()));
 
+	fJournal->StopLogFlusher();
 	fBlockAllocator.Uninitialize();
 
 	// This will also flush the log & all blocks to disk
@@ -487,6 +516,61 @@ Volume::RemoveQuery(Query* query)
 }
 
 
+/*!	Returns the statistics of the index with the specified name, if they
+	have been created already. You need to hold the IndexStatisticsLock()
+	while calling this method, and for as long as you access the object.
+*/
+IndexStatistics*
+Volume::FindIndexStatistics(const char* name)
+{
+	ASSERT_LOCKED_MUTEX(&fIndexStatisticsLock);
+
+	IndexStatisticsList::Iterator iterator = fIndexStatistics.GetIterator();
+	while (IndexStatistics* statistics = iterator.Next()) {
+		if (strcmp(statistics->Name(), name) == 0)
+			return statistics;
+	}
+
+	return NULL;
+}
+
+
+/*!	Takes over ownership of the \a statistics object. You need to hold the
+	IndexStatisticsLock().
+*/
+void
+Volume::AddIndexStatistics(IndexStatistics* statistics)
+{
+	ASSERT_LOCKED_MUTEX(&fIndexStatisticsLock);
+
+	fIndexStatistics.Add(statistics);
+}
+
+
+void
+Volume::RemoveIndexStatistics(const char* name)
+{
+	MutexLocker _(fIndexStatisticsLock);
+
+	IndexStatistics* statistics = FindIndexStatistics(name);
+	if (statistics != NULL)
+		RemoveIndexStatistics(statistics);
+}
+
+
+/*!	Removes and deletes the  statistics object. You need to hold the
+	IndexStatisticsLock().
+*/
+void
+Volume::RemoveIndexStatistics(IndexStatistics* statistics)
+{
+	ASSERT_LOCKED_MUTEX(&fIndexStatisticsLock);
+
+	fIndexStatistics.Remove(statistics);
+	delete statistics;
+}
+
+
 status_t
 Volume::CreateCheckVisitor()
 {
@@ -589,6 +673,8 @@ Volume::Initialize(int fd, const char* name, uint32 blockSize,
 	// create valid superblock
 
 	fSuperBlock.Initialize(name, numBlocks, blockSize);
+	if ((flags & VOLUME_INLINE_DATA) != 0)
+		fSuperBlock.SetFeatures(SUPER_BLOCK_FEATURE_INLINE_DATA);
 
 	// initialize short hands to the superblock (to save byte swapping)
 	fBlockSize = fSuperBlock.BlockSize();
@@ -701,3 +787,31 @@ Volume::_EraseUnusedBootBlock()
 
 	return B_OK;
 }
+
+
+/*!	Counts the trigram indices of this volume, so that Index::Update() does
+	not need to look them up for every attribute change if there are none.
+*/
+void
+Volume::_CountTrigramIndices()
+{
+	BPlusTree* tree = fIndicesNode->Tree();
+	if (tree == NULL)
+		return;
+
+	const uint16 prefixLength = strlen(BFS_TRIGRAM_INDEX_PREFIX);
+
+	TreeIterator iterator(tree);
+	iterator.Find((const uint8*)BFS_TRIGRAM_INDEX_PREFIX, prefixLength);
+
+	char name[B_FILE_NAME_LENGTH];
+	uint16 length;
+	ino_t id;
+	while (iterator.GetNextEntry(name, &length, sizeof(name), &id) == B_OK) {
+		if (length < prefixLength
+			|| strncmp(name, BFS_TRIGRAM_INDEX_PREFIX, prefixLength) != 0)
+			break;
+
+		fTrigramIndices++;
+	}
+}
@@ -10,6 +10,7 @@
 
 #include "bfs.h"
 #include "BlockAllocator.h"
+#include "IndexStatistics.h"
 
 
 class CheckVisitor;
@@ -24,6 +25,7 @@ enum volume_flags {
 
 enum volume_initialize_flags {
 	VOLUME_NO_INDICES	= 0x0001,
+	VOLUME_INLINE_DATA	= 0x0002,
 };
 
 typedef DoublyLinkedList<Inode> InodeList;
@@ -138,6 +140,27 @@ public:
 			void			AddQuery(Query* query);
 			void			RemoveQuery(Query* query);
 
+			// index statistics
+			mutex&			IndexStatisticsLock()
+								{ return fIndexStatisticsLock; }
+			IndexStatistics* FindIndexStatistics(const char* name);
+			void			AddIndexStatistics(IndexStatistics* statistics);
+			void			RemoveIndexStatistics(const char* name);
+			void			RemoveIndexStatistics(
+								IndexStatistics* statistics);
+
+			bool			HasInlineData() const
+								{ return (fSuperBlock.Features()
+									& SUPER_BLOCK_FEATURE_INLINE_DATA) != 0; }
+
+			// trigram indices
+			bool			HasTrigramIndices() const
+								{ return fTrigramIndices > 0; }
+			void			AddTrigramIndex()
+								{ atomic_add(&fTrigramIndices, 1); }
+			void			RemoveTrigramIndex()
+								{ atomic_add(&fTrigramIndices, -1); }
+
 			status_t		Sync();
 			Journal*		GetJournal(off_t refBlock) const;
 
@@ -149,6 +172,7 @@ public:
 
 private:
 			status_t		_EraseUnusedBootBlock();
+			void			_CountTrigramIndices();
 
 protected:
 			fs_volume*		fVolume;
@@ -174,6 +198,10 @@ protected:
 			mutex			fQueryLock;
 			DoublyLinkedList<Query> fQueries;
 
+			mutex			fIndexStatisticsLock;
+			IndexStatisticsList fIndexStatistics;
+			int32			fTrigramIndices;
+
 			uint32			fFlags;
 
 			void*			fBlockCache;
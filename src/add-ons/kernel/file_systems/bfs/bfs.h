@@ -76,7 +76,8 @@ struct disk_super_block {
 	int32		magic3;
 	inode_addr	root_dir;
 	inode_addr	indices;
-	int32		_reserved[8];
+	uint32		features;
+	int32		_reserved[7];
 	int32		pad_to_block[87];
 		// this also contains parts of the boot block
 
@@ -95,6 +96,7 @@ struct disk_super_block {
 	int32 AllocationGroupShift() const
 		{ return BFS_ENDIAN_TO_HOST_INT32(ag_shift); }
 	int32 Flags() const { return BFS_ENDIAN_TO_HOST_INT32(flags); }
+	inline uint32 Features() const;
 	off_t LogStart() const { return BFS_ENDIAN_TO_HOST_INT64(log_start); }
 	off_t LogEnd() const { return BFS_ENDIAN_TO_HOST_INT64(log_end); }
 
@@ -102,17 +104,38 @@ struct disk_super_block {
 	bool IsMagicValid() const;
 	bool IsValid() const;
 	void Initialize(const char *name, off_t numBlocks, uint32 blockSize);
+	void SetFeatures(uint32 features);
 } _PACKED;
 
 #define SUPER_BLOCK_FS_LENDIAN		'BIGE'		/* BIGE */
 
 #define SUPER_BLOCK_MAGIC1			'BFS1'		/* BFS1 */
+#define SUPER_BLOCK_MAGIC1_FEATURES	'BFS2'		/* BFS2 */
+	// used instead if any of the features below are in use; older
+	// implementations do not recognize, and therefore never mount, the volume
 #define SUPER_BLOCK_MAGIC2			0xdd121031
 #define SUPER_BLOCK_MAGIC3			0x15b6830e
 
 #define SUPER_BLOCK_DISK_CLEAN		'CLEN'		/* CLEN */
 #define SUPER_BLOCK_DISK_DIRTY		'DIRT'		/* DIRT */
 
+// Incompatible on-disk features; "features" is only valid with
+// SUPER_BLOCK_MAGIC1_FEATURES, and volumes with unknown ones must not be
+// mounted
+#define SUPER_BLOCK_FEATURE_INLINE_DATA	0x00000001
+	// small files may keep their contents in the inode's small data area
+#define SUPER_BLOCK_FEATURES_SUPPORTED	SUPER_BLOCK_FEATURE_INLINE_DATA
+
+
+inline uint32
+disk_super_block::Features() const
+{
+	if (Magic1() != (int32)SUPER_BLOCK_MAGIC1_FEATURES)
+		return 0;
+
+	return BFS_ENDIAN_TO_HOST_INT32(features);
+}
+
 //**************************************
 
 #define NUM_DIRECT_BLOCKS			12
@@ -172,6 +195,11 @@ struct small_data {
 #define FILE_NAME_NAME			0x13
 #define FILE_NAME_NAME_LENGTH	1
 
+// The contents of inline files are part of the small_data structure as well
+#define FILE_DATA_TYPE			'RAWT'
+#define FILE_DATA_NAME			0x14
+#define FILE_DATA_NAME_LENGTH	1
+
 // The maximum key length of attribute data that is put  in the index.
 // This excludes a terminating null byte.
 // This must be smaller than or equal as BPLUSTREE_MAX_KEY_LENGTH.
@@ -266,6 +294,7 @@ enum inode_flags {
 	INODE_DELETED			= 0x00000010,
 	INODE_NOT_READY			= 0x00000020,	// used during Inode construction
 	INODE_LONG_SYMLINK		= 0x00000040,	// symlink in data stream
+	INODE_INLINE_DATA		= 0x00000080,	// file data in small data area
 
 	INODE_PERMANENT_FLAGS	= 0x0000ffff,
 
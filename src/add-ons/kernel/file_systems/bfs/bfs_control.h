@@ -103,5 +103,21 @@ struct check_control {
  */
 #define BFS_IOCTL_RESIZE		14205
 
+/* Resizes the log area of a mounted volume. The parameter is a uint32 with
+ * the desired number of blocks (512 - 65535). The log can only grow into
+ * free blocks directly following it, B_DEVICE_FULL is returned otherwise.
+ */
+#define BFS_IOCTL_RESIZE_LOG	14206
+
+
+/* A string index named with this prefix followed by an attribute name, for
+ * example "BFS:trigrams:name", does not index the attribute values
+ * themselves, but all distinct (ASCII case-folded) three byte sequences they
+ * contain. Queries use it for substring and case-insensitive patterns like
+ * "*[Hh][Oo][Ww]*" that could otherwise not make use of an index.
+ * Like any other index, it only covers values written after its creation.
+ */
+#define BFS_TRIGRAM_INDEX_PREFIX	"BFS:trigrams:"
+
 
 #endif	/* BFS_CONTROL_H */
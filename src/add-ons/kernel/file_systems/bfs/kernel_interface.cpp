@@ -118,6 +118,197 @@ iterative_io_finished_hook(void* cookie, io_request* request, status_t status,
 }
 
 
+/*!	Reads the pages of a file that keeps its data inline; everything beyond
+	the end of the file is cleared.
+	You need to hold the inode's read lock when calling this function.
+*/
+static status_t
+read_inline_data_pages(Inode* inode, off_t pos, const iovec* vecs,
+	size_t count, size_t numBytes)
+{
+	size_t length = 0;
+	if (pos < inode->Size())
+		length = min_c(numBytes, (size_t)(inode->Size() - pos));
+
+	uint8* buffer = NULL;
+	if (length > 0) {
+		buffer = (uint8*)malloc(length);
+		if (buffer == NULL)
+			return B_NO_MEMORY;
+
+		status_t status = inode->ReadInlineData(pos, buffer, &length);
+		if (status != B_OK) {
+			free(buffer);
+			return status;
+		}
+	}
+
+	size_t offset = 0;
+	for (size_t i = 0; i < count && offset < numBytes; i++) {
+		size_t bytes = min_c(vecs[i].iov_len, numBytes - offset);
+		size_t copy = offset < length ? min_c(bytes, length - offset) : 0;
+
+		memcpy(vecs[i].iov_base, buffer + offset, copy);
+		memset((uint8*)vecs[i].iov_base + copy, 0, bytes - copy);
+		offset += bytes;
+	}
+
+	free(buffer);
+	return B_OK;
+}
+
+
+/*!	Writes to a file that keeps its data inline; everything beyond the end
+	of the file is ignored.
+	Inode::WriteAt() already puts the data into the inode, so a transaction
+	is only needed for pages that have been changed through a mapping. This
+	must not wait for the journal, though, as its owner might wait for the
+	pages we're supposed to write; \c B_WOULD_BLOCK lets the caller try
+	again later on, as the pages stay modified.
+	Returns \c B_BAD_TYPE if the file has been moved to a data stream in the
+	mean time.
+*/
+static status_t
+write_inline_data(Volume* volume, Inode* inode, off_t pos,
+	const uint8* buffer, size_t length)
+{
+	uint8* current = (uint8*)malloc(length);
+	if (current == NULL)
+		return B_NO_MEMORY;
+
+	MemoryDeleter currentDeleter(current);
+
+	{
+		InodeReadLocker locker(inode);
+
+		if (!inode->HasInlineData())
+			return B_BAD_TYPE;
+
+		size_t currentLength = length;
+		status_t status = inode->ReadInlineData(pos, current, &currentLength);
+		if (status != B_OK)
+			return status;
+
+		if (memcmp(buffer, current, currentLength) == 0)
+			return B_OK;
+	}
+
+	Transaction transaction;
+	status_t status = transaction.TryStart(volume, inode->BlockNumber());
+	if (status != B_OK)
+		return status;
+
+	WriteLocker locker(inode->Lock());
+
+	if (!inode->HasInlineData())
+		return B_BAD_TYPE;
+
+	status = inode->WriteInlineData(transaction, pos, buffer, &length);
+	if (status == B_OK)
+		status = transaction.Done();
+
+	return status;
+}
+
+
+/*!	Writes the pages of a file that keeps its data inline, see
+	write_inline_data().
+*/
+static status_t
+write_inline_data_pages(Volume* volume, Inode* inode, off_t pos,
+	const iovec* vecs, size_t count, size_t numBytes)
+{
+	// The inline data is smaller than an inode
+	size_t length = min_c(numBytes, (size_t)volume->InodeSize());
+	uint8* buffer = (uint8*)malloc(length);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+
+	MemoryDeleter bufferDeleter(buffer);
+
+	size_t offset = 0;
+	for (size_t i = 0; i < count && offset < length; i++) {
+		size_t bytes = min_c(vecs[i].iov_len, length - offset);
+		memcpy(buffer + offset, vecs[i].iov_base, bytes);
+		offset += bytes;
+	}
+
+	return write_inline_data(volume, inode, pos, buffer, offset);
+}
+
+
+#ifndef FS_SHELL
+/*!	Serves an I/O request for a file that keeps its data inline. The whole
+	request is handled synchronously.
+	Returns \c B_BAD_TYPE if the file has been moved to a data stream in the
+	mean time, and the request hasn't been touched yet.
+*/
+static status_t
+inline_data_io(Volume* volume, Inode* inode, io_request* request)
+{
+	bool isWrite = io_request_is_write(request);
+	off_t pos = io_request_offset(request);
+	off_t bytesLeft = io_request_length(request);
+	size_t bufferSize = volume->InodeSize();
+
+	uint8* buffer = (uint8*)malloc(bufferSize);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+
+	MemoryDeleter bufferDeleter(buffer);
+
+	if (isWrite) {
+		status_t status = B_OK;
+		while (status == B_OK && bytesLeft > 0) {
+			size_t length = min_c(bytesLeft, (off_t)bufferSize);
+
+			status = read_from_io_request(request, buffer, length);
+			if (status == B_OK) {
+				status = write_inline_data(volume, inode, pos, buffer,
+					length);
+			}
+
+			pos += length;
+			bytesLeft -= length;
+		}
+
+		if (status == B_BAD_TYPE) {
+			// The request has been touched already; the pages stay
+			// modified, and will be written to the data stream later on
+			status = B_WOULD_BLOCK;
+		}
+
+		return status;
+	}
+
+	// The inline data is smaller than an inode, and therefore always fits
+	// into the first chunk
+	InodeReadLocker locker(inode);
+
+	if (!inode->HasInlineData())
+		return B_BAD_TYPE;
+
+	status_t status = B_OK;
+	while (status == B_OK && bytesLeft > 0) {
+		size_t length = min_c(bytesLeft, (off_t)bufferSize);
+		size_t bytesRead = length;
+
+		status = inode->ReadInlineData(pos, buffer, &bytesRead);
+		if (status == B_OK) {
+			// everything beyond the end of the file is cleared
+			memset(buffer + bytesRead, 0, length - bytesRead);
+			status = write_to_io_request(request, buffer, length);
+		}
+
+		pos += length;
+		bytesLeft -= length;
+	}
+
+	return status;
+}
+#endif	// !FS_SHELL
+
+
 //	#pragma mark - Scanning
 
 
@@ -185,6 +376,16 @@ bfs_mount(fs_volume* _volume, const char* device, uint32 flags,
 		RETURN_ERROR(status);
 	}
 
+	void* handle = parse_driver_settings_string(args);
+	if (handle != NULL) {
+		// the log may only be grown automatically if explicitly asked for,
+		// since this changes the on-disk layout permanently
+		if (get_driver_boolean_parameter(handle, "grow_log", false, true))
+			volume->GetJournal(0)->SetAutomaticLogGrowth(true);
+
+		unload_driver_settings(handle);
+	}
+
 	_volume->private_volume = volume;
 	_volume->ops = &gBFSVolumeOps;
 	*_rootID = volume->ToVnode(volume->Root());
@@ -420,6 +621,11 @@ bfs_read_pages(fs_volume* _volume, fs_vnode* _node, void* _cookie,
 
 	InodeReadLocker _(inode);
 
+	if (inode->HasInlineData())
+		return read_inline_data_pages(inode, pos, vecs, count, *_numBytes);
+
+	inode->ReleaseLoggedFirstBlock();
+
 	uint32 vecIndex = 0;
 	size_t vecOffset = 0;
 	size_t bytesLeft = *_numBytes;
@@ -463,8 +669,17 @@ bfs_write_pages(fs_volume* _volume, fs_vnode* _node, void* _cookie,
 	if (inode->FileCache() == NULL)
 		RETURN_ERROR(B_BAD_VALUE);
 
+	if (inode->HasInlineData()) {
+		status_t status = write_inline_data_pages(volume, inode, pos, vecs,
+			count, *_numBytes);
+		if (status != B_BAD_TYPE)
+			return status;
+	}
+
 	InodeReadLocker _(inode);
 
+	inode->ReleaseLoggedFirstBlock();
+
 	uint32 vecIndex = 0;
 	size_t vecOffset = 0;
 	size_t bytesLeft = *_numBytes;
@@ -520,9 +735,21 @@ bfs_io(fs_volume* _volume, fs_vnode* _node, void* _cookie, io_request* request)
 		RETURN_ERROR(B_BAD_VALUE);
 	}
 
+#ifndef FS_SHELL
+	if (inode->HasInlineData()) {
+		status_t status = inline_data_io(volume, inode, request);
+		if (status != B_BAD_TYPE) {
+			notify_io_request(request, status);
+			return status;
+		}
+	}
+#endif
+
 	// We lock the node here and will unlock it in the "finished" hook.
 	rw_lock_read_lock(&inode->Lock());
 
+	inode->ReleaseLoggedFirstBlock();
+
 	// Due to how I/O request notifications work, it is possible that
 	// some other thread could be notified that the request completed
 	// before we have a chance to release the read lock. We thus need
@@ -793,6 +1020,17 @@ bfs_ioctl(fs_volume* _volume, fs_vnode* _node, void* _cookie, uint32 cmd,
 			ResizeVisitor resizer(volume);
 			return resizer.Resize(size, -1);
 		}
+		case BFS_IOCTL_RESIZE_LOG:
+		{
+			if (bufferLength != sizeof(uint32))
+				return B_BAD_VALUE;
+
+			uint32 length;
+			if (user_memcpy(&length, buffer, sizeof(uint32)) != B_OK)
+				return B_BAD_ADDRESS;
+
+			return volume->GetJournal(0)->ResizeLog(length);
+		}
 
 #ifdef DEBUG_FRAGMENTER
 		case 56741:
@@ -2009,6 +2247,11 @@ bfs_remove_attr(fs_volume* _volume, fs_vnode* _node, const char* name)
 	Volume* volume = (Volume*)_volume->private_volume;
 	Inode* inode = (Inode*)_node->private_node;
 
+	// the name and the inline data are not real attributes
+	if ((name[0] == FILE_NAME_NAME || name[0] == FILE_DATA_NAME)
+		&& name[1] == '\0')
+		return B_NOT_ALLOWED;
+
 	status_t status = inode->CheckPermissions(W_OK);
 	if (status != B_OK)
 		return status;
@@ -2219,6 +2462,11 @@ bfs_remove_index(fs_volume* _volume, const char* name)
 	status_t status = indices->Remove(transaction, name);
 	if (status == B_OK)
 		status = transaction.Done();
+	if (status == B_OK) {
+		volume->RemoveIndexStatistics(name);
+		if (Index::IsTrigramIndex(name))
+			volume->RemoveTrigramIndex();
+	}
 
 	RETURN_ERROR(status);
 }
@@ -8,6 +8,8 @@
 
 #ifdef FS_SHELL
 
+#include <algorithm>
+
 #include "fssh_api_wrapper.h"
 #include "fssh_auto_deleter.h"
 
@@ -39,6 +41,7 @@
 #	include <TypeConstants.h>
 #endif	// _BOOT_MODE
 
+#include <algorithm>
 #include <ctype.h>
 #include <errno.h>
 #include <new>
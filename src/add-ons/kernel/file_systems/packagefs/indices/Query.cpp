@@ -89,6 +89,12 @@ struct Query::QueryPolicy {
 		return index.index != NULL ? B_OK : B_ENTRY_NOT_FOUND;
 	}
 
+	static status_t IndexSetToTrigrams(Index& index, const char* attribute)
+	{
+		// trigram indices are not supported
+		return B_ENTRY_NOT_FOUND;
+	}
+
 	static void IndexUnset(Index& index)
 	{
 		index.index = NULL;
@@ -99,6 +105,13 @@ struct Query::QueryPolicy {
 		return index.index->CountEntries();
 	}
 
+	static int32 IndexEstimateMatches(Index& index, int32 op,
+		const void* value, size_t size, bool isPrefix)
+	{
+		// no statistics available
+		return -1;
+	}
+
 	static type_code IndexGetType(Index& index)
 	{
 		return index.index->Type();
@@ -157,6 +170,11 @@ struct Query::QueryPolicy {
 		return B_OK;
 	}
 
+	static ino_t IndexIteratorGetNodeID(IndexIterator* indexIterator)
+	{
+		return indexIterator->entry->ID();
+	}
+
 	static void IndexIteratorSkipDuplicates(IndexIterator* indexIterator)
 	{
 		// Nothing to do.
@@ -23,6 +23,7 @@
 
 #include "AttributeCookie.h"
 #include "AttributeDirectoryCookie.h"
+#include "CachedDataReader.h"
 #include "DebugSupport.h"
 #include "Directory.h"
 #include "Query.h"
@@ -173,6 +174,10 @@ packagefs_lookup(fs_volume* fsVolume, fs_vnode* fsDir, const char* entryName,
 		return volume->GetVNode(*_vnid, dummy);
 	}
 
+	// Load lazily loaded package contents first. If that fails, the entries
+	// already present are still usable and loading is retried next time.
+	volume->LoadDeferredNodes(dir);
+
 	// resolve normal entries -- look up the node
 	DirectoryReadLocker dirLocker(dir);
 	String entryNameString;
@@ -580,7 +585,6 @@ packagefs_open_dir(fs_volume* fsVolume, fs_vnode* fsNode, void** _cookie)
 
 	FUNCTION("volume: %p, node: %p (%" B_PRId64 ")\n", volume, node,
 		node->ID());
-	TOUCH(volume);
 
 	if (!S_ISDIR(node->Mode()))
 		return B_NOT_A_DIRECTORY;
@@ -591,6 +595,9 @@ packagefs_open_dir(fs_volume* fsVolume, fs_vnode* fsNode, void** _cookie)
 	if (error != B_OK)
 		return error;
 
+	// load lazily loaded package contents (see packagefs_lookup())
+	volume->LoadDeferredNodes(dir);
+
 	// create a cookie
 	DirectoryWriteLocker dirLocker(dir);
 	DirectoryCookie* cookie = new(std::nothrow) DirectoryCookie(dir);
@@ -1048,8 +1055,13 @@ packagefs_open_query(fs_volume* fsVolume, const char* queryString, uint32 flags,
 
 	VolumeWriteLocker volumeWriteLocker(volume);
 
+	// the indices don't know about nodes that haven't been loaded yet
+	status_t error = volume->LoadAllDeferredNodes();
+	if (error != B_OK)
+		return error;
+
 	Query* query;
-	status_t error = Query::Create(volume, queryString, flags, port, token,
+	error = Query::Create(volume, queryString, flags, port, token,
 		query);
 	if (error != B_OK)
 		return error;
@@ -1151,7 +1163,7 @@ packagefs_std_ops(int32 op, ...)
 			object_cache* quadChunkCache;
 			PackageFileHeapAccessorBase::sQuadChunkCache = quadChunkCache =
 				create_object_cache("pkgfs heap buffers",
-					PackageFileHeapAccessorBase::kChunkSize * 4,
+					PackageFileHeapAccessorBase::kMaxChunkSize * 4,
 					0);
 			PackageFileHeapAccessorBase::sQuadChunkFallbackBuffer =
 				object_cache_alloc(quadChunkCache, 0);
@@ -1169,12 +1181,15 @@ packagefs_std_ops(int32 op, ...)
 				return error;
 			}
 
+			CachedDataReader::GlobalInit();
+
 			return B_OK;
 		}
 
 		case B_MODULE_UNINIT:
 		{
 			PRINT("package_std_ops(): B_MODULE_UNINIT\n");
+			CachedDataReader::GlobalUninit();
 			PackageFSRoot::GlobalUninit();
 			delete_object_cache(TwoKeyAVLTreeNode<void*>::sNodeCache);
 			object_cache_free((object_cache*)
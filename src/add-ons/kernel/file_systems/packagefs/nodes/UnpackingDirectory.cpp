@@ -22,7 +22,8 @@ CLASS_CACHE(UnpackingDirectory);
 
 UnpackingDirectory::UnpackingDirectory(ino_t id)
 	:
-	Directory(id)
+	Directory(id),
+	fDeferredPackageDirectoryCount(0)
 {
 }
 
@@ -122,6 +123,9 @@ UnpackingDirectory::AddPackageNode(PackageNode* packageNode, dev_t deviceID)
 	} else
 		fPackageDirectories.Add(packageDirectory);
 
+	if (packageDirectory->HasDeferredChildren())
+		fDeferredPackageDirectoryCount++;
+
 	return B_OK;
 }
 
@@ -129,8 +133,13 @@ UnpackingDirectory::AddPackageNode(PackageNode* packageNode, dev_t deviceID)
 void
 UnpackingDirectory::RemovePackageNode(PackageNode* packageNode, dev_t deviceID)
 {
+	PackageDirectory* packageDirectory
+		= dynamic_cast<PackageDirectory*>(packageNode);
 	bool isNewest = packageNode == fPackageDirectories.Head();
-	fPackageDirectories.Remove(dynamic_cast<PackageDirectory*>(packageNode));
+	fPackageDirectories.Remove(packageDirectory);
+
+	if (packageDirectory->HasDeferredChildren())
+		fDeferredPackageDirectoryCount--;
 
 	// when removing the newest node, we need to find the next node (the list
 	// is not sorted)
@@ -183,6 +192,21 @@ void
 UnpackingDirectory::PrepareForRemoval()
 {
 	fPackageDirectories.MakeEmpty();
+	fDeferredPackageDirectoryCount = 0;
+}
+
+
+/*!	Must be called after the deferred children of one of the directory's
+	package directories have been loaded and added to the directory.
+*/
+void
+UnpackingDirectory::DeferredChildrenLoaded(PackageDirectory* packageDirectory)
+{
+	if (!packageDirectory->HasDeferredChildren())
+		return;
+
+	packageDirectory->SetDeferredChildrenOffset(0);
+	fDeferredPackageDirectoryCount--;
 }
 
 
@@ -42,6 +42,14 @@ public:
 
 	virtual	void				PrepareForRemoval();
 
+			bool				HasDeferredPackageDirectories() const
+									{ return fDeferredPackageDirectoryCount
+										> 0; }
+			const PackageDirectoryList& PackageDirectories() const
+									{ return fPackageDirectories; }
+			void				DeferredChildrenLoaded(
+									PackageDirectory* packageDirectory);
+
 	virtual	status_t			OpenAttributeDirectory(
 									AttributeDirectoryCookie*& _cookie);
 	virtual	status_t			OpenAttribute(const StringKey& name,
@@ -53,6 +61,7 @@ public:
 
 private:
 			PackageDirectoryList fPackageDirectories;
+			int32				fDeferredPackageDirectoryCount;
 };
 
 
@@ -8,8 +8,12 @@
 
 #include <algorithm>
 
+#include <sys/stat.h>
+
 #include <DataIO.h>
 
+#include <low_resource_manager.h>
+#include <smp.h>
 #include <util/AutoLock.h>
 #include <vm/VMCache.h>
 #include <vm/vm_page.h>
@@ -20,6 +24,10 @@
 using BPackageKit::BHPKG::BBufferDataReader;
 
 
+static const uint32 kReadAheadResources
+	= B_KERNEL_RESOURCE_PAGES | B_KERNEL_RESOURCE_MEMORY;
+
+
 static inline bool
 page_physical_number_less(const vm_page* a, const vm_page* b)
 {
@@ -75,49 +83,315 @@ private:
 };
 
 
+// #pragma mark - ReadAheadJob
+
+
+struct CachedDataReader::ReadAheadJob
+	: public DoublyLinkedListLinkImpl<ReadAheadJob> {
+	CachedDataReader*	reader;
+	off_t				lineOffset;
+	size_t				lineSize;
+};
+
+
+// #pragma mark - FileCache
+
+
+struct CachedDataReader::FileCacheKey {
+	dev_t			device;
+	ino_t			node;
+	off_t			size;
+	struct timespec	modified;
+	size_t			lineSize;
+
+	FileCacheKey()
+		:
+		device(-1),
+		node(-1),
+		size(0),
+		modified(),
+		lineSize(0)
+	{
+	}
+
+	FileCacheKey(const struct stat& st, size_t lineSize)
+		:
+		device(st.st_dev),
+		node(st.st_ino),
+		size(st.st_size),
+		modified(st.st_mtim),
+		lineSize(lineSize)
+	{
+	}
+
+	bool operator==(const FileCacheKey& other) const
+	{
+		return device == other.device && node == other.node
+			&& size == other.size
+			&& modified.tv_sec == other.modified.tv_sec
+			&& modified.tv_nsec == other.modified.tv_nsec
+			&& lineSize == other.lineSize;
+	}
+};
+
+
+/*!	The cached data of a package file. Readers of the same file -- e.g. of
+	the same package activated in several packagefs volumes -- share one file
+	cache, so the data are decompressed only once. An unused file cache is
+	kept until memory gets low or too many unused ones pile up.
+	\c referenceCount is guarded by \c sFileCachesLock, \c lineLockers by
+	\c lock.
+*/
+struct CachedDataReader::FileCache
+	: public DoublyLinkedListLinkImpl<FileCache> {
+	FileCache()
+		:
+		key(),
+		cache(NULL),
+		lineLockers(),
+		hashNext(NULL),
+		referenceCount(1),
+		shared(false)
+	{
+		mutex_init(&lock, "packagefs file cache");
+	}
+
+	~FileCache()
+	{
+		if (cache != NULL) {
+			cache->Lock();
+			cache->ReleaseRefAndUnlock();
+		}
+
+		mutex_destroy(&lock);
+	}
+
+	status_t Init(off_t size)
+	{
+		status_t error = lineLockers.Init();
+		if (error != B_OK)
+			RETURN_ERROR(error);
+
+		error = VMCacheFactory::CreateNullCache(VM_PRIORITY_SYSTEM, cache);
+		if (error != B_OK)
+			RETURN_ERROR(error);
+
+		cache->virtual_end = size;
+		return B_OK;
+	}
+
+	// sFileCachesLock must be held
+	void AcquireReference()
+	{
+		if (referenceCount++ == 0) {
+			sUnusedFileCaches.Remove(this);
+			sUnusedFileCacheCount--;
+		}
+	}
+
+	FileCacheKey	key;
+	mutex			lock;
+	VMCache*		cache;
+	LockerTable		lineLockers;
+	FileCache*		hashNext;
+	int32			referenceCount;
+	bool			shared;
+};
+
+
+struct CachedDataReader::FileCacheHashDefinition {
+	typedef FileCacheKey	KeyType;
+	typedef	FileCache		ValueType;
+
+	size_t HashKey(const FileCacheKey& key) const
+	{
+		return (size_t)key.node ^ (size_t)(key.node >> 32)
+			^ (size_t)key.device * 31;
+	}
+
+	size_t Hash(const FileCache* value) const
+	{
+		return HashKey(value->key);
+	}
+
+	bool Compare(const FileCacheKey& key, const FileCache* value) const
+	{
+		return value->key == key;
+	}
+
+	FileCache*& GetLink(FileCache* value) const
+	{
+		return value->hashNext;
+	}
+};
+
+
+mutex CachedDataReader::sReadAheadLock
+	= MUTEX_INITIALIZER("packagefs read-ahead");
+ConditionVariable CachedDataReader::sReadAheadCondition;
+CachedDataReader::ReadAheadJobList CachedDataReader::sReadAheadJobs;
+thread_id CachedDataReader::sReadAheadThreads[kMaxReadAheadThreads];
+int32 CachedDataReader::sReadAheadThreadCount = 0;
+bool CachedDataReader::sReadAheadTerminating = false;
+
+mutex CachedDataReader::sFileCachesLock
+	= MUTEX_INITIALIZER("packagefs file caches");
+CachedDataReader::FileCacheTable CachedDataReader::sFileCaches;
+CachedDataReader::FileCacheList CachedDataReader::sUnusedFileCaches;
+int32 CachedDataReader::sUnusedFileCacheCount = 0;
+bool CachedDataReader::sFileCachesInitialized = false;
+
+
 // #pragma mark - CachedDataReader
 
 
 CachedDataReader::CachedDataReader()
 	:
 	fReader(NULL),
+	fFileCache(NULL),
 	fCache(NULL),
-	fCacheLineLockers()
+	fCacheLineSize(kMaxCacheLineSize),
+	fLastLineOffset(-1),
+	fReadAheadEnd(0),
+	fReadAheadJobCount(0),
+	fReadAheadStopped(false)
 {
 	mutex_init(&fLock, "packagefs cached reader");
+	fReadAheadDoneCondition.Init(this, "packagefs read-ahead done");
 }
 
 
 CachedDataReader::~CachedDataReader()
 {
-	if (fCache != NULL) {
-		fCache->Lock();
-		fCache->ReleaseRefAndUnlock();
-	}
+	StopReadAhead();
+
+	if (fFileCache != NULL)
+		_ReleaseFileCache(fFileCache);
 
 	mutex_destroy(&fLock);
 }
 
 
 status_t
-CachedDataReader::Init(BAbstractBufferedDataReader* reader, off_t size)
+CachedDataReader::Init(BAbstractBufferedDataReader* reader, off_t size,
+	size_t cacheLineSize, const struct stat* fileStat)
 {
-	fReader = reader;
+	if (cacheLineSize == 0 || cacheLineSize % B_PAGE_SIZE != 0
+		|| cacheLineSize > kMaxCacheLineSize) {
+		RETURN_ERROR(B_BAD_VALUE);
+	}
 
-	status_t error = fCacheLineLockers.Init();
-	if (error != B_OK)
-		RETURN_ERROR(error);
+	fReader = reader;
+	fCacheLineSize = cacheLineSize;
 
-	error = VMCacheFactory::CreateNullCache(VM_PRIORITY_SYSTEM,
-		fCache);
-	if (error != B_OK)
-		RETURN_ERROR(error);
+	if (fileStat != NULL) {
+		FileCacheKey key(*fileStat, cacheLineSize);
+		fFileCache = _AcquireFileCache(&key, size);
+	} else
+		fFileCache = _AcquireFileCache(NULL, size);
+	if (fFileCache == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
 
-	fCache->virtual_end = size;
+	fCache = fFileCache->cache;
 	return B_OK;
 }
 
 
+/*!	Starts the threads that read cache lines ahead of sequential reads for
+	all readers. Read-ahead is an optimization only, so failing to spawn the
+	threads isn't an error.
+*/
+/*static*/ void
+CachedDataReader::GlobalInit()
+{
+	sReadAheadCondition.Init(&sReadAheadJobs, "packagefs read-ahead");
+
+	int32 threadCount = std::min((int32)smp_get_num_cpus(),
+		(int32)kMaxReadAheadThreads);
+	for (; sReadAheadThreadCount < threadCount; sReadAheadThreadCount++) {
+		thread_id thread = spawn_kernel_thread(&_ReadAheadThread,
+			"packagefs read-ahead", B_NORMAL_PRIORITY, NULL);
+		if (thread < 0)
+			break;
+
+		sReadAheadThreads[sReadAheadThreadCount] = thread;
+		resume_thread(thread);
+	}
+
+	// Without the table the readers just don't share their caches.
+	if (sFileCaches.Init() == B_OK) {
+		sFileCachesInitialized = true;
+		register_low_resource_handler(&_FileCachesLowResourceHandler, NULL,
+			B_KERNEL_RESOURCE_PAGES | B_KERNEL_RESOURCE_MEMORY, 0);
+	}
+}
+
+
+/*static*/ void
+CachedDataReader::GlobalUninit()
+{
+	MutexLocker locker(sReadAheadLock);
+	sReadAheadTerminating = true;
+	sReadAheadCondition.NotifyAll();
+	locker.Unlock();
+
+	for (int32 i = 0; i < sReadAheadThreadCount; i++)
+		wait_for_thread(sReadAheadThreads[i], NULL);
+	sReadAheadThreadCount = 0;
+
+	if (sFileCachesInitialized) {
+		unregister_low_resource_handler(&_FileCachesLowResourceHandler, NULL);
+
+		// all readers are gone, so all file caches left are unused
+		while (FileCache* fileCache = sUnusedFileCaches.RemoveHead()) {
+			sFileCaches.Remove(fileCache);
+			delete fileCache;
+		}
+		sUnusedFileCacheCount = 0;
+		sFileCachesInitialized = false;
+	}
+}
+
+
+/*!	Cancels the pending read-ahead jobs of this reader and waits for the ones
+	in progress. No further read-ahead is scheduled afterwards.
+*/
+void
+CachedDataReader::StopReadAhead()
+{
+	MutexLocker locker(fLock);
+	fReadAheadStopped = true;
+	if (fReadAheadJobCount == 0)
+		return;
+	locker.Unlock();
+
+	// dequeue the jobs that haven't been started yet
+	ReadAheadJobList jobs;
+	MutexLocker queueLocker(sReadAheadLock);
+	for (ReadAheadJobList::Iterator it = sReadAheadJobs.GetIterator();
+			ReadAheadJob* job = it.Next();) {
+		if (job->reader == this) {
+			it.Remove();
+			jobs.Add(job);
+		}
+	}
+	queueLocker.Unlock();
+
+	int32 canceledJobs = 0;
+	while (ReadAheadJob* job = jobs.RemoveHead()) {
+		ReleaseFile();
+		delete job;
+		canceledJobs++;
+	}
+
+	// wait for the others
+	locker.Lock();
+	fReadAheadJobCount -= canceledJobs;
+	while (fReadAheadJobCount > 0)
+		fReadAheadDoneCondition.Wait(&fLock);
+}
+
+
 status_t
 CachedDataReader::ReadDataToOutput(off_t offset, size_t size,
 	BDataIO* output)
@@ -130,12 +404,15 @@ CachedDataReader::ReadDataToOutput(off_t offset, size_t size,
 	if (size == 0)
 		return B_OK;
 
+	off_t firstLineOffset = (offset / fCacheLineSize) * fCacheLineSize;
+	off_t lineOffset = firstLineOffset;
+
 	while (size > 0) {
 		// the start of the current cache line
-		off_t lineOffset = (offset / kCacheLineSize) * kCacheLineSize;
+		lineOffset = (offset / fCacheLineSize) * fCacheLineSize;
 
 		// intersection of request and cache line
-		off_t cacheLineEnd = std::min(lineOffset + (off_t)kCacheLineSize,
+		off_t cacheLineEnd = std::min(lineOffset + (off_t)fCacheLineSize,
 			fCache->virtual_end);
 		size_t requestLineLength
 			= std::min(cacheLineEnd - offset, (off_t)size);
@@ -150,10 +427,24 @@ CachedDataReader::ReadDataToOutput(off_t offset, size_t size,
 		size -= requestLineLength;
 	}
 
+	_ScheduleReadAhead(firstLineOffset, lineOffset);
 	return B_OK;
 }
 
 
+bool
+CachedDataReader::AcquireFile()
+{
+	return true;
+}
+
+
+void
+CachedDataReader::ReleaseFile()
+{
+}
+
+
 status_t
 CachedDataReader::_ReadCacheLine(off_t lineOffset, size_t lineSize,
 	off_t requestOffset, size_t requestLength, BDataIO* output)
@@ -167,7 +458,7 @@ CachedDataReader::_ReadCacheLine(off_t lineOffset, size_t lineSize,
 	// check whether there are pages of the cache line and the mark them used
 	page_num_t firstPageOffset = lineOffset / B_PAGE_SIZE;
 	page_num_t linePageCount = (lineSize + B_PAGE_SIZE - 1) / B_PAGE_SIZE;
-	vm_page* pages[kPagesPerCacheLine] = {};
+	vm_page* pages[kMaxPagesPerCacheLine] = {};
 
 	AutoLocker<VMCache> cacheLocker(fCache);
 
@@ -413,31 +704,251 @@ CachedDataReader::_ReadIntoPages(vm_page** pages, size_t firstPage,
 void
 CachedDataReader::_LockCacheLine(CacheLineLocker* lineLocker)
 {
-	MutexLocker locker(fLock);
+	MutexLocker locker(fFileCache->lock);
 
 	CacheLineLocker* otherLineLocker
-		= fCacheLineLockers.Lookup(lineLocker->Offset());
+		= fFileCache->lineLockers.Lookup(lineLocker->Offset());
 	if (otherLineLocker == NULL) {
-		fCacheLineLockers.Insert(lineLocker);
+		fFileCache->lineLockers.Insert(lineLocker);
 		return;
 	}
 
 	// queue and wait
 	otherLineLocker->Queue().Add(lineLocker);
-	lineLocker->Wait(fLock);
+	lineLocker->Wait(fFileCache->lock);
 }
 
 
 void
 CachedDataReader::_UnlockCacheLine(CacheLineLocker* lineLocker)
 {
-	MutexLocker locker(fLock);
+	MutexLocker locker(fFileCache->lock);
 
-	fCacheLineLockers.Remove(lineLocker);
+	fFileCache->lineLockers.Remove(lineLocker);
 
 	if (CacheLineLocker* nextLineLocker = lineLocker->Queue().RemoveHead()) {
 		nextLineLocker->Queue().TakeFrom(&lineLocker->Queue());
-		fCacheLineLockers.Insert(nextLineLocker);
+		fFileCache->lineLockers.Insert(nextLineLocker);
 		nextLineLocker->WakeUp();
 	}
 }
+
+
+/*!	Queues the cache lines following a read for the read-ahead threads, if
+	the read continued where the previous one ended. Since file data aren't
+	aligned to cache lines, a read starting in the line the previous one ended
+	in counts as sequential, too.
+*/
+void
+CachedDataReader::_ScheduleReadAhead(off_t firstLineOffset,
+	off_t lastLineOffset)
+{
+	MutexLocker locker(fLock);
+
+	bool sequential = firstLineOffset == fLastLineOffset
+		|| firstLineOffset == fLastLineOffset + (off_t)fCacheLineSize;
+	fLastLineOffset = lastLineOffset;
+
+	if (!sequential) {
+		fReadAheadEnd = 0;
+		return;
+	}
+
+	if (fReadAheadStopped || sReadAheadThreadCount == 0
+		|| low_resource_state(kReadAheadResources) != B_NO_LOW_RESOURCE) {
+		return;
+	}
+
+	off_t lineOffset = std::max(fReadAheadEnd,
+		lastLineOffset + (off_t)fCacheLineSize);
+	off_t endOffset = std::min(
+		lastLineOffset + (off_t)(fCacheLineSize + kReadAheadSize),
+		fCache->virtual_end);
+
+	ReadAheadJobList jobs;
+	for (; lineOffset < endOffset; lineOffset += fCacheLineSize) {
+		ReadAheadJob* job = new(std::nothrow) ReadAheadJob;
+		if (job == NULL)
+			break;
+		if (!AcquireFile()) {
+			delete job;
+			break;
+		}
+
+		job->reader = this;
+		job->lineOffset = lineOffset;
+		job->lineSize = std::min(endOffset - lineOffset,
+			(off_t)fCacheLineSize);
+		jobs.Add(job);
+
+		fReadAheadJobCount++;
+		fReadAheadEnd = lineOffset + fCacheLineSize;
+	}
+
+	locker.Unlock();
+
+	if (jobs.IsEmpty())
+		return;
+
+	MutexLocker queueLocker(sReadAheadLock);
+	sReadAheadJobs.TakeFrom(&jobs);
+	sReadAheadCondition.NotifyAll();
+}
+
+
+/*!	Reads the job's cache line into the cache, unless it is already cached or
+	memory is getting low. Called by a read-ahead thread; deletes the job.
+*/
+void
+CachedDataReader::_ReadAhead(ReadAheadJob* job)
+{
+	if (low_resource_state(kReadAheadResources) == B_NO_LOW_RESOURCE) {
+		// A zero length request without output only populates the line.
+		_ReadCacheLine(job->lineOffset, job->lineSize, job->lineOffset, 0,
+			NULL);
+	}
+
+	delete job;
+	ReleaseFile();
+
+	MutexLocker locker(fLock);
+	if (--fReadAheadJobCount == 0)
+		fReadAheadDoneCondition.NotifyAll();
+}
+
+
+/*static*/ status_t
+CachedDataReader::_ReadAheadThread(void* data)
+{
+	MutexLocker locker(sReadAheadLock);
+
+	while (true) {
+		ReadAheadJob* job = sReadAheadJobs.RemoveHead();
+		if (job == NULL) {
+			if (sReadAheadTerminating)
+				break;
+
+			sReadAheadCondition.Wait(&sReadAheadLock);
+			continue;
+		}
+
+		locker.Unlock();
+		job->reader->_ReadAhead(job);
+		locker.Lock();
+	}
+
+	return B_OK;
+}
+
+
+/*!	Returns a referenced file cache for the file identified by \a key,
+	creating it, if there is none yet. With a \c NULL \a key the file cache
+	is private to the caller.
+*/
+/*static*/ CachedDataReader::FileCache*
+CachedDataReader::_AcquireFileCache(const FileCacheKey* key, off_t size)
+{
+	MutexLocker locker(sFileCachesLock);
+
+	if (key != NULL && sFileCachesInitialized) {
+		if (FileCache* fileCache = sFileCaches.Lookup(*key)) {
+			fileCache->AcquireReference();
+			return fileCache;
+		}
+	}
+
+	locker.Unlock();
+
+	FileCache* fileCache = new(std::nothrow) FileCache;
+	if (fileCache == NULL)
+		return NULL;
+
+	if (fileCache->Init(size) != B_OK) {
+		delete fileCache;
+		return NULL;
+	}
+
+	if (key == NULL)
+		return fileCache;
+
+	locker.Lock();
+
+	if (!sFileCachesInitialized)
+		return fileCache;
+
+	// someone else may have been faster
+	if (FileCache* otherFileCache = sFileCaches.Lookup(*key)) {
+		otherFileCache->AcquireReference();
+		locker.Unlock();
+		delete fileCache;
+		return otherFileCache;
+	}
+
+	fileCache->key = *key;
+	fileCache->shared = true;
+	sFileCaches.Insert(fileCache);
+	return fileCache;
+}
+
+
+/*!	Releases a reference to the given file cache. A shared file cache that
+	isn't used anymore is kept, so that the file's data don't have to be
+	decompressed again when it is used next time.
+*/
+/*static*/ void
+CachedDataReader::_ReleaseFileCache(FileCache* fileCache)
+{
+	MutexLocker locker(sFileCachesLock);
+
+	if (--fileCache->referenceCount > 0)
+		return;
+
+	if (fileCache->shared) {
+		sUnusedFileCaches.Add(fileCache);
+		if (++sUnusedFileCacheCount <= kMaxUnusedFileCaches)
+			return;
+
+		// too many unused file caches -- drop the least recently used one
+		fileCache = sUnusedFileCaches.RemoveHead();
+		sUnusedFileCacheCount--;
+		sFileCaches.Remove(fileCache);
+	}
+
+	locker.Unlock();
+	delete fileCache;
+}
+
+
+/*static*/ void
+CachedDataReader::_FileCachesLowResourceHandler(void* data, uint32 resources,
+	int32 level)
+{
+	MutexLocker locker(sFileCachesLock);
+
+	int32 count;
+	switch (level) {
+		case B_LOW_RESOURCE_NOTE:
+			count = sUnusedFileCacheCount / 2;
+			break;
+		case B_LOW_RESOURCE_WARNING:
+		case B_LOW_RESOURCE_CRITICAL:
+			count = sUnusedFileCacheCount;
+			break;
+		case B_NO_LOW_RESOURCE:
+		default:
+			return;
+	}
+
+	FileCacheList fileCaches;
+	for (; count > 0; count--) {
+		FileCache* fileCache = sUnusedFileCaches.RemoveHead();
+		sUnusedFileCacheCount--;
+		sFileCaches.Remove(fileCache);
+		fileCaches.Add(fileCache);
+	}
+
+	locker.Unlock();
+
+	while (FileCache* fileCache = fileCaches.RemoveHead())
+		delete fileCache;
+}
@@ -14,6 +14,9 @@
 #include <vm/vm_types.h>
 
 
+struct stat;
+
+
 using BPackageKit::BHPKG::BAbstractBufferedDataReader;
 using BPackageKit::BHPKG::BDataReader;
 
@@ -24,11 +27,31 @@ public:
 	virtual						~CachedDataReader();
 
 			status_t			Init(BAbstractBufferedDataReader* reader,
-									off_t size);
+									off_t size, size_t cacheLineSize,
+									const struct stat* fileStat = NULL);
+									// cacheLineSize must be a multiple of
+									// the page size <= kMaxCacheLineSize;
+									// with fileStat the cached data are
+									// shared with other readers of the file
+
+	static	const size_t		kMaxCacheLineSize = 64 * 1024;
+
+	static	void				GlobalInit();
+	static	void				GlobalUninit();
+
+			void				StopReadAhead();
+									// must be called before the underlying
+									// reader goes away
 
 	virtual	status_t			ReadDataToOutput(off_t offset, size_t size,
 									BDataIO* output);
 
+protected:
+	virtual	bool				AcquireFile();
+	virtual	void				ReleaseFile();
+									// keep the underlying file usable while
+									// a cache line is read ahead
+
 private:
 			class CacheLineLocker
 				: public DoublyLinkedListLinkImpl<CacheLineLocker> {
@@ -92,7 +115,7 @@ private:
 
 				size_t HashKey(off_t key) const
 				{
-					return size_t(key / kCacheLineSize);
+					return size_t(key / B_PAGE_SIZE);
 				}
 
 				size_t Hash(const CacheLineLocker* value) const
@@ -113,7 +136,15 @@ private:
 
 			typedef BOpenHashTable<LockerHashDefinition> LockerTable;
 
+			struct FileCacheKey;
+			struct FileCache;
+			struct FileCacheHashDefinition;
 			struct PagesDataOutput;
+			struct ReadAheadJob;
+
+			typedef BOpenHashTable<FileCacheHashDefinition> FileCacheTable;
+			typedef DoublyLinkedList<FileCache> FileCacheList;
+			typedef DoublyLinkedList<ReadAheadJob> ReadAheadJobList;
 
 private:
 			status_t			_ReadCacheLine(off_t lineOffset,
@@ -133,16 +164,49 @@ private:
 			void				_LockCacheLine(CacheLineLocker* lineLocker);
 			void				_UnlockCacheLine(CacheLineLocker* lineLocker);
 
+			void				_ScheduleReadAhead(off_t firstLineOffset,
+									off_t lastLineOffset);
+			void				_ReadAhead(ReadAheadJob* job);
+
+	static	status_t			_ReadAheadThread(void* data);
+
+	static	FileCache*			_AcquireFileCache(const FileCacheKey* key,
+									off_t size);
+	static	void				_ReleaseFileCache(FileCache* fileCache);
+	static	void				_FileCachesLowResourceHandler(void* data,
+									uint32 resources, int32 level);
+
 private:
-			static const size_t kCacheLineSize = 64 * 1024;
-			static const size_t kPagesPerCacheLine
-				= kCacheLineSize / B_PAGE_SIZE;
+			static const size_t kMaxPagesPerCacheLine
+				= kMaxCacheLineSize / B_PAGE_SIZE;
+			static const size_t kReadAheadSize = 4 * kMaxCacheLineSize;
+			static const int32	kMaxReadAheadThreads = 4;
+			static const int32	kMaxUnusedFileCaches = 32;
 
 private:
 			mutex				fLock;
 			BAbstractBufferedDataReader* fReader;
+			FileCache*			fFileCache;
 			VMCache*			fCache;
-			LockerTable			fCacheLineLockers;
+			size_t				fCacheLineSize;
+			off_t				fLastLineOffset;
+			off_t				fReadAheadEnd;
+			int32				fReadAheadJobCount;
+			bool				fReadAheadStopped;
+			ConditionVariable	fReadAheadDoneCondition;
+
+	static	mutex				sReadAheadLock;
+	static	ConditionVariable	sReadAheadCondition;
+	static	ReadAheadJobList	sReadAheadJobs;
+	static	thread_id			sReadAheadThreads[kMaxReadAheadThreads];
+	static	int32				sReadAheadThreadCount;
+	static	bool				sReadAheadTerminating;
+
+	static	mutex				sFileCachesLock;
+	static	FileCacheTable		sFileCaches;
+	static	FileCacheList		sUnusedFileCaches;
+	static	int32				sUnusedFileCacheCount;
+	static	bool				sFileCachesInitialized;
 };
 
 
@@ -47,6 +47,7 @@ typedef BPackageKit::BHPKG::BPackageContentHandler BPackageContentHandler;
 typedef BPackageKit::BHPKG::BPackageEntry BPackageEntry;
 typedef BPackageKit::BHPKG::BPackageEntryAttribute BPackageEntryAttribute;
 typedef BPackageKit::BHPKG::BPrivate::PackageReaderImpl PackageReaderImpl;
+typedef BPackageKit::BHPKG::BPrivate::DeferredEntryHandler DeferredEntryHandler;
 
 
 const char* const kArchitectureNames[B_PACKAGE_ARCHITECTURE_ENUM_COUNT] = {
@@ -87,14 +88,17 @@ private:
 // #pragma mark - LoaderContentHandler
 
 
-struct Package::LoaderContentHandler : BPackageContentHandler {
-	LoaderContentHandler(Package* package, const PackageSettings& settings)
+struct Package::LoaderContentHandler : BPackageContentHandler,
+	DeferredEntryHandler {
+	LoaderContentHandler(Package* package, const PackageSettings& settings,
+		int32 lazyDepth = -1)
 		:
 		fPackage(package),
 		fSettings(settings),
 		fSettingsItem(NULL),
 		fLastSettingsEntry(NULL),
 		fLastSettingsEntryEntry(NULL),
+		fLazyDepth(lazyDepth),
 		fErrorOccurred(false)
 	{
 	}
@@ -212,6 +216,31 @@ struct Package::LoaderContentHandler : BPackageContentHandler {
 		return B_OK;
 	}
 
+	virtual bool DeferEntryChildren(BPackageEntry* entry,
+		uint64 childrenOffset)
+	{
+		// Packages with settings are loaded completely, so that blocked
+		// entries don't have to be considered when loading children later.
+		if (fLazyDepth < 0 || fSettingsItem != NULL || fErrorOccurred)
+			return false;
+
+		int32 depth = 0;
+		for (const BPackageEntry* parent = entry->Parent(); parent != NULL;
+				parent = parent->Parent()) {
+			depth++;
+		}
+		if (depth < fLazyDepth)
+			return false;
+
+		PackageDirectory* directory = dynamic_cast<PackageDirectory*>(
+			(PackageNode*)entry->UserToken());
+		if (directory == NULL)
+			return false;
+
+		directory->SetDeferredChildrenOffset(childrenOffset);
+		return true;
+	}
+
 	virtual status_t HandleEntryDone(BPackageEntry* entry)
 	{
 		if (entry == fLastSettingsEntryEntry) {
@@ -369,6 +398,7 @@ private:
 	const PackageSettingsItem*	fSettingsItem;
 	PackageSettingsItem::Entry*	fLastSettingsEntry;
 	const BPackageEntry*		fLastSettingsEntryEntry;
+	int32						fLazyDepth;
 	bool						fErrorOccurred;
 };
 
@@ -394,14 +424,16 @@ struct Package::HeapReader {
 struct Package::HeapReaderV2 : public HeapReader, public CachedDataReader,
 	private BErrorOutput, private BFdIO {
 public:
-	HeapReaderV2()
+	HeapReaderV2(Package* package)
 		:
+		fPackage(package),
 		fHeapReader(NULL)
 	{
 	}
 
 	~HeapReaderV2()
 	{
+		StopReadAhead();
 		delete fHeapReader;
 	}
 
@@ -416,8 +448,11 @@ public:
 		fHeapReader->SetErrorOutput(this);
 		fHeapReader->SetFile(this);
 
+		// share the cached data with other packages of the same file
+		struct stat st;
 		status_t error = CachedDataReader::Init(fHeapReader,
-			fHeapReader->UncompressedHeapSize());
+			fHeapReader->UncompressedHeapSize(), fHeapReader->ChunkSize(),
+			fstat(fd, &st) == 0 ? &st : NULL);
 		if (error != B_OK)
 			return error;
 
@@ -436,6 +471,19 @@ public:
 			.CreatePackageDataReader(this, data.DataV2(), _reader);
 	}
 
+protected:
+	// CachedDataReader
+
+	virtual bool AcquireFile()
+	{
+		return fPackage->Open() >= 0;
+	}
+
+	virtual void ReleaseFile()
+	{
+		fPackage->Close();
+	}
+
 private:
 	// BErrorOutput
 
@@ -445,6 +493,7 @@ private:
 	}
 
 private:
+	Package*				fPackage;
 	PackageFileHeapReader*	fHeapReader;
 };
 
@@ -453,16 +502,23 @@ private:
 
 
 struct Package::CachingPackageReader : public PackageReaderImpl {
-	CachingPackageReader(BErrorOutput* errorOutput)
+	CachingPackageReader(BErrorOutput* errorOutput, Package* package)
 		:
 		PackageReaderImpl(errorOutput),
+		fPackage(package),
 		fCachedHeapReader(NULL),
-		fFD(-1)
+		fFD(-1),
+		fSharesHeapReader(false)
 	{
 	}
 
 	~CachingPackageReader()
 	{
+		if (fSharesHeapReader) {
+			PackageFileHeapReader* rawHeapReader;
+			DetachHeapReader(rawHeapReader);
+			delete rawHeapReader;
+		}
 	}
 
 	status_t Init(int fd, bool keepFD, uint32 flags)
@@ -475,7 +531,15 @@ struct Package::CachingPackageReader : public PackageReaderImpl {
 		PackageFileHeapReader* rawHeapReader,
 		BAbstractBufferedDataReader*& _cachedReader)
 	{
-		fCachedHeapReader = new(std::nothrow) HeapReaderV2;
+		// If the package has been loaded already, use its heap reader, so
+		// that the data it has already cached is reused.
+		if (fPackage->fHeapReader != NULL) {
+			fSharesHeapReader = true;
+			_cachedReader = static_cast<HeapReaderV2*>(fPackage->fHeapReader);
+			return B_OK;
+		}
+
+		fCachedHeapReader = new(std::nothrow) HeapReaderV2(fPackage);
 		if (fCachedHeapReader == NULL)
 			RETURN_ERROR(B_NO_MEMORY);
 
@@ -502,8 +566,10 @@ struct Package::CachingPackageReader : public PackageReaderImpl {
 	}
 
 private:
+	Package*		fPackage;
 	HeapReaderV2*	fCachedHeapReader;
 	int				fFD;
+	bool			fSharesHeapReader;
 };
 
 
@@ -567,9 +633,9 @@ Package::Init(const char* fileName)
 
 
 status_t
-Package::Load(const PackageSettings& settings)
+Package::Load(const PackageSettings& settings, int32 lazyDepth)
 {
-	status_t error = _Load(settings);
+	status_t error = _Load(settings, lazyDepth);
 	if (error != B_OK)
 		return error;
 
@@ -700,6 +766,51 @@ Package::Close()
 }
 
 
+/*!	Loads the children of \a directory, which have been skipped when loading
+	the package. The complete subtree is loaded. On error the directory is
+	left without children and still marked deferred.
+	The volume must be write-locked.
+*/
+status_t
+Package::LoadDeferredChildren(PackageDirectory* directory)
+{
+	if (!directory->HasDeferredChildren())
+		return B_OK;
+
+	int fd = Open();
+	if (fd < 0)
+		RETURN_ERROR(fd);
+	PackageCloser packageCloser(this);
+
+	LoaderErrorOutput errorOutput(this);
+	CachingPackageReader packageReader(&errorOutput, this);
+	status_t error = packageReader.Init(fd, false,
+		BHPKG::B_HPKG_READER_DONT_PRINT_VERSION_MISMATCH_MESSAGE);
+	if (error != B_OK)
+		RETURN_ERROR(error);
+
+	// Settings only affect packages that are never loaded lazily.
+	PackageSettings settings;
+	LoaderContentHandler handler(this, settings);
+	error = handler.Init();
+	if (error != B_OK)
+		RETURN_ERROR(error);
+
+	BPackageEntry entry(NULL, directory->Name());
+	entry.SetUserToken(static_cast<PackageNode*>(directory));
+
+	error = packageReader.ParseEntryChildren(&handler, &entry,
+		directory->DeferredChildrenOffset());
+	if (error != B_OK) {
+		while (PackageNode* child = directory->FirstChild())
+			directory->RemoveChild(child);
+		RETURN_ERROR(error);
+	}
+
+	return B_OK;
+}
+
+
 status_t
 Package::CreateDataReader(const PackageData& data,
 	BAbstractBufferedDataReader*& _reader)
@@ -712,7 +823,7 @@ Package::CreateDataReader(const PackageData& data,
 
 
 status_t
-Package::_Load(const PackageSettings& settings)
+Package::_Load(const PackageSettings& settings, int32 lazyDepth)
 {
 	// open package file
 	int fd = Open();
@@ -725,17 +836,17 @@ Package::_Load(const PackageSettings& settings)
 
 	// try current package file format version
 	{
-		CachingPackageReader packageReader(&errorOutput);
+		CachingPackageReader packageReader(&errorOutput, this);
 		status_t error = packageReader.Init(fd, false,
 			BHPKG::B_HPKG_READER_DONT_PRINT_VERSION_MISMATCH_MESSAGE);
 		if (error == B_OK) {
 			// parse content
-			LoaderContentHandler handler(this, settings);
+			LoaderContentHandler handler(this, settings, lazyDepth);
 			error = handler.Init();
 			if (error != B_OK)
 				RETURN_ERROR(error);
 
-			error = packageReader.ParseContent(&handler);
+			error = packageReader.ParseContent(&handler, &handler);
 			if (error != B_OK)
 				RETURN_ERROR(error);
 
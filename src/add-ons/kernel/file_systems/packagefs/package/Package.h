@@ -28,6 +28,7 @@ using BPackageKit::BPackageArchitecture;
 using BPackageKit::BHPKG::BAbstractBufferedDataReader;
 
 
+class PackageDirectory;
 class PackageLinkDirectory;
 class PackagesDirectory;
 class PackageSettings;
@@ -44,7 +45,11 @@ public:
 								~Package();
 
 			status_t			Init(const char* fileName);
-			status_t			Load(const PackageSettings& settings);
+			status_t			Load(const PackageSettings& settings,
+									int32 lazyDepth = -1);
+									// directories at or below lazyDepth get
+									// their children loaded only via
+									// LoadDeferredChildren(); -1 disables
 
 			::Volume*			Volume() const		{ return fVolume; }
 			const String&		FileName() const	{ return fFileName; }
@@ -98,6 +103,9 @@ public:
 			int					Open();
 			void				Close();
 
+			status_t			LoadDeferredChildren(
+									PackageDirectory* directory);
+
 			status_t			CreateDataReader(const PackageData& data,
 									BAbstractBufferedDataReader*& _reader);
 
@@ -117,7 +125,8 @@ private:
 			struct CachingPackageReader;
 
 private:
-			status_t			_Load(const PackageSettings& settings);
+			status_t			_Load(const PackageSettings& settings,
+									int32 lazyDepth);
 			bool				_InitVersionedName();
 
 private:
@@ -15,7 +15,8 @@ CLASS_CACHE(PackageDirectory);
 
 PackageDirectory::PackageDirectory(Package* package, mode_t mode)
 	:
-	PackageNode(package, mode)
+	PackageNode(package, mode),
+	fDeferredChildrenOffset(0)
 {
 }
 
@@ -32,8 +32,17 @@ public:
 			bool				HasPrecedenceOver(const PackageDirectory* other)
 									const;
 
+			// children not loaded yet -- offset in the package's TOC
+			void				SetDeferredChildrenOffset(uint64 offset)
+									{ fDeferredChildrenOffset = offset; }
+			uint64				DeferredChildrenOffset() const
+									{ return fDeferredChildrenOffset; }
+			bool				HasDeferredChildren() const
+									{ return fDeferredChildrenOffset != 0; }
+
 private:
 			PackageNodeList		fChildren;
+			uint64				fDeferredChildrenOffset;
 };
 
 
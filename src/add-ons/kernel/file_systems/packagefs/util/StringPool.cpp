@@ -6,18 +6,42 @@
 
 #include "StringPool.h"
 
+#include <errno.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include <debug.h>
+#include <kernel.h>
+
 #include "DebugSupport.h"
 
 
 static const size_t kInitialStringTableSize = 128;
 
+static const int32 kMaxStringTables = 4;
+static const off_t kMaxStringTableFileSize = 64 * 1024 * 1024;
+
 static char sStringsBuffer[sizeof(StringDataHash)];
 static char sEmptyStringBuffer[sizeof(StringData) + 1];
 
+
+struct StringPool::StringTable {
+	area_id			area;
+	const uint8*	data;
+	size_t			size;
+	const uint32*	buckets;
+	uint32			bucketMask;
+	dev_t			deviceID;
+	ino_t			nodeID;
+};
+
+
 StringData* StringData::fEmptyString;
 
 mutex StringPool::sLock;
 StringDataHash* StringPool::sStrings;
+StringPool::StringTable StringPool::sStringTables[kMaxStringTables];
+int32 StringPool::sStringTableCount = 0;
 
 
 // #pragma mark - StringData
@@ -26,6 +50,14 @@ StringDataHash* StringPool::sStrings;
 /*static*/ void
 StringData::Init()
 {
+	// static strings are string table entries
+	STATIC_ASSERT(offsetof(StringData, fReferenceCount)
+		== offsetof(PackageFSStringTableEntry, referenceCount));
+	STATIC_ASSERT(offsetof(StringData, fHash)
+		== offsetof(PackageFSStringTableEntry, hash));
+	STATIC_ASSERT(offsetof(StringData, fString)
+		== offsetof(PackageFSStringTableEntry, string));
+
 	fEmptyString = new(sEmptyStringBuffer) StringData(StringDataKey("", 0));
 }
 
@@ -56,6 +88,12 @@ StringPool::Init()
 /*static*/ void
 StringPool::Cleanup()
 {
+	// Strings from the string tables may be referenced by any volume, so the
+	// tables can only be deleted now.
+	for (int32 i = 0; i < sStringTableCount; i++)
+		delete_area(sStringTables[i].area);
+	sStringTableCount = 0;
+
 	sStrings->Remove(StringData::Empty());
 
 	sStrings->~StringDataHash();
@@ -65,9 +103,189 @@ StringPool::Cleanup()
 }
 
 
+/*!	Reads the string table file \a fd refers to. From then on strings
+	contained in the table are returned by Get() without allocating memory.
+	The table is copied into memory of its own, since the file can be
+	changed at any time, while the strings must stay valid until Cleanup()
+	is called. All entries are checked once when adding the table.
+*/
+/*static*/ status_t
+StringPool::AddStringTable(int fd)
+{
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+		RETURN_ERROR(errno);
+
+	if (st.st_size < (off_t)sizeof(PackageFSStringTableHeader)
+		|| st.st_size > kMaxStringTableFileSize) {
+		RETURN_ERROR(B_BAD_DATA);
+	}
+
+	MutexLocker locker(sLock);
+
+	// ignore tables we have already read
+	for (int32 i = 0; i < sStringTableCount; i++) {
+		if (sStringTables[i].deviceID == st.st_dev
+			&& sStringTables[i].nodeID == st.st_ino) {
+			return B_OK;
+		}
+	}
+
+	if (sStringTableCount == kMaxStringTables)
+		RETURN_ERROR(B_BUSY);
+
+	locker.Unlock();
+
+	void* address;
+	area_id area = create_area("packagefs string table", &address,
+		B_ANY_KERNEL_ADDRESS, ROUNDUP(st.st_size, B_PAGE_SIZE), B_FULL_LOCK,
+		B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA);
+	if (area < 0)
+		RETURN_ERROR(area);
+
+	ssize_t bytesRead = read_pos(fd, 0, address, st.st_size);
+	if (bytesRead != st.st_size) {
+		delete_area(area);
+		RETURN_ERROR(bytesRead < 0 ? bytesRead : B_BAD_DATA);
+	}
+
+	status_t error = _CheckStringTable((const uint8*)address, st.st_size);
+	if (error != B_OK) {
+		delete_area(area);
+		RETURN_ERROR(error);
+	}
+
+	// the strings must never change from now on
+	set_area_protection(area, B_KERNEL_READ_AREA);
+
+	locker.Lock();
+
+	// someone might have added the same or another table in the meantime
+	bool alreadyAdded = false;
+	for (int32 i = 0; i < sStringTableCount; i++) {
+		if (sStringTables[i].deviceID == st.st_dev
+			&& sStringTables[i].nodeID == st.st_ino) {
+			alreadyAdded = true;
+			break;
+		}
+	}
+	if (alreadyAdded || sStringTableCount == kMaxStringTables) {
+		locker.Unlock();
+		delete_area(area);
+		return alreadyAdded ? B_OK : B_BUSY;
+	}
+
+	const PackageFSStringTableHeader* header
+		= (const PackageFSStringTableHeader*)address;
+
+	StringTable& table = sStringTables[sStringTableCount++];
+	table.area = area;
+	table.data = (const uint8*)address;
+	table.size = st.st_size;
+	table.buckets = (const uint32*)(header + 1);
+	table.bucketMask = header->bucketCount - 1;
+	table.deviceID = st.st_dev;
+	table.nodeID = st.st_ino;
+
+	INFORM("StringPool: read string table with %" B_PRIu32 " strings\n",
+		header->stringCount);
+	return B_OK;
+}
+
+
+/*!	Checks the header and all entries of the string table in \a data.
+	Since the table is a copy nobody else can change, lookups don't need to
+	check anything anymore after that.
+*/
+/*static*/ status_t
+StringPool::_CheckStringTable(const uint8* data, size_t size)
+{
+	const PackageFSStringTableHeader* header
+		= (const PackageFSStringTableHeader*)data;
+	uint32 bucketCount = header->bucketCount;
+	if (header->magic != PACKAGE_FS_STRING_TABLE_MAGIC
+		|| header->version != PACKAGE_FS_STRING_TABLE_VERSION
+		|| header->headerSize != sizeof(PackageFSStringTableHeader)
+		|| header->tableSize != (uint64)size
+		|| bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0
+		|| bucketCount > (size - sizeof(PackageFSStringTableHeader))
+			/ sizeof(uint32)) {
+		return B_BAD_DATA;
+	}
+
+	const uint32* buckets = (const uint32*)(header + 1);
+	const size_t entriesOffset = sizeof(PackageFSStringTableHeader)
+		+ bucketCount * sizeof(uint32);
+	uint32 stringCount = 0;
+
+	for (uint32 i = 0; i < bucketCount; i++) {
+		uint32 offset = buckets[i];
+		if (offset == 0)
+			continue;
+
+		// The entry must lie within the table and must look like a static
+		// string, since we never write to it.
+		if (offset % sizeof(void*) != 0 || offset < entriesOffset
+			|| offset >= size
+			|| size - offset <= sizeof(PackageFSStringTableEntry)) {
+			return B_BAD_DATA;
+		}
+
+		const PackageFSStringTableEntry* entry
+			= (const PackageFSStringTableEntry*)(data + offset);
+		size_t maxLength = size - offset - sizeof(PackageFSStringTableEntry);
+		size_t length = strnlen(entry->string, maxLength);
+		if (entry->reserved != NULL
+			|| entry->referenceCount
+				!= PACKAGE_FS_STRING_TABLE_STATIC_REFERENCE_COUNT
+			|| length == maxLength
+			|| entry->hash != hash_hash_string_part(entry->string, length)) {
+			return B_BAD_DATA;
+		}
+
+		stringCount++;
+	}
+
+	if (stringCount != header->stringCount)
+		return B_BAD_DATA;
+
+	return B_OK;
+}
+
+
+/*static*/ StringData*
+StringPool::_LookupInStringTables(const StringDataKey& key)
+{
+	for (int32 i = 0; i < sStringTableCount; i++) {
+		const StringTable& table = sStringTables[i];
+		uint32 index = key.Hash() & table.bucketMask;
+		for (uint32 probes = 0; probes <= table.bucketMask; probes++) {
+			uint32 offset = table.buckets[index];
+			if (offset == 0)
+				break;
+
+			const PackageFSStringTableEntry* entry
+				= (const PackageFSStringTableEntry*)(table.data + offset);
+			if (entry->hash == key.Hash()
+				&& strncmp(entry->string, key.String(), key.Length()) == 0
+				&& entry->string[key.Length()] == '\0') {
+				return (StringData*)entry;
+			}
+
+			index = (index + 1) & table.bucketMask;
+		}
+	}
+
+	return NULL;
+}
+
+
 /*static*/ inline StringData*
 StringPool::_GetLocked(const StringDataKey& key)
 {
+	if (StringData* string = _LookupInStringTables(key))
+		return string;
+
 	if (StringData* string = sStrings->Lookup(key)) {
 		if (!string->AcquireReference())
 			return string;
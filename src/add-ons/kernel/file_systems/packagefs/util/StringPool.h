@@ -13,6 +13,7 @@
 
 #include <new>
 
+#include <packagefs.h>
 #include <util/AutoLock.h>
 #include <util/OpenHashTable.h>
 #include <util/StringHash.h>
@@ -62,17 +63,28 @@ public:
 	static	status_t			Init();
 	static	void				Cleanup();
 
+	static	status_t			AddStringTable(int fd);
+
 	static	StringData*			Get(const char* string, size_t length);
 	static	void				LastReferenceReleased(StringData* data);
 
 	static	void				DumpUsageStatistics();
 
+private:
+			struct StringTable;
+
 private:
 	static	StringData*			_GetLocked(const StringDataKey& key);
+	static	status_t			_CheckStringTable(const uint8* data,
+									size_t size);
+	static	StringData*			_LookupInStringTables(
+									const StringDataKey& key);
 
 private:
 	static	mutex				sLock;
 	static	StringDataHash*		sStrings;
+	static	StringTable			sStringTables[];
+	static	int32				sStringTableCount;
 };
 
 
@@ -107,15 +119,27 @@ public:
 
 	bool AcquireReference()
 	{
+		if (IsStatic())
+			return false;
 		return atomic_add(&fReferenceCount, 1) == 0;
 	}
 
 	void ReleaseReference()
 	{
+		if (IsStatic())
+			return;
 		if (atomic_add(&fReferenceCount, -1) == 1)
 			StringPool::LastReferenceReleased(this);
 	}
 
+	// Static strings live in a read-only string table and are never
+	// deleted.
+	bool IsStatic() const
+	{
+		return fReferenceCount
+			== PACKAGE_FS_STRING_TABLE_STATIC_REFERENCE_COUNT;
+	}
+
 	// debugging only
 	int32 CountReferences() const
 	{
@@ -9,6 +9,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/param.h>
 #include <sys/stat.h>
@@ -39,6 +40,7 @@
 #include "PackageLinksDirectory.h"
 #include "Resolvable.h"
 #include "SizeIndex.h"
+#include "StringPool.h"
 #include "UnpackingLeafNode.h"
 #include "UnpackingDirectory.h"
 #include "Utils.h"
@@ -70,6 +72,9 @@ static const char* const kActivationFileName
 static const char* const kActivationFilePath
 	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY "/"
 		PACKAGES_DIRECTORY_ACTIVATION_FILE;
+static const char* const kStringTableFilePath
+	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY "/"
+		PACKAGE_FS_STRING_TABLE_FILE_NAME;
 
 
 // #pragma mark - ShineThroughDirectory
@@ -173,6 +178,7 @@ Volume::Volume(fs_volume* fsVolume)
 	fPackagesDirectories(),
 	fPackagesDirectoriesByNodeRef(),
 	fPackageSettings(),
+	fLazyDepth(-1),
 	fNextNodeID(kRootDirectoryID + 1)
 {
 	rw_lock_init(&fLock, "packagefs volume");
@@ -317,6 +323,7 @@ Volume::Mount(const char* parameterString)
 	const char* mountType = NULL;
 	const char* shineThrough = NULL;
 	const char* packagesState = NULL;
+	const char* lazyDepth = NULL;
 
 	DriverSettingsUnloader parameterHandle(
 		parse_driver_settings_string(parameterString));
@@ -331,8 +338,23 @@ Volume::Mount(const char* parameterString)
 			"shine-through", NULL, NULL);
 		packagesState = get_driver_parameter(parameterHandle.Get(), "state",
 			NULL, NULL);
+		lazyDepth = get_driver_parameter(parameterHandle.Get(), "lazy-depth",
+			NULL, NULL);
 	}
 
+	// If not given as mount parameter, the depth from which on directory
+	// contents are loaded lazily can be set in the driver settings.
+	DriverSettingsUnloader settingsHandle;
+	if (lazyDepth == NULL) {
+		settingsHandle.SetTo(load_driver_settings("packagefs"));
+		if (settingsHandle.IsSet()) {
+			lazyDepth = get_driver_parameter(settingsHandle.Get(), "lazy_depth",
+				NULL, NULL);
+		}
+	}
+	if (lazyDepth != NULL)
+		fLazyDepth = strtol(lazyDepth, NULL, 0);
+
 	if (packages != NULL && packages[0] == '\0') {
 		FATAL("invalid package folder ('packages' parameter)!\n");
 		RETURN_ERROR(B_BAD_VALUE);
@@ -423,6 +445,9 @@ Volume::Mount(const char* parameterString)
 	if (error != B_OK)
 		RETURN_ERROR(error);
 
+	// map the string table, so loading the packages can use its strings
+	_AddStringTable();
+
 	// add initial packages
 	error = _AddInitialPackages();
 	if (error != B_OK)
@@ -454,6 +479,74 @@ Volume::Unmount()
 }
 
 
+/*!	Adds the children of \a directory that have not been loaded yet, since
+	they belong to package directories whose contents are loaded lazily.
+	The volume must not be locked.
+*/
+status_t
+Volume::LoadDeferredNodes(Directory* directory)
+{
+	UnpackingDirectory* unpackingDirectory
+		= dynamic_cast<UnpackingDirectory*>(directory);
+	if (unpackingDirectory == NULL
+		|| !unpackingDirectory->HasDeferredPackageDirectories()) {
+		return B_OK;
+	}
+
+	VolumeWriteLocker volumeLocker(this);
+
+	return _LoadDeferredNodes(unpackingDirectory);
+}
+
+
+/*!	Adds all nodes that have not been loaded yet. Nodes loaded lazily are
+	indexed only when they are added, so this must be done before running a
+	query. The volume must be write locked.
+*/
+status_t
+Volume::LoadAllDeferredNodes()
+{
+	// Loading a directory's children may add further directories with
+	// deferred children, and it changes the node table, so we collect the
+	// directories first and repeat until none are left.
+	for (;;) {
+		int32 count = 0;
+		for (NodeIDHashTable::Iterator it = fNodes.GetIterator();
+				Node* node = it.Next();) {
+			UnpackingDirectory* directory
+				= dynamic_cast<UnpackingDirectory*>(node);
+			if (directory != NULL && directory->HasDeferredPackageDirectories())
+				count++;
+		}
+
+		if (count == 0)
+			return B_OK;
+
+		BReference<UnpackingDirectory>* directories
+			= new(std::nothrow) BReference<UnpackingDirectory>[count];
+		if (directories == NULL)
+			RETURN_ERROR(B_NO_MEMORY);
+		ArrayDeleter<BReference<UnpackingDirectory> > directoriesDeleter(
+			directories);
+
+		int32 index = 0;
+		for (NodeIDHashTable::Iterator it = fNodes.GetIterator();
+				Node* node = it.Next();) {
+			UnpackingDirectory* directory
+				= dynamic_cast<UnpackingDirectory*>(node);
+			if (directory != NULL && directory->HasDeferredPackageDirectories())
+				directories[index++].SetTo(directory);
+		}
+
+		for (int32 i = 0; i < count; i++) {
+			status_t error = _LoadDeferredNodes(directories[i]);
+			if (error != B_OK)
+				RETURN_ERROR(error);
+		}
+	}
+}
+
+
 status_t
 Volume::IOCtl(Node* node, uint32 operation, void* buffer, size_t size)
 {
@@ -753,6 +846,23 @@ Volume::_LoadOldPackagesStates(const char* packagesState)
 }
 
 
+void
+Volume::_AddStringTable()
+{
+	FileDescriptorCloser fd(openat(fPackagesDirectory->DirectoryFD(),
+		kStringTableFilePath, O_RDONLY));
+	if (!fd.IsSet())
+		return;
+
+	// The table is an optimization only, so errors aren't fatal.
+	status_t error = StringPool::AddStringTable(fd.Get());
+	if (error != B_OK) {
+		ERROR("Failed to map string table \"%s\": %s\n", kStringTableFilePath,
+			strerror(error));
+	}
+}
+
+
 status_t
 Volume::_AddInitialPackages()
 {
@@ -1012,7 +1122,8 @@ Volume::_AddPackageContent(Package* package, bool notify)
 				BPackageKit::BHPKG::B_HPKG_PACKAGE_INFO_FILE_NAME) == 0) {
 			continue;
 		}
-		error = _AddPackageContentRootNode(package, node, notify);
+		error = _AddPackageContentRootNode(package, fRootDirectory, node,
+			notify);
 		if (error != B_OK) {
 			_RemovePackageContent(package, node, notify);
 			RETURN_ERROR(error);
@@ -1037,7 +1148,8 @@ Volume::_RemovePackageContent(Package* package, PackageNode* endNode,
 		// skip over ".PackageInfo" file, it isn't part of the package content
 		if (strcmp(node->Name(),
 				BPackageKit::BHPKG::B_HPKG_PACKAGE_INFO_FILE_NAME) != 0) {
-			_RemovePackageContentRootNode(package, node, NULL, notify);
+			_RemovePackageContentRootNode(package, fRootDirectory, node, NULL,
+				notify);
 		}
 
 		node = nextNode;
@@ -1049,18 +1161,18 @@ Volume::_RemovePackageContent(Package* package, PackageNode* endNode,
 
 /*!	This method recursively iterates through the descendents of the given
 	package root node and adds all package nodes to the node tree in
-	pre-order.
+	pre-order. The root node is added to \a rootDirectory.
 	Due to limited kernel stack space we avoid deep recursive function calls
 	and rather use the package node stack implied by the tree.
 */
 status_t
-Volume::_AddPackageContentRootNode(Package* package,
+Volume::_AddPackageContentRootNode(Package* package, Directory* rootDirectory,
 	PackageNode* rootPackageNode, bool notify)
 {
 	ASSERT_WRITE_LOCKED_RW_LOCK(&fLock);
 
 	PackageNode* packageNode = rootPackageNode;
-	Directory* directory = fRootDirectory;
+	Directory* directory = rootDirectory;
 	directory->WriteLock();
 
 	do {
@@ -1069,14 +1181,16 @@ Volume::_AddPackageContentRootNode(Package* package,
 			// returns B_OK with a NULL node, when skipping the node
 		if (error != B_OK) {
 			// unlock all directories
-			while (directory != NULL) {
+			while (true) {
 				directory->WriteUnlock();
+				if (directory == rootDirectory)
+					break;
 				directory = directory->GetParentUnchecked();
 			}
 
 			// remove the added package nodes
-			_RemovePackageContentRootNode(package, rootPackageNode, packageNode,
-				notify);
+			_RemovePackageContentRootNode(package, rootDirectory,
+				rootPackageNode, packageNode, notify);
 			RETURN_ERROR(error);
 		}
 
@@ -1095,9 +1209,16 @@ Volume::_AddPackageContentRootNode(Package* package,
 
 		// continue with the next available (ancestors's) sibling
 		do {
+			if (packageNode == rootPackageNode) {
+				// we're done with the root node
+				directory->WriteUnlock();
+				directory = NULL;
+				packageNode = NULL;
+				break;
+			}
+
 			PackageDirectory* packageDirectory = packageNode->Parent();
-			PackageNode* sibling = packageDirectory != NULL
-				? packageDirectory->NextChild(packageNode) : NULL;
+			PackageNode* sibling = packageDirectory->NextChild(packageNode);
 
 			if (sibling != NULL) {
 				packageNode = sibling;
@@ -1120,27 +1241,32 @@ Volume::_AddPackageContentRootNode(Package* package,
 
 /*!	Recursively iterates through the descendents of the given package root node
 	and removes all package nodes from the node tree in post-order, until
-	encountering \a endPackageNode (if non-null).
+	encountering \a endPackageNode (if non-null). The root node must have been
+	added to \a rootDirectory.
 	Due to limited kernel stack space we avoid deep recursive function calls
 	and rather use the package node stack implied by the tree.
 */
 void
 Volume::_RemovePackageContentRootNode(Package* package,
-	PackageNode* rootPackageNode, PackageNode* endPackageNode, bool notify)
+	Directory* rootDirectory, PackageNode* rootPackageNode,
+	PackageNode* endPackageNode, bool notify)
 {
 	ASSERT_WRITE_LOCKED_RW_LOCK(&fLock);
 
 	PackageNode* packageNode = rootPackageNode;
-	Directory* directory = fRootDirectory;
+	Directory* directory = rootDirectory;
 	directory->WriteLock();
 
 	do {
 		if (packageNode == endPackageNode) {
 			// unlock all directories
-			while (directory != NULL) {
+			while (true) {
 				directory->WriteUnlock();
+				if (directory == rootDirectory)
+					break;
 				directory = directory->GetParentUnchecked();
 			}
+			directory = NULL;
 			break;
 		}
 
@@ -1161,7 +1287,7 @@ Volume::_RemovePackageContentRootNode(Package* package,
 		// continue with the next available (ancestors's) sibling
 		do {
 			PackageDirectory* packageDirectory = packageNode->Parent();
-			PackageNode* sibling = packageDirectory != NULL
+			PackageNode* sibling = packageNode != rootPackageNode
 				? packageDirectory->NextChild(packageNode) : NULL;
 
 			// we're done with the node -- remove it
@@ -1173,18 +1299,89 @@ Volume::_RemovePackageContentRootNode(Package* package,
 				break;
 			}
 
+			if (packageNode == rootPackageNode) {
+				// we're done with the root node
+				directory->WriteUnlock();
+				directory = NULL;
+				packageNode = NULL;
+				break;
+			}
+
 			// no more siblings -- go back up the tree
 			packageNode = packageDirectory;
 			directory->WriteUnlock();
 			directory = directory->GetParentUnchecked();
 				// the parent is still locked, so this is safe
-		} while (packageNode != NULL/* && packageNode != rootPackageNode*/);
-	} while (packageNode != NULL/* && packageNode != rootPackageNode*/);
+		} while (packageNode != NULL);
+	} while (packageNode != NULL);
 
 	ASSERT(directory == NULL);
 }
 
 
+status_t
+Volume::_LoadDeferredNodes(UnpackingDirectory* directory)
+{
+	status_t result = B_OK;
+	PackageDirectoryList::ConstIterator it
+		= directory->PackageDirectories().GetIterator();
+	while (PackageDirectory* packageDirectory = it.Next()) {
+		if (!packageDirectory->HasDeferredChildren())
+			continue;
+
+		status_t error = _AddDeferredPackageNodes(directory, packageDirectory);
+		if (error != B_OK)
+			result = error;
+	}
+
+	return result;
+}
+
+
+status_t
+Volume::_AddDeferredPackageNodes(UnpackingDirectory* directory,
+	PackageDirectory* packageDirectory)
+{
+	BReference<Package> package(packageDirectory->GetPackage());
+	if (!package.IsSet())
+		RETURN_ERROR(B_ENTRY_NOT_FOUND);
+
+	// see _AddPackageContent() for why we keep the package open
+	int fd = package->Open();
+	if (fd < 0)
+		RETURN_ERROR(fd);
+	PackageCloser packageCloser(package);
+
+	status_t error = package->LoadDeferredChildren(packageDirectory);
+	if (error != B_OK)
+		RETURN_ERROR(error);
+
+	// The nodes are not new, they merely haven't been visible so far, so
+	// there's nobody to notify.
+	for (PackageNode* child = packageDirectory->FirstChild(); child != NULL;
+			child = packageDirectory->NextChild(child)) {
+		error = _AddPackageContentRootNode(package, directory, child, false);
+		if (error == B_OK)
+			continue;
+
+		// remove the children added so far and leave the package directory
+		// deferred
+		for (PackageNode* addedChild = packageDirectory->FirstChild();
+				addedChild != child;
+				addedChild = packageDirectory->NextChild(addedChild)) {
+			_RemovePackageContentRootNode(package, directory, addedChild,
+				NULL, false);
+		}
+		while (PackageNode* node = packageDirectory->FirstChild())
+			packageDirectory->RemoveChild(node);
+		RETURN_ERROR(error);
+	}
+
+	directory->DeferredChildrenLoaded(packageDirectory);
+	return B_OK;
+}
+
+
 status_t
 Volume::_AddPackageNode(Directory* directory, PackageNode* packageNode,
 	bool notify, Node*& _node)
@@ -1538,7 +1735,7 @@ Volume::_LoadPackage(PackagesDirectory* packagesDirectory, const char* name,
 	if (error != B_OK)
 		return error;
 
-	error = package->Load(fPackageSettings);
+	error = package->Load(fPackageSettings, fLazyDepth);
 	if (error != B_OK)
 		return error;
 
@@ -1682,6 +1879,17 @@ Volume::_ChangeActivation(ActivationChangeRequest& request)
 		INFORM("package \"%s\" activated\n", package->FileName().Data());
 	}
 
+	// Live queries must see the nodes of the new packages, so don't defer
+	// loading them.
+	if (error == B_OK && !fQueries.IsEmpty()) {
+		error = LoadAllDeferredNodes();
+		if (error != B_OK) {
+			ERROR("Volume::_ChangeActivation(): failed to load deferred "
+				"nodes: %s\n", strerror(error));
+			error = B_OK;
+		}
+	}
+
 	// Try to roll back the changes, if an error occurred.
 	if (error != B_OK) {
 		for (int32 i = newPackageIndex - 1; i >= 0; i--) {
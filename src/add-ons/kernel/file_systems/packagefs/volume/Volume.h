@@ -27,8 +27,10 @@
 
 
 class Directory;
+class PackageDirectory;
 class PackageFSRoot;
 class PackagesDirectory;
+class UnpackingDirectory;
 class UnpackingNode;
 
 typedef IndexHashTable::Iterator IndexDirIterator;
@@ -71,6 +73,9 @@ public:
 			Node*				FindNode(ino_t nodeID) const
 									{ return fNodes.Lookup(nodeID); }
 
+			status_t			LoadDeferredNodes(Directory* directory);
+			status_t			LoadAllDeferredNodes();
+
 			status_t			IOCtl(Node* node, uint32 operation,
 									void* buffer, size_t size);
 
@@ -114,6 +119,7 @@ private:
 			status_t			_LoadOldPackagesStates(
 									const char* packagesState);
 
+			void				_AddStringTable();
 			status_t			_AddInitialPackages();
 			status_t			_AddInitialPackagesFromActivationFile(
 									PackagesDirectory* packagesDirectory);
@@ -133,11 +139,19 @@ private:
 									PackageNode* endNode, bool notify);
 
 			status_t			_AddPackageContentRootNode(Package* package,
+									Directory* rootDirectory,
 									PackageNode* node, bool notify);
 			void				_RemovePackageContentRootNode(Package* package,
+									Directory* rootDirectory,
 									PackageNode* packageNode,
 									PackageNode* endPackageNode, bool notify);
 
+			status_t			_LoadDeferredNodes(
+									UnpackingDirectory* directory);
+			status_t			_AddDeferredPackageNodes(
+									UnpackingDirectory* directory,
+									PackageDirectory* packageDirectory);
+
 			status_t			_AddPackageNode(Directory* directory,
 									PackageNode* packageNode, bool notify,
 									Node*& _node);
@@ -190,6 +204,7 @@ private:
 			PackagesDirectoryList fPackagesDirectories;
 			PackagesDirectoryHashTable fPackagesDirectoriesByNodeRef;
 			PackageSettings		fPackageSettings;
+			int32				fLazyDepth;
 
 			struct {
 				dev_t			deviceID;
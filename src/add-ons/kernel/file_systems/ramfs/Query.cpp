@@ -170,6 +170,12 @@ struct Query::QueryPolicy {
 		return index.index != NULL ? B_OK : B_ENTRY_NOT_FOUND;
 	}
 
+	static status_t IndexSetToTrigrams(Index& index, const char* attribute)
+	{
+		// trigram indices are not supported
+		return B_ENTRY_NOT_FOUND;
+	}
+
 	static void IndexUnset(Index& index)
 	{
 		index.index = NULL;
@@ -180,6 +186,13 @@ struct Query::QueryPolicy {
 		return index.index->CountEntries();
 	}
 
+	static int32 IndexEstimateMatches(Index& index, int32 op,
+		const void* value, size_t size, bool isPrefix)
+	{
+		// no statistics available
+		return -1;
+	}
+
 	static type_code IndexGetType(Index& index)
 	{
 		return index.index->GetType();
@@ -225,6 +238,11 @@ struct Query::QueryPolicy {
 		return B_OK;
 	}
 
+	static ino_t IndexIteratorGetNodeID(IndexIterator* indexIterator)
+	{
+		return indexIterator->entry->GetNode()->GetID();
+	}
+
 	static void IndexIteratorSkipDuplicates(IndexIterator* indexIterator)
 	{
 		// Nothing to do.
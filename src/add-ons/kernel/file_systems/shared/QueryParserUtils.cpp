@@ -144,6 +144,109 @@ getFirstPatternSymbol(const char* string)
 }
 
 
+/*!	Returns the single character the set at the start of \a _pattern (behind
+	the opening bracket) stands for, ignoring the case of ASCII letters, as
+	in "[Hh]". Returns -1 if the set may match different characters.
+	In any case, \a _pattern is moved behind the set.
+*/
+static int32
+getSetCharacter(const char** _pattern)
+{
+	const char* pattern = *_pattern;
+	int32 character = -1;
+	bool valid = true;
+
+	if (pattern[0] == '^' || pattern[0] == '!')
+		valid = false;
+
+	while (pattern[0] != ']' && pattern[0] != '\0') {
+		if (pattern[0] == '\\' && pattern[1] != '\0')
+			pattern++;
+
+		uint8 c = foldTrigramCharacter(*pattern++);
+		if ((c & 0x80) != 0 || (pattern[0] == '-' && pattern[1] != ']'))
+			valid = false;
+		else if (character < 0)
+			character = c;
+		else if (character != c)
+			valid = false;
+	}
+
+	if (pattern[0] == ']')
+		pattern++;
+
+	*_pattern = pattern;
+	return valid ? character : -1;
+}
+
+
+/*!	Collects the distinct three byte sequences every string matching
+	\a pattern must contain, with ASCII letters folded to lower case (see
+	foldTrigramCharacter()). \a trigrams must have room for \a maxCount
+	of them. Returns the number of trigrams found.
+*/
+int32
+getPatternTrigrams(const char* pattern, uint8* trigrams, int32 maxCount)
+{
+	uint8 previous[2];
+	int32 length = 0;
+	int32 count = 0;
+
+	while (pattern[0] != '\0' && count < maxCount) {
+		int32 c;
+		switch (pattern[0]) {
+			case '*':
+			case '?':
+				pattern++;
+				c = -1;
+				break;
+			case '[':
+				pattern++;
+				c = getSetCharacter(&pattern);
+				break;
+			case '\\':
+				if (pattern[1] != '\0')
+					pattern++;
+				// supposed to fall through
+			default:
+				c = foldTrigramCharacter(*pattern++);
+				break;
+		}
+
+		if (c < 0) {
+			// the run of known characters has been interrupted
+			length = 0;
+			continue;
+		}
+
+		if (length < 2) {
+			previous[length++] = c;
+			continue;
+		}
+
+		uint8* trigram = trigrams + count * 3;
+		trigram[0] = previous[0];
+		trigram[1] = previous[1];
+		trigram[2] = c;
+
+		previous[0] = previous[1];
+		previous[1] = c;
+
+		bool found = false;
+		for (int32 i = 0; i < count; i++) {
+			if (memcmp(trigrams + i * 3, trigram, 3) == 0) {
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			count++;
+	}
+
+	return count;
+}
+
+
 status_t
 isValidPattern(const char* pattern)
 {
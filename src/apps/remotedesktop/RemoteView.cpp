@@ -10,6 +10,7 @@
 #include "NetSender.h"
 #include "RemoteMessage.h"
 #include "RemoteView.h"
+#include "StreamCompression.h"
 #include "StreamingRingBuffer.h"
 
 #include <Application.h>
@@ -24,6 +25,7 @@
 
 #include <new>
 #include <stdio.h>
+#include <string.h>
 
 
 static const uint8 kCursorData[] = { 16 /* size, 16x16 */,
@@ -71,6 +73,8 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 	fCursorBitmap(NULL),
 	fCursorVisible(false)
 {
+	memset(fDeltaBitmaps, 0, sizeof(fDeltaBitmaps));
+
 	fReceiveBuffer = new(std::nothrow) StreamingRingBuffer(16 * 1024);
 	if (fReceiveBuffer == NULL) {
 		fInitStatus = B_NO_MEMORY;
@@ -174,6 +178,9 @@ RemoteView::~RemoteView()
 
 	int32 result;
 	wait_for_thread(fDrawThread, &result);
+
+	for (int32 i = 0; i < RP_BITMAP_DELTA_SLOT_COUNT; i++)
+		delete fDeltaBitmaps[i];
 }
 
 
@@ -443,7 +450,12 @@ RemoteView::_DrawThread()
 	// cursor
 	BPoint cursorHotSpot(0, 0);
 
+	uint32 features = RP_FEATURE_BITMAP_DELTAS;
+	if (StreamDecoder::DecompressionSupported())
+		features |= RP_FEATURE_STREAM_COMPRESSION;
+
 	reply.Start(RP_INIT_CONNECTION);
+	reply.Add(features);
 	reply.Flush();
 
 	while (!fStopThread) {
@@ -485,6 +497,12 @@ RemoteView::_DrawThread()
 				continue;
 			}
 
+			case RP_ENABLE_STREAM_COMPRESSION:
+			{
+				// the receiver already decompresses everything after this
+				continue;
+			}
+
 			case RP_CREATE_STATE:
 			case RP_DELETE_STATE:
 			{
@@ -775,6 +793,78 @@ RemoteView::_DrawThread()
 				break;
 			}
 
+			case RP_DRAW_BITMAP_DELTA:
+			{
+				BRect bitmapRect, viewRect;
+				uint32 options, slot, flags;
+				int32 width, height, rectCount;
+				color_space colorSpace;
+
+				message.Read(bitmapRect);
+				message.Read(viewRect);
+				message.Read(options);
+				message.Read(slot);
+				message.Read(width);
+				message.Read(height);
+				message.Read(colorSpace);
+				message.Read(flags);
+				if (message.Read(rectCount) != B_OK
+					|| slot >= RP_BITMAP_DELTA_SLOT_COUNT) {
+					continue;
+				}
+
+				BRect bounds(0, 0, width - 1, height - 1);
+				BBitmap*& bitmap = fDeltaBitmaps[slot];
+				if (bitmap == NULL || bitmap->Bounds() != bounds
+					|| bitmap->ColorSpace() != colorSpace) {
+					delete bitmap;
+					bitmap = new(std::nothrow) BBitmap(bounds, flags,
+						colorSpace);
+					if (bitmap != NULL && bitmap->InitCheck() != B_OK) {
+						delete bitmap;
+						bitmap = NULL;
+					}
+
+					if (bitmap == NULL)
+						continue;
+				}
+
+				uint8* bits = (uint8*)bitmap->Bits();
+				int32 bytesPerRow = bitmap->BytesPerRow();
+				status_t result = B_OK;
+				for (int32 i = 0; i < rectCount && result == B_OK; i++) {
+					clipping_rect rect;
+					result = message.Read(rect);
+					if (result != B_OK)
+						break;
+
+					if (rect.left < 0 || rect.top < 0 || rect.left > rect.right
+						|| rect.top > rect.bottom || rect.right >= width
+						|| rect.bottom >= height) {
+						result = B_BAD_DATA;
+						break;
+					}
+
+					size_t length = (rect.right - rect.left + 1) * 4;
+					for (int32 y = rect.top; y <= rect.bottom
+							&& result == B_OK; y++) {
+						result = message.ReadData(
+							bits + y * bytesPerRow + rect.left * 4, length);
+					}
+				}
+
+				if (result != B_OK) {
+					// the contents no longer match what the server has
+					delete bitmap;
+					bitmap = NULL;
+					continue;
+				}
+
+				offscreen->DrawBitmap(bitmap, bitmapRect, viewRect, options);
+				invalidRegion.Include(viewRect);
+				break;
+			}
+
 			case RP_DRAW_BITMAP_RECTS:
 			{
 				color_space colorSpace;
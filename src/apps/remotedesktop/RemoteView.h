@@ -13,6 +13,8 @@
 #include <ObjectList.h>
 #include <View.h>
 
+#include "RemoteMessage.h"
+
 class BBitmap;
 class NetReceiver;
 class NetSender;
@@ -75,6 +77,7 @@ static	int32						_DrawEntry(void *data);
 
 		BBitmap *					fOffscreenBitmap;
 		BView *						fOffscreen;
+		BBitmap *					fDeltaBitmaps[RP_BITMAP_DELTA_SLOT_COUNT];
 
 		BCursor						fViewCursor;
 		BBitmap *					fCursorBitmap;
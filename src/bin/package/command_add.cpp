@@ -36,6 +36,7 @@ command_add(int argc, const char* const* argv)
 	bool verbose = false;
 	bool force = false;
 	int32 compressionLevel = BPackageKit::BHPKG::B_HPKG_COMPRESSION_LEVEL_BEST;
+	int32 compressionThreadCount = 1;
 
 	while (true) {
 		static struct option sLongOptions[] = {
@@ -46,7 +47,7 @@ command_add(int argc, const char* const* argv)
 		};
 
 		opterr = 0; // don't print errors
-		int c = getopt_long(argc, (char**)argv, "+0123456789C:fhi:qv",
+		int c = getopt_long(argc, (char**)argv, "+0123456789C:fhi:j:qv",
 			sLongOptions, NULL);
 		if (c == -1)
 			break;
@@ -81,6 +82,10 @@ command_add(int argc, const char* const* argv)
 				packageInfoFileName = optarg;
 				break;
 
+			case 'j':
+				compressionThreadCount = parse_thread_count_argument(optarg);
+				break;
+
 			case 'q':
 				quiet = true;
 				break;
@@ -114,6 +119,11 @@ command_add(int argc, const char* const* argv)
 	writerParameters.SetFlags(
 		B_HPKG_WRITER_UPDATE_PACKAGE | (force ? B_HPKG_WRITER_FORCE_ADD : 0));
 	writerParameters.SetCompressionLevel(compressionLevel);
+	if (writerParameters.SetCompressionThreadCount(compressionThreadCount)
+			!= B_OK) {
+		fprintf(stderr, "Error: Out of memory!\n");
+		return 1;
+	}
 	if (compressionLevel == 0) {
 		writerParameters.SetCompression(
 			BPackageKit::BHPKG::B_HPKG_COMPRESSION_NONE);
@@ -40,7 +40,10 @@ command_create(int argc, const char* const* argv)
 	bool quiet = false;
 	bool verbose = false;
 	int32 compressionLevel = BPackageKit::BHPKG::B_HPKG_COMPRESSION_LEVEL_BEST;
+	int32 compressionThreadCount = 1;
 	int32 compression = parse_compression_argument(NULL);
+	uint32 chunkSize = BPackageKit::BHPKG::B_HPKG_DEFAULT_HEAP_CHUNK_SIZE;
+	uint32 dictionarySize = 0;
 
 	while (true) {
 		static struct option sLongOptions[] = {
@@ -51,7 +54,7 @@ command_create(int argc, const char* const* argv)
 		};
 
 		opterr = 0; // don't print errors
-		int c = getopt_long(argc, (char**)argv, "+b0123456789C:hi:I:z:qv",
+		int c = getopt_long(argc, (char**)argv, "+b0123456789C:d:hi:I:j:s:z:qv",
 			sLongOptions, NULL);
 		if (c == -1)
 			break;
@@ -78,6 +81,10 @@ command_create(int argc, const char* const* argv)
 				changeToDirectory = optarg;
 				break;
 
+			case 'd':
+				dictionarySize = parse_size_argument(optarg);
+				break;
+
 			case 'h':
 				print_usage_and_exit(false);
 				break;
@@ -90,6 +97,14 @@ command_create(int argc, const char* const* argv)
 				installPath = optarg;
 				break;
 
+			case 'j':
+				compressionThreadCount = parse_thread_count_argument(optarg);
+				break;
+
+			case 's':
+				chunkSize = parse_size_argument(optarg);
+				break;
+
 			case 'z':
 				compression = parse_compression_argument(optarg);
 				break;
@@ -144,6 +159,14 @@ command_create(int argc, const char* const* argv)
 	if (compressionLevel == 0)
 		compression = BPackageKit::BHPKG::B_HPKG_COMPRESSION_NONE;
 	writerParameters.SetCompression(compression);
+	if (writerParameters.SetCompressionThreadCount(compressionThreadCount)
+			!= B_OK
+		|| writerParameters.SetChunkSize(chunkSize) != B_OK
+		|| writerParameters.SetCompressionDictionarySize(dictionarySize)
+			!= B_OK) {
+		fprintf(stderr, "Error: Out of memory!\n");
+		return 1;
+	}
 
 	PackageWriterListener listener(verbose, quiet);
 	BPackageWriter packageWriter(&listener);
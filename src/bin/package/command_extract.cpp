@@ -30,7 +30,8 @@
 #include <package/hpkg/PackageDataReader.h>
 #include <package/hpkg/PackageEntry.h>
 #include <package/hpkg/PackageEntryAttribute.h>
-#include <package/hpkg/PackageReader.h>
+#include <package/hpkg/PackageFileHeapReader.h>
+#include <package/hpkg/PackageReaderImpl.h>
 #include <package/hpkg/StandardErrorOutput.h>
 #include <package/hpkg/v1/PackageContentHandler.h>
 #include <package/hpkg/v1/PackageDataReader.h>
@@ -50,6 +51,7 @@ using BPackageKit::BHPKG::BErrorOutput;
 using BPackageKit::BHPKG::BFDDataReader;
 using BPackageKit::BHPKG::BPackageInfoAttributeValue;
 using BPackageKit::BHPKG::BStandardErrorOutput;
+using BPackageKit::BHPKG::BPrivate::PackageReaderImpl;
 
 
 struct VersionPolicyV1 {
@@ -97,6 +99,13 @@ struct VersionPolicyV1 {
 		return _heapReader != NULL ? B_OK : B_NO_MEMORY;
 	}
 
+	static status_t SetReadAhead(PackageReader& packageReader,
+		int32 threadCount)
+	{
+		// V1 packages compress the data of each file separately
+		return B_OK;
+	}
+
 	static status_t CreatePackageDataReader(BBufferPool* bufferPool,
 		HeapReaderBase* heapReader, const PackageData& data,
 		BAbstractBufferedDataReader*& _reader)
@@ -111,7 +120,7 @@ struct VersionPolicyV2 {
 	typedef BPackageKit::BHPKG::BPackageData PackageData;
 	typedef BPackageKit::BHPKG::BPackageEntry PackageEntry;
 	typedef BPackageKit::BHPKG::BPackageEntryAttribute PackageEntryAttribute;
-	typedef BPackageKit::BHPKG::BPackageReader PackageReader;
+	typedef PackageReaderImpl PackageReader;
 	typedef BAbstractBufferedDataReader HeapReaderBase;
 
 	static inline size_t BufferSize()
@@ -150,6 +159,12 @@ struct VersionPolicyV2 {
 		return B_OK;
 	}
 
+	static status_t SetReadAhead(PackageReader& packageReader,
+		int32 threadCount)
+	{
+		return packageReader.RawHeapReader()->SetReadAhead(threadCount);
+	}
+
 	static status_t CreatePackageDataReader(BBufferPool* bufferPool,
 		HeapReaderBase* heapReader, const PackageData& data,
 		BAbstractBufferedDataReader*& _reader)
@@ -766,7 +781,8 @@ template<typename VersionPolicy>
 static void
 do_extract(const char* packageFileName, const char* changeToDirectory,
 	const char* packageInfoFileName, const char* const* explicitEntries,
-	int explicitEntryCount, bool ignoreVersionError)
+	int explicitEntryCount, int32 readAheadThreadCount,
+	bool ignoreVersionError)
 {
 	// open package
 	BStandardErrorOutput errorOutput;
@@ -796,6 +812,16 @@ do_extract(const char* packageFileName, const char* changeToDirectory,
 	ObjectDeleter<BDataReader> heapReaderDeleter(
 		mustDeleteHeapReader ? heapReader : NULL);
 
+	if (readAheadThreadCount > 0) {
+		error = VersionPolicy::SetReadAhead(packageReader,
+			readAheadThreadCount);
+		if (error != B_OK) {
+			fprintf(stderr, "Error: Failed to set up decompression threads: "
+				"\"%s\"\n", strerror(error));
+			exit(1);
+		}
+	}
+
 	PackageContentExtractHandler<VersionPolicy> handler(&bufferPool,
 		heapReader);
 	error = handler.Init();
@@ -861,6 +887,7 @@ command_extract(int argc, const char* const* argv)
 {
 	const char* changeToDirectory = NULL;
 	const char* packageInfoFileName = NULL;
+	int32 readAheadThreadCount = 0;
 
 	while (true) {
 		static struct option sLongOptions[] = {
@@ -869,7 +896,7 @@ command_extract(int argc, const char* const* argv)
 		};
 
 		opterr = 0; // don't print errors
-		int c = getopt_long(argc, (char**)argv, "+C:hi:", sLongOptions, NULL);
+		int c = getopt_long(argc, (char**)argv, "+C:hi:j:", sLongOptions, NULL);
 		if (c == -1)
 			break;
 
@@ -886,6 +913,10 @@ command_extract(int argc, const char* const* argv)
 				packageInfoFileName = optarg;
 				break;
 
+			case 'j':
+				readAheadThreadCount = parse_thread_count_argument(optarg);
+				break;
+
 			default:
 				print_usage_and_exit(true);
 				break;
@@ -901,9 +932,11 @@ command_extract(int argc, const char* const* argv)
 	const char* const* explicitEntries = argv + optind;
 	int explicitEntryCount = argc - optind;
 	do_extract<VersionPolicyV2>(packageFileName, changeToDirectory,
-		packageInfoFileName, explicitEntries, explicitEntryCount, true);
+		packageInfoFileName, explicitEntries, explicitEntryCount,
+		readAheadThreadCount, true);
 	do_extract<VersionPolicyV1>(packageFileName, changeToDirectory,
-		packageInfoFileName, explicitEntries, explicitEntryCount, false);
+		packageInfoFileName, explicitEntries, explicitEntryCount,
+		readAheadThreadCount, false);
 
 	return 0;
 }
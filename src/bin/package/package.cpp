@@ -12,6 +12,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <package/hpkg/HPKGDefs.h>
 
@@ -19,6 +20,8 @@
 extern const char* __progname;
 const char* kCommandName = __progname;
 
+static const int32 kMaxCompressionThreads = 64;
+
 
 static const char* kUsage =
 	"Usage: %s <command> <command args>\n"
@@ -37,6 +40,8 @@ static const char* kUsage =
 	"        -i <info>  - Use the package info file <info>. It will be added as\n"
 	"                     \".PackageInfo\", overriding a \".PackageInfo\" file,\n"
 	"                     existing.\n"
+	"        -j <count> - Compress using <count> threads. 0 uses one thread per\n"
+	"                     CPU. Defaults to 1.\n"
 	"        -q         - Be quiet (don't show any output except for errors).\n"
 	"        -v         - Be verbose (show more info about created package).\n"
 	"\n"
@@ -56,9 +61,17 @@ static const char* kUsage =
 	"        -b         - Create an empty build package. Only the .PackageInfo will\n"
 	"                     be added.\n"
 	"        -C <dir>   - Change to directory <dir> before adding entries.\n"
+	"        -d <size>  - Train a compression dictionary of at most <size> KiB on\n"
+	"                     the files to be added and store it in the package. Only\n"
+	"                     supported with zstd compression. Up to 32 KiB.\n"
 	"        -i <info>  - Use the package info file <info>. It will be added as\n"
 	"                     \".PackageInfo\", overriding a \".PackageInfo\" file,\n"
 	"                     existing.\n"
+	"        -j <count> - Compress using <count> threads. 0 uses one thread per\n"
+	"                     CPU. Defaults to 1.\n"
+	"        -s <size>  - Compress the data in chunks of <size> KiB. Must be a power\n"
+	"                     of two from 4 to 64. Smaller chunks speed up random\n"
+	"                     access at some cost in compression. Defaults to 64.\n"
 	"        -I <path>  - Set the package's installation path to <path>. This is\n"
 	"                     an option only for use in package building. It will cause\n"
 	"                     the package .self link to point to <path>, which is useful\n"
@@ -77,6 +90,8 @@ static const char* kUsage =
 	"        -C <dir>   - Change to directory <dir> before extracting the contents\n"
 	"                     of the archive.\n"
 	"        -i <info>  - Extract the .PackageInfo file to <info> instead.\n"
+	"        -j <count> - Decompress ahead using <count> threads. 0 uses one\n"
+	"                     thread per CPU.\n"
 	"\n"
 	"    info [ <options> ] <package>\n"
 	"        Prints individual meta information of package file <package>.\n"
@@ -109,6 +124,8 @@ static const char* kUsage =
 	"\n"
 	"        -0 ... -9  - Use compression level 0 ... 9. 0 means no, 9 best\n"
 	"                     compression. Defaults to 9.\n"
+	"        -j <count> - Compress using <count> threads. 0 uses one thread per\n"
+	"                     CPU. Defaults to 1.\n"
 	"        -z <type>  - Specify compression method to use.\n"
 	"        -q         - Be quiet (don't show any output except for errors).\n"
 	"        -v         - Be verbose (show more info about created package).\n"
@@ -149,6 +166,40 @@ parse_compression_argument(const char* arg)
 }
 
 
+int32
+parse_thread_count_argument(const char* arg)
+{
+	char* end;
+	long count = strtol(arg, &end, 10);
+	if (*arg == '\0' || *end != '\0' || count < 0) {
+		fprintf(stderr, "error: invalid thread count '%s'\n", arg);
+		exit(1);
+	}
+
+	if (count == 0) {
+		count = sysconf(_SC_NPROCESSORS_ONLN);
+		if (count < 1)
+			count = 1;
+	}
+
+	return count < kMaxCompressionThreads ? count : kMaxCompressionThreads;
+}
+
+
+uint32
+parse_size_argument(const char* arg)
+{
+	char* end;
+	long size = strtol(arg, &end, 10);
+	if (*arg == '\0' || *end != '\0' || size < 0 || size > 1024 * 1024) {
+		fprintf(stderr, "error: invalid size '%s'\n", arg);
+		exit(1);
+	}
+
+	return size * 1024;
+}
+
+
 int
 main(int argc, const char* const* argv)
 {
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Entry.h>
+#include <Path.h>
+#include <String.h>
+
+#include <package/ChecksumAccessors.h>
+#include <package/RepositoryDelta.h>
+
+#include "package_repo.h"
+
+
+using BPackageKit::BPrivate::GeneralFileChecksumAccessor;
+using BPackageKit::BPrivate::RepositoryDelta;
+
+
+int
+command_delta(int argc, const char* const* argv)
+{
+	bool quiet = false;
+	bool verbose = false;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ "quiet", no_argument, 0, 'q' },
+			{ "verbose", no_argument, 0, 'v' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+hqv", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'q':
+				quiet = true;
+				break;
+
+			case 'v':
+				verbose = true;
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	// The remaining three arguments are the old and new repository file plus
+	// the delta directory.
+	if (optind + 3 != argc)
+		print_usage_and_exit(true);
+
+	const char* baseRepositoryFileName = argv[optind++];
+	const char* repositoryFileName = argv[optind++];
+	const char* deltaDirectoryName = argv[optind++];
+
+	BEntry baseRepositoryEntry(baseRepositoryFileName);
+	BEntry repositoryEntry(repositoryFileName);
+
+	RepositoryDelta delta;
+	status_t result = delta.SetTo(baseRepositoryEntry, repositoryEntry);
+	if (result != B_OK) {
+		fprintf(stderr, "Error: failed to compute delta between \"%s\" and "
+			"\"%s\": %s\n", baseRepositoryFileName, repositoryFileName,
+			strerror(result));
+		return 1;
+	}
+
+	// Clients verify the repository file they get from applying the delta
+	// against the new repository's checksum, so make sure it matches.
+	BString checkFileName(repositoryFileName);
+	checkFileName += ".___delta___";
+	BEntry checkEntry(checkFileName.String());
+	result = delta.Apply(baseRepositoryEntry, checkEntry);
+
+	BString checksum;
+	BString expectedChecksum;
+	if (result == B_OK) {
+		result = GeneralFileChecksumAccessor(checkEntry).GetChecksum(checksum);
+		if (result == B_OK) {
+			result = GeneralFileChecksumAccessor(repositoryEntry).GetChecksum(
+				expectedChecksum);
+		}
+	}
+	checkEntry.Remove();
+
+	if (result != B_OK) {
+		fprintf(stderr, "Error: failed to apply the delta to \"%s\": %s\n",
+			baseRepositoryFileName, strerror(result));
+		return 1;
+	}
+
+	if (checksum != expectedChecksum) {
+		fprintf(stderr, "Error: applying the delta to \"%s\" doesn't "
+			"reproduce \"%s\". Were both written by the same version of "
+			"package_repo?\n", baseRepositoryFileName, repositoryFileName);
+		return 1;
+	}
+
+	// the delta is named after the checksum of the file it applies to
+	BPath deltaPath(deltaDirectoryName, delta.BaseChecksum().String());
+	result = deltaPath.InitCheck();
+	if (result == B_OK)
+		result = delta.WriteToFile(BEntry(deltaPath.Path()));
+	if (result != B_OK) {
+		fprintf(stderr, "Error: failed to write delta to directory \"%s\": "
+			"%s\n", deltaDirectoryName, strerror(result));
+		return 1;
+	}
+
+	if (!quiet) {
+		printf("removed %" B_PRId32 " and added %" B_PRId32 " packages\n",
+			delta.CountRemovedPackages(), delta.CountAddedPackages());
+	}
+
+	if (verbose)
+		printf("\nsuccessfully created delta '%s'\n", deltaPath.Path());
+
+	return 0;
+}
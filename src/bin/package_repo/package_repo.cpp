@@ -29,6 +29,15 @@ static const char* kUsage =
 	"    -q         - be quiet (don't show any output except for errors).\n"
 	"    -v         - be verbose (list package attributes as encountered).\n"
 	"\n"
+	"  delta [ <options> ] <old-repo> <new-repo> <delta-dir>\n"
+	"    Writes the changes between <old-repo> and <new-repo> to a file in\n"
+	"    <delta-dir>, named after the checksum of <old-repo>. Clients having\n"
+	"    <old-repo> cached fetch it from the \"deltas\" subdirectory of the\n"
+	"    repository instead of the complete repository file.\n"
+	"\n"
+	"    -q         - be quiet (don't show any output except for errors).\n"
+	"    -v         - be verbose.\n"
+	"\n"
 	"  list [ <options> ] <package-repo>\n"
 	"    Lists the contents of package repository file <package-repo>.\n"
 	"\n"
@@ -74,6 +83,9 @@ main(int argc, const char* const* argv)
 	if (strcmp(command, "create") == 0)
 		return command_create(argc - 1, argv + 1);
 
+	if (strcmp(command, "delta") == 0)
+		return command_delta(argc - 1, argv + 1);
+
 	if (strcmp(command, "list") == 0)
 		return command_list(argc - 1, argv + 1);
 
@@ -5,26 +5,112 @@
  */
 
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <DiskDevice.h>
 #include <DiskDeviceRoster.h>
 #include <DiskSystem.h>
+#include <Path.h>
 #include <StringForSize.h>
 
+#include "bfs_control.h"
+
 
 extern "C" const char* __progname;
 static const char* kProgramName = __progname;
 
 
+static status_t
+get_partition(const char* path, BDiskDevice& device, BPartition*& partition)
+{
+	BDiskDeviceRoster roster;
+	status_t status = roster.GetPartitionForPath(path, &device, &partition);
+	if (status != B_OK) {
+		if (strncmp(path, "/dev", 4)) {
+			// try mounted volume
+			status = roster.FindPartitionByMountPoint(path, &device,
+				&partition);
+		}
+
+		// TODO: try to register file device
+
+		if (status != B_OK) {
+			fprintf(stderr, "%s: Failed to get disk device for path \"%s\": "
+				"%s\n", kProgramName, path, strerror(status));
+		}
+	}
+
+	return status;
+}
+
+
+/*!	Changes the size of the log of a mounted BFS volume. The log is always
+	kept in the first allocation group, and must fit there.
+*/
+static int
+resize_log(const char* path, const char* sizeString)
+{
+	char* end;
+	unsigned long length = strtoul(sizeString, &end, 0);
+	if (end == sizeString || *end != '\0' || length == 0
+		|| length > UINT32_MAX) {
+		fprintf(stderr, "%s: The new log size \"%s\" is not a number\n",
+			kProgramName, sizeString);
+		return 1;
+	}
+
+	BPartition* partition;
+	BDiskDevice device;
+	if (get_partition(path, device, partition) != B_OK)
+		return 1;
+
+	BPath mountPoint;
+	if (!partition->IsMounted()
+		|| partition->GetMountPoint(&mountPoint) != B_OK) {
+		fprintf(stderr, "%s: The log can only be resized while the volume is "
+			"mounted.\n", kProgramName);
+		return 1;
+	}
+
+	int fd = open(mountPoint.Path(), O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "%s: Could not open \"%s\": %s\n", kProgramName,
+			mountPoint.Path(), strerror(errno));
+		return 1;
+	}
+
+	uint32 logLength = length;
+	if (ioctl(fd, BFS_IOCTL_RESIZE_LOG, &logLength, sizeof(uint32)) != 0) {
+		fprintf(stderr, "%s: Resizing the log failed: %s\n", kProgramName,
+			strerror(errno));
+		close(fd);
+		return 1;
+	}
+
+	close(fd);
+	return 0;
+}
+
+
 int
 main(int argc, char** argv)
 {
+	if (argc == 4 && !strcmp(argv[1], "--log"))
+		return resize_log(argv[2], argv[3]);
+
 	if (argc != 3) {
 		fprintf(stderr, "Usage: %s <device> <size>\n"
+			"       %s --log <device> <blocks>\n"
 			"Resize volume on <device> to new size <size> (in bytes, suffixes "
-			"'k', 'm', 'g', 't' are interpreted as KiB, Mib, GiB, TiB).\n",
-			kProgramName);
+			"'k', 'm', 'g', 't' are interpreted as KiB, Mib, GiB, TiB).\n"
+			"With --log, resize the log of the mounted BFS volume on <device> "
+			"to <blocks>\nfile system blocks instead.\n",
+			kProgramName, kProgramName);
 		return 1;
 	}
 
@@ -35,27 +121,12 @@ main(int argc, char** argv)
 		return 1;
 	}
 
-	BDiskDeviceRoster roster;
 	BPartition* partition;
 	BDiskDevice device;
 
-	status_t status = roster.GetPartitionForPath(argv[1], &device,
-		&partition);
-	if (status != B_OK) {
-		if (strncmp(argv[1], "/dev", 4)) {
-			// try mounted volume
-			status = roster.FindPartitionByMountPoint(argv[1], &device,
-				&partition);
-		}
-
-		// TODO: try to register file device
-
-		if (status != B_OK) {
-			fprintf(stderr, "%s: Failed to get disk device for path \"%s\": "
-				"%s\n", kProgramName, argv[1], strerror(status));
-			return 1;
-		}
-	}
+	status_t status = get_partition(argv[1], device, partition);
+	if (status != B_OK)
+		return 1;
 
 	// Prepare the device for modifications
 
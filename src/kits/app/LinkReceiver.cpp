@@ -30,6 +30,7 @@
 #include <Shape.h>
 #include <ShapePrivate.h>
 
+#include <LinkRing.h>
 #include <StackOrHeapArray.h>
 
 #include "link_message.h"
@@ -58,13 +59,16 @@ LinkReceiver::LinkReceiver(port_id port)
 	:
 	fReceivePort(port), fRecvBuffer(NULL), fRecvPosition(0), fRecvStart(0),
 	fRecvBufferSize(0), fDataSize(0),
-	fReplySize(0), fReadError(B_OK)
+	fReplySize(0), fReadError(B_OK),
+	fRing(NULL), fRingData(NULL), fRingSize(0), fRingTail(0),
+	fRingSemaphore(-1)
 {
 }
 
 
 LinkReceiver::~LinkReceiver()
 {
+	SetRing(NULL, 0);
 	free(fRecvBuffer);
 }
 
@@ -76,6 +80,48 @@ LinkReceiver::SetPort(port_id port)
 }
 
 
+/*!	Initializes the shared memory \a ring of \a size bytes, and reads the
+	messages of the sender that is told to use it from there. Messages
+	written to the port are still received as well.
+	The sender must also be given RingSemaphore(), which is deleted when the
+	ring is no longer used, so that a waiting sender notices.
+*/
+status_t
+LinkReceiver::SetRing(void* ring, size_t size)
+{
+	if (fRingSemaphore >= 0) {
+		delete_sem(fRingSemaphore);
+		fRingSemaphore = -1;
+	}
+
+	if (ring == NULL) {
+		fRing = NULL;
+		fRingData = NULL;
+		fRingSize = 0;
+		return B_OK;
+	}
+
+	if (size <= sizeof(link_ring))
+		return B_BAD_VALUE;
+
+	uint32 dataSize = size - sizeof(link_ring);
+	if ((dataSize & (dataSize - 1)) != 0)
+		return B_BAD_VALUE;
+
+	fRingSemaphore = create_sem(0, "link ring");
+	if (fRingSemaphore < 0)
+		return fRingSemaphore;
+
+	fRing = (link_ring*)ring;
+	fRingData = (uint8*)ring + sizeof(link_ring);
+	fRingSize = dataSize;
+	fRingTail = 0;
+
+	memset(fRing, 0, sizeof(link_ring));
+	return B_OK;
+}
+
+
 status_t
 LinkReceiver::GetNextMessage(int32 &code, bigtime_t timeout)
 {
@@ -126,8 +172,30 @@ LinkReceiver::GetNextMessage(int32 &code, bigtime_t timeout)
 bool
 LinkReceiver::HasMessages() const
 {
-	return fDataSize - (fRecvStart + fReplySize) > 0
-		|| port_count(fReceivePort) > 0;
+	if (fDataSize - (fRecvStart + fReplySize) > 0)
+		return true;
+	if (fRing == NULL)
+		return port_count(fReceivePort) > 0;
+	if (!RingIsEmpty())
+		return true;
+
+	// The sender may have woken us up for a batch we already took from the
+	// ring. Such wake-up calls are the only empty messages on our port, and
+	// they must not count, or our caller would wait for a message that isn't
+	// coming.
+	while (port_count(fReceivePort) > 0) {
+		if (port_buffer_size_etc(fReceivePort, B_RELATIVE_TIMEOUT, 0) != 0)
+			return true;
+
+		int32 code;
+		if (read_port_etc(fReceivePort, &code, NULL, 0, B_RELATIVE_TIMEOUT, 0)
+				< B_OK) {
+			break;
+		}
+	}
+
+	// a batch may have been written while we were looking at the port
+	return !RingIsEmpty();
 }
 
 
@@ -224,6 +292,16 @@ LinkReceiver::ReadFromPort(bigtime_t timeout)
 	// we are here so it means we finished reading the buffer contents
 	ResetBuffer();
 
+	if (fRing != NULL)
+		return ReadFromRing(timeout);
+
+	return ReadMessageFromPort(timeout);
+}
+
+
+status_t
+LinkReceiver::ReadMessageFromPort(bigtime_t timeout)
+{
 	status_t err = AdjustReplyBuffer(timeout);
 	if (err < B_OK)
 		return err;
@@ -251,11 +329,23 @@ LinkReceiver::ReadFromPort(bigtime_t timeout)
 
 		// we just ignore incorrect messages, and don't bother our caller
 
+		if (code == kLinkRingCode && fRing != NULL) {
+			// just a wake-up call, the data is in the ring
+			bytesRead = 0;
+			break;
+		}
+
 		if (code != kLinkCode) {
 			STRACE(("wrong port message %lx received.\n", code));
 			continue;
 		}
 
+		if (fRing != NULL) {
+			// the sender may wait for us to take this batch
+			atomic_add(&fRing->port_batches, 1);
+			WakeUpRingSender();
+		}
+
 		// port read seems to be valid
 		break;
 	}
@@ -265,6 +355,106 @@ LinkReceiver::ReadFromPort(bigtime_t timeout)
 }
 
 
+status_t
+LinkReceiver::ReadFromRing(bigtime_t timeout)
+{
+	while (true) {
+		status_t status = ReadRingBatch();
+		if (status != B_WOULD_BLOCK)
+			return status;
+
+		// The ring is empty, ask the sender to wake us up, and make sure it
+		// didn't just miss that.
+		atomic_set(&fRing->receiver_waiting, 1);
+		status = ReadRingBatch();
+		if (status != B_WOULD_BLOCK) {
+			atomic_set(&fRing->receiver_waiting, 0);
+			return status;
+		}
+
+		status = ReadMessageFromPort(timeout);
+		atomic_set(&fRing->receiver_waiting, 0);
+		if (status != B_OK || fDataSize > 0)
+			return status;
+	}
+}
+
+
+/*!	Copies the next batch of messages from the ring into our buffer, so that
+	the sender cannot change them while they are being read.
+	Returns \c B_WOULD_BLOCK if the ring is empty.
+*/
+status_t
+LinkReceiver::ReadRingBatch()
+{
+	uint32 head = (uint32)atomic_get(&fRing->head);
+
+	while (true) {
+		uint32 used = head - fRingTail;
+		if (used == 0)
+			return B_WOULD_BLOCK;
+		if (used > fRingSize)
+			return B_BAD_DATA;
+
+		uint32 position = fRingTail & (fRingSize - 1);
+		int32 size;
+		memcpy(&size, fRingData + position, sizeof(int32));
+
+		if (size == kLinkRingWrapMarker) {
+			if (fRingSize - position > used)
+				return B_BAD_DATA;
+
+			fRingTail += fRingSize - position;
+			continue;
+		}
+
+		uint32 length = sizeof(int32) + ((size + 3) & ~3);
+		if (size < (int32)sizeof(message_header)
+			|| (size_t)size > kMaxBufferSize || length > used
+			|| position + length > fRingSize) {
+			return B_BAD_DATA;
+		}
+
+		if (size > fRecvBufferSize) {
+			int32 bufferSize = size <= (int32)kInitialBufferSize
+				? (int32)kInitialBufferSize
+				: (size + B_PAGE_SIZE - 1) & ~(B_PAGE_SIZE - 1);
+			char* buffer = (char*)malloc(bufferSize);
+			if (buffer == NULL)
+				return B_NO_MEMORY;
+
+			free(fRecvBuffer);
+			fRecvBuffer = buffer;
+			fRecvBufferSize = bufferSize;
+		}
+
+		memcpy(fRecvBuffer, fRingData + position + sizeof(int32), size);
+		fDataSize = size;
+
+		fRingTail += length;
+		atomic_set(&fRing->tail, (int32)fRingTail);
+		WakeUpRingSender();
+		return B_OK;
+	}
+}
+
+
+bool
+LinkReceiver::RingIsEmpty() const
+{
+	return (uint32)atomic_get(&fRing->head) == fRingTail;
+}
+
+
+//!	Wakes up the sender, if it waits for room in the ring.
+void
+LinkReceiver::WakeUpRingSender()
+{
+	if (atomic_test_and_set(&fRing->sender_waiting, 0, 1) == 1)
+		release_sem_etc(fRingSemaphore, 1, B_DO_NOT_RESCHEDULE);
+}
+
+
 status_t
 LinkReceiver::Read(void *data, ssize_t passedSize)
 {
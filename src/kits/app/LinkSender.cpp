@@ -26,6 +26,7 @@
 
 #include <ServerProtocol.h>
 #include <LinkSender.h>
+#include <LinkRing.h>
 
 #include "link_message.h"
 #include "syscalls.h"
@@ -56,6 +57,11 @@ LinkSender::LinkSender(port_id port)
 	:
 	fPort(port),
 	fTargetTeam(-1),
+	fRing(NULL),
+	fRingData(NULL),
+	fRingSize(0),
+	fRingSemaphore(-1),
+	fRingPortBatches(0),
 	fBuffer(NULL),
 	fBufferSize(0),
 
@@ -79,6 +85,40 @@ LinkSender::SetPort(port_id port)
 }
 
 
+/*!	Makes the sender hand all further messages to the receiver through the
+	shared memory \a ring of \a size bytes, which has been set up by the
+	receiver along with \a semaphore. Passing \c NULL goes back to writing
+	them to the port.
+*/
+status_t
+LinkSender::SetRing(void* ring, size_t size, sem_id semaphore)
+{
+	if (ring == NULL) {
+		fRing = NULL;
+		fRingData = NULL;
+		fRingSize = 0;
+		return B_OK;
+	}
+
+	if (size <= sizeof(link_ring))
+		return B_BAD_VALUE;
+
+	uint32 dataSize = size - sizeof(link_ring);
+	if ((dataSize & (dataSize - 1)) != 0)
+		return B_BAD_VALUE;
+
+	if (semaphore < 0)
+		return B_BAD_VALUE;
+
+	fRing = (link_ring*)ring;
+	fRingData = (uint8*)ring + sizeof(link_ring);
+	fRingSize = dataSize;
+	fRingSemaphore = semaphore;
+	fRingPortBatches = 0;
+	return B_OK;
+}
+
+
 status_t
 LinkSender::StartMessage(int32 code, size_t minSize)
 {
@@ -430,6 +470,24 @@ LinkSender::Flush(bigtime_t timeout, bool needsReply)
 	if (fCurrentStart == 0)
 		return B_OK;
 
+	status_t err;
+	if (fRing != NULL)
+		err = FlushToRing(timeout);
+	else
+		err = FlushToPort(timeout);
+	if (err < B_OK)
+		return err;
+
+	fCurrentEnd = 0;
+	fCurrentStart = 0;
+
+	return B_OK;
+}
+
+
+status_t
+LinkSender::FlushToPort(bigtime_t timeout)
+{
 	STRACE(("info: LinkSender Flush() waiting to send messages of %ld bytes on port %ld.\n",
 		fCurrentEnd, fPort));
 
@@ -454,10 +512,119 @@ LinkSender::Flush(bigtime_t timeout, bool needsReply)
 	STRACE(("info: LinkSender Flush() messages total of %ld bytes on port %ld.\n",
 		fCurrentEnd, fPort));
 
-	fCurrentEnd = 0;
-	fCurrentStart = 0;
+	return B_OK;
+}
+
+
+/*!	Puts the buffered messages into the ring as one batch, and wakes up the
+	receiver if it is waiting for more.
+*/
+status_t
+LinkSender::FlushToRing(bigtime_t timeout)
+{
+	uint32 length = (fCurrentEnd + 3) & ~3;
+
+	if (sizeof(int32) + length > fRingSize / 2) {
+		// The batch might not fit into the ring at all, use the port. Since
+		// the receiver reads the port only once the ring is empty, it has to
+		// be empty now, and stay so until the receiver took the batch.
+		status_t status = WaitForRing(0, timeout);
+		if (status == B_OK)
+			status = FlushToPort(timeout);
+		if (status == B_OK)
+			fRingPortBatches++;
+
+		return status;
+	}
+
+	uint32 head = (uint32)fRing->head;
+	uint32 position = head & (fRingSize - 1);
+	uint32 skip = 0;
+	if (position + sizeof(int32) + length > fRingSize)
+		skip = fRingSize - position;
+
+	status_t status = WaitForRing(fRingSize - skip - sizeof(int32) - length,
+		timeout);
+	if (status != B_OK)
+		return status;
+
+	if (skip > 0) {
+		*(int32*)(fRingData + position) = kLinkRingWrapMarker;
+		position = 0;
+	}
+
+	*(int32*)(fRingData + position) = fCurrentEnd;
+	memcpy(fRingData + position + sizeof(int32), fBuffer, fCurrentEnd);
+
+	atomic_set(&fRing->head, head + skip + sizeof(int32) + length);
+
+	// The batch is out, so a failure to wake up the receiver is not ours to
+	// report: it either went away, or its port is full and it will look at
+	// the ring once it got to the other messages.
+	if (atomic_test_and_set(&fRing->receiver_waiting, 0, 1) == 1) {
+		if (timeout != B_INFINITE_TIMEOUT) {
+			do {
+				status = write_port_etc(fPort, kLinkRingCode, NULL, 0,
+					B_RELATIVE_TIMEOUT, timeout);
+			} while (status == B_INTERRUPTED);
+		} else {
+			do {
+				status = write_port(fPort, kLinkRingCode, NULL, 0);
+			} while (status == B_INTERRUPTED);
+		}
+	}
+
+	return B_OK;
+}
+
+
+/*!	Waits until no more than \a maxUsed bytes of the ring are in use, and
+	the receiver has read all batches written to the port.
+*/
+status_t
+LinkSender::WaitForRing(uint32 maxUsed, bigtime_t timeout)
+{
+	bigtime_t deadline = timeout != B_INFINITE_TIMEOUT
+		? system_time() + timeout : B_INFINITE_TIMEOUT;
+
+	while (!RingHasRoom(maxUsed)) {
+		// Ask the receiver to wake us up, and make sure it didn't just make
+		// room before it could see that.
+		atomic_set(&fRing->sender_waiting, 1);
+		if (RingHasRoom(maxUsed)) {
+			atomic_set(&fRing->sender_waiting, 0);
+			break;
+		}
+
+		// the semaphore is deleted when the receiver goes away
+		status_t status;
+		if (timeout != B_INFINITE_TIMEOUT) {
+			do {
+				status = acquire_sem_etc(fRingSemaphore, 1,
+					B_ABSOLUTE_TIMEOUT, deadline);
+			} while (status == B_INTERRUPTED);
+		} else {
+			do {
+				status = acquire_sem(fRingSemaphore);
+			} while (status == B_INTERRUPTED);
+		}
+
+		if (status != B_OK) {
+			atomic_set(&fRing->sender_waiting, 0);
+			return status;
+		}
+	}
 
 	return B_OK;
 }
 
+
+bool
+LinkSender::RingHasRoom(uint32 maxUsed) const
+{
+	return (uint32)fRing->head - (uint32)atomic_get(&fRing->tail) <= maxUsed
+		&& (int32)((uint32)atomic_get(&fRing->port_batches)
+			- fRingPortBatches) >= 0;
+}
+
 }	// namespace BPrivate
@@ -1655,6 +1655,35 @@ set_control_look(const BString& path)
 }
 
 
+/*!	\brief Queries the server whether it retains the contents of windows
+		that are covered, so that they don't have to be redrawn.
+*/
+status_t
+get_retain_window_contents(bool& retain)
+{
+	BPrivate::AppServerLink link;
+	link.StartMessage(AS_GET_RETAIN_WINDOW_CONTENTS);
+
+	int32 code;
+	if (link.FlushWithReply(code) != B_OK || code != B_OK)
+		return B_ERROR;
+
+	return link.Read<bool>(&retain);
+}
+
+
+//!	\brief Private function which sets whether window contents are retained.
+void
+set_retain_window_contents(bool retain)
+{
+	BPrivate::AppServerLink link;
+
+	link.StartMessage(AS_SET_RETAIN_WINDOW_CONTENTS);
+	link.Attach<bool>(retain);
+	link.Flush();
+}
+
+
 status_t
 get_application_order(int32 workspace, team_id** _applications,
 	int32* _count)
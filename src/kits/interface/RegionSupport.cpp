@@ -75,6 +75,7 @@ SOFTWARE.
 #include "RegionSupport.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <new>
 
 using std::nothrow;
@@ -101,6 +102,13 @@ using std::nothrow;
 	 (r1)->bottom > (r2)->top && \
 	 (r1)->top < (r2)->bottom)
 
+/*  1 if clipping_rect r1 covers all of r2. */
+#define SUBSUMES(r1, r2) \
+	((r1).left <= (r2).left && \
+	 (r1).top <= (r2).top && \
+	 (r1).right >= (r2).right && \
+	 (r1).bottom >= (r2).bottom)
+
 /*
  *  update region fBounds
  */
@@ -473,6 +481,31 @@ BRegion::Support::XIntersectRegion(
     if ( (!(reg1->fCount)) || (!(reg2->fCount))  ||
 	(!EXTENTCHECK(&reg1->fBounds, &reg2->fBounds)))
         newReg->fCount = 0;
+    else if (reg1->fCount == 1 && reg2->fCount == 1)
+    {
+	clipping_rect rect;
+	rect.left = max_c(reg1->fBounds.left, reg2->fBounds.left);
+	rect.top = max_c(reg1->fBounds.top, reg2->fBounds.top);
+	rect.right = min_c(reg1->fBounds.right, reg2->fBounds.right);
+	rect.bottom = min_c(reg1->fBounds.bottom, reg2->fBounds.bottom);
+	miSetRect(newReg, rect);
+	return 1;
+    }
+    /*
+     * a single rectangle that covers the other region leaves it as is
+     */
+    else if (reg1->fCount == 1 && SUBSUMES(reg1->fBounds, reg2->fBounds))
+    {
+	if (newReg != reg2)
+	    miRegionCopy(newReg, reg2);
+	return 1;
+    }
+    else if (reg2->fCount == 1 && SUBSUMES(reg2->fBounds, reg1->fBounds))
+    {
+	if (newReg != reg1)
+	    miRegionCopy(newReg, reg1);
+	return 1;
+    }
     else
 	miRegionOp (newReg, reg1, reg2,
     		miIntersectO, NULL, NULL);
@@ -629,6 +662,119 @@ TopRects(
 #endif // notdef
 #endif // 0
 
+/*======================================================================
+ *	    Fast paths
+ *====================================================================*/
+
+/*
+ * The window and view clipping in the app_server mostly combines regions
+ * made of few rectangles, or regions that don't share any band. Those
+ * cases are handled directly, without going through miRegionOp().
+ */
+
+/*	Sets the region to a single rectangle, which must not be empty. */
+void
+BRegion::Support::miSetRect(BRegion* pReg, const clipping_rect& rect)
+{
+	clipping_rect copy = rect;
+	if (!pReg->_SetSize(1))
+		return;
+
+	pReg->fData[0] = pReg->fBounds = copy;
+	pReg->fCount = 1;
+}
+
+
+/*	Sets regD to m without s, for two overlapping rectangles. The result
+ *	has at most one band above and below s, and one band with up to two
+ *	rectangles besides it, which never need to be coalesced.
+ */
+void
+BRegion::Support::miSubtractRect(BRegion* regD, const clipping_rect& m,
+	const clipping_rect& s)
+{
+	clipping_rect rects[4];
+	int count = 0;
+	int top = max_c(m.top, s.top);
+	int bottom = min_c(m.bottom, s.bottom);
+
+	if (s.top > m.top)
+		rects[count++] = (clipping_rect){ m.left, m.top, m.right, s.top };
+	if (s.left > m.left)
+		rects[count++] = (clipping_rect){ m.left, top, s.left, bottom };
+	if (s.right < m.right)
+		rects[count++] = (clipping_rect){ s.right, top, m.right, bottom };
+	if (s.bottom < m.bottom)
+		rects[count++] = (clipping_rect){ m.left, s.bottom, m.right, m.bottom };
+
+	if (count == 0) {
+		EMPTY_REGION(regD);
+		return;
+	}
+
+	if (!regD->_SetSize(count))
+		return;
+
+	memcpy(regD->fData, rects, count * sizeof(clipping_rect));
+	regD->fCount = count;
+	regD->fBounds = rects[0];
+	for (int i = 1; i < count; i++)
+		EXTENTS(&rects[i], regD);
+}
+
+
+/*	Sets newReg to the union of two regions that don't share a band, that
+ *	is upper ends above lower starts. The bands are simply concatenated;
+ *	only when the regions touch, their adjoining bands may need to be
+ *	coalesced. newReg must be neither of the source regions.
+ */
+void
+BRegion::Support::miUnionSeparated(BRegion* newReg, const BRegion* upper,
+	const BRegion* lower)
+{
+	const clipping_rect* upperRects = upper->fData;
+	const clipping_rect* lowerRects = lower->fData;
+	int upperCount = upper->fCount;
+	int lowerCount = lower->fCount;
+
+	int lastBand = upperCount - 1;
+	while (lastBand > 0
+		&& upperRects[lastBand - 1].top == upperRects[upperCount - 1].top)
+		lastBand--;
+
+	int bandSize = upperCount - lastBand;
+	bool coalesce = upper->fBounds.bottom == lower->fBounds.top
+		&& lowerCount >= bandSize
+		&& lowerRects[bandSize - 1].top == lowerRects[0].top
+		&& (lowerCount == bandSize
+			|| lowerRects[bandSize].top != lowerRects[0].top);
+	for (int i = 0; coalesce && i < bandSize; i++) {
+		coalesce = upperRects[lastBand + i].left == lowerRects[i].left
+			&& upperRects[lastBand + i].right == lowerRects[i].right;
+	}
+
+	int count = upperCount + lowerCount - (coalesce ? bandSize : 0);
+	if (!newReg->_SetSize(count))
+		return;
+
+	memcpy(newReg->fData, upperRects, upperCount * sizeof(clipping_rect));
+	if (coalesce) {
+		for (int i = lastBand; i < upperCount; i++)
+			newReg->fData[i].bottom = lowerRects[0].bottom;
+
+		lowerRects += bandSize;
+		lowerCount -= bandSize;
+	}
+	memcpy(newReg->fData + upperCount, lowerRects,
+		lowerCount * sizeof(clipping_rect));
+
+	newReg->fCount = count;
+	newReg->fBounds.left = min_c(upper->fBounds.left, lower->fBounds.left);
+	newReg->fBounds.top = upper->fBounds.top;
+	newReg->fBounds.right = max_c(upper->fBounds.right, lower->fBounds.right);
+	newReg->fBounds.bottom = lower->fBounds.bottom;
+}
+
 /*======================================================================
  *	    Generic BRegion* Operator
  *====================================================================*/
@@ -1267,6 +1413,39 @@ BRegion::Support::XUnionRegion(
         return 1;
     }
 
+    /*
+     * two rectangles side by side in the same band
+     */
+    if (reg1->fCount == 1 && reg2->fCount == 1
+	&& reg1->fBounds.top == reg2->fBounds.top
+	&& reg1->fBounds.bottom == reg2->fBounds.bottom
+	&& reg1->fBounds.right >= reg2->fBounds.left
+	&& reg2->fBounds.right >= reg1->fBounds.left)
+    {
+	clipping_rect rect = reg1->fBounds;
+	rect.left = min_c(reg1->fBounds.left, reg2->fBounds.left);
+	rect.right = max_c(reg1->fBounds.right, reg2->fBounds.right);
+	miSetRect(newReg, rect);
+	return 1;
+    }
+
+    /*
+     * one region lies completely above the other
+     */
+    if (newReg != reg1 && newReg != reg2)
+    {
+	if (reg1->fBounds.bottom <= reg2->fBounds.top)
+	{
+	    miUnionSeparated(newReg, reg1, reg2);
+	    return 1;
+	}
+	if (reg2->fBounds.bottom <= reg1->fBounds.top)
+	{
+	    miUnionSeparated(newReg, reg2, reg1);
+	    return 1;
+	}
+    }
+
     miRegionOp (newReg, reg1, reg2, miUnionO,
     		miUnionNonO, miUnionNonO);
 
@@ -1506,6 +1685,21 @@ BRegion::Support::XSubtractRegion(
         return 1;
     }
 
+    /*
+     * nothing is left when a single rectangle covers the whole region
+     */
+    if (regS->fCount == 1 && SUBSUMES(regS->fBounds, regM->fBounds))
+    {
+	EMPTY_REGION(regD);
+	return 1;
+    }
+
+    if (regM->fCount == 1 && regS->fCount == 1)
+    {
+	miSubtractRect(regD, regM->fBounds, regS->fBounds);
+	return 1;
+    }
+
     miRegionOp (regD, regM, regS, miSubtractO,
     		miSubtractNonO1, NULL);
 
@@ -1547,18 +1741,31 @@ BRegion::Support::XPointInRegion(
     const BRegion* pRegion,
     int x, int y)
 {
-	// TODO: binary search by "y"!
-    int i;
-
     if (pRegion->fCount == 0)
         return false;
     if (!INBOX(pRegion->fBounds, x, y))
         return false;
-    for (i=0; i<pRegion->fCount; i++)
-    {
-        if (INBOX (pRegion->fData[i], x, y))
-	    return true;
-    }
+
+	// The bottoms never decrease from band to band, so the band that
+	// contains y is found with a binary search.
+	const clipping_rect* rects = pRegion->fData;
+	int count = pRegion->fCount;
+	int lower = 0;
+	int upper = count;
+	while (lower < upper) {
+		int middle = (lower + upper) / 2;
+		if (rects[middle].bottom <= y)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	for (int i = lower; i < count && rects[i].top <= y; i++) {
+		if (x < rects[i].left)
+			break;
+		if (x < rects[i].right)
+			return true;
+	}
     return false;
 }
 
@@ -1579,6 +1786,9 @@ BRegion::Support::XRectInRegion(
     if ((region->fCount == 0) || !EXTENTCHECK(&region->fBounds, prect))
         return(RectangleOut);
 
+    if (region->fCount == 1)
+        return SUBSUMES(region->fBounds, rect) ? RectangleIn : RectanglePart;
+
     partOut = false;
     partIn = false;
 
@@ -43,6 +43,7 @@
 #include <Roster.h>
 #include <RosterPrivate.h>
 #include <Screen.h>
+#include <ServerMemoryAllocator.h>
 #include <ServerProtocol.h>
 #include <String.h>
 #include <TextView.h>
@@ -492,6 +493,11 @@ BWindow::~BWindow()
 	int32 code;
 	fLink->FlushWithReply(code);
 
+	if (fDrawingRingArea >= 0) {
+		BApplication::Private::ServerAllocator()->RemoveArea(
+			fDrawingRingArea);
+	}
+
 	// the sender port belongs to the app_server
 	delete_port(fLink->ReceiverPort());
 	delete fLink;
@@ -2872,6 +2878,7 @@ BWindow::_InitData(BRect frame, const char* title, window_look look,
 
 	// TODO: other initializations!
 	fOffscreen = false;
+	fDrawingRingArea = -1;
 
 	// Create the server-side window
 
@@ -2936,6 +2943,8 @@ BWindow::_InitData(BRect frame, const char* title, window_look look,
 
 			fMaxZoomWidth = fMaxWidth;
 			fMaxZoomHeight = fMaxHeight;
+
+			_InitDrawingRing();
 		} else
 			sendPort = -1;
 
@@ -2950,6 +2959,40 @@ BWindow::_InitData(BRect frame, const char* title, window_look look,
 }
 
 
+/*!	Reads the shared memory ring the server set up for our link from its
+	reply to the window creation, and lets the link use it for all further
+	messages.
+*/
+void
+BWindow::_InitDrawingRing()
+{
+	area_id serverArea;
+	uint32 offset;
+	uint32 size;
+	sem_id semaphore;
+	if (fLink->Read<area_id>(&serverArea) != B_OK || serverArea < 0
+		|| fLink->Read<uint32>(&offset) != B_OK
+		|| fLink->Read<uint32>(&size) != B_OK
+		|| fLink->Read<sem_id>(&semaphore) != B_OK) {
+		return;
+	}
+
+	area_id area;
+	uint8* base;
+	if (BApplication::Private::ServerAllocator()->AddArea(serverArea, area,
+			base, offset + size) != B_OK) {
+		return;
+	}
+
+	if (fLink->Sender().SetRing(base + offset, size, semaphore) != B_OK) {
+		BApplication::Private::ServerAllocator()->RemoveArea(serverArea);
+		return;
+	}
+
+	fDrawingRingArea = serverArea;
+}
+
+
 //! Rename the handler and its thread
 void
 BWindow::_SetName(const char* title)
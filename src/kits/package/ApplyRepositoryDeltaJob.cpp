@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "ApplyRepositoryDeltaJob.h"
+
+#include <package/ChecksumAccessors.h>
+#include <package/Context.h>
+#include <package/RepositoryCache.h>
+
+#include "FetchFileJob.h"
+
+
+namespace BPackageKit {
+
+namespace BPrivate {
+
+
+ApplyRepositoryDeltaJob::ApplyRepositoryDeltaJob(const BContext& context,
+	const BString& title, const BString& baseURL,
+	const BEntry& repoCacheEntry, const BEntry& checksumFileEntry,
+	const BEntry& targetEntry)
+	:
+	inherited(context, title),
+	fBaseURL(baseURL),
+	fRepoCacheEntry(repoCacheEntry),
+	fChecksumFileEntry(checksumFileEntry),
+	fTargetEntry(targetEntry),
+	fDeltaApplied(false)
+{
+}
+
+
+ApplyRepositoryDeltaJob::~ApplyRepositoryDeltaJob()
+{
+}
+
+
+status_t
+ApplyRepositoryDeltaJob::Execute()
+{
+	fDeltaApplied = _FetchAndApplyDelta() == B_OK;
+	if (!fDeltaApplied)
+		fTargetEntry.Remove();
+
+	return B_OK;
+}
+
+
+status_t
+ApplyRepositoryDeltaJob::_FetchAndApplyDelta()
+{
+	BRepositoryCache repoCache;
+	status_t result = repoCache.SetTo(fRepoCacheEntry);
+	if (result != B_OK)
+		return result;
+
+	// the deltas are named after the checksum of the file they apply to
+	BString checksum;
+	result = GeneralFileChecksumAccessor(fRepoCacheEntry).GetChecksum(
+		checksum);
+	if (result != B_OK)
+		return result;
+
+	BEntry deltaEntry;
+	result = fContext.GetNewTempfile("repodelta-", &deltaEntry);
+	if (result != B_OK)
+		return result;
+
+	BString deltaURL = BString(fBaseURL) << "/deltas/" << checksum;
+	FetchFileJob fetchDeltaJob(fContext, Title(), deltaURL, deltaEntry);
+		// Not having a delta is the normal case, and no failure to report,
+		// so the context's job state listener is not attached.
+	result = fetchDeltaJob.Run();
+	if (result == B_OK)
+		result = repoCache.ApplyDelta(deltaEntry, fTargetEntry);
+
+	deltaEntry.Remove();
+	if (result != B_OK)
+		return result;
+
+	// the result must be identical to the current repository file
+	BString expectedChecksum;
+	result = ChecksumFileChecksumAccessor(fChecksumFileEntry).GetChecksum(
+		expectedChecksum);
+	if (result == B_OK) {
+		result = GeneralFileChecksumAccessor(fTargetEntry).GetChecksum(
+			checksum);
+	}
+	if (result != B_OK)
+		return result;
+
+	return expectedChecksum.ICompare(checksum) == 0 ? B_OK : B_BAD_DATA;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BPackageKit
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__PRIVATE__APPLY_REPOSITORY_DELTA_JOB_H_
+#define _PACKAGE__PRIVATE__APPLY_REPOSITORY_DELTA_JOB_H_
+
+
+#include <Entry.h>
+#include <String.h>
+
+#include <package/Job.h>
+
+
+namespace BPackageKit {
+
+namespace BPrivate {
+
+
+/*!	Fetches the delta between the given cached repository file and the
+	current version of the repository and applies it, writing the new
+	repository file to the target entry, whose checksum is then validated
+	against the given checksum file.
+	Deltas are optional, so the job never fails; if anything goes wrong,
+	DeltaApplied() returns \c false, the target entry is left absent, and the
+	caller is expected to fetch the complete repository file instead.
+*/
+class ApplyRepositoryDeltaJob : public BJob {
+	typedef	BJob				inherited;
+
+public:
+								ApplyRepositoryDeltaJob(
+									const BContext& context,
+									const BString& title,
+									const BString& baseURL,
+									const BEntry& repoCacheEntry,
+									const BEntry& checksumFileEntry,
+									const BEntry& targetEntry);
+	virtual						~ApplyRepositoryDeltaJob();
+
+			bool				DeltaApplied() const
+									{ return fDeltaApplied; }
+			const BEntry&		TargetEntry() const
+									{ return fTargetEntry; }
+
+protected:
+	virtual	status_t			Execute();
+
+private:
+			status_t			_FetchAndApplyDelta();
+
+private:
+			BString				fBaseURL;
+			BEntry				fRepoCacheEntry;
+			BEntry				fChecksumFileEntry;
+			BEntry				fTargetEntry;
+			bool				fDeltaApplied;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BPackageKit
+
+
+#endif // _PACKAGE__PRIVATE__APPLY_REPOSITORY_DELTA_JOB_H_
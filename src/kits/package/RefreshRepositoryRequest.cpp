@@ -21,6 +21,7 @@
 #include <package/PackageRoster.h>
 
 #include "ActivateRepositoryCacheJob.h"
+#include "ApplyRepositoryDeltaJob.h"
 #include "FetchFileJob.h"
 #include "ValidateChecksumJob.h"
 
@@ -38,7 +39,8 @@ BRefreshRepositoryRequest::BRefreshRepositoryRequest(const BContext& context,
 	const BRepositoryConfig& repoConfig)
 	:
 	inherited(context),
-	fRepoConfig(repoConfig)
+	fRepoConfig(repoConfig),
+	fValidateChecksumJob(NULL)
 {
 }
 
@@ -112,14 +114,66 @@ BRefreshRepositoryRequest::JobSucceeded(BSupportKit::BJob* job)
 {
 	if (job == fValidateChecksumJob
 		&& !fValidateChecksumJob->ChecksumsMatch()) {
-		// the remote repo cache has a different checksum, we fetch it
+		// the remote repo cache has a different checksum, we update ours
+		// incrementally, if possible, or fetch it
 		fValidateChecksumJob = NULL;
 			// don't re-trigger fetching if anything goes wrong, fail instead
-		_FetchRepositoryCache();
+		if (_ApplyRepositoryDelta() != B_OK)
+			_FetchRepositoryCache();
+		return;
+	}
+
+	ApplyRepositoryDeltaJob* applyDeltaJob
+		= dynamic_cast<ApplyRepositoryDeltaJob*>(job);
+	if (applyDeltaJob != NULL) {
+		if (applyDeltaJob->DeltaApplied()) {
+			_ActivateRepositoryCache(applyDeltaJob->TargetEntry(), NULL);
+		} else {
+			// there was no usable delta or the result doesn't match
+			_FetchRepositoryCache();
+		}
 	}
 }
 
 
+/*!	Queues the job that builds the new repository cache from the current one
+	and a delta fetched from the repository. The delta is optional; if it
+	can't be fetched or applied, or the result doesn't match the repository's
+	checksum, JobSucceeded() falls back to fetching the complete repository
+	cache.
+*/
+status_t
+BRefreshRepositoryRequest::_ApplyRepositoryDelta()
+{
+	BRepositoryCache repoCache;
+	BPackageRoster roster;
+	status_t result = roster.GetRepositoryCache(fRepoConfig.Name(),
+		&repoCache);
+	if (result != B_OK)
+		return result;
+
+	BEntry tempRepoCache;
+	result = fContext.GetNewTempfile("repocache-", &tempRepoCache);
+	if (result != B_OK)
+		return result;
+
+	BString title = B_TRANSLATE("Fetching repository delta from %url");
+	title.ReplaceAll("%url", fRepoConfig.BaseURL());
+	ApplyRepositoryDeltaJob* applyDeltaJob
+		= new (std::nothrow) ApplyRepositoryDeltaJob(fContext, title,
+			fRepoConfig.BaseURL(), repoCache.Entry(), fFetchedChecksumFile,
+			tempRepoCache);
+	if (applyDeltaJob == NULL)
+		return B_NO_MEMORY;
+	if ((result = QueueJob(applyDeltaJob)) != B_OK) {
+		delete applyDeltaJob;
+		return result;
+	}
+
+	return B_OK;
+}
+
+
 status_t
 BRefreshRepositoryRequest::_FetchRepositoryCache()
 {
@@ -160,8 +214,17 @@ BRefreshRepositoryRequest::_FetchRepositoryCache()
 		return result;
 	}
 
+	return _ActivateRepositoryCache(tempRepoCache, validateChecksumJob);
+}
+
+
+status_t
+BRefreshRepositoryRequest::_ActivateRepositoryCache(
+	const BEntry& repoCacheEntry, BSupportKit::BJob* dependency)
+{
 	// job activating the cache
 	BPath targetRepoCachePath;
+	status_t result;
 	BPackageRoster roster;
 	result = fRepoConfig.IsUserSpecific()
 		? roster.GetUserRepositoryCachePath(&targetRepoCachePath, true)
@@ -172,10 +235,11 @@ BRefreshRepositoryRequest::_FetchRepositoryCache()
 	ActivateRepositoryCacheJob* activateJob
 		= new (std::nothrow) ActivateRepositoryCacheJob(fContext,
 			BString("Activating repository cache for ") << fRepoConfig.Name(),
-			tempRepoCache, fRepoConfig.Name(), targetDirectory);
+			repoCacheEntry, fRepoConfig.Name(), targetDirectory);
 	if (activateJob == NULL)
 		return B_NO_MEMORY;
-	activateJob->AddDependency(validateChecksumJob);
+	if (dependency != NULL)
+		activateJob->AddDependency(dependency);
 	if ((result = QueueJob(activateJob)) != B_OK) {
 		delete activateJob;
 		return result;
@@ -28,6 +28,7 @@
 #include <package/RepositoryInfo.h>
 
 #include <package/PackageInfoContentHandler.h>
+#include <package/RepositoryDelta.h>
 
 
 namespace BPackageKit {
@@ -172,6 +173,24 @@ BRepositoryCache::GetPackageInfos(GetPackageInfosCallback callback, void* contex
 }
 
 
+/*!	Writes the repository file that results from applying the repository
+	delta file \a deltaEntry to this cache's repository file to
+	\a targetEntry. The delta must have been computed against a repository
+	file with the same checksum as the cache's.
+*/
+status_t
+BRepositoryCache::ApplyDelta(const BEntry& deltaEntry,
+	const BEntry& targetEntry) const
+{
+	BPackageKit::BPrivate::RepositoryDelta delta;
+	status_t result = delta.SetTo(deltaEntry);
+	if (result != B_OK)
+		return result;
+
+	return delta.Apply(fEntry, targetEntry);
+}
+
+
 status_t
 BRepositoryCache::_ReadCache(const BPath& repositoryCachePath,
 	BRepositoryInfo& repositoryInfo, GetPackageInfosCallback callback, void* context) const
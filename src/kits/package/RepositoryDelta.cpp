@@ -0,0 +1,381 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/RepositoryDelta.h>
+
+#include <stdio.h>
+
+#include <map>
+#include <new>
+#include <set>
+
+#include <File.h>
+#include <Message.h>
+#include <Path.h>
+
+#include <package/ChecksumAccessors.h>
+#include <package/RepositoryCache.h>
+#include <package/hpkg/RepositoryWriter.h>
+
+
+namespace BPackageKit {
+
+namespace BPrivate {
+
+
+using BHPKG::BRepositoryWriter;
+using BHPKG::BRepositoryWriterListener;
+
+
+static const uint32 kRepositoryDeltaWhat = 'hpkd';
+
+static const char* const kBaseChecksumField = "base checksum";
+static const char* const kRepositoryInfoField = "repository info";
+static const char* const kRemovedPackageField = "removed package file";
+static const char* const kAddedPackageField = "added package";
+
+
+namespace {
+
+
+struct PackageInfoCollector {
+	BObjectList<BPackageInfo, true>&	packageInfos;
+	status_t							error;
+
+	PackageInfoCollector(BObjectList<BPackageInfo, true>& packageInfos)
+		:
+		packageInfos(packageInfos),
+		error(B_OK)
+	{
+	}
+};
+
+
+class ErrorRepositoryWriterListener : public BRepositoryWriterListener {
+public:
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		vfprintf(stderr, format, args);
+	}
+
+	virtual void OnPackageAdded(const BPackageInfo& packageInfo)
+	{
+	}
+
+	virtual void OnRepositoryInfoSectionDone(uint32 uncompressedSize)
+	{
+	}
+
+	virtual void OnPackageAttributesSectionDone(uint32 stringCount,
+		uint32 uncompressedSize)
+	{
+	}
+
+	virtual void OnRepositoryDone(uint32 headerSize, uint32 repositoryInfoSize,
+		uint32 licenseCount, uint32 packageCount, uint32 packageAttributesSize,
+		uint64 totalSize)
+	{
+	}
+};
+
+
+}	// anonymous namespace
+
+
+RepositoryDelta::RepositoryDelta()
+	:
+	fBaseChecksum(),
+	fRepositoryInfo(),
+	fAddedPackages(20),
+	fRemovedPackages()
+{
+}
+
+
+RepositoryDelta::~RepositoryDelta()
+{
+}
+
+
+/*!	Reads the delta from the given file.
+*/
+status_t
+RepositoryDelta::SetTo(const BEntry& deltaEntry)
+{
+	_Unset();
+
+	BFile file(&deltaEntry, B_READ_ONLY);
+	status_t result = file.InitCheck();
+	if (result != B_OK)
+		return result;
+
+	BMessage archive;
+	if ((result = archive.Unflatten(&file)) != B_OK)
+		return result;
+	if (archive.what != kRepositoryDeltaWhat)
+		return B_BAD_DATA;
+
+	BMessage repositoryInfoArchive;
+	if ((result = archive.FindString(kBaseChecksumField, &fBaseChecksum))
+			!= B_OK
+		|| (result = archive.FindMessage(kRepositoryInfoField,
+			&repositoryInfoArchive)) != B_OK
+		|| (result = fRepositoryInfo.SetTo(&repositoryInfoArchive)) != B_OK) {
+		return result;
+	}
+
+	BString packageName;
+	for (int32 i = 0; archive.FindString(kRemovedPackageField, i, &packageName)
+			== B_OK; i++) {
+		if (!fRemovedPackages.Add(packageName))
+			return B_NO_MEMORY;
+	}
+
+	BMessage packageInfoArchive;
+	for (int32 i = 0; archive.FindMessage(kAddedPackageField, i,
+			&packageInfoArchive) == B_OK; i++) {
+		BPackageInfo* packageInfo = new(std::nothrow) BPackageInfo(
+			&packageInfoArchive, &result);
+		if (packageInfo == NULL)
+			return B_NO_MEMORY;
+		if (result != B_OK || (result = packageInfo->InitCheck()) != B_OK
+			|| !fAddedPackages.AddItem(packageInfo)) {
+			delete packageInfo;
+			return result != B_OK ? result : B_NO_MEMORY;
+		}
+	}
+
+	return B_OK;
+}
+
+
+/*!	Computes the delta that turns the base repository file into the other
+	given repository file.
+	Packages are identified by name, version, and architecture, since a
+	repository may provide several versions of a package. A package counts as
+	unchanged, if its checksum is the same in both files as well; otherwise
+	it is removed and added again.
+*/
+status_t
+RepositoryDelta::SetTo(const BEntry& baseRepositoryEntry,
+	const BEntry& repositoryEntry)
+{
+	_Unset();
+
+	status_t result = GeneralFileChecksumAccessor(baseRepositoryEntry)
+		.GetChecksum(fBaseChecksum);
+	if (result != B_OK)
+		return result;
+
+	PackageInfoList basePackageInfos(100);
+	if ((result = _ReadPackageInfos(baseRepositoryEntry, NULL,
+			basePackageInfos)) != B_OK) {
+		return result;
+	}
+
+	PackageInfoList packageInfos(100);
+	if ((result = _ReadPackageInfos(repositoryEntry, &fRepositoryInfo,
+			packageInfos)) != B_OK) {
+		return result;
+	}
+
+	typedef std::map<BString, const BPackageInfo*> PackageInfoMap;
+	PackageInfoMap basePackages;
+	for (int32 i = 0; const BPackageInfo* info = basePackageInfos.ItemAt(i);
+			i++) {
+		basePackages[info->CanonicalFileName()] = info;
+	}
+
+	while (BPackageInfo* info = packageInfos.RemoveItemAt(0)) {
+		BString fileName = info->CanonicalFileName();
+		PackageInfoMap::iterator it = basePackages.find(fileName);
+		if (it != basePackages.end()) {
+			const BPackageInfo* baseInfo = it->second;
+			basePackages.erase(it);
+
+			if (info->Checksum() == baseInfo->Checksum()) {
+				delete info;
+				continue;
+			}
+
+			if (!fRemovedPackages.Add(fileName)) {
+				delete info;
+				return B_NO_MEMORY;
+			}
+		}
+
+		if (!fAddedPackages.AddItem(info)) {
+			delete info;
+			return B_NO_MEMORY;
+		}
+	}
+
+	for (PackageInfoMap::iterator it = basePackages.begin();
+			it != basePackages.end(); ++it) {
+		if (!fRemovedPackages.Add(it->first))
+			return B_NO_MEMORY;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+RepositoryDelta::WriteToFile(const BEntry& deltaEntry) const
+{
+	BMessage archive(kRepositoryDeltaWhat);
+	BMessage repositoryInfoArchive;
+	status_t result;
+	if ((result = archive.AddString(kBaseChecksumField, fBaseChecksum))
+			!= B_OK
+		|| (result = fRepositoryInfo.Archive(&repositoryInfoArchive)) != B_OK
+		|| (result = archive.AddMessage(kRepositoryInfoField,
+			&repositoryInfoArchive)) != B_OK) {
+		return result;
+	}
+
+	for (int32 i = 0; i < fRemovedPackages.CountStrings(); i++) {
+		result = archive.AddString(kRemovedPackageField,
+			fRemovedPackages.StringAt(i));
+		if (result != B_OK)
+			return result;
+	}
+
+	for (int32 i = 0; const BPackageInfo* info = fAddedPackages.ItemAt(i);
+			i++) {
+		BMessage packageInfoArchive;
+		if ((result = info->Archive(&packageInfoArchive)) != B_OK
+			|| (result = archive.AddMessage(kAddedPackageField,
+				&packageInfoArchive)) != B_OK) {
+			return result;
+		}
+	}
+
+	BFile file(&deltaEntry, B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	if ((result = file.InitCheck()) != B_OK)
+		return result;
+
+	return archive.Flatten(&file);
+}
+
+
+/*!	Writes the repository file resulting from applying the delta to the
+	given base repository file.
+	Since the repository writer output depends only on the repository info
+	and the set of packages, the result is identical to the repository file
+	the delta was computed from, as long as both were written by the same
+	writer version. Callers should nonetheless verify the result's checksum.
+	\return \c B_MISMATCHED_VALUES, if the delta doesn't belong to the base
+		repository file.
+*/
+status_t
+RepositoryDelta::Apply(const BEntry& baseRepositoryEntry,
+	const BEntry& repositoryEntry, BRepositoryWriterListener* listener) const
+{
+	BString baseChecksum;
+	status_t result = GeneralFileChecksumAccessor(baseRepositoryEntry)
+		.GetChecksum(baseChecksum);
+	if (result != B_OK)
+		return result;
+	if (baseChecksum != fBaseChecksum)
+		return B_MISMATCHED_VALUES;
+
+	PackageInfoList basePackageInfos(100);
+	if ((result = _ReadPackageInfos(baseRepositoryEntry, NULL,
+			basePackageInfos)) != B_OK) {
+		return result;
+	}
+
+	BPath repositoryPath;
+	if ((result = repositoryEntry.GetPath(&repositoryPath)) != B_OK)
+		return result;
+
+	std::set<BString> removedPackages;
+	for (int32 i = 0; i < fRemovedPackages.CountStrings(); i++)
+		removedPackages.insert(fRemovedPackages.StringAt(i));
+
+	ErrorRepositoryWriterListener errorListener;
+	if (listener == NULL)
+		listener = &errorListener;
+
+	BRepositoryInfo repositoryInfo(fRepositoryInfo);
+	BRepositoryWriter repositoryWriter(listener, &repositoryInfo);
+	if ((result = repositoryWriter.Init(repositoryPath.Path())) != B_OK)
+		return result;
+
+	for (int32 i = 0; const BPackageInfo* info = basePackageInfos.ItemAt(i);
+			i++) {
+		if (removedPackages.find(info->CanonicalFileName())
+				!= removedPackages.end()) {
+			continue;
+		}
+		if ((result = repositoryWriter.AddPackageInfo(*info)) != B_OK)
+			return result;
+	}
+
+	for (int32 i = 0; const BPackageInfo* info = fAddedPackages.ItemAt(i);
+			i++) {
+		if ((result = repositoryWriter.AddPackageInfo(*info)) != B_OK)
+			return result;
+	}
+
+	return repositoryWriter.Finish();
+}
+
+
+void
+RepositoryDelta::_Unset()
+{
+	fBaseChecksum.Truncate(0);
+	fRepositoryInfo = BRepositoryInfo();
+	fAddedPackages.MakeEmpty();
+	fRemovedPackages.MakeEmpty();
+}
+
+
+/*static*/ status_t
+RepositoryDelta::_ReadPackageInfos(const BEntry& entry,
+	BRepositoryInfo* _repositoryInfo, PackageInfoList& _packageInfos)
+{
+	BRepositoryCache repositoryCache;
+	status_t result = repositoryCache.SetTo(entry);
+	if (result != B_OK)
+		return result;
+
+	PackageInfoCollector collector(_packageInfos);
+	if ((result = repositoryCache.GetPackageInfos(&_AddPackageInfo,
+			&collector)) != B_OK) {
+		return result;
+	}
+	if (collector.error != B_OK)
+		return collector.error;
+
+	if (_repositoryInfo != NULL)
+		*_repositoryInfo = repositoryCache.Info();
+
+	return B_OK;
+}
+
+
+/*static*/ bool
+RepositoryDelta::_AddPackageInfo(void* context, const BPackageInfo& info)
+{
+	PackageInfoCollector* collector = (PackageInfoCollector*)context;
+
+	BPackageInfo* clonedInfo = new(std::nothrow) BPackageInfo(info);
+	if (clonedInfo == NULL || !collector->packageInfos.AddItem(clonedInfo)) {
+		delete clonedInfo;
+		collector->error = B_NO_MEMORY;
+		return false;
+	}
+
+	return true;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BPackageKit
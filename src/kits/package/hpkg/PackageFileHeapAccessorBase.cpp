@@ -56,12 +56,12 @@ PackageFileHeapAccessorBase::OffsetArray::~OffsetArray()
 
 bool
 PackageFileHeapAccessorBase::OffsetArray::InitUncompressedChunksOffsets(
-	size_t totalChunkCount)
+	size_t totalChunkCount, size_t chunkSize)
 {
 	if (totalChunkCount <= 1)
 		return true;
 
-	const size_t max32BitChunks = (uint64(1) << 32) / kChunkSize;
+	const size_t max32BitChunks = (uint64(1) << 32) / chunkSize;
 	size_t actual32BitChunks = totalChunkCount;
 	if (totalChunkCount - 1 > max32BitChunks) {
 		actual32BitChunks = max32BitChunks;
@@ -73,17 +73,17 @@ PackageFileHeapAccessorBase::OffsetArray::InitUncompressedChunksOffsets(
 		return false;
 
 	{
-		uint32 offset = kChunkSize;
-		for (size_t i = 1; i < actual32BitChunks; i++, offset += kChunkSize)
+		uint32 offset = chunkSize;
+		for (size_t i = 1; i < actual32BitChunks; i++, offset += chunkSize)
 			fOffsets[i] = offset;
 
 	}
 
 	if (actual32BitChunks < totalChunkCount) {
-		uint64 offset = actual32BitChunks * kChunkSize;
+		uint64 offset = actual32BitChunks * chunkSize;
 		uint32* offsets = fOffsets + actual32BitChunks;
 		for (size_t i = actual32BitChunks; i < totalChunkCount;
-				i++, offset += kChunkSize) {
+				i++, offset += chunkSize) {
 			*offsets++ = (uint32)offset;
 			*offsets++ = uint32(offset >> 32);
 		}
@@ -186,13 +186,14 @@ PackageFileHeapAccessorBase::OffsetArray::_AllocateOffsetArray(
 
 PackageFileHeapAccessorBase::PackageFileHeapAccessorBase(
 	BErrorOutput* errorOutput, BPositionIO* file, off_t heapOffset,
-	DecompressionAlgorithmOwner* decompressionAlgorithm)
+	DecompressionAlgorithmOwner* decompressionAlgorithm, size_t chunkSize)
 	:
 	fErrorOutput(errorOutput),
 	fFile(file),
 	fHeapOffset(heapOffset),
 	fCompressedHeapSize(0),
 	fUncompressedHeapSize(0),
+	fChunkSize(chunkSize),
 	fDecompressionAlgorithm(decompressionAlgorithm)
 {
 	if (fDecompressionAlgorithm != NULL)
@@ -207,6 +208,19 @@ PackageFileHeapAccessorBase::~PackageFileHeapAccessorBase()
 }
 
 
+/*!	Returns whether \a chunkSize is a power of two between kMinChunkSize and
+	kMaxChunkSize. Chunk sizes are stored in 16 bit in the chunk size table and
+	the kernel's chunk buffers are sized for kMaxChunkSize, so larger chunks
+	are not possible.
+*/
+/*static*/ bool
+PackageFileHeapAccessorBase::IsValidChunkSize(size_t chunkSize)
+{
+	return chunkSize >= kMinChunkSize && chunkSize <= kMaxChunkSize
+		&& (chunkSize & (chunkSize - 1)) == 0;
+}
+
+
 status_t
 PackageFileHeapAccessorBase::ReadDataToOutput(off_t offset, size_t size,
 	BDataIO* output)
@@ -255,14 +269,14 @@ PackageFileHeapAccessorBase::ReadDataToOutput(off_t offset, size_t size,
 	// segment data buffer
 	iovec localScratch;
 	compressedDataBuffer = (uint16*)(quadChunkBuffer + 0);
-	uncompressedDataBuffer = (uint16*)(quadChunkBuffer + kChunkSize);
-	localScratch.iov_base = (quadChunkBuffer + (kChunkSize * 2));
-	localScratch.iov_len = kChunkSize * 2;
+	uncompressedDataBuffer = (uint16*)(quadChunkBuffer + kMaxChunkSize);
+	localScratch.iov_base = (quadChunkBuffer + (kMaxChunkSize * 2));
+	localScratch.iov_len = kMaxChunkSize * 2;
 	scratch = &localScratch;
 #else
 	MemoryDeleter compressedMemoryDeleter, uncompressedMemoryDeleter;
-	compressedDataBuffer = (uint16*)malloc(kChunkSize);
-	uncompressedDataBuffer = (uint16*)malloc(kChunkSize);
+	compressedDataBuffer = (uint16*)malloc(fChunkSize);
+	uncompressedDataBuffer = (uint16*)malloc(fChunkSize);
 	compressedMemoryDeleter.SetTo(compressedDataBuffer);
 	uncompressedMemoryDeleter.SetTo(uncompressedDataBuffer);
 #endif
@@ -271,8 +285,8 @@ PackageFileHeapAccessorBase::ReadDataToOutput(off_t offset, size_t size,
 		return B_NO_MEMORY;
 
 	// read the data
-	size_t chunkIndex = size_t(offset / kChunkSize);
-	size_t inChunkOffset = (uint64)offset - (uint64)chunkIndex * kChunkSize;
+	size_t chunkIndex = size_t(offset / fChunkSize);
+	size_t inChunkOffset = (uint64)offset - (uint64)chunkIndex * fChunkSize;
 	size_t remainingBytes = size;
 
 	while (remainingBytes > 0) {
@@ -281,9 +295,9 @@ PackageFileHeapAccessorBase::ReadDataToOutput(off_t offset, size_t size,
 		if (error != B_OK)
 			return error;
 
-		size_t toWrite = std::min((size_t)kChunkSize - inChunkOffset,
+		size_t toWrite = std::min(fChunkSize - inChunkOffset,
 			remainingBytes);
-			// The last chunk may be shorter than kChunkSize, but since
+			// The last chunk may be shorter than fChunkSize, but since
 			// size (and thus remainingSize) had been clamped, that doesn't
 			// harm.
 		error = output->WriteExactly(
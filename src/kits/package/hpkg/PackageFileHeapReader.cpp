@@ -6,6 +6,11 @@
 
 #include <package/hpkg/PackageFileHeapReader.h>
 
+#include <string.h>
+#if !defined(_KERNEL_MODE)
+#	include <pthread.h>
+#endif
+
 #include <algorithm>
 #include <new>
 
@@ -23,14 +28,315 @@ namespace BHPKG {
 namespace BPrivate {
 
 
+#if !defined(_KERNEL_MODE)
+
+
+struct PackageFileHeapReader::ReadAheadJob {
+	size_t		chunkIndex;
+	void*		compressedData;
+	void*		uncompressedData;
+	size_t		compressedSize;
+	size_t		uncompressedSize;
+	status_t	error;
+	bool		decompress;
+	bool		done;
+};
+
+
+/*!	Decompresses the chunks following the one last read on a number of worker
+	threads, as long as the chunks are accessed sequentially. The compressed
+	data are read by the reading thread, only the decompression is done by the
+	workers. The jobs form a ring buffer in chunk order.
+
+	Reading the same chunk again is served from the copy of the chunk last
+	handed out, since requests that aren't chunk aligned access each chunk
+	twice.
+*/
+struct PackageFileHeapReader::ReadAheadPipeline {
+	ReadAheadPipeline(PackageFileHeapReader* reader)
+		:
+		fReader(reader),
+		fJobs(NULL),
+		fJobCount(0),
+		fFirstJob(0),
+		fQueuedJobs(0),
+		fStartedJobs(0),
+		fThreads(NULL),
+		fThreadCount(0),
+		fTerminating(false),
+		fCurrentChunkData(NULL),
+		fCurrentChunkSize(0),
+		fCurrentChunkIndex(0),
+		fNextChunkIndex(0)
+	{
+		pthread_mutex_init(&fReadLock, NULL);
+		pthread_mutex_init(&fLock, NULL);
+		pthread_cond_init(&fJobQueuedCondition, NULL);
+		pthread_cond_init(&fJobDoneCondition, NULL);
+	}
+
+	~ReadAheadPipeline()
+	{
+		pthread_mutex_lock(&fLock);
+		fTerminating = true;
+		pthread_cond_broadcast(&fJobQueuedCondition);
+		pthread_mutex_unlock(&fLock);
+
+		for (int32 i = 0; i < fThreadCount; i++)
+			pthread_join(fThreads[i], NULL);
+		delete[] fThreads;
+
+		for (int32 i = 0; i < fJobCount; i++) {
+			free(fJobs[i].compressedData);
+			free(fJobs[i].uncompressedData);
+		}
+		delete[] fJobs;
+		free(fCurrentChunkData);
+
+		pthread_cond_destroy(&fJobDoneCondition);
+		pthread_cond_destroy(&fJobQueuedCondition);
+		pthread_mutex_destroy(&fLock);
+		pthread_mutex_destroy(&fReadLock);
+	}
+
+	status_t Init(int32 threadCount)
+	{
+		// Use two jobs per thread, so that the threads can continue while the
+		// reading thread consumes the decompressed chunks.
+		fJobs = new(std::nothrow) ReadAheadJob[threadCount * 2];
+		fThreads = new(std::nothrow) pthread_t[threadCount];
+		fCurrentChunkData = malloc(fReader->fChunkSize);
+		if (fJobs == NULL || fThreads == NULL || fCurrentChunkData == NULL)
+			return B_NO_MEMORY;
+
+		for (; fJobCount < threadCount * 2; fJobCount++) {
+			ReadAheadJob& job = fJobs[fJobCount];
+			job.compressedData = malloc(fReader->fChunkSize);
+			job.uncompressedData = malloc(fReader->fChunkSize);
+			if (job.compressedData == NULL || job.uncompressedData == NULL) {
+				fJobCount++;
+				return B_NO_MEMORY;
+			}
+		}
+
+		for (; fThreadCount < threadCount; fThreadCount++) {
+			if (pthread_create(&fThreads[fThreadCount], NULL, &_WorkerEntry,
+					this) != 0) {
+				return B_NO_MORE_THREADS;
+			}
+		}
+
+		return B_OK;
+	}
+
+	/*!	Copies the data of the given chunk into \a buffer, if they are
+		available already. Queues the following chunks for decompression, if
+		the access is sequential.
+		\return \c true, if the chunk has been copied, \c false, if the caller
+			has to read the chunk itself.
+	*/
+	bool ReadChunk(size_t chunkIndex, void* buffer)
+	{
+		pthread_mutex_lock(&fReadLock);
+
+		if (fCurrentChunkSize > 0 && chunkIndex == fCurrentChunkIndex) {
+			memcpy(buffer, fCurrentChunkData, fCurrentChunkSize);
+			pthread_mutex_unlock(&fReadLock);
+			return true;
+		}
+
+		if (chunkIndex + 1 == fNextChunkIndex) {
+			// a repeated access to a chunk we didn't read ahead
+			pthread_mutex_unlock(&fReadLock);
+			return false;
+		}
+
+		bool sequential = chunkIndex == fNextChunkIndex;
+		fNextChunkIndex = chunkIndex + 1;
+		fCurrentChunkSize = 0;
+
+		bool found = false;
+		if (sequential && fQueuedJobs > 0
+			&& fJobs[fFirstJob].chunkIndex == chunkIndex) {
+			ReadAheadJob& job = _WaitForFirstJob();
+			if (job.error == B_OK) {
+				std::swap(fCurrentChunkData, job.uncompressedData);
+				fCurrentChunkSize = job.uncompressedSize;
+				fCurrentChunkIndex = chunkIndex;
+				memcpy(buffer, fCurrentChunkData, fCurrentChunkSize);
+				found = true;
+			}
+			_FirstJobDone();
+		} else
+			_DiscardJobs();
+
+		if (sequential)
+			_QueueJobs(chunkIndex + 1);
+
+		pthread_mutex_unlock(&fReadLock);
+		return found;
+	}
+
+private:
+	void _QueueJobs(size_t chunkIndex)
+	{
+		size_t chunkSize = fReader->fChunkSize;
+		size_t chunkCount = (fReader->fUncompressedHeapSize + chunkSize - 1)
+			/ chunkSize;
+		if (fQueuedJobs > 0) {
+			chunkIndex = fJobs[(fFirstJob + fQueuedJobs - 1) % fJobCount]
+				.chunkIndex + 1;
+		}
+
+		// The jobs between fStartedJobs and fJobCount are not accessed by
+		// the workers, so they can be prepared without holding the lock.
+		for (; fQueuedJobs < fJobCount && chunkIndex < chunkCount;
+				chunkIndex++) {
+			ReadAheadJob& job = fJobs[(fFirstJob + fQueuedJobs) % fJobCount];
+			uint64 offset;
+			fReader->_GetChunkLocation(chunkIndex, offset, job.compressedSize,
+				job.uncompressedSize);
+			job.chunkIndex = chunkIndex;
+			job.decompress = job.compressedSize != job.uncompressedSize;
+			job.error = B_OK;
+			job.done = !job.decompress;
+
+			// Read errors are reported when the chunk is read synchronously.
+			if (fReader->fFile->ReadAtExactly(fReader->fHeapOffset
+						+ (off_t)offset,
+					job.decompress ? job.compressedData : job.uncompressedData,
+					job.compressedSize) != B_OK) {
+				break;
+			}
+
+			pthread_mutex_lock(&fLock);
+			fQueuedJobs++;
+			if (job.decompress)
+				pthread_cond_signal(&fJobQueuedCondition);
+			pthread_mutex_unlock(&fLock);
+		}
+	}
+
+	ReadAheadJob& _WaitForFirstJob()
+	{
+		pthread_mutex_lock(&fLock);
+
+		ReadAheadJob& job = fJobs[fFirstJob];
+		while (!job.done)
+			pthread_cond_wait(&fJobDoneCondition, &fLock);
+
+		pthread_mutex_unlock(&fLock);
+		return job;
+	}
+
+	void _FirstJobDone()
+	{
+		pthread_mutex_lock(&fLock);
+
+		fFirstJob = (fFirstJob + 1) % fJobCount;
+		fQueuedJobs--;
+		if (fStartedJobs > 0)
+			fStartedJobs--;
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+	void _DiscardJobs()
+	{
+		pthread_mutex_lock(&fLock);
+
+		// wait for the jobs the workers are busy with
+		for (int32 i = 0; i < fStartedJobs; i++) {
+			ReadAheadJob& job = fJobs[(fFirstJob + i) % fJobCount];
+			while (!job.done)
+				pthread_cond_wait(&fJobDoneCondition, &fLock);
+		}
+
+		fFirstJob = 0;
+		fQueuedJobs = 0;
+		fStartedJobs = 0;
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+	static void* _WorkerEntry(void* data)
+	{
+		((ReadAheadPipeline*)data)->_Worker();
+		return NULL;
+	}
+
+	void _Worker()
+	{
+		DecompressionAlgorithmOwner* decompressionAlgorithm
+			= fReader->fDecompressionAlgorithm;
+
+		pthread_mutex_lock(&fLock);
+
+		while (true) {
+			while (!fTerminating && fStartedJobs == fQueuedJobs)
+				pthread_cond_wait(&fJobQueuedCondition, &fLock);
+			if (fTerminating)
+				break;
+
+			ReadAheadJob& job = fJobs[(fFirstJob + fStartedJobs) % fJobCount];
+			fStartedJobs++;
+			if (!job.decompress)
+				continue;
+
+			pthread_mutex_unlock(&fLock);
+
+			iovec compressed = { job.compressedData, job.compressedSize };
+			iovec uncompressed = { job.uncompressedData, job.uncompressedSize };
+			job.error = decompressionAlgorithm->algorithm->DecompressBuffer(
+				compressed, uncompressed, decompressionAlgorithm->parameters,
+				NULL);
+			if (job.error == B_OK
+				&& uncompressed.iov_len != job.uncompressedSize) {
+				job.error = B_BAD_DATA;
+			}
+
+			pthread_mutex_lock(&fLock);
+
+			job.done = true;
+			pthread_cond_broadcast(&fJobDoneCondition);
+		}
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+private:
+	PackageFileHeapReader*	fReader;
+	pthread_mutex_t			fReadLock;
+	pthread_mutex_t			fLock;
+	pthread_cond_t			fJobQueuedCondition;
+	pthread_cond_t			fJobDoneCondition;
+	ReadAheadJob*			fJobs;
+	int32					fJobCount;
+	int32					fFirstJob;
+	int32					fQueuedJobs;
+	int32					fStartedJobs;
+	pthread_t*				fThreads;
+	int32					fThreadCount;
+	bool					fTerminating;
+	void*					fCurrentChunkData;
+	size_t					fCurrentChunkSize;
+	size_t					fCurrentChunkIndex;
+	size_t					fNextChunkIndex;
+};
+
+
+#endif	// !_KERNEL_MODE
+
+
 PackageFileHeapReader::PackageFileHeapReader(BErrorOutput* errorOutput,
 	BPositionIO* file, off_t heapOffset, off_t compressedHeapSize,
 	uint64 uncompressedHeapSize,
-	DecompressionAlgorithmOwner* decompressionAlgorithm)
+	DecompressionAlgorithmOwner* decompressionAlgorithm, size_t chunkSize)
 	:
 	PackageFileHeapAccessorBase(errorOutput, file, heapOffset,
-		decompressionAlgorithm),
-	fOffsets()
+		decompressionAlgorithm, chunkSize),
+	fOffsets(),
+	fReadAheadPipeline(NULL)
 {
 	fCompressedHeapSize = compressedHeapSize;
 	fUncompressedHeapSize = uncompressedHeapSize;
@@ -39,6 +345,9 @@ PackageFileHeapReader::PackageFileHeapReader(BErrorOutput* errorOutput,
 
 PackageFileHeapReader::~PackageFileHeapReader()
 {
+#if !defined(_KERNEL_MODE)
+	delete fReadAheadPipeline;
+#endif
 }
 
 
@@ -57,7 +366,7 @@ PackageFileHeapReader::Init()
 	// Determine number of chunks and adjust the compressed heap size (subtract
 	// the size of the chunk size array at the end). Note that the size of the
 	// last chunk has not been saved, since its size is implied.
-	ssize_t chunkCount = (fUncompressedHeapSize + kChunkSize - 1) / kChunkSize;
+	ssize_t chunkCount = (fUncompressedHeapSize + fChunkSize - 1) / fChunkSize;
 	if (chunkCount == 0)
 		return B_OK;
 
@@ -72,7 +381,7 @@ PackageFileHeapReader::Init()
 			return B_BAD_DATA;
 		}
 
-		if (!fOffsets.InitUncompressedChunksOffsets(chunkCount))
+		if (!fOffsets.InitUncompressedChunksOffsets(chunkCount, fChunkSize))
 			return B_NO_MEMORY;
 
 		return B_OK;
@@ -90,7 +399,7 @@ PackageFileHeapReader::Init()
 	fCompressedHeapSize -= chunkSizeTableSize;
 
 	// allocate a buffer
-	uint16* buffer = (uint16*)malloc(kChunkSize);
+	uint16* buffer = (uint16*)malloc(fChunkSize);
 	if (buffer == NULL)
 		return B_NO_MEMORY;
 	MemoryDeleter bufferDeleter(buffer);
@@ -100,7 +409,7 @@ PackageFileHeapReader::Init()
 	size_t index = 0;
 	uint64 offset = fCompressedHeapSize;
 	while (remainingChunks > 0) {
-		size_t toRead = std::min(remainingChunks, kChunkSize / 2);
+		size_t toRead = std::min(remainingChunks, fChunkSize / 2);
 		status_t error = ReadFileData(offset, buffer, toRead * 2);
 		if (error != B_OK)
 			return error;
@@ -118,9 +427,9 @@ PackageFileHeapReader::Init()
 	// look at least plausible.
 	uint64 lastChunkOffset = fOffsets[chunkCount - 1];
 	if (lastChunkOffset >= fCompressedHeapSize
-			|| fCompressedHeapSize - lastChunkOffset > kChunkSize
+			|| fCompressedHeapSize - lastChunkOffset > fChunkSize
 			|| fCompressedHeapSize - lastChunkOffset
-				> fUncompressedHeapSize - (chunkCount - 1) * kChunkSize) {
+				> fUncompressedHeapSize - (chunkCount - 1) * fChunkSize) {
 		fErrorOutput->PrintError(
 			"Invalid total compressed heap size (%" B_PRIu64 ", uncompressed: "
 			"%" B_PRIu64 ", last chunk offset: %" B_PRIu64 ")\n",
@@ -137,11 +446,11 @@ PackageFileHeapReader::Clone() const
 {
 	PackageFileHeapReader* clone = new(std::nothrow) PackageFileHeapReader(
 		fErrorOutput, fFile, fHeapOffset, fCompressedHeapSize,
-		fUncompressedHeapSize, fDecompressionAlgorithm);
+		fUncompressedHeapSize, fDecompressionAlgorithm, fChunkSize);
 	if (clone == NULL)
 		return NULL;
 
-	ssize_t chunkCount = (fUncompressedHeapSize + kChunkSize - 1) / kChunkSize;
+	ssize_t chunkCount = (fUncompressedHeapSize + fChunkSize - 1) / fChunkSize;
 	if (!clone->fOffsets.Init(chunkCount, fOffsets)) {
 		delete clone;
 		return NULL;
@@ -151,23 +460,75 @@ PackageFileHeapReader::Clone() const
 }
 
 
+#if !defined(_KERNEL_MODE)
+
+
+/*!	Enables decompressing chunks ahead of sequential reads on \a threadCount
+	worker threads. Concurrent reads are serialized while read-ahead is
+	enabled. Uncompressed heaps don't need read-ahead and ignore the call.
+*/
+status_t
+PackageFileHeapReader::SetReadAhead(int32 threadCount)
+{
+	delete fReadAheadPipeline;
+	fReadAheadPipeline = NULL;
+
+	if (threadCount <= 0 || fDecompressionAlgorithm == NULL)
+		return B_OK;
+
+	fReadAheadPipeline = new(std::nothrow) ReadAheadPipeline(this);
+	if (fReadAheadPipeline == NULL)
+		return B_NO_MEMORY;
+
+	status_t error = fReadAheadPipeline->Init(threadCount);
+	if (error != B_OK) {
+		delete fReadAheadPipeline;
+		fReadAheadPipeline = NULL;
+	}
+
+	return error;
+}
+
+
+#endif	// !_KERNEL_MODE
+
+
 status_t
 PackageFileHeapReader::ReadAndDecompressChunk(size_t chunkIndex,
 	void* compressedDataBuffer, void* uncompressedDataBuffer,
 	iovec* scratchBuffer)
+{
+#if !defined(_KERNEL_MODE)
+	if (fReadAheadPipeline != NULL
+		&& fReadAheadPipeline->ReadChunk(chunkIndex, uncompressedDataBuffer)) {
+		return B_OK;
+	}
+#endif
+
+	uint64 offset;
+	size_t compressedSize;
+	size_t uncompressedSize;
+	_GetChunkLocation(chunkIndex, offset, compressedSize, uncompressedSize);
+
+	return ReadAndDecompressChunkData(offset, compressedSize, uncompressedSize,
+		compressedDataBuffer, uncompressedDataBuffer, scratchBuffer);
+}
+
+
+void
+PackageFileHeapReader::_GetChunkLocation(size_t chunkIndex, uint64& _offset,
+	size_t& _compressedSize, size_t& _uncompressedSize) const
 {
 	uint64 offset = fOffsets[chunkIndex];
 	bool isLastChunk
-		= ((uint64)chunkIndex + 1) * kChunkSize >= fUncompressedHeapSize;
-	size_t compressedSize = isLastChunk
+		= ((uint64)chunkIndex + 1) * fChunkSize >= fUncompressedHeapSize;
+	_offset = offset;
+	_compressedSize = isLastChunk
 		? fCompressedHeapSize - offset
 		: fOffsets[chunkIndex + 1] - offset;
-	size_t uncompressedSize = isLastChunk
-		? fUncompressedHeapSize - (uint64)chunkIndex * kChunkSize
-		: kChunkSize;
-
-	return ReadAndDecompressChunkData(offset, compressedSize, uncompressedSize,
-		compressedDataBuffer, uncompressedDataBuffer, scratchBuffer);
+	_uncompressedSize = isLastChunk
+		? fUncompressedHeapSize - (uint64)chunkIndex * fChunkSize
+		: fChunkSize;
 }
 
 
@@ -6,6 +6,8 @@
 
 #include <package/hpkg/PackageFileHeapWriter.h>
 
+#include <pthread.h>
+
 #include <algorithm>
 #include <new>
 
@@ -19,6 +21,7 @@
 #include <package/hpkg/PackageFileHeapReader.h>
 #include <RangeArray.h>
 #include <CompressionAlgorithm.h>
+#include <ZstdCompressionAlgorithm.h>
 
 
 // minimum length of data we require before trying to compress them
@@ -194,18 +197,215 @@ private:
 };
 
 
+struct PackageFileHeapWriter::CompressionJob {
+	void*		uncompressedData;
+	void*		compressedData;
+	size_t		uncompressedSize;
+	size_t		compressedSize;
+		// 0, if the data shall be written uncompressed
+	status_t	error;
+	bool		compress;
+	bool		done;
+};
+
+
+/*!	Compresses chunks on a number of worker threads. The jobs form a ring
+	buffer; they are queued and written back by the writer's thread in order,
+	so the resulting heap does not depend on the number of threads used.
+*/
+struct PackageFileHeapWriter::CompressionPipeline {
+	CompressionPipeline(PackageFileHeapWriter* writer)
+		:
+		fWriter(writer),
+		fJobs(NULL),
+		fJobCount(0),
+		fFirstJob(0),
+		fQueuedJobs(0),
+		fStartedJobs(0),
+		fThreads(NULL),
+		fThreadCount(0),
+		fTerminating(false)
+	{
+		pthread_mutex_init(&fLock, NULL);
+		pthread_cond_init(&fJobQueuedCondition, NULL);
+		pthread_cond_init(&fJobDoneCondition, NULL);
+	}
+
+	~CompressionPipeline()
+	{
+		pthread_mutex_lock(&fLock);
+		fTerminating = true;
+		pthread_cond_broadcast(&fJobQueuedCondition);
+		pthread_mutex_unlock(&fLock);
+
+		for (int32 i = 0; i < fThreadCount; i++)
+			pthread_join(fThreads[i], NULL);
+		delete[] fThreads;
+
+		for (int32 i = 0; i < fJobCount; i++) {
+			free(fJobs[i].uncompressedData);
+			free(fJobs[i].compressedData);
+		}
+		delete[] fJobs;
+
+		pthread_cond_destroy(&fJobDoneCondition);
+		pthread_cond_destroy(&fJobQueuedCondition);
+		pthread_mutex_destroy(&fLock);
+	}
+
+	status_t Init(int32 threadCount)
+	{
+		// Use two jobs per thread, so that the threads can continue while the
+		// finished chunks are written.
+		fJobs = new(std::nothrow) CompressionJob[threadCount * 2];
+		fThreads = new(std::nothrow) pthread_t[threadCount];
+		if (fJobs == NULL || fThreads == NULL)
+			return B_NO_MEMORY;
+
+		for (; fJobCount < threadCount * 2; fJobCount++) {
+			CompressionJob& job = fJobs[fJobCount];
+			job.uncompressedData = malloc(fWriter->fChunkSize);
+			job.compressedData = malloc(fWriter->fChunkSize);
+			if (job.uncompressedData == NULL || job.compressedData == NULL) {
+				fJobCount++;
+				return B_NO_MEMORY;
+			}
+		}
+
+		for (; fThreadCount < threadCount; fThreadCount++) {
+			if (pthread_create(&fThreads[fThreadCount], NULL, &_WorkerEntry,
+					this) != 0) {
+				return B_NO_MORE_THREADS;
+			}
+		}
+
+		return B_OK;
+	}
+
+	bool IsEmpty() const
+	{
+		return fQueuedJobs == 0;
+	}
+
+	bool IsFull() const
+	{
+		return fQueuedJobs == fJobCount;
+	}
+
+	/*!	Queues the given data for compression. The caller gets an unused
+		buffer of the same size in return.
+	*/
+	void QueueJob(void*& data, size_t size, bool compress)
+	{
+		pthread_mutex_lock(&fLock);
+
+		CompressionJob& job = fJobs[(fFirstJob + fQueuedJobs) % fJobCount];
+		std::swap(job.uncompressedData, data);
+		job.uncompressedSize = size;
+		job.compressedSize = 0;
+		job.error = B_OK;
+		job.compress = compress;
+		job.done = false;
+
+		fQueuedJobs++;
+		pthread_cond_signal(&fJobQueuedCondition);
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+	CompressionJob& WaitForFirstJob()
+	{
+		pthread_mutex_lock(&fLock);
+
+		CompressionJob& job = fJobs[fFirstJob];
+		while (!job.done)
+			pthread_cond_wait(&fJobDoneCondition, &fLock);
+
+		pthread_mutex_unlock(&fLock);
+		return job;
+	}
+
+	void FirstJobDone()
+	{
+		pthread_mutex_lock(&fLock);
+
+		fFirstJob = (fFirstJob + 1) % fJobCount;
+		fQueuedJobs--;
+		fStartedJobs--;
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+private:
+	static void* _WorkerEntry(void* data)
+	{
+		((CompressionPipeline*)data)->_Worker();
+		return NULL;
+	}
+
+	void _Worker()
+	{
+		pthread_mutex_lock(&fLock);
+
+		while (true) {
+			while (!fTerminating && fStartedJobs == fQueuedJobs)
+				pthread_cond_wait(&fJobQueuedCondition, &fLock);
+			if (fTerminating)
+				break;
+
+			CompressionJob& job = fJobs[(fFirstJob + fStartedJobs) % fJobCount];
+			fStartedJobs++;
+
+			pthread_mutex_unlock(&fLock);
+
+			if (job.compress) {
+				size_t compressedSize;
+				job.error = fWriter->_CompressData(job.uncompressedData,
+					job.uncompressedSize, job.compressedData, compressedSize);
+				if (job.error == B_OK)
+					job.compressedSize = compressedSize;
+				else if (job.error == B_BUFFER_OVERFLOW)
+					job.error = B_OK;
+			}
+
+			pthread_mutex_lock(&fLock);
+
+			job.done = true;
+			pthread_cond_broadcast(&fJobDoneCondition);
+		}
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+private:
+	PackageFileHeapWriter*	fWriter;
+	pthread_mutex_t			fLock;
+	pthread_cond_t			fJobQueuedCondition;
+	pthread_cond_t			fJobDoneCondition;
+	CompressionJob*			fJobs;
+	int32					fJobCount;
+	int32					fFirstJob;
+	int32					fQueuedJobs;
+	int32					fStartedJobs;
+	pthread_t*				fThreads;
+	int32					fThreadCount;
+	bool					fTerminating;
+};
+
+
 PackageFileHeapWriter::PackageFileHeapWriter(BErrorOutput* errorOutput,
 	BPositionIO* file, off_t heapOffset,
 	CompressionAlgorithmOwner* compressionAlgorithm,
-	DecompressionAlgorithmOwner* decompressionAlgorithm)
+	DecompressionAlgorithmOwner* decompressionAlgorithm, size_t chunkSize)
 	:
 	PackageFileHeapAccessorBase(errorOutput, file, heapOffset,
-		decompressionAlgorithm),
+		decompressionAlgorithm, chunkSize),
 	fPendingDataBuffer(NULL),
 	fCompressedDataBuffer(NULL),
 	fPendingDataSize(0),
 	fOffsets(),
-	fCompressionAlgorithm(compressionAlgorithm)
+	fCompressionAlgorithm(compressionAlgorithm),
+	fCompressionPipeline(NULL)
 {
 	if (fCompressionAlgorithm != NULL)
 		fCompressionAlgorithm->AcquireReference();
@@ -222,13 +422,24 @@ PackageFileHeapWriter::~PackageFileHeapWriter()
 
 
 void
-PackageFileHeapWriter::Init()
+PackageFileHeapWriter::Init(int32 compressionThreadCount)
 {
 	// allocate data buffers
-	fPendingDataBuffer = malloc(kChunkSize);
-	fCompressedDataBuffer = malloc(kChunkSize);
+	fPendingDataBuffer = malloc(fChunkSize);
+	fCompressedDataBuffer = malloc(fChunkSize);
 	if (fPendingDataBuffer == NULL || fCompressedDataBuffer == NULL)
 		throw std::bad_alloc();
+
+	// start the compression threads, if requested
+	if (fCompressionAlgorithm != NULL && compressionThreadCount > 1) {
+		fCompressionPipeline = new CompressionPipeline(this);
+		status_t error = fCompressionPipeline->Init(compressionThreadCount);
+		if (error != B_OK) {
+			// just compress the chunks ourselves
+			delete fCompressionPipeline;
+			fCompressionPipeline = NULL;
+		}
+	}
 }
 
 
@@ -240,8 +451,13 @@ PackageFileHeapWriter::Reinit(PackageFileHeapReader* heapReader)
 	fUncompressedHeapSize = heapReader->UncompressedHeapSize();
 	fPendingDataSize = 0;
 
+	if (heapReader->ChunkSize() != fChunkSize) {
+		fErrorOutput->PrintError("Heap chunk size mismatch\n");
+		throw status_t(B_BAD_VALUE);
+	}
+
 	// copy the offsets array
-	size_t chunkCount = (fUncompressedHeapSize + kChunkSize - 1) / kChunkSize;
+	size_t chunkCount = (fUncompressedHeapSize + fChunkSize - 1) / fChunkSize;
 	if (chunkCount > 0) {
 		if (!fOffsets.AddUninitialized(chunkCount))
 			throw std::bad_alloc();
@@ -254,6 +470,44 @@ PackageFileHeapWriter::Reinit(PackageFileHeapReader* heapReader)
 }
 
 
+/*!	Makes the writer compress the chunks using the given dictionary. Readers
+	need the same dictionary to decompress them. Only zstd compression supports
+	dictionaries.
+*/
+status_t
+PackageFileHeapWriter::SetCompressionDictionary(const void* dictionary,
+	size_t size)
+{
+	if (fUncompressedHeapSize != 0)
+		return B_BAD_VALUE;
+
+	BZstdCompressionParameters* compressionParameters
+		= fCompressionAlgorithm != NULL
+			? dynamic_cast<BZstdCompressionParameters*>(
+				fCompressionAlgorithm->parameters)
+			: NULL;
+	BZstdDecompressionParameters* decompressionParameters
+		= fDecompressionAlgorithm != NULL
+			? dynamic_cast<BZstdDecompressionParameters*>(
+				fDecompressionAlgorithm->parameters)
+			: NULL;
+	if (compressionParameters == NULL || decompressionParameters == NULL)
+		return B_NOT_SUPPORTED;
+
+	status_t error = compressionParameters->SetDictionary(dictionary, size);
+	if (error == B_OK)
+		error = decompressionParameters->SetDictionary(dictionary, size);
+	return error;
+}
+
+
+void
+PackageFileHeapWriter::SetHeapOffset(off_t heapOffset)
+{
+	fHeapOffset = heapOffset;
+}
+
+
 status_t
 PackageFileHeapWriter::AddData(BDataReader& dataReader, off_t size,
 	uint64& _offset)
@@ -266,7 +520,7 @@ PackageFileHeapWriter::AddData(BDataReader& dataReader, off_t size,
 	while (remainingSize > 0) {
 		// read data into pending data buffer
 		size_t toCopy = std::min(remainingSize,
-			off_t(kChunkSize - fPendingDataSize));
+			off_t(fChunkSize - fPendingDataSize));
 		status_t error = dataReader.ReadData(readOffset,
 			(uint8*)fPendingDataBuffer + fPendingDataSize, toCopy);
 		if (error != B_OK) {
@@ -280,7 +534,7 @@ PackageFileHeapWriter::AddData(BDataReader& dataReader, off_t size,
 		remainingSize -= toCopy;
 		readOffset += toCopy;
 
-		if (fPendingDataSize == kChunkSize) {
+		if (fPendingDataSize == fChunkSize) {
 			error = _FlushPendingData();
 			if (error != B_OK)
 				return error;
@@ -318,6 +572,8 @@ PackageFileHeapWriter::RemoveDataRanges(
 	// Before we begin flush any pending data, so we don't need any special
 	// handling and also can use the pending data buffer.
 	status_t status = _FlushPendingData();
+	if (status == B_OK)
+		status = _WriteQueuedChunks();
 	if (status != B_OK)
 		throw status_t(status);
 
@@ -337,8 +593,8 @@ PackageFileHeapWriter::RemoveDataRanges(
 	// Build a list of (possibly partial) chunks we want to keep.
 
 	// the first partial chunk (if any) and all chunks between ranges
-	ChunkBuffer chunkBuffer(this, kChunkSize);
-	uint64 writeOffset = ranges[0].offset - ranges[0].offset % kChunkSize;
+	ChunkBuffer chunkBuffer(this, fChunkSize);
+	uint64 writeOffset = ranges[0].offset - ranges[0].offset % fChunkSize;
 	uint64 readOffset = writeOffset;
 	for (ssize_t i = 0; i < rangeCount; i++) {
 		const Range<uint64>& range = ranges[i];
@@ -360,13 +616,13 @@ PackageFileHeapWriter::RemoveDataRanges(
 	// been removed and re-add all data we want to keep.
 
 	// truncate the offsets array and reset the heap sizes
-	ssize_t firstChunkIndex = ssize_t(writeOffset / kChunkSize);
+	ssize_t firstChunkIndex = ssize_t(writeOffset / fChunkSize);
 	fCompressedHeapSize = fOffsets[firstChunkIndex];
-	fUncompressedHeapSize = (uint64)firstChunkIndex * kChunkSize;
+	fUncompressedHeapSize = (uint64)firstChunkIndex * fChunkSize;
 	fOffsets.Remove(firstChunkIndex, fOffsets.Count() - firstChunkIndex);
 
 	// we need a decompression buffer
-	void* decompressionBuffer = malloc(kChunkSize);
+	void* decompressionBuffer = malloc(fChunkSize);
 	if (decompressionBuffer == NULL)
 		throw std::bad_alloc();
 	MemoryDeleter decompressionBufferDeleter(decompressionBuffer);
@@ -378,7 +634,7 @@ PackageFileHeapWriter::RemoveDataRanges(
 
 		// If we have an aligned, complete chunk, copy its compressed data.
 		bool copyCompressed = fPendingDataSize == 0 && segment.toKeepOffset == 0
-			&& segment.toKeepSize == kChunkSize;
+			&& segment.toKeepSize == fChunkSize;
 
 		// Read more chunks. We need at least one buffered one to do anything
 		// and we want to buffer as many as necessary to ensure we don't
@@ -387,7 +643,7 @@ PackageFileHeapWriter::RemoveDataRanges(
 			&& (!chunkBuffer.HasBufferedChunk()
 				|| (!copyCompressed
 					&& chunkBuffer.NextReadOffset()
-						< fCompressedHeapSize + kChunkSize))) {
+						< fCompressedHeapSize + fChunkSize))) {
 			// read chunk
 			chunkBuffer.ReadNextChunk();
 		}
@@ -419,9 +675,13 @@ PackageFileHeapWriter::RemoveDataRanges(
 			uncompressedData = decompressionBuffer;
 		}
 
-		// add chunk data
+		// add chunk data -- since the read ahead above depends on the heap
+		// size, the chunks cannot be left queued for compression
 		AddDataThrows((uint8*)uncompressedData + segment.toKeepOffset,
 			segment.toKeepSize);
+		status = _WriteQueuedChunks();
+		if (status != B_OK)
+			throw status_t(status);
 
 		chunkBuffer.CurrentSegmentDone();
 	}
@@ -440,6 +700,8 @@ PackageFileHeapWriter::Finish()
 {
 	// flush pending data, if any
 	status_t error = _FlushPendingData();
+	if (error == B_OK)
+		error = _WriteQueuedChunks();
 	if (error != B_OK)
 		return error;
 
@@ -460,7 +722,7 @@ PackageFileHeapWriter::Finish()
 	uint16* buffer = (uint16*)fPendingDataBuffer;
 	for (ssize_t offsetIndex = 1; offsetIndex < offsetCount;) {
 		ssize_t toWrite = std::min(offsetCount - offsetIndex,
-			ssize_t(kChunkSize / 2));
+			ssize_t(fChunkSize / 2));
 
 		for (ssize_t i = 0; i < toWrite; i++, offsetIndex++) {
 			// store chunkSize - 1, so it fits 16 bit (chunks cannot be empty)
@@ -482,7 +744,7 @@ PackageFileHeapWriter::ReadAndDecompressChunk(size_t chunkIndex,
 	void* compressedDataBuffer, void* uncompressedDataBuffer,
 	iovec* scratchBuffer)
 {
-	if (uint64(chunkIndex + 1) * kChunkSize > fUncompressedHeapSize) {
+	if (uint64(chunkIndex + 1) * fChunkSize > fUncompressedHeapSize) {
 		// The chunk has not been written to disk yet. Its data are still in the
 		// pending data buffer.
 		memcpy(uncompressedDataBuffer, fPendingDataBuffer, fPendingDataSize);
@@ -491,12 +753,19 @@ PackageFileHeapWriter::ReadAndDecompressChunk(size_t chunkIndex,
 		return B_OK;
 	}
 
+	if (chunkIndex >= (size_t)fOffsets.Count()) {
+		// The chunk is still queued for compression.
+		status_t error = _WriteQueuedChunks();
+		if (error != B_OK)
+			return error;
+	}
+
 	uint64 offset = fOffsets[chunkIndex];
 	size_t compressedSize = chunkIndex + 1 == (size_t)fOffsets.Count()
 		? fCompressedHeapSize - offset
 		: fOffsets[chunkIndex + 1] - offset;
 
-	return ReadAndDecompressChunkData(offset, compressedSize, kChunkSize,
+	return ReadAndDecompressChunkData(offset, compressedSize, fChunkSize,
 		compressedDataBuffer, uncompressedDataBuffer, scratchBuffer);
 }
 
@@ -504,6 +773,9 @@ PackageFileHeapWriter::ReadAndDecompressChunk(size_t chunkIndex,
 void
 PackageFileHeapWriter::_Uninit()
 {
+	delete fCompressionPipeline;
+	fCompressionPipeline = NULL;
+
 	free(fPendingDataBuffer);
 	free(fCompressedDataBuffer);
 	fPendingDataBuffer = NULL;
@@ -517,6 +789,19 @@ PackageFileHeapWriter::_FlushPendingData()
 	if (fPendingDataSize == 0)
 		return B_OK;
 
+	if (fCompressionPipeline != NULL) {
+		if (fCompressionPipeline->IsFull()) {
+			status_t error = _WriteFirstQueuedChunk();
+			if (error != B_OK)
+				return error;
+		}
+
+		fCompressionPipeline->QueueJob(fPendingDataBuffer, fPendingDataSize,
+			fPendingDataSize >= kCompressionSizeThreshold);
+		fPendingDataSize = 0;
+		return B_OK;
+	}
+
 	status_t error = _WriteChunk(fPendingDataBuffer, fPendingDataSize, true);
 	if (error == B_OK)
 		fPendingDataSize = 0;
@@ -525,10 +810,56 @@ PackageFileHeapWriter::_FlushPendingData()
 }
 
 
+status_t
+PackageFileHeapWriter::_WriteFirstQueuedChunk()
+{
+	CompressionJob& job = fCompressionPipeline->WaitForFirstJob();
+
+	status_t error = job.error;
+	if (error != B_OK) {
+		fErrorOutput->PrintError("Failed to compress chunk data: %s\n",
+			strerror(error));
+	} else if (!fOffsets.Add(fCompressedHeapSize)) {
+		fErrorOutput->PrintError("Out of memory!\n");
+		error = B_NO_MEMORY;
+	} else if (job.compressedSize != 0) {
+		error = _WriteDataUncompressed(job.compressedData,
+			job.compressedSize);
+	} else {
+		error = _WriteDataUncompressed(job.uncompressedData,
+			job.uncompressedSize);
+	}
+
+	fCompressionPipeline->FirstJobDone();
+	return error;
+}
+
+
+status_t
+PackageFileHeapWriter::_WriteQueuedChunks()
+{
+	if (fCompressionPipeline == NULL)
+		return B_OK;
+
+	while (!fCompressionPipeline->IsEmpty()) {
+		status_t error = _WriteFirstQueuedChunk();
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
 status_t
 PackageFileHeapWriter::_WriteChunk(const void* data, size_t size,
 	bool mayCompress)
 {
+	// keep the chunks in order
+	status_t error = _WriteQueuedChunks();
+	if (error != B_OK)
+		return error;
+
 	// add offset
 	if (!fOffsets.Add(fCompressedHeapSize)) {
 		fErrorOutput->PrintError("Out of memory!\n");
@@ -557,17 +888,41 @@ PackageFileHeapWriter::_WriteChunk(const void* data, size_t size,
 }
 
 
+/*!	Compresses the given data into \a compressedDataBuffer, which must be
+	at least \a size bytes large. Returns \c B_BUFFER_OVERFLOW, if compressing
+	doesn't save any space.
+	May be called from any thread.
+*/
 status_t
-PackageFileHeapWriter::_WriteDataCompressed(const void* data, size_t size)
+PackageFileHeapWriter::_CompressData(const void* data, size_t size,
+	void* compressedDataBuffer, size_t& _compressedSize) const
 {
 	if (fCompressionAlgorithm == NULL)
 		return B_BUFFER_OVERFLOW;
 
 	const iovec uncompressed = { (void*)data, size };
-	iovec compressed = { fCompressedDataBuffer, size };
+	iovec compressed = { compressedDataBuffer, size };
 	status_t error = fCompressionAlgorithm->algorithm->CompressBuffer(
 		uncompressed, compressed,
 		fCompressionAlgorithm->parameters);
+	if (error != B_OK)
+		return error;
+
+	// only use compressed data when we've actually saved space
+	if (compressed.iov_len == size)
+		return B_BUFFER_OVERFLOW;
+
+	_compressedSize = compressed.iov_len;
+	return B_OK;
+}
+
+
+status_t
+PackageFileHeapWriter::_WriteDataCompressed(const void* data, size_t size)
+{
+	size_t compressedSize;
+	status_t error = _CompressData(data, size, fCompressedDataBuffer,
+		compressedSize);
 	if (error != B_OK) {
 		if (error != B_BUFFER_OVERFLOW) {
 			fErrorOutput->PrintError("Failed to compress chunk data: %s\n",
@@ -576,11 +931,7 @@ PackageFileHeapWriter::_WriteDataCompressed(const void* data, size_t size)
 		return error;
 	}
 
-	// only use compressed data when we've actually saved space
-	if (compressed.iov_len == size)
-		return B_BUFFER_OVERFLOW;
-
-	return _WriteDataUncompressed(fCompressedDataBuffer, compressed.iov_len);
+	return _WriteDataUncompressed(fCompressedDataBuffer, compressedSize);
 }
 
 
@@ -609,16 +960,16 @@ PackageFileHeapWriter::_PushChunks(ChunkBuffer& chunkBuffer, uint64 startOffset,
 		throw status_t(B_BAD_VALUE);
 	}
 
-	ssize_t chunkIndex = startOffset / kChunkSize;
-	uint64 uncompressedChunkOffset = (uint64)chunkIndex * kChunkSize;
+	ssize_t chunkIndex = startOffset / fChunkSize;
+	uint64 uncompressedChunkOffset = (uint64)chunkIndex * fChunkSize;
 
 	while (startOffset < endOffset) {
 		bool isLastChunk = fUncompressedHeapSize - uncompressedChunkOffset
-			<= kChunkSize;
+			<= fChunkSize;
 		uint32 inChunkOffset = uint32(startOffset - uncompressedChunkOffset);
 		uint32 uncompressedChunkSize = isLastChunk
 			? fUncompressedHeapSize - uncompressedChunkOffset
-			: kChunkSize;
+			: fChunkSize;
 		uint64 compressedChunkOffset = fOffsets[chunkIndex];
 		uint32 compressedChunkSize = isLastChunk
 			? fCompressedHeapSize - compressedChunkOffset
@@ -644,7 +995,7 @@ void
 PackageFileHeapWriter::_UnwriteLastPartialChunk()
 {
 	// If the last chunk is partial, read it in and remove it from the offsets.
-	size_t lastChunkSize = fUncompressedHeapSize % kChunkSize;
+	size_t lastChunkSize = fUncompressedHeapSize % fChunkSize;
 	if (lastChunkSize != 0) {
 		uint64 lastChunkOffset = fOffsets[fOffsets.Count() - 1];
 		size_t compressedSize = fCompressedHeapSize - lastChunkOffset;
@@ -59,6 +59,36 @@ set_package_data_from_attribute_value(const BPackageAttributeValue& value,
 }
 
 
+// #pragma mark - DeferredEntryHandler
+
+
+DeferredEntryHandler::~DeferredEntryHandler()
+{
+}
+
+
+// #pragma mark - EntryHandlerContext
+
+
+struct PackageReaderImpl::EntryHandlerContext : AttributeHandlerContext {
+	EntryHandlerContext(BErrorOutput* errorOutput,
+		BPackageContentHandler* packageContentHandler,
+		DeferredEntryHandler* deferredHandler,
+		const PackageFileSection& tocSection, BHPKGPackageSectionID section,
+		bool ignoreUnknownAttributes)
+		:
+		AttributeHandlerContext(errorOutput, packageContentHandler, section,
+			ignoreUnknownAttributes),
+		deferredHandler(deferredHandler),
+		tocSection(tocSection)
+	{
+	}
+
+	DeferredEntryHandler*		deferredHandler;
+	const PackageFileSection&	tocSection;
+};
+
+
 // #pragma mark - AttributeAttributeHandler
 
 
@@ -109,8 +139,15 @@ struct PackageReaderImpl::EntryAttributeHandler : AttributeHandler {
 		BPackageEntry* parentEntry, const char* name)
 		:
 		fEntry(parentEntry, name),
-		fNotified(false)
+		fChildrenOffset(
+			static_cast<EntryHandlerContext*>(context)->tocSection
+				.currentOffset),
+		fNotified(false),
+		fDeferralChecked(false),
+		fChildrenDeferred(false)
 	{
+		// The handler is created right after the entry's attribute has been
+		// read, so the current TOC offset is where its children start.
 		_SetFileType(context, B_HPKG_DEFAULT_FILE_TYPE);
 	}
 
@@ -147,7 +184,7 @@ struct PackageReaderImpl::EntryAttributeHandler : AttributeHandler {
 					return error;
 
 //TRACE("%*sentry \"%s\"\n", fLevel * 2, "", value.string);
-				if (_handler != NULL) {
+				if (_handler != NULL && !_ChildrenDeferred(context)) {
 					return EntryAttributeHandler::Create(context, &fEntry,
 						value.string, *_handler);
 				}
@@ -246,6 +283,20 @@ private:
 		return context->packageContentHandler->HandleEntry(&fEntry);
 	}
 
+	bool _ChildrenDeferred(AttributeHandlerContext* context)
+	{
+		if (fDeferralChecked)
+			return fChildrenDeferred;
+
+		fDeferralChecked = true;
+		DeferredEntryHandler* deferredHandler
+			= static_cast<EntryHandlerContext*>(context)->deferredHandler;
+		if (deferredHandler != NULL)
+			fChildrenDeferred = deferredHandler->DeferEntryChildren(&fEntry,
+				fChildrenOffset);
+		return fChildrenDeferred;
+	}
+
 	status_t _SetFileType(AttributeHandlerContext* context, uint64 fileType)
 	{
 		switch (fileType) {
@@ -274,7 +325,40 @@ private:
 
 private:
 	BPackageEntry	fEntry;
+	uint64			fChildrenOffset;
 	bool			fNotified;
+	bool			fDeferralChecked;
+	bool			fChildrenDeferred;
+};
+
+
+// #pragma mark - EntryChildrenAttributeHandler
+
+
+/*!	Parses the attributes of an entry whose children have been deferred.
+	Only the child entries are passed on, the entry itself has already been
+	handled.
+*/
+struct PackageReaderImpl::EntryChildrenAttributeHandler : AttributeHandler {
+	EntryChildrenAttributeHandler(BPackageEntry* entry)
+		:
+		fEntry(entry)
+	{
+	}
+
+	virtual status_t HandleAttribute(AttributeHandlerContext* context,
+		uint8 id, const AttributeValue& value, AttributeHandler** _handler)
+	{
+		if (id == B_HPKG_ATTRIBUTE_ID_DIRECTORY_ENTRY && _handler != NULL) {
+			return EntryAttributeHandler::Create(context, fEntry,
+				value.string, *_handler);
+		}
+
+		return B_OK;
+	}
+
+private:
+	BPackageEntry*	fEntry;
 };
 
 
@@ -382,13 +466,21 @@ PackageReaderImpl::Init(BPositionIO* file, bool keepFile, uint32 flags,
 
 status_t
 PackageReaderImpl::ParseContent(BPackageContentHandler* contentHandler)
+{
+	return ParseContent(contentHandler, NULL);
+}
+
+
+status_t
+PackageReaderImpl::ParseContent(BPackageContentHandler* contentHandler,
+	DeferredEntryHandler* deferredHandler)
 {
 	status_t error = _PrepareSections();
 	if (error != B_OK)
 		return error;
 
-	AttributeHandlerContext context(ErrorOutput(), contentHandler,
-		B_HPKG_SECTION_PACKAGE_ATTRIBUTES,
+	EntryHandlerContext context(ErrorOutput(), contentHandler,
+		deferredHandler, fTOCSection, B_HPKG_SECTION_PACKAGE_ATTRIBUTES,
 		MinorFormatVersion() > B_HPKG_MINOR_VERSION);
 	RootAttributeHandler rootAttributeHandler;
 
@@ -426,6 +518,55 @@ PackageReaderImpl::ParseContent(BLowLevelPackageContentHandler* contentHandler)
 }
 
 
+/*!	Parses the children of a directory entry that have been skipped by a
+	previous ParseContent() call with a DeferredEntryHandler. \a entry is
+	passed as parent to the content handler; \a childrenOffset is the
+	offset the DeferredEntryHandler has been given for the entry.
+*/
+status_t
+PackageReaderImpl::ParseEntryChildren(BPackageContentHandler* contentHandler,
+	BPackageEntry* entry, uint64 childrenOffset)
+{
+	status_t error = PrepareSection(fTOCSection);
+	if (error != B_OK)
+		return error;
+
+	if (childrenOffset < fTOCSection.stringsLength
+		|| childrenOffset >= fTOCSection.uncompressedLength) {
+		ErrorOutput()->PrintError("Error: Invalid TOC offset for entry "
+			"children: %llu\n", childrenOffset);
+		return B_BAD_VALUE;
+	}
+
+	EntryHandlerContext context(ErrorOutput(), contentHandler, NULL,
+		fTOCSection, B_HPKG_SECTION_PACKAGE_TOC,
+		MinorFormatVersion() > B_HPKG_MINOR_VERSION);
+	EntryChildrenAttributeHandler rootAttributeHandler(entry);
+
+	fTOCSection.currentOffset = childrenOffset;
+	SetCurrentSection(&fTOCSection);
+
+	rootAttributeHandler.SetLevel(0);
+	ClearAttributeHandlerStack();
+	PushAttributeHandler(&rootAttributeHandler);
+
+	bool sectionHandled;
+	error = ParseAttributeTree(&context, sectionHandled);
+
+	// clean up on error
+	if (error != B_OK) {
+		context.ErrorOccurred();
+		while (AttributeHandler* handler = PopAttributeHandler()) {
+			if (handler != &rootAttributeHandler)
+				handler->Delete(&context);
+		}
+		return error;
+	}
+
+	return B_OK;
+}
+
+
 status_t
 PackageReaderImpl::_PrepareSections()
 {
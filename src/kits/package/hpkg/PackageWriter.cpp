@@ -6,9 +6,13 @@
 
 #include <package/hpkg/PackageWriter.h>
 
+#include <pthread.h>
+
+#include <map>
 #include <new>
 
 #include <package/hpkg/PackageWriterImpl.h>
+#include <PthreadMutexLocker.h>
 
 
 namespace BPackageKit {
@@ -16,6 +20,99 @@ namespace BPackageKit {
 namespace BHPKG {
 
 
+// #pragma mark - extended parameters
+
+
+/*!	Holds the parameters that have been added after BPackageWriterParameters
+	was first published. They are kept in a table outside of the objects, so
+	that the layout of the class does not change; objects without an entry
+	use the defaults.
+*/
+struct ExtendedParameters {
+	ExtendedParameters()
+		:
+		compressionThreadCount(1),
+		chunkSize(B_HPKG_DEFAULT_HEAP_CHUNK_SIZE),
+		compressionDictionarySize(0)
+	{
+	}
+
+	int32	compressionThreadCount;
+	uint32	chunkSize;
+	uint32	compressionDictionarySize;
+};
+
+typedef std::map<const BPackageWriterParameters*, ExtendedParameters>
+	ExtendedParametersMap;
+
+static pthread_mutex_t sExtendedParametersLock = PTHREAD_MUTEX_INITIALIZER;
+static ExtendedParametersMap sExtendedParameters;
+
+// set in fFlags when copying the extended parameters failed
+static const uint32 kExtendedParametersLost = 0x80000000;
+
+
+static ExtendedParameters
+get_extended_parameters(const BPackageWriterParameters* parameters)
+{
+	PthreadMutexLocker locker(&sExtendedParametersLock);
+
+	ExtendedParametersMap::const_iterator it
+		= sExtendedParameters.find(parameters);
+	return it != sExtendedParameters.end() ? it->second : ExtendedParameters();
+}
+
+
+static status_t
+set_extended_parameters(const BPackageWriterParameters* parameters,
+	const ExtendedParameters& extended)
+{
+	PthreadMutexLocker locker(&sExtendedParametersLock);
+
+	try {
+		sExtendedParameters[parameters] = extended;
+	} catch (std::bad_alloc&) {
+		return B_NO_MEMORY;
+	}
+
+	return B_OK;
+}
+
+
+static void
+remove_extended_parameters(const BPackageWriterParameters* parameters)
+{
+	PthreadMutexLocker locker(&sExtendedParametersLock);
+
+	sExtendedParameters.erase(parameters);
+}
+
+
+/*!	Gives  parameters the extended parameters of  other. Returns
+	\c false if that failed.
+*/
+static bool
+copy_extended_parameters(const BPackageWriterParameters* parameters,
+	const BPackageWriterParameters* other)
+{
+	PthreadMutexLocker locker(&sExtendedParametersLock);
+
+	ExtendedParametersMap::const_iterator it = sExtendedParameters.find(other);
+	if (it == sExtendedParameters.end()) {
+		sExtendedParameters.erase(parameters);
+		return true;
+	}
+
+	try {
+		sExtendedParameters[parameters] = it->second;
+	} catch (std::bad_alloc&) {
+		return false;
+	}
+
+	return true;
+}
+
+
 // #pragma mark - BPackageWriterParameters
 
 
@@ -28,22 +125,63 @@ BPackageWriterParameters::BPackageWriterParameters()
 }
 
 
+BPackageWriterParameters::BPackageWriterParameters(
+	const BPackageWriterParameters& other)
+	:
+	fFlags(other.fFlags),
+	fCompression(other.fCompression),
+	fCompressionLevel(other.fCompressionLevel)
+{
+	if (!copy_extended_parameters(this, &other))
+		fFlags |= kExtendedParametersLost;
+}
+
+
 BPackageWriterParameters::~BPackageWriterParameters()
 {
+	remove_extended_parameters(this);
+}
+
+
+BPackageWriterParameters&
+BPackageWriterParameters::operator=(const BPackageWriterParameters& other)
+{
+	if (this == &other)
+		return *this;
+
+	fFlags = other.fFlags;
+	fCompression = other.fCompression;
+	fCompressionLevel = other.fCompressionLevel;
+
+	if (!copy_extended_parameters(this, &other))
+		fFlags |= kExtendedParametersLost;
+
+	return *this;
+}
+
+
+/*!	Returns \c B_NO_MEMORY if the parameters are a copy that did not get all
+	values of the original, \c B_OK otherwise.
+*/
+status_t
+BPackageWriterParameters::InitCheck() const
+{
+	return (fFlags & kExtendedParametersLost) != 0 ? B_NO_MEMORY : B_OK;
 }
 
 
 uint32
 BPackageWriterParameters::Flags() const
 {
-	return fFlags;
+	return fFlags & ~kExtendedParametersLost;
 }
 
 
 void
 BPackageWriterParameters::SetFlags(uint32 flags)
 {
-	fFlags = flags;
+	fFlags = (flags & ~kExtendedParametersLost)
+		| (fFlags & kExtendedParametersLost);
 }
 
 
@@ -75,6 +213,54 @@ BPackageWriterParameters::SetCompressionLevel(int32 compressionLevel)
 }
 
 
+int32
+BPackageWriterParameters::CompressionThreadCount() const
+{
+	return get_extended_parameters(this).compressionThreadCount;
+}
+
+
+status_t
+BPackageWriterParameters::SetCompressionThreadCount(int32 threadCount)
+{
+	ExtendedParameters extended = get_extended_parameters(this);
+	extended.compressionThreadCount = threadCount;
+	return set_extended_parameters(this, extended);
+}
+
+
+uint32
+BPackageWriterParameters::ChunkSize() const
+{
+	return get_extended_parameters(this).chunkSize;
+}
+
+
+status_t
+BPackageWriterParameters::SetChunkSize(uint32 chunkSize)
+{
+	ExtendedParameters extended = get_extended_parameters(this);
+	extended.chunkSize = chunkSize;
+	return set_extended_parameters(this, extended);
+}
+
+
+uint32
+BPackageWriterParameters::CompressionDictionarySize() const
+{
+	return get_extended_parameters(this).compressionDictionarySize;
+}
+
+
+status_t
+BPackageWriterParameters::SetCompressionDictionarySize(uint32 size)
+{
+	ExtendedParameters extended = get_extended_parameters(this);
+	extended.compressionDictionarySize = size;
+	return set_extended_parameters(this, extended);
+}
+
+
 // #pragma mark - BPackageWriter
 
 
@@ -35,6 +35,7 @@
 #include <AutoDeleter.h>
 #include <AutoDeleterPosix.h>
 #include <RangeArray.h>
+#include <ZstdCompressionAlgorithm.h>
 
 #include <package/hpkg/HPKGDefsPrivate.h>
 
@@ -50,6 +51,10 @@ using BPrivate::FileDescriptorCloser;
 
 static const char* const kPublicDomainLicenseName = "Public Domain";
 
+// zstd wants about a hundred times the dictionary size of training data
+static const size_t kDictionarySamplesSizeFactor = 100;
+static const size_t kMaxDictionarySamplesSize = 8 * 1024 * 1024;
+
 
 #include <typeinfo>
 
@@ -423,6 +428,75 @@ private:
 };
 
 
+// #pragma mark - DictionarySamples
+
+
+/*!	Training data for the heap compression dictionary: the beginnings of the
+	package's files, stored one after the other.
+*/
+struct PackageWriterImpl::DictionarySamples {
+	DictionarySamples(size_t maxSize, size_t maxSampleSize)
+		:
+		fData(NULL),
+		fSize(0),
+		fMaxSize(maxSize),
+		fMaxSampleSize(maxSampleSize)
+	{
+		fData = (uint8*)malloc(maxSize);
+		if (fData == NULL)
+			throw std::bad_alloc();
+	}
+
+	~DictionarySamples()
+	{
+		free(fData);
+	}
+
+	bool IsFull() const
+	{
+		return fSize == fMaxSize;
+	}
+
+	void AddFile(int fd, off_t fileSize)
+	{
+		size_t toRead = (size_t)std::min(fileSize,
+			(off_t)std::min(fMaxSampleSize, fMaxSize - fSize));
+		if (toRead == 0)
+			return;
+
+		ssize_t bytesRead = pread(fd, fData + fSize, toRead, 0);
+		if (bytesRead <= 0)
+			return;
+
+		if (!fSampleSizes.Add(bytesRead))
+			throw std::bad_alloc();
+		fSize += bytesRead;
+	}
+
+	const void* Data() const
+	{
+		return fData;
+	}
+
+	const size_t* SampleSizes() const
+	{
+		return fSampleSizes.Elements();
+	}
+
+	uint32 CountSamples() const
+	{
+		return fSampleSizes.Count();
+	}
+
+private:
+	uint8*			fData;
+	size_t			fSize;
+	size_t			fMaxSize;
+	size_t			fMaxSampleSize;
+	Array<size_t>	fSampleSizes;
+};
+
+
 // #pragma mark - PackageWriterImpl (Inline Methods)
 
 
@@ -443,6 +517,8 @@ PackageWriterImpl::PackageWriterImpl(BPackageWriterListener* listener)
 	:
 	inherited("package", listener),
 	fListener(listener),
+	fHeapDictionary(NULL),
+	fHeapDictionarySize(0),
 	fHeapRangesToRemove(NULL),
 	fRootEntry(NULL),
 	fRootAttribute(NULL),
@@ -454,6 +530,7 @@ PackageWriterImpl::PackageWriterImpl(BPackageWriterListener* listener)
 
 PackageWriterImpl::~PackageWriterImpl()
 {
+	free(fHeapDictionary);
 	delete fHeapRangesToRemove;
 	delete fRootAttribute;
 	delete fRootEntry;
@@ -677,13 +754,32 @@ PackageWriterImpl::_Init(BPositionIO* file, bool keepFile, const char* fileName,
 			return result;
 
 		// While the compression level can change, we have to reuse the
-		// compression algorithm at least.
+		// compression algorithm, chunk size, and dictionary at least.
 		SetCompression(B_BENDIAN_TO_HOST_INT16(header.heap_compression));
+		SetChunkSize(B_BENDIAN_TO_HOST_INT32(header.heap_chunk_size));
 
 		result = InitHeapReader(fHeapOffset);
 		if (result != B_OK)
 			return result;
 
+		uint32 dictionarySize = heap_dictionary_size(header);
+		if (dictionarySize > 0) {
+			fHeapDictionary = malloc(dictionarySize);
+			if (fHeapDictionary == NULL)
+				throw std::bad_alloc();
+			fHeapDictionarySize = dictionarySize;
+
+			result = File()->ReadAtExactly(sizeof(hpkg_header),
+				fHeapDictionary, dictionarySize);
+			if (result == B_OK) {
+				result = fHeapWriter->SetCompressionDictionary(fHeapDictionary,
+					dictionarySize);
+			}
+			if (result != B_OK)
+				return result;
+		}
+		fHeaderSize = fHeapOffset;
+
 		fHeapWriter->Reinit(packageReader.RawHeapReader());
 
 		// Remove the old packages attributes and TOC section from the heap.
@@ -710,6 +806,13 @@ PackageWriterImpl::_Init(BPositionIO* file, bool keepFile, const char* fileName,
 status_t
 PackageWriterImpl::_Finish()
 {
+	// Train the heap compression dictionary, if requested. This must be done
+	// before any data are added to the heap.
+	if (Parameters().CompressionDictionarySize() > 0
+		&& (Flags() & B_HPKG_WRITER_UPDATE_PACKAGE) == 0) {
+		_InitHeapDictionary();
+	}
+
 	// write entries
 	for (EntryList::ConstIterator it = fRootEntry->ChildIterator();
 			Entry* entry = it.Next();) {
@@ -740,6 +843,7 @@ PackageWriterImpl::_Finish()
 	header.heap_size_compressed = B_HOST_TO_BENDIAN_INT64(compressedHeapSize);
 	header.heap_size_uncompressed = B_HOST_TO_BENDIAN_INT64(
 		fHeapWriter->UncompressedHeapSize());
+	header.heap_dictionary_size = B_HOST_TO_BENDIAN_INT32(fHeapDictionarySize);
 
 	// Truncate the file to the size it is supposed to have. In update mode, it
 	// can be greater when one or more files are shrunk. In creation mode it
@@ -760,12 +864,17 @@ PackageWriterImpl::_Finish()
 	// general
 	header.magic = B_HOST_TO_BENDIAN_INT32(B_HPKG_MAGIC);
 	header.header_size = B_HOST_TO_BENDIAN_INT16(fHeaderSize);
-	header.version = B_HOST_TO_BENDIAN_INT16(B_HPKG_VERSION);
+	header.version = B_HOST_TO_BENDIAN_INT16(
+		package_file_version(fHeapWriter->ChunkSize(), fHeapDictionarySize));
 	header.total_size = B_HOST_TO_BENDIAN_INT64(totalSize);
 	header.minor_version = B_HOST_TO_BENDIAN_INT16(B_HPKG_MINOR_VERSION);
 
-	// write the header
+	// write the header and the heap dictionary following it
 	RawWriteBuffer(&header, sizeof(hpkg_header), 0);
+	if (fHeapDictionarySize > 0) {
+		RawWriteBuffer(fHeapDictionary, fHeapDictionarySize,
+			sizeof(hpkg_header));
+	}
 
 	SetFinished(true);
 	return B_OK;
@@ -797,11 +906,17 @@ PackageWriterImpl::_Recompress(BPositionIO* inputFile)
 
 	off_t totalSize = fHeapWriter->HeapOffset() + (off_t)compressedHeapSize;
 
+	header.header_size = B_HOST_TO_BENDIAN_INT16(fHeaderSize);
+	header.version = B_HOST_TO_BENDIAN_INT16(
+		package_file_version(fHeapWriter->ChunkSize(), 0));
+	header.minor_version = B_HOST_TO_BENDIAN_INT16(B_HPKG_MINOR_VERSION);
 	header.heap_compression = B_HOST_TO_BENDIAN_INT16(
 		Parameters().Compression());
 	header.heap_chunk_size = B_HOST_TO_BENDIAN_INT32(fHeapWriter->ChunkSize());
 	header.heap_size_uncompressed
 		= B_HOST_TO_BENDIAN_INT64(uncompressedHeapSize);
+	header.heap_dictionary_size = 0;
+		// the input's dictionary is not carried over
 
 	if (Parameters().Compression() == B_HPKG_COMPRESSION_NONE) {
 		header.heap_size_compressed
@@ -1396,6 +1511,126 @@ PackageWriterImpl::_WritePackageAttributes(hpkg_header& header, uint64& _length)
 }
 
 
+/*!	Trains a dictionary on the beginnings of the files to be added and makes
+	the heap writer use it. Since the dictionary is stored between the header
+	and the heap, the heap moves accordingly. If there isn't enough data to
+	train a dictionary, the package is written without one.
+*/
+void
+PackageWriterImpl::_InitHeapDictionary()
+{
+	if (Parameters().Compression() != B_HPKG_COMPRESSION_ZSTD) {
+		fListener->PrintError("Compression dictionaries are only supported "
+			"with zstd compression\n");
+		throw status_t(B_BAD_VALUE);
+	}
+
+	size_t dictionarySize = std::min(Parameters().CompressionDictionarySize(),
+		(uint32)B_HPKG_MAX_HEAP_DICTIONARY_SIZE);
+
+	DictionarySamples samples(std::min(
+			dictionarySize * kDictionarySamplesSizeFactor,
+			kMaxDictionarySamplesSize),
+		fHeapWriter->ChunkSize());
+	for (EntryList::ConstIterator it = fRootEntry->ChildIterator();
+			Entry* entry = it.Next();) {
+		_CollectDictionarySamples(AT_FDCWD, entry, entry->Name(), samples);
+	}
+
+	void* dictionary = malloc(dictionarySize);
+	if (dictionary == NULL)
+		throw std::bad_alloc();
+	MemoryDeleter dictionaryDeleter(dictionary);
+
+	status_t error = BZstdCompressionAlgorithm::TrainDictionary(
+		samples.Data(), samples.SampleSizes(), samples.CountSamples(),
+		dictionary, dictionarySize);
+	if (error != B_OK)
+		return;
+
+	error = fHeapWriter->SetCompressionDictionary(dictionary, dictionarySize);
+	if (error != B_OK) {
+		fListener->PrintError("Failed to set heap compression dictionary: "
+			"%s\n", strerror(error));
+		throw status_t(error);
+	}
+
+	fHeapDictionary = dictionaryDeleter.Detach();
+	fHeapDictionarySize = dictionarySize;
+	fHeaderSize = fHeapOffset = sizeof(hpkg_header) + dictionarySize;
+	fHeapWriter->SetHeapOffset(fHeapOffset);
+}
+
+
+/*!	Adds samples for the dictionary training from the given entry and,
+	recursively, its children. Entries that can't be read are skipped; any
+	real problem will be reported when the entry is added.
+*/
+void
+PackageWriterImpl::_CollectDictionarySamples(int dirFD, Entry* entry,
+	const char* fileName, DictionarySamples& samples)
+{
+	if (samples.IsFull())
+		return;
+
+	bool isImplicitEntry = entry != NULL && entry->IsImplicit();
+
+	int fd;
+	FileDescriptorCloser fdCloser;
+	if (entry != NULL && entry->FD() >= 0) {
+		fd = entry->FD();
+	} else {
+		fd = openat(dirFD, fileName,
+			O_RDONLY | (isImplicitEntry ? 0 : O_NOTRAVERSE));
+		if (fd < 0)
+			return;
+		fdCloser.SetTo(fd);
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0)
+		return;
+
+	if (S_ISREG(st.st_mode)) {
+		samples.AddFile(fd, st.st_size);
+		return;
+	}
+
+	if (!S_ISDIR(st.st_mode))
+		return;
+
+	if (isImplicitEntry) {
+		for (EntryList::ConstIterator it = entry->ChildIterator();
+				Entry* child = it.Next();) {
+			_CollectDictionarySamples(fd, child, child->Name(), samples);
+		}
+		return;
+	}
+
+	int clonedFD = dup(fd);
+	if (clonedFD < 0)
+		return;
+
+	DirCloser dir(fdopendir(clonedFD));
+	if (!dir.IsSet()) {
+		close(clonedFD);
+		return;
+	}
+
+	while (dirent* dirEntry = readdir(dir.Get())) {
+		if (strcmp(dirEntry->d_name, ".") == 0
+			|| strcmp(dirEntry->d_name, "..") == 0) {
+			continue;
+		}
+
+		_CollectDictionarySamples(fd, NULL, dirEntry->d_name, samples);
+	}
+
+	// the directory offset is shared with fd, which may be the entry's
+	rewinddir(dir.Get());
+}
+
+
 void
 PackageWriterImpl::_AddEntry(int dirFD, Entry* entry, const char* fileName,
 	char* pathBuffer)
@@ -20,6 +20,7 @@
 #include <DataIO.h>
 #include <OS.h>
 
+#include <AutoDeleter.h>
 #include <ZlibCompressionAlgorithm.h>
 #include <ZstdCompressionAlgorithm.h>
 
@@ -846,8 +847,21 @@ ReaderImplBase::DetachHeapReader(PackageFileHeapReader*& _rawHeapReader)
 
 status_t
 ReaderImplBase::InitHeapReader(uint32 compression, uint32 chunkSize,
-	off_t offset, uint64 compressedSize, uint64 uncompressedSize)
+	off_t offset, uint64 compressedSize, uint64 uncompressedSize,
+	off_t dictionaryOffset, uint32 dictionarySize)
 {
+	if (!PackageFileHeapReader::IsValidChunkSize(chunkSize)) {
+		fErrorOutput->PrintError("Error: Invalid heap chunk size (%" B_PRIu32
+			")\n", chunkSize);
+		return B_BAD_DATA;
+	}
+
+	if (dictionarySize != 0 && compression != B_HPKG_COMPRESSION_ZSTD) {
+		fErrorOutput->PrintError("Error: Heap dictionary given for a "
+			"compression that doesn't support it\n");
+		return B_BAD_DATA;
+	}
+
 	DecompressionAlgorithmOwner* decompressionAlgorithm = NULL;
 	BReference<DecompressionAlgorithmOwner> decompressionAlgorithmReference;
 
@@ -866,16 +880,38 @@ ReaderImplBase::InitHeapReader(uint32 compression, uint32 chunkSize,
 			}
 			break;
 		case B_HPKG_COMPRESSION_ZSTD:
+		{
+			BZstdDecompressionParameters* parameters
+				= new(std::nothrow) BZstdDecompressionParameters;
 			decompressionAlgorithm = DecompressionAlgorithmOwner::Create(
-				new(std::nothrow) BZstdCompressionAlgorithm,
-				new(std::nothrow) BZstdDecompressionParameters);
+				new(std::nothrow) BZstdCompressionAlgorithm, parameters);
 			decompressionAlgorithmReference.SetTo(decompressionAlgorithm, true);
 			if (decompressionAlgorithm == NULL
 				|| decompressionAlgorithm->algorithm == NULL
 				|| decompressionAlgorithm->parameters == NULL) {
 				return B_NO_MEMORY;
 			}
+
+			if (dictionarySize > 0) {
+				void* dictionary = malloc(dictionarySize);
+				if (dictionary == NULL)
+					return B_NO_MEMORY;
+				MemoryDeleter dictionaryDeleter(dictionary);
+
+				status_t error = ReadBuffer(dictionaryOffset, dictionary,
+					dictionarySize);
+				if (error != B_OK)
+					return error;
+
+				error = parameters->SetDictionary(dictionary, dictionarySize);
+				if (error != B_OK) {
+					fErrorOutput->PrintError("Error: Failed to set up heap "
+						"dictionary: %s\n", strerror(error));
+					return error;
+				}
+			}
 			break;
+		}
 		default:
 			fErrorOutput->PrintError("Error: Invalid heap compression\n");
 			return B_BAD_DATA;
@@ -883,7 +919,7 @@ ReaderImplBase::InitHeapReader(uint32 compression, uint32 chunkSize,
 
 	fRawHeapReader = new(std::nothrow) PackageFileHeapReader(fErrorOutput,
 		fFile, offset, compressedSize, uncompressedSize,
-		decompressionAlgorithm);
+		decompressionAlgorithm, chunkSize);
 	if (fRawHeapReader == NULL)
 		return B_NO_MEMORY;
 
@@ -478,6 +478,8 @@ RepositoryWriterImpl::_WritePackageAttributes(hpkg_repo_header& header,
 	// write the package attributes (zlib writer on top of a file writer)
 	uint64 startOffset = fHeapWriter->UncompressedHeapSize();
 
+	_SortPackageAttributes();
+
 	uint32 stringsLength;
 	uint32 stringsCount = WritePackageAttributes(PackageAttributes(),
 		stringsLength);
@@ -495,6 +497,45 @@ RepositoryWriterImpl::_WritePackageAttributes(hpkg_repo_header& header,
 }
 
 
+/*!	Orders the packages by name. Together with the ordering of the string
+	table this makes the written file depend only on the set of packages and
+	not on the order they have been added in, so that a client applying a
+	repository delta can reproduce the file exactly.
+	Package names are unique within a repository (see
+	_RegisterCurrentPackageInfo()), so the name is a full key. The sort is
+	stable anyway, so that the result never depends on the implementation
+	of the sort algorithm.
+*/
+void
+RepositoryWriterImpl::_SortPackageAttributes()
+{
+	PackageAttributeList& packageAttributes = PackageAttributes();
+	int32 count = packageAttributes.Count();
+	if (count < 2)
+		return;
+
+	PackageAttribute** attributes = new PackageAttribute*[count];
+	ArrayDeleter<PackageAttribute*> attributesDeleter(attributes);
+
+	for (int32 i = 0; i < count; i++)
+		attributes[i] = packageAttributes.RemoveHead();
+
+	std::stable_sort(attributes, attributes + count,
+		&_PackageAttributeNameLess);
+
+	for (int32 i = 0; i < count; i++)
+		packageAttributes.Add(attributes[i]);
+}
+
+
+/*static*/ bool
+RepositoryWriterImpl::_PackageAttributeNameLess(const PackageAttribute* a,
+	const PackageAttribute* b)
+{
+	return strcmp(a->string->string, b->string->string) < 0;
+}
+
+
 }	// namespace BPrivate
 
 }	// namespace BHPKG
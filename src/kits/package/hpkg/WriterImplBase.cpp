@@ -258,6 +258,8 @@ WriterImplBase::Init(BPositionIO* file, bool keepFile, const char* fileName,
 	const BPackageWriterParameters& parameters)
 {
 	fParameters = parameters;
+	if (parameters.InitCheck() != B_OK || fParameters.InitCheck() != B_OK)
+		throw std::bad_alloc();
 
 	if (fPackageStringCache.Init() != B_OK)
 		throw std::bad_alloc();
@@ -355,10 +357,16 @@ WriterImplBase::InitHeapReader(size_t headerSize)
 			return B_BAD_VALUE;
 	}
 
+	if (!PackageFileHeapWriter::IsValidChunkSize(fParameters.ChunkSize())) {
+		fErrorOutput->PrintError("Error: Invalid heap chunk size %" B_PRIu32
+			"\n", fParameters.ChunkSize());
+		return B_BAD_VALUE;
+	}
+
 	// create heap writer
 	fHeapWriter = new PackageFileHeapWriter(fErrorOutput, fFile, headerSize,
-		compressionAlgorithm, decompressionAlgorithm);
-	fHeapWriter->Init();
+		compressionAlgorithm, decompressionAlgorithm, fParameters.ChunkSize());
+	fHeapWriter->Init(fParameters.CompressionThreadCount());
 
 	return B_OK;
 }
@@ -371,6 +379,14 @@ WriterImplBase::SetCompression(uint32 compression)
 }
 
 
+void
+WriterImplBase::SetChunkSize(uint32 chunkSize)
+{
+	if (fParameters.SetChunkSize(chunkSize) != B_OK)
+		throw std::bad_alloc();
+}
+
+
 void
 WriterImplBase::RegisterPackageInfo(PackageAttributeList& attributeList,
 	const BPackageInfo& packageInfo)
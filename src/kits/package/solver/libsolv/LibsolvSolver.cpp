@@ -10,18 +10,30 @@
 #include "LibsolvSolver.h"
 
 #include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 
 #include <new>
+#include <vector>
 
 #include <solv/policy.h>
 #include <solv/poolarch.h>
 #include <solv/repo.h>
 #include <solv/repo_haiku.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
 #include <solv/selection.h>
 #include <solv/solverdebug.h>
 
+#include <Entry.h>
+#include <Path.h>
+
+#include <package/ChecksumAccessors.h>
 #include <package/PackageResolvableExpression.h>
+#include <package/PackageRoster.h>
 #include <package/RepositoryCache.h>
 #include <package/solver/SolverPackage.h>
 #include <package/solver/SolverPackageSpecifier.h>
@@ -31,6 +43,7 @@
 #include <package/solver/SolverResult.h>
 
 #include <AutoDeleter.h>
+#include <AutoDeleterPosix.h>
 #include <ObjectList.h>
 
 
@@ -38,6 +51,39 @@
 // abort()s. Obviously that isn't good behavior for a library.
 
 
+using BPackageKit::BPrivate::GeneralFileChecksumAccessor;
+
+
+static const char* const kSolvCacheSuffix = ".solv";
+
+
+/*!	Returns the repository cache file a remote repository of the given name
+	is read from, looking it up the same way BPackageRoster does.
+*/
+static status_t
+get_repository_cache_entry(const BString& name, BEntry& _entry)
+{
+	if (name.IsEmpty())
+		return B_BAD_VALUE;
+
+	BPackageRoster roster;
+	BPath path;
+	status_t error = roster.GetUserRepositoryCachePath(&path);
+	if (error == B_OK && (error = path.Append(name)) == B_OK
+		&& (error = _entry.SetTo(path.Path())) == B_OK && _entry.Exists()) {
+		return B_OK;
+	}
+
+	if ((error = roster.GetCommonRepositoryCachePath(&path)) != B_OK
+		|| (error = path.Append(name)) != B_OK
+		|| (error = _entry.SetTo(path.Path())) != B_OK) {
+		return error;
+	}
+
+	return _entry.Exists() ? B_OK : B_ENTRY_NOT_FOUND;
+}
+
+
 BSolver*
 BPackageKit::create_solver()
 {
@@ -106,10 +152,21 @@ struct LibsolvSolver::RepositoryInfo {
 		fChangeCount = fRepository->ChangeCount();
 	}
 
+	const BEntry* CacheEntry() const
+	{
+		return fCacheEntry.InitCheck() == B_OK ? &fCacheEntry : NULL;
+	}
+
+	void SetCacheEntry(const BEntry& entry)
+	{
+		fCacheEntry = entry;
+	}
+
 private:
 	BSolverRepository*	fRepository;
 	Repo*				fSolvRepo;
 	uint64				fChangeCount;
+	BEntry				fCacheEntry;
 };
 
 
@@ -235,6 +292,14 @@ LibsolvSolver::AddRepository(BSolverRepository* repository)
 		return B_NO_MEMORY;
 	}
 
+	// A remote repository is usually read from the repository cache of the
+	// same name, next to which we keep its libsolv data.
+	if (!repository->IsInstalled()) {
+		BEntry cacheEntry;
+		if (get_repository_cache_entry(repository->Name(), cacheEntry) == B_OK)
+			info->SetCacheEntry(cacheEntry);
+	}
+
 	return B_OK;
 }
 
@@ -748,21 +813,37 @@ LibsolvSolver::_AddRepositories()
 		repo->priority = -1 - repository->Priority();
 		repo->appdata = (void*)repositoryInfo;
 
-		int32 packageCount = repository->CountPackages();
-		for (int32 k = 0; k < packageCount; k++) {
-			BSolverPackage* package = repository->PackageAt(k);
-			Id solvableId = repo_add_haiku_package_info(repo, package->Info(),
-				REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE);
-
-			try {
-				fSolvablePackages[solvableId] = package;
-				fPackageSolvables[package] = solvableId;
-			} catch (std::bad_alloc&) {
-				return B_NO_MEMORY;
+		// For a repository read from a repository cache file, the libsolv
+		// data are kept in a file next to the cache.
+		BString solvCachePath;
+		struct stat cacheStat;
+		if (const BEntry* cacheEntry = repositoryInfo->CacheEntry()) {
+			BPath cachePath;
+			if (cacheEntry->GetPath(&cachePath) == B_OK
+				&& cacheEntry->GetStat(&cacheStat) == B_OK) {
+				solvCachePath << cachePath.Path() << kSolvCacheSuffix;
 			}
 		}
 
-		repo_internalize(repo);
+		BString cacheChecksum;
+		bool solvCacheOutdated = false;
+		error = solvCachePath.IsEmpty()
+			? B_ENTRY_NOT_FOUND
+			: _ReadSolvCache(repositoryInfo, solvCachePath, cacheStat,
+				cacheChecksum, solvCacheOutdated);
+		if (error == B_NO_MEMORY)
+			return error;
+		if (error != B_OK) {
+			error = _AddPackages(repositoryInfo);
+			if (error != B_OK)
+				return error;
+			solvCacheOutdated = !solvCachePath.IsEmpty();
+		}
+
+		if (solvCacheOutdated) {
+			_WriteSolvCache(repositoryInfo, solvCachePath, cacheStat,
+				cacheChecksum);
+		}
 
 		if (repository->IsInstalled()) {
 			fInstalledRepository = repositoryInfo;
@@ -779,6 +860,202 @@ LibsolvSolver::_AddRepositories()
 }
 
 
+status_t
+LibsolvSolver::_AddPackages(RepositoryInfo* repositoryInfo)
+{
+	BSolverRepository* repository = repositoryInfo->Repository();
+	Repo* repo = repositoryInfo->SolvRepo();
+
+	int32 packageCount = repository->CountPackages();
+	for (int32 i = 0; i < packageCount; i++) {
+		BSolverPackage* package = repository->PackageAt(i);
+		Id solvableId = repo_add_haiku_package_info(repo, package->Info(),
+			REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE);
+
+		try {
+			fSolvablePackages[solvableId] = package;
+			fPackageSolvables[package] = solvableId;
+		} catch (std::bad_alloc&) {
+			return B_NO_MEMORY;
+		}
+	}
+
+	repo_internalize(repo);
+
+	return B_OK;
+}
+
+
+/*!	Adds the solvables stored in the given file to the repository's (empty)
+	libsolv repo. The file starts with a line containing the size, the
+	modification time, and the checksum of the repository cache it was
+	created from, followed by the repo in libsolv's own format.
+	The file is valid, if size and modification time still match the cache's.
+	Otherwise, the cache's checksum is computed and compared; if it matches,
+	the file is used, and \a _outdated is set to have it rewritten with the
+	new size and modification time. \a _cacheChecksum is set to the cache's
+	checksum, if it is known.
+	The solvables are in the same order as the repository's packages. If they
+	don't match, the repo is emptied again and an error is returned.
+*/
+status_t
+LibsolvSolver::_ReadSolvCache(RepositoryInfo* repositoryInfo, const char* path,
+	const struct stat& cacheStat, BString& _cacheChecksum, bool& _outdated)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+		return errno;
+	FileCloser fileCloser(file);
+
+	char header[256];
+	int64 size;
+	int64 seconds;
+	int64 nanoseconds;
+	char checksum[128];
+	if (fgets(header, sizeof(header), file) == NULL
+		|| sscanf(header, "%" B_SCNd64 " %" B_SCNd64 " %" B_SCNd64 " %127s",
+			&size, &seconds, &nanoseconds, checksum) != 4) {
+		return B_BAD_DATA;
+	}
+
+	if (size == cacheStat.st_size && seconds == cacheStat.st_mtim.tv_sec
+		&& nanoseconds == cacheStat.st_mtim.tv_nsec) {
+		_cacheChecksum = checksum;
+	} else {
+		// the cache has been touched or replaced -- check its contents
+		status_t error = GeneralFileChecksumAccessor(
+			*repositoryInfo->CacheEntry()).GetChecksum(_cacheChecksum);
+		if (error != B_OK)
+			return error;
+		if (_cacheChecksum != checksum)
+			return B_BAD_DATA;
+
+		_outdated = true;
+	}
+
+	Repo* repo = repositoryInfo->SolvRepo();
+	if (repo_add_solv(repo, file, 0) != 0) {
+		repo_empty(repo, 1);
+		return B_BAD_DATA;
+	}
+
+	// match the solvables with the packages
+	BSolverRepository* repository = repositoryInfo->Repository();
+	int32 packageCount = repository->CountPackages();
+	std::vector<Id> solvableIds;
+	try {
+		solvableIds.reserve(packageCount);
+	} catch (std::bad_alloc&) {
+		repo_empty(repo, 1);
+		return B_NO_MEMORY;
+	}
+
+	Id solvableId = repo->start;
+	bool matches = true;
+	for (int32 i = 0; matches && i < packageCount; i++) {
+		BSolverPackage* package = repository->PackageAt(i);
+		if (package->Info().InitCheck() != B_OK) {
+			// repo_add_haiku_package_info() doesn't add a solvable either
+			solvableIds.push_back(0);
+			continue;
+		}
+
+		while (solvableId < repo->end
+			&& fPool->solvables[solvableId].repo != repo) {
+			solvableId++;
+		}
+
+		matches = solvableId < repo->end
+			&& _SolvableMatches(fPool->solvables + solvableId,
+				package->Info());
+		solvableIds.push_back(solvableId++);
+	}
+
+	for (; matches && solvableId < repo->end; solvableId++) {
+		if (fPool->solvables[solvableId].repo == repo)
+			matches = false;
+	}
+
+	if (!matches) {
+		repo_empty(repo, 1);
+		return B_BAD_DATA;
+	}
+
+	for (int32 i = 0; i < packageCount; i++) {
+		BSolverPackage* package = repository->PackageAt(i);
+		try {
+			fSolvablePackages[solvableIds[i]] = package;
+			fPackageSolvables[package] = solvableIds[i];
+		} catch (std::bad_alloc&) {
+			return B_NO_MEMORY;
+		}
+	}
+
+	return B_OK;
+}
+
+
+/*!	Stores the repository's libsolv repo in the given file, so that
+	_ReadSolvCache() can use it as long as the repository cache is unchanged.
+	If \a cacheChecksum is empty, the cache's checksum is computed.
+	Failing to write the file is not an error.
+*/
+void
+LibsolvSolver::_WriteSolvCache(RepositoryInfo* repositoryInfo,
+	const char* path, const struct stat& cacheStat,
+	const BString& cacheChecksum)
+{
+	BString checksum(cacheChecksum);
+	if (checksum.IsEmpty()
+		&& GeneralFileChecksumAccessor(*repositoryInfo->CacheEntry())
+			.GetChecksum(checksum) != B_OK) {
+		return;
+	}
+
+	// Write to a temporary file and move it into place afterwards, so that
+	// other solvers never read an incomplete file.
+	BString tempPath;
+	tempPath.SetToFormat("%s.%d", path, (int)getpid());
+
+	FILE* file = fopen(tempPath, "w");
+	if (file == NULL)
+		return;
+
+	bool success = fprintf(file, "%" B_PRIdOFF " %" B_PRId64 " %" B_PRId64
+			" %s\n", cacheStat.st_size, (int64)cacheStat.st_mtim.tv_sec,
+			(int64)cacheStat.st_mtim.tv_nsec, checksum.String()) >= 0
+		&& repo_write(repositoryInfo->SolvRepo(), file) == 0;
+	if (fclose(file) != 0)
+		success = false;
+
+	if (!success || rename(tempPath, path) != 0)
+		unlink(tempPath);
+}
+
+
+/*!	Returns whether the given solvable has been created from the given
+	package info, comparing name, version, and the package file checksum.
+*/
+bool
+LibsolvSolver::_SolvableMatches(Solvable* solvable,
+	const BPackageInfo& info) const
+{
+	BString name("pkg:");
+	name << info.Name();
+	if (name != pool_id2str(fPool, solvable->name)
+		|| info.Version().ToString() != pool_id2str(fPool, solvable->evr)) {
+		return false;
+	}
+
+	Id checksumType;
+	const char* checksum = solvable_lookup_checksum(solvable,
+		SOLVABLE_CHECKSUM, &checksumType);
+	if (checksum == NULL)
+		return info.Checksum().IsEmpty();
+	return info.Checksum().ICompare(checksum) == 0;
+}
+
+
 LibsolvSolver::RepositoryInfo*
 LibsolvSolver::_InstalledRepository() const
 {
@@ -9,6 +9,7 @@
 #include <map>
 
 #include <ObjectList.h>
+#include <String.h>
 #include <package/solver/Solver.h>
 #include <package/solver/SolverProblemSolution.h>
 
@@ -20,6 +21,7 @@ using namespace BPackageKit;
 
 
 namespace BPackageKit {
+	class BPackageInfo;
 	class BPackageResolvableExpression;
 	class BSolverPackage;
 }
@@ -95,6 +97,17 @@ private:
 
 			bool				_HaveRepositoriesChanged() const;
 			status_t			_AddRepositories();
+			status_t			_AddPackages(RepositoryInfo* repositoryInfo);
+			status_t			_ReadSolvCache(RepositoryInfo* repositoryInfo,
+									const char* path,
+									const struct stat& cacheStat,
+									BString& _cacheChecksum, bool& _outdated);
+			void				_WriteSolvCache(RepositoryInfo* repositoryInfo,
+									const char* path,
+									const struct stat& cacheStat,
+									const BString& cacheChecksum);
+			bool				_SolvableMatches(Solvable* solvable,
+									const BPackageInfo& info) const;
 			RepositoryInfo*		_InstalledRepository() const;
 			RepositoryInfo*		_GetRepositoryInfo(
 									BSolverRepository* repository) const;
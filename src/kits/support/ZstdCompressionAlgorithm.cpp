@@ -25,6 +25,7 @@
 // build compression support only for userland
 #if defined(ZSTD_ENABLED) && !defined(_KERNEL_MODE) && !defined(_BOOT_MODE)
 #	define B_ZSTD_COMPRESSION_SUPPORT 1
+#	include <zdict.h>
 #endif
 
 
@@ -50,13 +51,17 @@ BZstdCompressionParameters::BZstdCompressionParameters(
 	:
 	BCompressionParameters(),
 	fCompressionLevel(compressionLevel),
-	fBufferSize(kDefaultBufferSize)
+	fBufferSize(kDefaultBufferSize),
+	fDictionary(NULL)
 {
 }
 
 
 BZstdCompressionParameters::~BZstdCompressionParameters()
 {
+#ifdef B_ZSTD_COMPRESSION_SUPPORT
+	ZSTD_freeCDict((ZSTD_CDict*)fDictionary);
+#endif
 }
 
 
@@ -88,19 +93,54 @@ BZstdCompressionParameters::SetBufferSize(size_t size)
 }
 
 
+/*!	Makes CompressBuffer() use the given dictionary. The data are copied and
+	prepared for the current compression level, so the level must be set
+	before. Passing \c NULL removes the dictionary.
+*/
+status_t
+BZstdCompressionParameters::SetDictionary(const void* dictionary, size_t size)
+{
+#ifdef B_ZSTD_COMPRESSION_SUPPORT
+	ZSTD_CDict* newDictionary = NULL;
+	if (dictionary != NULL) {
+		newDictionary = ZSTD_createCDict(dictionary, size, fCompressionLevel);
+		if (newDictionary == NULL)
+			return B_NO_MEMORY;
+	}
+
+	ZSTD_freeCDict((ZSTD_CDict*)fDictionary);
+	fDictionary = newDictionary;
+	return B_OK;
+#else
+	return B_NOT_SUPPORTED;
+#endif
+}
+
+
+bool
+BZstdCompressionParameters::HasDictionary() const
+{
+	return fDictionary != NULL;
+}
+
+
 // #pragma mark - BZstdDecompressionParameters
 
 
 BZstdDecompressionParameters::BZstdDecompressionParameters()
 	:
 	BDecompressionParameters(),
-	fBufferSize(kDefaultBufferSize)
+	fBufferSize(kDefaultBufferSize),
+	fDictionary(NULL)
 {
 }
 
 
 BZstdDecompressionParameters::~BZstdDecompressionParameters()
 {
+#ifdef ZSTD_ENABLED
+	ZSTD_freeDDict((ZSTD_DDict*)fDictionary);
+#endif
 }
 
 
@@ -118,6 +158,37 @@ BZstdDecompressionParameters::SetBufferSize(size_t size)
 }
 
 
+/*!	Makes DecompressBuffer() use the given dictionary. The data are copied.
+	Passing \c NULL removes the dictionary.
+*/
+status_t
+BZstdDecompressionParameters::SetDictionary(const void* dictionary,
+	size_t size)
+{
+#ifdef ZSTD_ENABLED
+	ZSTD_DDict* newDictionary = NULL;
+	if (dictionary != NULL) {
+		newDictionary = ZSTD_createDDict(dictionary, size);
+		if (newDictionary == NULL)
+			return B_NO_MEMORY;
+	}
+
+	ZSTD_freeDDict((ZSTD_DDict*)fDictionary);
+	fDictionary = newDictionary;
+	return B_OK;
+#else
+	return B_NOT_SUPPORTED;
+#endif
+}
+
+
+bool
+BZstdDecompressionParameters::HasDictionary() const
+{
+	return fDictionary != NULL;
+}
+
+
 // #pragma mark - CompressionStrategy
 
 
@@ -379,8 +450,20 @@ BZstdCompressionAlgorithm::CompressBuffer(const iovec& input, iovec& output,
 		? zstdParameters->CompressionLevel()
 		: B_ZSTD_COMPRESSION_DEFAULT;
 
-	size_t zstdError = ZSTD_compress(output.iov_base, output.iov_len,
-		input.iov_base, input.iov_len, compressionLevel);
+	size_t zstdError;
+	if (zstdParameters != NULL && zstdParameters->fDictionary != NULL) {
+		ZSTD_CCtx* cctx = ZSTD_createCCtx();
+		if (cctx == NULL)
+			return B_NO_MEMORY;
+		CObjectDeleter<ZSTD_CCtx, size_t, ZSTD_freeCCtx> cctxDeleter(cctx);
+
+		zstdError = ZSTD_compress_usingCDict(cctx, output.iov_base,
+			output.iov_len, input.iov_base, input.iov_len,
+			(const ZSTD_CDict*)zstdParameters->fDictionary);
+	} else {
+		zstdError = ZSTD_compress(output.iov_base, output.iov_len,
+			input.iov_base, input.iov_len, compressionLevel);
+	}
 	if (ZSTD_isError(zstdError))
 		return _TranslateZstdError(zstdError);
 
@@ -405,10 +488,23 @@ BZstdCompressionAlgorithm::DecompressBuffer(const iovec& input, iovec& output,
 	else
 #endif
 		dctxDeleter.SetTo(dctx = ZSTD_createDCtx());
-
-	size_t zstdError = ZSTD_decompressDCtx(dctx,
-		output.iov_base, output.iov_len,
-		input.iov_base, input.iov_len);
+	if (dctx == NULL)
+		return B_NO_MEMORY;
+
+	const BZstdDecompressionParameters* zstdParameters
+		= dynamic_cast<const BZstdDecompressionParameters*>(parameters);
+
+	size_t zstdError;
+	if (zstdParameters != NULL && zstdParameters->fDictionary != NULL) {
+		zstdError = ZSTD_decompress_usingDDict(dctx,
+			output.iov_base, output.iov_len,
+			input.iov_base, input.iov_len,
+			(const ZSTD_DDict*)zstdParameters->fDictionary);
+	} else {
+		zstdError = ZSTD_decompressDCtx(dctx,
+			output.iov_base, output.iov_len,
+			input.iov_base, input.iov_len);
+	}
 	if (ZSTD_isError(zstdError))
 		return _TranslateZstdError(zstdError);
 
@@ -420,6 +516,31 @@ BZstdCompressionAlgorithm::DecompressBuffer(const iovec& input, iovec& output,
 }
 
 
+/*!	Trains a dictionary on the given samples, which are stored one after the
+	other in \a samples. \a _size is the capacity of \a dictionary on input
+	and the size of the dictionary on output. Training needs a sufficient
+	number of samples -- at least about a hundred times the dictionary size in
+	total -- and fails with \c B_BAD_VALUE otherwise.
+*/
+/*static*/ status_t
+BZstdCompressionAlgorithm::TrainDictionary(const void* samples,
+	const size_t* sampleSizes, uint32 sampleCount, void* dictionary,
+	size_t& _size)
+{
+#ifdef B_ZSTD_COMPRESSION_SUPPORT
+	size_t result = ZDICT_trainFromBuffer(dictionary, _size, samples,
+		sampleSizes, sampleCount);
+	if (ZDICT_isError(result))
+		return B_BAD_VALUE;
+
+	_size = result;
+	return B_OK;
+#else
+	return B_NOT_SUPPORTED;
+#endif
+}
+
+
 /*static*/ status_t
 BZstdCompressionAlgorithm::_TranslateZstdError(size_t error)
 {
@@ -431,6 +552,7 @@ BZstdCompressionAlgorithm::_TranslateZstdError(size_t error)
 			return B_BAD_VALUE;
 		case ZSTD_error_corruption_detected:
 		case ZSTD_error_checksum_wrong:
+		case ZSTD_error_dictionary_wrong:
 			return B_BAD_DATA;
 		case ZSTD_error_version_unsupported:
 			return B_BAD_VALUE;
@@ -103,7 +103,7 @@ ScaleBitmap(BBitmap* source, BBitmap& dest, BRect bounds, color_space colorSpace
 		view.DrawBitmap(source, source->Bounds(),
 			ThumbBounds(&dest, source->Bounds().Width()
 				/ source->Bounds().Height()),
-			B_FILTER_BITMAP_BILINEAR);
+			B_FILTER_BITMAP_BILINEAR | B_FILTER_BITMAP_AREA_AVERAGE);
 		view.Sync();
 		view.UnlockLooper();
 	}
@@ -57,6 +57,7 @@ DesktopSettingsPrivate::_SetDefaults()
 	fFocusFollowsMouseMode = B_NORMAL_FOCUS_FOLLOWS_MOUSE;
 	fAcceptFirstClick = true;
 	fShowAllDraggers = true;
+	fRetainWindowContents = false;
 
 	// init scrollbar info
 	fScrollBarInfo.proportional = true;
@@ -306,6 +307,12 @@ DesktopSettingsPrivate::_Load()
 				fControlLook = controlLook;
 			}
 
+			bool retainWindowContents;
+			if (settings.FindBool("retain window contents",
+					&retainWindowContents) == B_OK) {
+				fRetainWindowContents = retainWindowContents;
+			}
+
 			// colors
 			for (int32 i = 0; i < kColorWhichCount; i++) {
 				char colorName[12];
@@ -456,6 +463,7 @@ DesktopSettingsPrivate::Save(uint32 mask)
 			settings.AddBool("subpixel ordering", gSubpixelOrderingRGB);
 
 			settings.AddString("control look", fControlLook);
+			settings.AddBool("retain window contents", fRetainWindowContents);
 
 			for (int32 i = 0; i < kColorWhichCount; i++) {
 				char colorName[12];
@@ -815,6 +823,24 @@ DesktopSettingsPrivate::ControlLook() const
 }
 
 
+void
+DesktopSettingsPrivate::SetRetainWindowContents(bool retain)
+{
+	if (retain == fRetainWindowContents)
+		return;
+
+	fRetainWindowContents = retain;
+	Save(kAppearanceSettings);
+}
+
+
+bool
+DesktopSettingsPrivate::RetainWindowContents() const
+{
+	return fRetainWindowContents;
+}
+
+
 void
 DesktopSettingsPrivate::_ValidateWorkspacesLayout(int32& columns,
 	int32& rows) const
@@ -976,6 +1002,13 @@ DesktopSettings::ControlLook() const
 	return fSettings->ControlLook();
 }
 
+
+bool
+DesktopSettings::RetainWindowContents() const
+{
+	return fSettings->RetainWindowContents();
+}
+
 //	#pragma mark - write access
 
 
@@ -1103,3 +1136,10 @@ LockedDesktopSettings::SetControlLook(const char* path)
 	return fSettings->SetControlLook(path);
 }
 
+
+void
+LockedDesktopSettings::SetRetainWindowContents(bool retain)
+{
+	fSettings->SetRetainWindowContents(retain);
+}
+
@@ -0,0 +1,688 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "PictureRasterCache.h"
+
+#include <math.h>
+#include <new>
+#include <stack>
+#include <string.h>
+
+#include <AutoDeleter.h>
+#include <AutoLocker.h>
+#include <ObjectListPrivate.h>
+#include <PicturePlayer.h>
+
+#include "BitmapHWInterface.h"
+#include "Canvas.h"
+#include "DrawingEngine.h"
+#include "DrawState.h"
+#include "GlobalSubpixelSettings.h"
+#include "IntRect.h"
+#include "PictureBoundingBoxPlayer.h"
+#include "ServerPicture.h"
+
+
+//#define PRINT_PICTURE_RASTER_CACHE_STATISTICS
+#ifdef PRINT_PICTURE_RASTER_CACHE_STATISTICS
+static uint32 sPictureDrawCount = 0;
+#endif
+
+
+namespace {
+
+
+enum operation_kind {
+	kShapeOperation,
+	kStringOperation,
+	kPixelsOperation,
+	kGradientOperation
+};
+
+
+/*!	Finds out whether playing a picture onto a transparent bitmap with
+	B_OP_ALPHA, and then compositing that bitmap, gives the same result as
+	playing the picture directly. This is the case when every operation only
+	composites the source over the destination, which is why only solid
+	patterns and opaque colors are accepted in the B_OP_COPY and B_OP_OVER
+	modes.
+*/
+class CacheabilityCallbacks : public BPrivate::PicturePlayerCallbacks {
+public:
+	CacheabilityCallbacks(const DrawState& state)
+		:
+		fCacheable(true),
+		fAlphaFunction(state.AlphaFncMode())
+	{
+		fState.drawingMode = state.GetDrawingMode();
+		fState.alphaSourceMode = state.AlphaSrcMode();
+		fState.alphaFunction = state.AlphaFncMode();
+		fState.highAlpha = state.HighColor().alpha;
+		fState.solidHigh = state.GetPattern() == kSolidHigh;
+	}
+
+	bool IsCacheable() const
+	{
+		return fCacheable;
+	}
+
+	virtual void StrokeLine(const BPoint& start, const BPoint& end)
+		{ _Draw(kShapeOperation); }
+	virtual void DrawRect(const BRect& rect, bool fill)
+		{ _Draw(kShapeOperation); }
+	virtual void DrawRoundRect(const BRect& rect, const BPoint& radii,
+		bool fill)
+		{ _Draw(kShapeOperation); }
+	virtual void DrawBezier(const BPoint controlPoints[4], bool fill)
+		{ _Draw(kShapeOperation); }
+	virtual void DrawArc(const BPoint& center, const BPoint& radii,
+		float startTheta, float arcTheta, bool fill)
+		{ _Draw(kShapeOperation); }
+	virtual void DrawEllipse(const BRect& rect, bool fill)
+		{ _Draw(kShapeOperation); }
+	virtual void DrawPolygon(size_t numPoints, const BPoint points[],
+		bool isClosed, bool fill)
+		{ _Draw(kShapeOperation); }
+	virtual void DrawShape(const BShape& shape, bool fill)
+		{ _Draw(kShapeOperation); }
+
+	virtual void DrawString(const char* string, size_t length,
+		const escapement_delta& delta)
+		{ _Draw(kStringOperation); }
+	virtual void DrawStringLocations(const char* string, size_t length,
+		const BPoint locations[], size_t locationCount)
+		{ _Draw(kStringOperation); }
+
+	virtual void DrawPixels(const BRect& source, const BRect& destination,
+		uint32 width, uint32 height, size_t bytesPerRow,
+		color_space pixelFormat, uint32 flags, const void* data,
+		size_t length)
+		{ _Draw(kPixelsOperation); }
+
+	virtual void StrokeLineGradient(const BPoint& start, const BPoint& end,
+		BGradient& gradient)
+		{ _Draw(kGradientOperation); }
+	virtual void DrawRectGradient(const BRect& rect, BGradient& gradient,
+		bool fill)
+		{ _Draw(kGradientOperation); }
+	virtual void DrawRoundRectGradient(const BRect& rect, const BPoint& radii,
+		BGradient& gradient, bool fill)
+		{ _Draw(kGradientOperation); }
+	virtual void DrawBezierGradient(const BPoint controlPoints[4],
+		BGradient& gradient, bool fill)
+		{ _Draw(kGradientOperation); }
+	virtual void DrawArcGradient(const BPoint& center, const BPoint& radii,
+		float startTheta, float arcTheta, BGradient& gradient, bool fill)
+		{ _Draw(kGradientOperation); }
+	virtual void DrawEllipseGradient(const BRect& rect, BGradient& gradient,
+		bool fill)
+		{ _Draw(kGradientOperation); }
+	virtual void DrawPolygonGradient(size_t numPoints, const BPoint points[],
+		bool isClosed, BGradient& gradient, bool fill)
+		{ _Draw(kGradientOperation); }
+	virtual void DrawShapeGradient(const BShape& shape, BGradient& gradient,
+		bool fill)
+		{ _Draw(kGradientOperation); }
+
+	// Nested pictures, clipping and layers depend on more than the picture
+	// itself, or on the destination.
+	virtual void DrawPicture(const BPoint& where, int32 token)
+		{ fCacheable = false; }
+	virtual void SetClippingRects(size_t numRects,
+		const clipping_rect rects[])
+		{ fCacheable = false; }
+	virtual void ClipToPicture(int32 token, const BPoint& where,
+		bool clipToInverse)
+		{ fCacheable = false; }
+	virtual void ClipToRect(const BRect& rect, bool inverse)
+		{ fCacheable = false; }
+	virtual void ClipToShape(int32 opCount, const uint32 opList[],
+		int32 ptCount, const BPoint ptList[], bool inverse)
+		{ fCacheable = false; }
+	virtual void BlendLayer(Layer* layer)
+		{ fCacheable = false; }
+
+	virtual void PushState()
+	{
+		fStack.push(fState);
+	}
+
+	virtual void PopState()
+	{
+		if (fStack.empty())
+			return;
+
+		fState = fStack.top();
+		fStack.pop();
+	}
+
+	virtual void SetDrawingMode(drawing_mode mode)
+	{
+		fState.drawingMode = mode;
+	}
+
+	virtual void SetBlendingMode(source_alpha alphaSourceMode,
+		alpha_function alphaFunctionMode)
+	{
+		fState.alphaSourceMode = alphaSourceMode;
+		fState.alphaFunction = alphaFunctionMode;
+	}
+
+	virtual void SetForeColor(const rgb_color& color)
+	{
+		fState.highAlpha = color.alpha;
+	}
+
+	virtual void SetStipplePattern(const pattern& stipplePattern)
+	{
+		fState.solidHigh = Pattern(stipplePattern) == kSolidHigh;
+	}
+
+private:
+	void _Draw(operation_kind kind)
+	{
+		if (!fCacheable)
+			return;
+
+		if (!fState.solidHigh
+			|| (kind == kStringOperation && gSubpixelAntialiasing)) {
+			fCacheable = false;
+			return;
+		}
+
+		switch (fState.drawingMode) {
+			case B_OP_ALPHA:
+				if (fState.alphaFunction != fAlphaFunction)
+					fCacheable = false;
+				else if (fState.alphaSourceMode != B_PIXEL_ALPHA
+					&& (kind == kPixelsOperation
+						|| kind == kGradientOperation)) {
+					fCacheable = false;
+				}
+				break;
+
+			case B_OP_OVER:
+				if (fState.highAlpha != 255 || kind == kPixelsOperation
+					|| kind == kGradientOperation) {
+					fCacheable = false;
+				}
+				break;
+
+			case B_OP_COPY:
+				// strings are blended with the low color in B_OP_COPY
+				if (fState.highAlpha != 255 || kind != kShapeOperation)
+					fCacheable = false;
+				break;
+
+			default:
+				fCacheable = false;
+				break;
+		}
+	}
+
+private:
+	struct state {
+		drawing_mode	drawingMode;
+		source_alpha	alphaSourceMode;
+		alpha_function	alphaFunction;
+		uint8			highAlpha;
+		bool			solidHigh;
+	};
+
+	bool				fCacheable;
+	alpha_function		fAlphaFunction;
+	state				fState;
+	std::stack<state>	fStack;
+};
+
+
+}	// namespace
+
+
+// #pragma mark - Key
+
+
+PictureRasterCache::Key::Key()
+	:
+	picture(NULL),
+	dataLength(0)
+{
+}
+
+
+/*!	Fills in the key for drawing \a newPicture with \a state. Without scaling
+	and transformation, moving the picture by whole pixels does not change
+	its pixels, so only the fractional part of the origin is part of the key,
+	and the whole pixels are returned in \a _integerOffset.
+*/
+void
+PictureRasterCache::Key::SetTo(ServerPicture* newPicture,
+	const DrawState& state, BPoint& _integerOffset)
+{
+	picture = newPicture;
+	dataLength = newPicture->DataLength();
+
+	origin = state.CombinedOrigin();
+	scale = state.CombinedScale();
+	transform = state.CombinedTransform();
+
+	_integerOffset = BPoint(0, 0);
+	if (scale == 1.0 && transform.IsIdentity()) {
+		_integerOffset.x = floorf(origin.x);
+		_integerOffset.y = floorf(origin.y);
+		origin -= _integerOffset;
+	}
+
+	highColor = state.HighColor();
+	lowColor = state.LowColor();
+	pattern = state.GetPattern();
+	drawingMode = state.GetDrawingMode();
+	alphaSourceMode = state.AlphaSrcMode();
+	alphaFunctionMode = state.AlphaFncMode();
+	penLocation = state.PenLocation();
+	penSize = state.PenSize();
+	lineCapMode = state.LineCapMode();
+	lineJoinMode = state.LineJoinMode();
+	miterLimit = state.MiterLimit();
+	fillRule = state.FillRule();
+	font = state.Font();
+	fontAliasing = state.ForceFontAliasing();
+	subPixelPrecise = state.SubPixelPrecise();
+}
+
+
+bool
+PictureRasterCache::Key::operator==(const Key& other) const
+{
+	return picture == other.picture
+		&& dataLength == other.dataLength
+		&& origin == other.origin
+		&& scale == other.scale
+		&& transform == other.transform
+		&& highColor == other.highColor
+		&& lowColor == other.lowColor
+		&& pattern == other.pattern
+		&& drawingMode == other.drawingMode
+		&& alphaSourceMode == other.alphaSourceMode
+		&& alphaFunctionMode == other.alphaFunctionMode
+		&& penLocation == other.penLocation
+		&& penSize == other.penSize
+		&& lineCapMode == other.lineCapMode
+		&& lineJoinMode == other.lineJoinMode
+		&& miterLimit == other.miterLimit
+		&& fillRule == other.fillRule
+		&& fontAliasing == other.fontAliasing
+		&& subPixelPrecise == other.subPixelPrecise
+		&& font == other.font;
+}
+
+
+// #pragma mark - PictureRasterCache
+
+
+PictureRasterCache PictureRasterCache::sDefaultInstance;
+
+
+PictureRasterCache::PictureRasterCache()
+	:
+	fLock("picture raster cache"),
+	fEntryCount(0),
+	fCurrentCacheBytes(0),
+	fHitCount(0),
+	fMissCount(0),
+	fRenderCount(0),
+	fUncacheableCount(0),
+	fEvictedCount(0)
+{
+}
+
+
+PictureRasterCache::~PictureRasterCache()
+{
+	Clear();
+}
+
+
+/* static */ PictureRasterCache*
+PictureRasterCache::Default()
+{
+	return &sDefaultInstance;
+}
+
+
+/*!	Draws \a picture into \a canvas from the cache, if possible. Returns
+	\c false if nothing was drawn, in which case the caller has to play the
+	picture itself.
+
+	A picture is rasterized the second time it is drawn with the same state,
+	so that pictures that are only drawn once don't cost anything extra.
+*/
+bool
+PictureRasterCache::Draw(ServerPicture* picture, Canvas* canvas)
+{
+	const DrawState& state = *canvas->CurrentState();
+	if (state.GetAlphaMask() != NULL) {
+		// The mask would have to be applied to each operation, not to
+		// their combined result
+		return false;
+	}
+
+	Key key;
+	BPoint integerOffset;
+	key.SetTo(picture, state, integerOffset);
+
+	AutoLocker<BLocker> locker(fLock);
+
+#ifdef PRINT_PICTURE_RASTER_CACHE_STATISTICS
+	if (sPictureDrawCount++ > 200) {
+		_PrintAndResetStatistics();
+		sPictureDrawCount = 0;
+	}
+#endif
+
+	Entry* entry = _Lookup(key);
+	if (entry == NULL) {
+		fMissCount++;
+
+		entry = new(std::nothrow) Entry;
+		if (entry == NULL)
+			return false;
+
+		entry->key = key;
+		entry->drawCount = 1;
+		entry->cacheable = true;
+		_Insert(entry);
+		return false;
+	}
+
+	if (entry->bitmap != NULL) {
+		fHitCount++;
+
+		BReference<UtilityBitmap> bitmap = entry->bitmap;
+		BPoint leftTop = entry->leftTop + integerOffset;
+		locker.Unlock();
+
+		_Blit(canvas, bitmap, leftTop);
+		return true;
+	}
+
+	fMissCount++;
+	if (!entry->cacheable || ++entry->drawCount < 2)
+		return false;
+
+	// Render without holding the lock; the entry may be gone afterwards
+	locker.Unlock();
+
+	BPoint leftTop;
+	BReference<UtilityBitmap> bitmap(_Render(picture, state, leftTop), true);
+
+	locker.Lock();
+
+	entry = _Lookup(key);
+	if (bitmap == NULL) {
+		fUncacheableCount++;
+		if (entry != NULL)
+			entry->cacheable = false;
+		return false;
+	}
+
+	fRenderCount++;
+	if (entry != NULL && entry->bitmap == NULL) {
+		size_t bytes = bitmap->BitsLength();
+		_MakeRoom(bytes, entry);
+		if (fCurrentCacheBytes + bytes <= kMaxCacheBytes) {
+			entry->bitmap = bitmap;
+			entry->leftTop = leftTop - integerOffset;
+			fCurrentCacheBytes += bytes;
+		}
+	}
+	locker.Unlock();
+
+	_Blit(canvas, bitmap, leftTop);
+	return true;
+}
+
+
+/*!	Removes all entries of \a picture; to be called when the picture goes
+	away.
+*/
+void
+PictureRasterCache::Remove(ServerPicture* picture)
+{
+	AutoLocker<BLocker> locker(fLock);
+
+	Entry* entry = fEntries.Head();
+	while (entry != NULL) {
+		Entry* next = fEntries.GetNext(entry);
+		if (entry->key.picture == picture)
+			_RemoveEntry(entry);
+		entry = next;
+	}
+}
+
+
+void
+PictureRasterCache::Clear()
+{
+	AutoLocker<BLocker> locker(fLock);
+
+	while (Entry* entry = fEntries.Head())
+		_RemoveEntry(entry);
+
+	fHitCount = 0;
+	fMissCount = 0;
+	fRenderCount = 0;
+	fUncacheableCount = 0;
+	fEvictedCount = 0;
+}
+
+
+/*!	Looks up the entry for \a key and moves it to the front of the list.
+	Entries recorded for an older version of the picture are removed on the
+	way, since it has been appended to since.
+*/
+PictureRasterCache::Entry*
+PictureRasterCache::_Lookup(const Key& key)
+{
+	Entry* entry = fEntries.Head();
+	while (entry != NULL) {
+		Entry* next = fEntries.GetNext(entry);
+
+		if (entry->key.picture == key.picture) {
+			if (entry->key.dataLength != key.dataLength)
+				_RemoveEntry(entry);
+			else if (entry->key == key) {
+				fEntries.Remove(entry);
+				fEntries.Add(entry, false);
+				return entry;
+			}
+		}
+
+		entry = next;
+	}
+
+	return NULL;
+}
+
+
+void
+PictureRasterCache::_Insert(Entry* entry)
+{
+	if (fEntryCount >= kMaxEntries) {
+		fEvictedCount++;
+		_RemoveEntry(fEntries.Tail());
+	}
+
+	fEntries.Add(entry, false);
+	fEntryCount++;
+}
+
+
+void
+PictureRasterCache::_RemoveEntry(Entry* entry)
+{
+	if (entry->bitmap != NULL)
+		fCurrentCacheBytes -= entry->bitmap->BitsLength();
+
+	fEntries.Remove(entry);
+	fEntryCount--;
+	delete entry;
+}
+
+
+/*!	Drops the bitmaps of the least recently used entries until \a bytes
+	more fit into the cache. The entries themselves are kept, but need to be
+	seen twice again before they are rendered anew.
+*/
+void
+PictureRasterCache::_MakeRoom(size_t bytes, Entry* keep)
+{
+	for (Entry* entry = fEntries.Tail();
+			entry != NULL && fCurrentCacheBytes + bytes > kMaxCacheBytes;
+			entry = fEntries.GetPrevious(entry)) {
+		if (entry == keep || entry->bitmap == NULL)
+			continue;
+
+		fCurrentCacheBytes -= entry->bitmap->BitsLength();
+		entry->bitmap.Unset();
+		entry->drawCount = 0;
+		fEvictedCount++;
+	}
+}
+
+
+bool
+PictureRasterCache::_IsCacheable(ServerPicture* picture,
+	const DrawState& state) const
+{
+	BMallocIO* mallocIO = dynamic_cast<BMallocIO*>(picture->fData.Get());
+	if (mallocIO == NULL)
+		return false;
+
+	CacheabilityCallbacks callbacks(state);
+
+	BPrivate::PicturePlayer player(mallocIO->Buffer(),
+		mallocIO->BufferLength(), ServerPicture::PictureList::Private(
+			picture->fPictures.Get()).AsBList());
+	player.Play(callbacks);
+
+	return callbacks.IsCacheable();
+}
+
+
+/*!	Plays \a picture with \a state, but without clipping, into a new
+	transparent bitmap that covers the picture's bounding box. The left top
+	corner of the bitmap in the local coordinates of the canvas is returned
+	in \a _leftTop.
+*/
+UtilityBitmap*
+PictureRasterCache::_Render(ServerPicture* picture, const DrawState& state,
+	BPoint& _leftTop)
+{
+	if (!_IsCacheable(picture, state))
+		return NULL;
+
+	BRect boundingBox;
+	PictureBoundingBoxPlayer::Play(picture, &state, &boundingBox);
+	if (!boundingBox.IsValid())
+		return NULL;
+
+	// Compensate for the rounding in Painter, as in Layer
+	boundingBox.left = floorf(boundingBox.left);
+	boundingBox.right = ceilf(boundingBox.right) + 2;
+	boundingBox.top = floorf(boundingBox.top);
+	boundingBox.bottom = ceilf(boundingBox.bottom) + 2;
+
+	if ((boundingBox.Width() + 1) * (boundingBox.Height() + 1) * 4
+			> kMaxBitmapBytes) {
+		return NULL;
+	}
+
+	BReference<UtilityBitmap> bitmap(new(std::nothrow) UtilityBitmap(
+		boundingBox, B_RGBA32, 0), true);
+	if (bitmap == NULL || !bitmap->IsValid())
+		return NULL;
+
+	memset(bitmap->Bits(), 0, bitmap->BitsLength());
+
+	BitmapHWInterface interface(bitmap);
+	ObjectDeleter<DrawingEngine> engine(interface.CreateDrawingEngine());
+	if (!engine.IsSet())
+		return NULL;
+
+	engine->SetRendererOffset(boundingBox.left, boundingBox.top);
+
+	OffscreenCanvas canvas(engine.Get(), state, boundingBox);
+
+	// Every operation that made it through _IsCacheable() composites the
+	// same way in B_OP_ALPHA as in the mode it was recorded with
+	DrawState* const drawState = canvas.CurrentState();
+	drawState->SetDrawingModeLocked(false);
+	drawState->SetDrawingMode(B_OP_ALPHA);
+	drawState->SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_COMPOSITE);
+	drawState->SetDrawingModeLocked(true);
+	canvas.PushState();
+
+	canvas.ResyncDrawState();
+
+	if (!engine->LockParallelAccess())
+		return NULL;
+
+	BRegion clipping;
+	clipping.Set((clipping_rect)IntRect(boundingBox));
+	engine->ConstrainClippingRegion(&clipping);
+	picture->Play(&canvas);
+	engine->UnlockParallelAccess();
+
+	canvas.PopState();
+
+	_leftTop = boundingBox.LeftTop();
+	return bitmap.Detach();
+}
+
+
+void
+PictureRasterCache::_Blit(Canvas* canvas, UtilityBitmap* bitmap,
+	BPoint leftTop)
+{
+	BRect destination = bitmap->Bounds();
+	destination.OffsetBy(leftTop);
+	canvas->LocalToScreenTransform().Apply(&destination);
+
+	alpha_function alphaFunction = canvas->CurrentState()->AlphaFncMode();
+
+	canvas->PushState();
+
+	DrawState* const drawState = canvas->CurrentState();
+	drawState->SetDrawingMode(B_OP_ALPHA);
+	drawState->SetBlendingMode(B_PIXEL_ALPHA, alphaFunction);
+	drawState->SetTransformEnabled(false);
+	canvas->ResyncDrawState();
+
+	canvas->GetDrawingEngine()->DrawBitmap(bitmap, bitmap->Bounds(),
+		destination, 0);
+
+	drawState->SetTransformEnabled(true);
+
+	canvas->PopState();
+	canvas->ResyncDrawState();
+}
+
+
+void
+PictureRasterCache::_PrintAndResetStatistics()
+{
+	debug_printf("PictureRasterCache statistics: entries=%" B_PRId32
+		" bytes=%" B_PRIuSIZE " hit=%4" B_PRIu32 " miss=%4" B_PRIu32
+		" rendered=%4" B_PRIu32 " uncacheable=%4" B_PRIu32 " evicted=%4"
+		B_PRIu32 "\n", fEntryCount, fCurrentCacheBytes, fHitCount,
+		fMissCount, fRenderCount, fUncacheableCount, fEvictedCount);
+	fHitCount = 0;
+	fMissCount = 0;
+	fRenderCount = 0;
+	fUncacheableCount = 0;
+	fEvictedCount = 0;
+}
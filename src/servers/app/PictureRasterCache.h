@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef PICTURE_RASTER_CACHE_H
+#define PICTURE_RASTER_CACHE_H
+
+
+#include <AffineTransform.h>
+#include <Locker.h>
+#include <Referenceable.h>
+
+#include <util/DoublyLinkedList.h>
+
+#include "PatternHandler.h"
+#include "ServerBitmap.h"
+#include "ServerFont.h"
+
+
+class Canvas;
+class DrawState;
+class ServerPicture;
+
+
+/*!	Keeps rasterized versions of pictures that are drawn repeatedly with the
+	same state, so that drawing them again is a single bitmap blit instead
+	of replaying the picture.
+
+	Only pictures whose operations give the same result when they are first
+	composited onto a transparent bitmap are cached; anything that depends
+	on the destination pixels, on clipping or on other pictures is always
+	played.
+*/
+class PictureRasterCache {
+private:
+	enum {
+		kMaxCacheBytes = 4 * 1024 * 1024, // 4 MiB
+		kMaxBitmapBytes = 256 * 1024,
+		kMaxEntries = 256
+	};
+
+public:
+								PictureRasterCache();
+								~PictureRasterCache();
+
+	static	PictureRasterCache*	Default();
+
+			bool				Draw(ServerPicture* picture, Canvas* canvas);
+			void				Remove(ServerPicture* picture);
+			void				Clear();
+
+private:
+	struct Key {
+								Key();
+
+			void				SetTo(ServerPicture* newPicture,
+									const DrawState& state,
+									BPoint& _integerOffset);
+			bool				operator==(const Key& other) const;
+
+			ServerPicture*		picture;
+			off_t				dataLength;
+			BPoint				origin;
+			float				scale;
+			BAffineTransform	transform;
+			rgb_color			highColor;
+			rgb_color			lowColor;
+			Pattern				pattern;
+			drawing_mode		drawingMode;
+			source_alpha		alphaSourceMode;
+			alpha_function		alphaFunctionMode;
+			BPoint				penLocation;
+			float				penSize;
+			cap_mode			lineCapMode;
+			join_mode			lineJoinMode;
+			float				miterLimit;
+			int32				fillRule;
+			ServerFont			font;
+			bool				fontAliasing;
+			bool				subPixelPrecise;
+	};
+
+	struct Entry : DoublyLinkedListLinkImpl<Entry> {
+			Key					key;
+			int32				drawCount;
+			bool				cacheable;
+			BReference<UtilityBitmap>
+								bitmap;
+			BPoint				leftTop;
+	};
+
+	typedef DoublyLinkedList<Entry> EntryList;
+
+			Entry*				_Lookup(const Key& key);
+			void				_Insert(Entry* entry);
+			void				_RemoveEntry(Entry* entry);
+			void				_MakeRoom(size_t bytes, Entry* keep);
+
+			bool				_IsCacheable(ServerPicture* picture,
+									const DrawState& state) const;
+			UtilityBitmap*		_Render(ServerPicture* picture,
+									const DrawState& state,
+									BPoint& _leftTop);
+			void				_Blit(Canvas* canvas, UtilityBitmap* bitmap,
+									BPoint leftTop);
+
+			void				_PrintAndResetStatistics();
+
+private:
+	static	PictureRasterCache	sDefaultInstance;
+
+			BLocker				fLock;
+			EntryList			fEntries;
+				// most recently used first
+			int32				fEntryCount;
+			size_t				fCurrentCacheBytes;
+
+			// Statistics counters
+			uint32				fHitCount;
+			uint32				fMissCount;
+			uint32				fRenderCount;
+			uint32				fUncacheableCount;
+			uint32				fEvictedCount;
+};
+
+
+#endif	// PICTURE_RASTER_CACHE_H
@@ -187,6 +187,8 @@ string_for_message_code(uint32 code)
 		CODE(AS_GET_DECORATOR_SETTINGS);
 		CODE(AS_GET_SHOW_ALL_DRAGGERS);
 		CODE(AS_SET_SHOW_ALL_DRAGGERS);
+		CODE(AS_GET_RETAIN_WINDOW_CONTENTS);
+		CODE(AS_SET_RETAIN_WINDOW_CONTENTS);
 
 		// Subpixel antialiasing & hinting
 		CODE(AS_SET_SUBPIXEL_ANTIALIASING);
@@ -1571,6 +1571,40 @@ ServerApp::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_GET_RETAIN_WINDOW_CONTENTS:
+		{
+			STRACE(("ServerApp %s: Get Retain Window Contents\n",
+				Signature()));
+
+			if (fDesktop->LockSingleWindow()) {
+				DesktopSettings settings(fDesktop);
+
+				fLink.StartMessage(B_OK);
+				fLink.Attach<bool>(settings.RetainWindowContents());
+
+				fDesktop->UnlockSingleWindow();
+			} else
+				fLink.StartMessage(B_ERROR);
+
+			fLink.Flush();
+			break;
+		}
+
+		case AS_SET_RETAIN_WINDOW_CONTENTS:
+		{
+			STRACE(("ServerApp %s: Set Retain Window Contents\n",
+				Signature()));
+
+			// the windows pick up the change the next time their contents
+			// are covered or exposed
+			bool retain;
+			if (link.Read<bool>(&retain) == B_OK) {
+				LockedDesktopSettings settings(fDesktop);
+				settings.SetRetainWindowContents(retain);
+			}
+			break;
+		}
+
 		/* font messages */
 
 		case AS_ADD_FONT_FILE:
@@ -91,6 +91,8 @@ public:
 			void				RemovePicture(ServerPicture* picture);
 
 			Desktop*			GetDesktop() const { return fDesktop; }
+			ClientMemoryAllocator* MemoryAllocator() const
+									{ return fMemoryAllocator.Get(); }
 
 			const ServerFont&	PlainFont() const { return fPlainFont; }
 
@@ -21,6 +21,7 @@
 #include "DrawState.h"
 #include "GlobalFontManager.h"
 #include "Layer.h"
+#include "PictureRasterCache.h"
 #include "ServerApp.h"
 #include "ServerBitmap.h"
 #include "ServerFont.h"
@@ -1111,6 +1112,7 @@ ServerPicture::~ServerPicture()
 	ASSERT(fOwner == NULL);
 
 	gTokenSpace.RemoveToken(fToken);
+	PictureRasterCache::Default()->Remove(this);
 
 	if (fPictures.IsSet()) {
 		for (int32 i = fPictures->CountItems(); i-- > 0;) {
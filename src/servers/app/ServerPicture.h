@@ -69,6 +69,7 @@ public:
 
 private:
 	friend class PictureBoundingBoxPlayer;
+	friend class PictureRasterCache;
 
 			typedef BObjectList<ServerPicture> PictureList;
 
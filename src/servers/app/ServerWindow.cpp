@@ -43,6 +43,7 @@
 #include <GradientDiamond.h>
 #include <GradientConic.h>
 
+#include <LinkRing.h>
 #include <MessagePrivate.h>
 #include <PortLink.h>
 #include <ShapePrivate.h>
@@ -67,6 +68,7 @@
 #include "HWInterface.h"
 #include "Layer.h"
 #include "Overlay.h"
+#include "PictureRasterCache.h"
 #include "ProfileMessageSupport.h"
 #include "RenderingBuffer.h"
 #include "ServerApp.h"
@@ -80,6 +82,10 @@
 using std::nothrow;
 
 
+static const size_t kDrawingRingSize = 128 * 1024;
+	// must be a power of two
+
+
 //#define TRACE_SERVER_WINDOW
 #ifdef TRACE_SERVER_WINDOW
 #	include <stdio.h>
@@ -2479,6 +2485,9 @@ void
 ServerWindow::_DispatchViewDrawingMessage(int32 code,
 	BPrivate::LinkReceiver &link)
 {
+	if (!fWindow->InUpdate())
+		fWindow->InvalidateRetainedContents(fCurrentView);
+
 	if (!fCurrentView->IsVisible() || !fWindow->IsVisible()) {
 		if (link.NeedsReply()) {
 			debug_printf("ServerWindow::DispatchViewDrawingMessage() got "
@@ -3239,7 +3248,10 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 					fCurrentView->SetDrawingOrigin(where);
 
 					fCurrentView->PushState();
-					picture->Play(fCurrentView);
+					if (!PictureRasterCache::Default()->Draw(picture,
+							fCurrentView)) {
+						picture->Play(fCurrentView);
+					}
 					fCurrentView->PopState();
 
 					fCurrentView->PopState();
@@ -4234,6 +4246,15 @@ ServerWindow::_MessageLooper()
 	fLink.Attach<float>((float)maxWidth);
 	fLink.Attach<float>((float)minHeight);
 	fLink.Attach<float>((float)maxHeight);
+
+	_InitDrawingRing();
+	if (fDrawingRing.IsSet()) {
+		fLink.Attach<area_id>(fDrawingRing->Area());
+		fLink.Attach<uint32>(fDrawingRing->AreaOffset());
+		fLink.Attach<uint32>(sizeof(link_ring) + kDrawingRingSize);
+		fLink.Attach<sem_id>(fLink.Receiver().RingSemaphore());
+	} else
+		fLink.Attach<area_id>(-1);
 	fLink.Flush();
 
 	BPrivate::LinkReceiver& receiver = fLink.Receiver();
@@ -4363,8 +4384,13 @@ ServerWindow::_MessageLooper()
 				break;
 			}
 
-			// next message
-			status_t status = receiver.GetNextMessage(code);
+			// next message; don't wait for it with the Desktop locked
+			status_t status = receiver.GetNextMessage(code, 0);
+			if (status == B_WOULD_BLOCK || status == B_TIMED_OUT) {
+				if (lockedDesktopSingleWindow)
+					fDesktop->UnlockSingleWindow();
+				break;
+			}
 			if (status != B_OK) {
 				// that shouldn't happen, it's our port
 				printf("Someone deleted our message port!\n");
@@ -4552,6 +4578,27 @@ ServerWindow::_MessageNeedsAllWindowsLocked(uint32 code) const
 }
 
 
+/*!	Sets up the ring buffer in client memory through which the client sends
+	its messages, so that the port only needs to be used to wake us up.
+	If that fails, everything keeps going through the port.
+*/
+void
+ServerWindow::_InitDrawingRing()
+{
+	if (App()->MemoryAllocator() == NULL)
+		return;
+
+	fDrawingRing.SetTo(new(std::nothrow) ClientMemory);
+	if (!fDrawingRing.IsSet())
+		return;
+
+	size_t size = sizeof(link_ring) + kDrawingRingSize;
+	void* ring = fDrawingRing->Allocate(App()->MemoryAllocator(), size);
+	if (ring == NULL || fLink.Receiver().SetRing(ring, size) != B_OK)
+		fDrawingRing.Unset();
+}
+
+
 void
 ServerWindow::_ResizeToFullScreen()
 {
@@ -35,6 +35,7 @@ class BMessenger;
 class BPoint;
 class BMessage;
 
+class ClientMemory;
 class Desktop;
 class ServerApp;
 class Decorator;
@@ -143,6 +144,8 @@ private:
 			bool				_MessageNeedsAllWindowsLocked(
 									uint32 code) const;
 
+			void				_InitDrawingRing();
+
 private:
 			char*				fTitle;
 
@@ -155,6 +158,8 @@ private:
 			team_id				fClientTeam;
 
 			port_id				fMessagePort;
+			ObjectDeleter<ClientMemory>
+								fDrawingRing;
 			port_id				fClientReplyPort;
 			port_id				fClientLooperPort;
 			BMessenger			fFocusMessenger;
@@ -31,12 +31,14 @@
 #include "Decorator.h"
 #include "DecorManager.h"
 #include "Desktop.h"
+#include "DesktopSettings.h"
 #include "DrawingEngine.h"
 #include "HWInterface.h"
 #include "MessagePrivate.h"
 #include "PortLink.h"
 #include "ServerApp.h"
 #include "ServerWindow.h"
+#include "WindowBackingStore.h"
 #include "WindowBehaviour.h"
 #include "Workspace.h"
 #include "WorkspacesView.h"
@@ -89,6 +91,9 @@ Window::Window(const BRect& frame, const char *name,
 	fContentRegionValid(false),
 	fEffectiveDrawingRegionValid(false),
 
+	fVisibleRegionOrigin(frame.LeftTop()),
+	fVisibleRegionOnScreen(false),
+
 	fRegionPool(),
 
 	fWindow(window),
@@ -195,6 +200,10 @@ Window::SetClipping(BRegion* stillAvailableOnScreen)
 {
 	// this function is only called from the Desktop thread
 
+	BRegion* previouslyVisible = NULL;
+	if (fVisibleRegionOnScreen && _UpdateBackingStore())
+		previouslyVisible = fRegionPool.GetRegion(fVisibleRegion);
+
 	// start from full region (as if the window was fully visible)
 	GetFullRegion(&fVisibleRegion);
 	// clip to region still available on screen
@@ -202,6 +211,23 @@ Window::SetClipping(BRegion* stillAvailableOnScreen)
 
 	fVisibleContentRegionValid = false;
 	fEffectiveDrawingRegionValid = false;
+
+	if (previouslyVisible != NULL) {
+		// retain what is about to be covered (the window might have been
+		// moved as well)
+		BRegion* visible = fRegionPool.GetRegion(fVisibleRegion);
+		if (visible != NULL) {
+			visible->OffsetBy((int32)(fVisibleRegionOrigin.x - fFrame.left),
+				(int32)(fVisibleRegionOrigin.y - fFrame.top));
+			previouslyVisible->Exclude(visible);
+			_RetainContents(*previouslyVisible);
+			fRegionPool.Recycle(visible);
+		}
+		fRegionPool.Recycle(previouslyVisible);
+	}
+
+	fVisibleRegionOrigin = fFrame.LeftTop();
+	fVisibleRegionOnScreen = true;
 }
 
 
@@ -446,6 +472,7 @@ Window::ScrollViewBy(View* view, int32 dx, int32 dy)
 		return;
 
 	view->ScrollBy(dx, dy, dirty);
+	_InvalidateRetainedContents(*dirty);
 
 //fDrawingEngine->FillRegion(*dirty, (rgb_color){ 255, 0, 255, 255 });
 //snooze(20000);
@@ -464,6 +491,16 @@ void
 Window::CopyContents(BRegion* region, int32 xOffset, int32 yOffset)
 {
 	// executed in ServerWindow thread with the read lock held
+	if (fBackingStore.IsSet() && fBackingStore->HasContents()) {
+		BRegion* destination = fRegionPool.GetRegion(*region);
+		if (destination != NULL) {
+			destination->OffsetBy(xOffset, yOffset);
+			_InvalidateRetainedContents(*destination);
+			fRegionPool.Recycle(destination);
+		} else
+			fBackingStore->MakeEmpty();
+	}
+
 	if (!IsVisible())
 		return;
 
@@ -784,6 +821,9 @@ Window::RedrawDirtyRegion()
 		dirtyContentRegion->IntersectWith(&fDirtyRegion);
 		exposeContentRegion->IntersectWith(&fExposeRegion);
 
+		if (fBackingStore.IsSet() && fBackingStore->HasContents())
+			_RestoreContents(*dirtyContentRegion, *exposeContentRegion);
+
 		_TriggerContentRedraw(*dirtyContentRegion, *exposeContentRegion);
 
 		fRegionPool.Recycle(dirtyContentRegion);
@@ -821,6 +861,8 @@ Window::MarkContentDirty(BRegion& dirtyRegion, BRegion& exposeRegion)
 	// since this won't affect other windows, read locking
 	// is sufficient. If there was no dirty region before,
 	// an update message is triggered
+	_InvalidateRetainedContents(dirtyRegion);
+
 	if (fHidden || IsOffscreenWindow())
 		return;
 
@@ -834,6 +876,8 @@ void
 Window::MarkContentDirtyAsync(BRegion& dirtyRegion)
 {
 	// NOTE: see comments in ProcessDirtyRegion()
+	_InvalidateRetainedContents(dirtyRegion);
+
 	if (fHidden || IsOffscreenWindow())
 		return;
 
@@ -850,6 +894,17 @@ Window::MarkContentDirtyAsync(BRegion& dirtyRegion)
 void
 Window::InvalidateView(View* view, BRegion& viewRegion)
 {
+	if (view != NULL && fBackingStore.IsSet()
+		&& fBackingStore->HasContents()) {
+		BRegion* region = fRegionPool.GetRegion(viewRegion);
+		if (region != NULL) {
+			view->LocalToScreenTransform().Apply(region);
+			_InvalidateRetainedContents(*region);
+			fRegionPool.Recycle(region);
+		} else
+			fBackingStore->MakeEmpty();
+	}
+
 	if (view && IsVisible() && view->IsVisible()) {
 		if (!fContentRegionValid)
 			_UpdateContentRegion();
@@ -867,6 +922,23 @@ Window::InvalidateView(View* view, BRegion& viewRegion)
 	}
 }
 
+
+/*!	The client can draw without being asked to, but that only ends up on
+	screen where the window is visible. Whatever has been retained of the
+	view is out of date then.
+*/
+void
+Window::InvalidateRetainedContents(View* view)
+{
+	if (!fBackingStore.IsSet() || !fBackingStore->HasContents())
+		return;
+
+	if (!fContentRegionValid)
+		_UpdateContentRegion();
+
+	_InvalidateRetainedContents(view->ScreenAndUserClipping(&fContentRegion));
+}
+
 // DisableUpdateRequests
 void
 Window::DisableUpdateRequests()
@@ -1108,6 +1180,9 @@ Window::SetHidden(bool hidden)
 {
 	// the desktop takes care of dirty regions
 	if (fHidden != hidden) {
+		if (hidden)
+			_RetainVisibleContents();
+
 		fHidden = hidden;
 
 		fTopView->SetHidden(hidden);
@@ -1127,6 +1202,17 @@ Window::SetShowLevel(int32 showLevel)
 }
 
 
+void
+Window::SetCurrentWorkspace(int32 index)
+{
+	if (index < 0)
+		_RetainVisibleContents();
+
+	fCurrentWorkspace = index;
+	fPriorWorkspace = index;
+}
+
+
 void
 Window::SetMinimized(bool minimized)
 {
@@ -2014,6 +2100,152 @@ Window::_UpdateContentRegion()
 }
 
 
+bool
+Window::_RetainsContents() const
+{
+	// direct windows draw behind our back
+	if (IsOffscreenWindow() || (fFlags & kWindowScreenFlag) != 0
+		|| fWindow->IsDirectlyAccessing()) {
+		return false;
+	}
+
+	DesktopSettings settings(fDesktop);
+	return settings.RetainWindowContents();
+}
+
+
+/*!	Creates or deletes the backing store as configured, and makes sure it
+	matches the size of the window. Returns whether the contents on screen
+	can be retained.
+*/
+bool
+Window::_UpdateBackingStore()
+{
+	if (!_RetainsContents()) {
+		fBackingStore.Unset();
+		return false;
+	}
+
+	if (!fBackingStore.IsSet()) {
+		fBackingStore.SetTo(new(std::nothrow) WindowBackingStore);
+		if (!fBackingStore.IsSet())
+			return false;
+	}
+
+	int32 width = fFrame.IntegerWidth() + 1;
+	int32 height = fFrame.IntegerHeight() + 1;
+	if (fBackingStore->Width() == width && fBackingStore->Height() == height)
+		return true;
+
+	// After a resize, the views may have been laid out differently than
+	// what is still on screen.
+	fBackingStore->SetSize(width, height);
+	return false;
+}
+
+
+/*!	Retains the contents of \a region, which is in screen coordinates as of
+	the last SetClipping(). The region is changed.
+*/
+void
+Window::_RetainContents(BRegion& region)
+{
+	// the decorator is drawn by us, and cheap to draw again
+	if (!fContentRegionValid)
+		_UpdateContentRegion();
+
+	BRegion* ignore = fRegionPool.GetRegion(fContentRegion);
+	if (ignore == NULL)
+		return;
+
+	region.OffsetBy((int32)(fFrame.left - fVisibleRegionOrigin.x),
+		(int32)(fFrame.top - fVisibleRegionOrigin.y));
+	region.IntersectWith(ignore);
+
+	// what is waiting to be redrawn is not worth keeping
+	*ignore = fDirtyRegion;
+	if (fPendingUpdateSession->IsUsed())
+		ignore->Include(&fPendingUpdateSession->DirtyRegion());
+	if (fCurrentUpdateSession->IsUsed())
+		ignore->Include(&fCurrentUpdateSession->DirtyRegion());
+	region.Exclude(ignore);
+	fRegionPool.Recycle(ignore);
+
+	region.OffsetBy(-(int32)fFrame.left, -(int32)fFrame.top);
+	if (region.CountRects() > 0 && fDrawingEngine->LockParallelAccess()) {
+		fBackingStore->Retain(fDrawingEngine.Get(), region,
+			fVisibleRegionOrigin);
+		fDrawingEngine->UnlockParallelAccess();
+	}
+}
+
+
+//!	Retains everything that is visible, as the window is about to go away.
+void
+Window::_RetainVisibleContents()
+{
+	if (fVisibleRegionOnScreen && _UpdateBackingStore()) {
+		BRegion* visible = fRegionPool.GetRegion(fVisibleRegion);
+		if (visible != NULL) {
+			_RetainContents(*visible);
+			fRegionPool.Recycle(visible);
+		}
+	}
+
+	fVisibleRegionOnScreen = false;
+}
+
+
+/*!	Puts back what has been retained of \a dirty, and removes those parts
+	from \a dirty and \a expose, so that the client doesn't have to redraw
+	them.
+*/
+void
+Window::_RestoreContents(BRegion& dirty, BRegion& expose)
+{
+	if (!_RetainsContents()) {
+		fBackingStore.Unset();
+		return;
+	}
+
+	BRegion* restored = fRegionPool.GetRegion(dirty);
+	if (restored == NULL)
+		return;
+
+	restored->OffsetBy(-(int32)fFrame.left, -(int32)fFrame.top);
+	if (fDrawingEngine->LockParallelAccess()) {
+		fBackingStore->Restore(fDrawingEngine.Get(), *restored,
+			fFrame.LeftTop());
+		fDrawingEngine->UnlockParallelAccess();
+	} else
+		restored->MakeEmpty();
+
+	restored->OffsetBy((int32)fFrame.left, (int32)fFrame.top);
+	dirty.Exclude(restored);
+	expose.Exclude(restored);
+	fRegionPool.Recycle(restored);
+}
+
+
+//!	Forgets the retained contents of \a region, which is in screen coordinates.
+void
+Window::_InvalidateRetainedContents(const BRegion& region)
+{
+	if (!fBackingStore.IsSet() || !fBackingStore->HasContents())
+		return;
+
+	BRegion* invalid = fRegionPool.GetRegion(region);
+	if (invalid == NULL) {
+		fBackingStore->MakeEmpty();
+		return;
+	}
+
+	invalid->OffsetBy(-(int32)fFrame.left, -(int32)fFrame.top);
+	fBackingStore->Invalidate(*invalid);
+	fRegionPool.Recycle(invalid);
+}
+
+
 void
 Window::_ObeySizeLimits()
 {
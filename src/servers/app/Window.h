@@ -75,6 +75,7 @@ class Desktop;
 class DrawingEngine;
 class EventDispatcher;
 class Screen;
+class WindowBackingStore;
 class WindowBehaviour;
 class WorkspacesView;
 
@@ -159,6 +160,8 @@ public:
 			void				MarkContentDirtyAsync(BRegion& dirtyRegion);
 			// shortcut for invalidating just one view
 			void				InvalidateView(View* view, BRegion& viewRegion);
+			// for drawing that happens outside of an update
+			void				InvalidateRetainedContents(View* view);
 
 			void				DisableUpdateRequests();
 			void				EnableUpdateRequests();
@@ -221,8 +224,7 @@ public:
 			void				SetMinimized(bool minimized);
 	inline	bool				IsMinimized() const { return fMinimized; }
 
-			void				SetCurrentWorkspace(int32 index)
-									{ fCurrentWorkspace = index; fPriorWorkspace = index; }
+			void				SetCurrentWorkspace(int32 index);
 			int32				CurrentWorkspace() const
 									{ return fCurrentWorkspace; }
 			bool				IsVisible() const;
@@ -340,6 +342,16 @@ protected:
 			void				_ObeySizeLimits();
 			void				_PropagatePosition();
 
+			// retaining the contents of hidden parts
+			bool				_RetainsContents() const;
+			bool				_UpdateBackingStore();
+			void				_RetainContents(BRegion& region);
+			void				_RetainVisibleContents();
+			void				_RestoreContents(BRegion& dirty,
+									BRegion& expose);
+			void				_InvalidateRetainedContents(
+									const BRegion& region);
+
 			BString				fTitle;
 			// TODO: no fp rects anywhere
 			BRect				fFrame;
@@ -375,6 +387,17 @@ protected:
 			bool				fContentRegionValid : 1;
 			bool				fEffectiveDrawingRegionValid : 1;
 
+			// Where the window was when the visible region was set, and
+			// whether it has been on screen since then, ie. whether the screen
+			// still shows its contents there.
+			BPoint				fVisibleRegionOrigin;
+			bool				fVisibleRegionOnScreen : 1;
+
+			// Only used when the desktop is configured to retain window
+			// contents, see WindowBackingStore.
+			ObjectDeleter<WindowBackingStore>
+								fBackingStore;
+
 			::RegionPool		fRegionPool;
 
 			BObjectList<Window> fSubsets;
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT license.
+ */
+
+
+#include "WindowBackingStore.h"
+
+#include <new>
+
+#include "DrawingEngine.h"
+#include "ServerBitmap.h"
+
+
+WindowBackingStore::WindowBackingStore()
+	:
+	fWidth(0),
+	fHeight(0)
+{
+}
+
+
+WindowBackingStore::~WindowBackingStore()
+{
+}
+
+
+/*!	Changing the size throws away the retained contents, as they no longer
+	match the layout of the window.
+*/
+void
+WindowBackingStore::SetSize(int32 width, int32 height)
+{
+	if (width == fWidth && height == fHeight)
+		return;
+
+	MakeEmpty();
+	fWidth = width;
+	fHeight = height;
+}
+
+
+//!	Copies the \a region of the window from the screen into the store.
+void
+WindowBackingStore::Retain(DrawingEngine* engine, const BRegion& region,
+	BPoint origin)
+{
+	if (fWidth <= 0 || fHeight <= 0)
+		return;
+
+	BRegion retain(BRect(0, 0, fWidth - 1, fHeight - 1));
+	retain.IntersectWith(&region);
+	if (retain.CountRects() == 0)
+		return;
+
+	if (!fBitmap.IsSet()) {
+		// the memory is only held as long as there is something to retain
+		fBitmap.SetTo(new(std::nothrow) UtilityBitmap(
+			BRect(0, 0, fWidth - 1, fHeight - 1), B_RGB32, 0), true);
+		if (!fBitmap.IsSet() || !fBitmap->IsValid()) {
+			fBitmap.Unset();
+			return;
+		}
+	}
+
+	retain.OffsetBy(origin);
+	if (engine->ReadRegion(retain, fBitmap, origin) != B_OK)
+		return;
+
+	retain.OffsetBy(-origin.x, -origin.y);
+	fValidRegion.Include(&retain);
+}
+
+
+/*!	Puts the retained parts of \a region back on screen. On return, \a region
+	only contains the parts that could be restored; the rest still has to be
+	redrawn by the client.
+*/
+void
+WindowBackingStore::Restore(DrawingEngine* engine, BRegion& region,
+	BPoint origin)
+{
+	region.IntersectWith(&fValidRegion);
+	if (region.CountRects() == 0)
+		return;
+
+	region.OffsetBy(origin);
+	if (engine->WriteRegion(region, fBitmap, origin) != B_OK) {
+		region.MakeEmpty();
+		return;
+	}
+	region.OffsetBy(-origin.x, -origin.y);
+
+	// what is on screen is retained again once it gets covered
+	fValidRegion.Exclude(&region);
+	if (!HasContents())
+		MakeEmpty();
+}
+
+
+//!	Forgets about the contents in \a region, as they are out of date.
+void
+WindowBackingStore::Invalidate(const BRegion& region)
+{
+	if (!HasContents())
+		return;
+
+	fValidRegion.Exclude(&region);
+	if (!HasContents())
+		MakeEmpty();
+}
+
+
+void
+WindowBackingStore::MakeEmpty()
+{
+	fValidRegion.MakeEmpty();
+	fBitmap.Unset();
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT license.
+ */
+#ifndef WINDOW_BACKING_STORE_H
+#define WINDOW_BACKING_STORE_H
+
+
+#include <Point.h>
+#include <Referenceable.h>
+#include <Region.h>
+
+
+class DrawingEngine;
+class UtilityBitmap;
+
+
+/*!	Retains the contents of those parts of a window that are covered by
+	other windows or are not on screen at all, so that they can be put back
+	without asking the client to redraw them.
+	All regions are in window coordinates, ie. relative to the left top
+	corner of the window frame, while "origin" is the position of that
+	corner on screen.
+*/
+class WindowBackingStore {
+public:
+								WindowBackingStore();
+								~WindowBackingStore();
+
+			void				SetSize(int32 width, int32 height);
+			int32				Width() const { return fWidth; }
+			int32				Height() const { return fHeight; }
+
+			bool				HasContents() const
+									{ return fValidRegion.CountRects() > 0; }
+			const BRegion&		ValidRegion() const { return fValidRegion; }
+
+			void				Retain(DrawingEngine* engine,
+									const BRegion& region, BPoint origin);
+			void				Restore(DrawingEngine* engine,
+									BRegion& region, BPoint origin);
+			void				Invalidate(const BRegion& region);
+			void				MakeEmpty();
+
+private:
+			int32				fWidth;
+			int32				fHeight;
+			BReference<UtilityBitmap> fBitmap;
+			BRegion				fValidRegion;
+};
+
+
+#endif	// WINDOW_BACKING_STORE_H
@@ -1431,6 +1431,31 @@ DrawingEngine::ReadBitmap(ServerBitmap* bitmap, bool drawCursor, BRect bounds)
 }
 
 
+/*!	Copies the parts of the drawing buffer in \a region into \a bitmap.
+	The region is in screen coordinates, the top left corner of the bitmap is
+	at \a origin on screen.
+*/
+status_t
+DrawingEngine::ReadRegion(const BRegion& region, ServerBitmap* bitmap,
+	BPoint origin)
+{
+	ASSERT_PARALLEL_LOCKED();
+
+	return _TransferRegion(region, bitmap, origin, false);
+}
+
+
+//!	The counterpart of ReadRegion(), puts the bitmap contents back on screen.
+status_t
+DrawingEngine::WriteRegion(const BRegion& region, ServerBitmap* bitmap,
+	BPoint origin)
+{
+	ASSERT_PARALLEL_LOCKED();
+
+	return _TransferRegion(region, bitmap, origin, true);
+}
+
+
 // #pragma mark -
 
 
@@ -1515,3 +1540,56 @@ DrawingEngine::_CopyRect(uint8* src, uint32 width, uint32 height,
 		}
 	}
 }
+
+
+status_t
+DrawingEngine::_TransferRegion(const BRegion& region, ServerBitmap* bitmap,
+	BPoint origin, bool toScreen)
+{
+	RenderingBuffer* buffer = fGraphicsCard->DrawingBuffer();
+	if (buffer == NULL)
+		return B_ERROR;
+
+	// the pixels are copied as they are, so both sides need to have the
+	// same 32 bit layout
+	color_space bufferColorSpace = buffer->ColorSpace();
+	if (bufferColorSpace != B_RGB32 && bufferColorSpace != B_RGBA32)
+		return B_NOT_SUPPORTED;
+	if (bitmap->ColorSpace() != B_RGB32 && bitmap->ColorSpace() != B_RGBA32)
+		return B_BAD_VALUE;
+
+	BRect bufferClip(0, 0, buffer->Width() - 1, buffer->Height() - 1);
+	BRect bitmapClip(bitmap->Bounds().OffsetByCopy(origin));
+	AutoFloatingOverlaysHider _(fGraphicsCard, region.Frame());
+
+	uint32 bufferBytesPerRow = buffer->BytesPerRow();
+	uint32 bitmapBytesPerRow = bitmap->BytesPerRow();
+
+	int32 count = region.CountRects();
+	for (int32 i = 0; i < count; i++) {
+		BRect rect = region.RectAt(i) & bufferClip & bitmapClip;
+		if (!rect.IsValid())
+			continue;
+
+		uint8* screenBits = (uint8*)buffer->Bits()
+			+ (ssize_t)rect.left * 4 + (ssize_t)rect.top * bufferBytesPerRow;
+		uint8* bitmapBits = bitmap->Bits()
+			+ (ssize_t)(rect.left - origin.x) * 4
+			+ (ssize_t)(rect.top - origin.y) * bitmapBytesPerRow;
+		uint32 width = (rect.IntegerWidth() + 1) * 4;
+
+		for (int32 y = rect.IntegerHeight(); y >= 0; y--) {
+			if (toScreen)
+				memcpy(screenBits, bitmapBits, width);
+			else
+				memcpy(bitmapBits, screenBits, width);
+			screenBits += bufferBytesPerRow;
+			bitmapBits += bitmapBytesPerRow;
+		}
+
+		if (toScreen)
+			fGraphicsCard->Invalidate(rect);
+	}
+
+	return B_OK;
+}
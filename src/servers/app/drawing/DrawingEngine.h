@@ -66,6 +66,13 @@ public:
 	virtual	status_t		ReadBitmap(ServerBitmap *bitmap, bool drawCursor,
 								BRect bounds);
 
+	// for retaining window contents, the top left corner of the bitmap
+	// is at "origin" on screen
+	virtual	status_t		ReadRegion(const BRegion& region,
+								ServerBitmap* bitmap, BPoint origin);
+	virtual	status_t		WriteRegion(const BRegion& region,
+								ServerBitmap* bitmap, BPoint origin);
+
 	// clipping for all drawing functions, passing a NULL region
 	// will remove any clipping (drawing allowed everywhere)
 	virtual	void			ConstrainClippingRegion(const BRegion* region);
@@ -206,6 +213,9 @@ private:
 			void			_CopyRect(uint8* bits,
 								uint32 width, uint32 height, uint32 bytesPerRow,
 								int32 xOffset, int32 yOffset) const;
+			status_t		_TransferRegion(const BRegion& region,
+								ServerBitmap* bitmap, BPoint origin,
+								bool toScreen);
 
 			ObjectDeleter<Painter>
 							fPainter;
@@ -21,11 +21,110 @@
 #include "DrawingEngine.h"
 #include "RenderingBuffer.h"
 #include "SystemPalette.h"
+#include "TileWorkerPool.h"
+
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 5 \
+	&& !defined(__clang__)
+#	define HW_INTERFACE_X86 1
+#	include <emmintrin.h>
+#endif
 
 
 using std::nothrow;
 
 
+extern uint32 gSIMDFlags;
+
+// updates smaller than this are copied by the calling thread alone
+static const int32 kMinParallelCopyPixels = 256 * 1024;
+static const int32 kMinCopyTilePixels = 64 * 1024;
+static const int32 kMaxCopyWorkers = 3;
+	// copying is bound by memory bandwidth, more threads don't help
+
+static const int32 kMinStreamingCopyBytes = 256;
+
+enum {
+	COPY_WORKERS_UNINITIALIZED = 0,
+	COPY_WORKERS_INITIALIZING,
+	COPY_WORKERS_READY
+};
+
+
+static TileWorkerPool*
+create_copy_workers()
+{
+	system_info info;
+	if (get_system_info(&info) != B_OK)
+		return NULL;
+
+	int32 workerCount = min_c((int32)info.cpu_count - 1, kMaxCopyWorkers);
+	if (workerCount <= 0)
+		return NULL;
+
+	TileWorkerPool* workers = new(nothrow) TileWorkerPool;
+	if (workers == NULL)
+		return NULL;
+
+	if (workers->Init(workerCount) != B_OK) {
+		delete workers;
+		return NULL;
+	}
+
+	return workers;
+}
+
+
+#ifdef HW_INTERFACE_X86
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+
+/*!	Copies \a rows rows of \a bytes bytes each using non-temporal stores.
+	Frame buffer memory is usually mapped write-combined, where streaming
+	full cache lines is a lot faster than what memcpy() does, and it doesn't
+	evict the back buffer from the cache either.
+*/
+static void
+stream_copy_rows(uint8* dst, uint32 dstBPR, const uint8* src, uint32 srcBPR,
+	int32 bytes, int32 rows)
+{
+	for (; rows > 0; rows--, dst += dstBPR, src += srcBPR) {
+		uint8* d = dst;
+		const uint8* s = src;
+		int32 left = bytes;
+
+		// align the destination (bytes is a multiple of 4)
+		for (; left > 0 && ((addr_t)d & 15) != 0; left -= 4, d += 4, s += 4)
+			*(uint32*)d = *(const uint32*)s;
+
+		for (; left >= 64; left -= 64, d += 64, s += 64) {
+			__m128i a = _mm_loadu_si128((const __m128i*)s);
+			__m128i b = _mm_loadu_si128((const __m128i*)(s + 16));
+			__m128i c = _mm_loadu_si128((const __m128i*)(s + 32));
+			__m128i e = _mm_loadu_si128((const __m128i*)(s + 48));
+			_mm_stream_si128((__m128i*)d, a);
+			_mm_stream_si128((__m128i*)(d + 16), b);
+			_mm_stream_si128((__m128i*)(d + 32), c);
+			_mm_stream_si128((__m128i*)(d + 48), e);
+		}
+		for (; left >= 16; left -= 16, d += 16, s += 16) {
+			_mm_stream_si128((__m128i*)d,
+				_mm_loadu_si128((const __m128i*)s));
+		}
+		for (; left > 0; left -= 4, d += 4, s += 4)
+			*(uint32*)d = *(const uint32*)s;
+	}
+
+	// make the stores visible before anyone else touches the frame buffer
+	_mm_sfence();
+}
+
+
+#pragma GCC pop_options
+#endif	// HW_INTERFACE_X86
+
+
 HWInterfaceListener::HWInterfaceListener()
 {
 }
@@ -52,7 +151,8 @@ HWInterface::HWInterface()
 	fHardwareCursorEnabled(false),
 	fCursorLocation(0, 0),
 	fVGADevice(-1),
-	fListeners(20)
+	fListeners(20),
+	fCopyWorkersState(COPY_WORKERS_UNINITIALIZED)
 {
 }
 
@@ -393,6 +493,25 @@ HWInterface::_CopyBackToFront(/*const*/ BRegion& region)
 	uint8* src = (uint8*)backBuffer->Bits();
 
 	int32 count = region.CountRects();
+
+	// Spread large updates over several threads. This leaves out the
+	// VGA modes, which might be blitted by the driver.
+	if (FrontBuffer()->ColorSpace() != B_GRAY8) {
+		int64 pixels = 0;
+		for (int32 i = 0; i < count; i++) {
+			clipping_rect r = region.RectAtInt(i);
+			pixels += (int64)(r.right - r.left + 1) * (r.bottom - r.top + 1);
+		}
+
+		if (pixels >= kMinParallelCopyPixels) {
+			TileWorkerPool* workers = _CopyWorkers();
+			if (workers != NULL && workers->Run(region, kMinCopyTilePixels,
+					&_CopyTileToFront, this)) {
+				return;
+			}
+		}
+	}
+
 	for (int32 i = 0; i < count; i++) {
 		clipping_rect r = region.RectAtInt(i);
 		// offset to left top pixel in source buffer (always B_RGBA32)
@@ -402,6 +521,44 @@ HWInterface::_CopyBackToFront(/*const*/ BRegion& region)
 }
 
 
+/*!	Returns the threads that help copying large updates to the front buffer,
+	creating them on first use, or \c NULL if there are none (yet). Most
+	interfaces, like those of offscreen windows, never need them.
+*/
+TileWorkerPool*
+HWInterface::_CopyWorkers()
+{
+	int32 state = atomic_get(&fCopyWorkersState);
+	if (state == COPY_WORKERS_READY)
+		return fCopyWorkers.Get();
+
+	// whoever comes first creates the pool, the others don't wait for it
+	if (state != COPY_WORKERS_UNINITIALIZED
+		|| atomic_test_and_set(&fCopyWorkersState, COPY_WORKERS_INITIALIZING,
+			COPY_WORKERS_UNINITIALIZED) != COPY_WORKERS_UNINITIALIZED) {
+		return NULL;
+	}
+
+	fCopyWorkers.SetTo(create_copy_workers());
+	atomic_set(&fCopyWorkersState, COPY_WORKERS_READY);
+	return fCopyWorkers.Get();
+}
+
+
+/*static*/ void
+HWInterface::_CopyTileToFront(void* cookie, const clipping_rect& tile)
+{
+	HWInterface* interface = (HWInterface*)cookie;
+	RenderingBuffer* backBuffer = interface->BackBuffer();
+
+	uint32 srcBPR = backBuffer->BytesPerRow();
+	uint8* src = (uint8*)backBuffer->Bits() + tile.top * srcBPR
+		+ tile.left * 4;
+	interface->_CopyToFront(src, srcBPR, tile.left, tile.top, tile.right,
+		tile.bottom);
+}
+
+
 // #pragma mark -
 
 
@@ -671,6 +828,14 @@ HWInterface::_CopyToFront(uint8* src, uint32 srcBPR, int32 x, int32 y,
 			if (bytes > 0) {
 				// offset to left top pixel in dest buffer
 				dst += y * dstBPR + x * 4;
+#ifdef HW_INTERFACE_X86
+				if (bytes >= kMinStreamingCopyBytes
+					&& (gSIMDFlags & APPSERVER_SIMD_SSE2) != 0) {
+					stream_copy_rows(dst, dstBPR, src, srcBPR, bytes,
+						bottom - y + 1);
+					break;
+				}
+#endif
 				// copy
 				for (; y <= bottom; y++) {
 					// bytes is guaranteed to be multiple of 4
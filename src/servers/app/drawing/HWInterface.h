@@ -32,6 +32,7 @@ class EventStream;
 class Overlay;
 class RenderingBuffer;
 class ServerBitmap;
+class TileWorkerPool;
 
 
 class HWInterfaceListener {
@@ -180,6 +181,9 @@ protected:
 	// does the actual transfer and handles color space conversion
 			void				_CopyToFront(uint8* src, uint32 srcBPR, int32 x,
 									int32 y, int32 right, int32 bottom) const;
+			TileWorkerPool*		_CopyWorkers();
+	static	void				_CopyTileToFront(void* cookie,
+									const clipping_rect& tile);
 
 			IntRect				_CursorFrame() const;
 			void				_RestoreCursorArea() const;
@@ -245,6 +249,10 @@ protected:
 
 private:
 			BList				fListeners;
+
+			ObjectDeleter<TileWorkerPool>
+								fCopyWorkers;
+			int32				fCopyWorkersState;
 };
 
 #endif // HW_INTERFACE_H
@@ -27,7 +27,8 @@
 #include "IntRect.h"
 
 
-AGGTextRenderer::AGGTextRenderer(renderer_subpix_type& subpixRenderer,
+AGGTextRenderer::AGGTextRenderer(renderer_base& baseRenderer,
+		renderer_subpix_type& subpixRenderer,
 		renderer_type& solidRenderer, renderer_bin_type& binRenderer,
 		scanline_unpacked_type& scanline,
 		scanline_unpacked_subpix_type& subpixScanline,
@@ -44,6 +45,7 @@ AGGTextRenderer::AGGTextRenderer(renderer_subpix_type& subpixRenderer,
 	fCurves(fPathAdaptor),
 	fContour(fCurves),
 
+	fBaseRenderer(baseRenderer),
 	fSolidRenderer(solidRenderer),
 	fBinRenderer(binRenderer),
 	fSubpixRenderer(subpixRenderer),
@@ -256,7 +258,11 @@ public:
 						break;
 
 					case glyph_data_gray8:
-						if (fRenderer.fMaskedScanline != NULL) {
+						if (glyph->coverage != NULL
+							&& fRenderer.fMaskedScanline == NULL) {
+							_BlendCoverage(glyph, x + fTransformOffset.x,
+								y + fTransformOffset.y);
+						} else if (fRenderer.fMaskedScanline != NULL) {
 							agg::render_scanlines(fRenderer.fGray8Adaptor,
 								*fRenderer.fMaskedScanline,
 								fRenderer.fSolidRenderer);
@@ -270,9 +276,15 @@ public:
 					case glyph_data_subpix:
 						// TODO: Handle alpha mask (fRenderer.fMaskedScanline)
 						//       and remove the grayscale workaround for that.
-						agg::render_scanlines(fRenderer.fGray8Adaptor,
-							fRenderer.fGray8Scanline,
-							fRenderer.fSubpixRenderer);
+						if (glyph->coverage != NULL
+							&& fRenderer.fMaskedScanline == NULL) {
+							_BlendCoverage(glyph, x + fTransformOffset.x,
+								y + fTransformOffset.y);
+						} else {
+							agg::render_scanlines(fRenderer.fGray8Adaptor,
+								fRenderer.fGray8Scanline,
+								fRenderer.fSubpixRenderer);
+						}
 						break;
 
 					case glyph_data_outline: {
@@ -352,6 +364,57 @@ private:
 		}
 	}
 
+	// Blends the pre-rasterized coverage of a gray8 or subpix glyph, which
+	// saves replaying its scanlines. Pixels without any coverage are left
+	// alone, as they are not part of any span.
+	void _BlendCoverage(const GlyphCache* glyph, double x, double y)
+	{
+		bool subpix = glyph->data_type == glyph_data_subpix;
+		int32 bytesPerPixel = subpix ? 3 : 1;
+		int32 left = agg::iround(x) + glyph->coverage_left;
+		int32 top = agg::iround(y) + glyph->coverage_top;
+
+		int32 firstRow = max_c(0, fClippingFrame.top - top);
+		int32 lastRow = min_c(glyph->coverage_height - 1,
+			fClippingFrame.bottom - top);
+
+		const uint8* row = glyph->coverage
+			+ firstRow * glyph->coverage_bytes_per_row;
+		for (int32 i = firstRow; i <= lastRow; i++,
+				row += glyph->coverage_bytes_per_row) {
+			int32 start = 0;
+			while (start < glyph->coverage_width) {
+				// find the next run of pixels that have any coverage
+				const uint8* covers = row + start * bytesPerPixel;
+				if (covers[0] == 0 && (!subpix
+						|| (covers[1] == 0 && covers[2] == 0))) {
+					start++;
+					continue;
+				}
+
+				int32 end = start + 1;
+				for (; end < glyph->coverage_width; end++) {
+					const uint8* next = row + end * bytesPerPixel;
+					if (next[0] == 0 && (!subpix
+							|| (next[1] == 0 && next[2] == 0))) {
+						break;
+					}
+				}
+
+				if (subpix) {
+					fRenderer.fBaseRenderer.blend_solid_hspan_subpix(
+						left + start, top + i, (end - start) * 3,
+						fRenderer.fSubpixRenderer.color(), covers);
+				} else {
+					fRenderer.fBaseRenderer.blend_solid_hspan(left + start,
+						top + i, end - start,
+						fRenderer.fSolidRenderer.color(), covers);
+				}
+				start = end;
+			}
+		}
+	}
+
 private:
 	const Transformable& fTransform;
 	const BPoint&		fTransformOffset;
@@ -54,6 +54,7 @@
 
 #include "AlphaMask.h"
 #include "BitmapPainter.h"
+#include "BitmapScaling.h"
 #include "DrawingMode.h"
 #include "GlobalSubpixelSettings.h"
 #include "PatternHandler.h"
@@ -106,9 +107,21 @@ using std::nothrow;
 #define fCurve					fInternal.fCurve
 
 
-static uint32 detect_simd();
+static uint32 init_simd();
 
-uint32 gSIMDFlags = detect_simd();
+uint32 gSIMDFlags = init_simd();
+
+
+#if defined(__i386__) || defined(__x86_64__)
+static inline uint64
+read_xcr0()
+{
+	uint32 low;
+	uint32 high;
+	__asm__ volatile("xgetbv" : "=a" (low), "=d" (high) : "c" (0));
+	return ((uint64)high << 32) | low;
+}
+#endif
 
 
 /*!	Detect SIMD flags for use in AppServer. Checks all CPUs in the system
@@ -117,7 +130,7 @@ uint32 gSIMDFlags = detect_simd();
 static uint32
 detect_simd()
 {
-#if __i386__
+#if defined(__i386__) || defined(__x86_64__)
 	// Only scan CPUs for which we are certain the SIMD flags are properly
 	// defined.
 	const char* vendorNames[] = {
@@ -156,12 +169,24 @@ detect_simd()
 		uint32 cpuSIMD = 0;
 		uint32 maxStdFunc = cpuInfo.regs.eax;
 		if (vendorFound && maxStdFunc >= 1) {
-			get_cpuid(&cpuInfo, 1, 0);
+			get_cpuid(&cpuInfo, 1, cpu);
+			uint32 ecx = cpuInfo.regs.ecx;
 			uint32 edx = cpuInfo.regs.edx;
 			if (edx & (1 << 23))
 				cpuSIMD |= APPSERVER_SIMD_MMX;
 			if (edx & (1 << 25))
 				cpuSIMD |= APPSERVER_SIMD_SSE;
+			if (edx & (1 << 26))
+				cpuSIMD |= APPSERVER_SIMD_SSE2;
+
+			// AVX2 also needs the OS to save the AVX state (OSXSAVE and AVX
+			// set, and XMM and YMM state enabled in XCR0).
+			if (maxStdFunc >= 7 && (ecx & (1 << 27)) != 0
+				&& (ecx & (1 << 28)) != 0 && (read_xcr0() & 0x6) == 0x6) {
+				get_cpuid(&cpuInfo, 7, cpu);
+				if (cpuInfo.regs.ebx & (1 << 5))
+					cpuSIMD |= APPSERVER_SIMD_AVX2;
+			}
 		} else {
 			// no flags can be identified
 			cpuSIMD = 0;
@@ -169,12 +194,22 @@ detect_simd()
 		systemSIMD &= cpuSIMD;
 	}
 	return systemSIMD;
-#else	// !__i386__
+#else	// !__i386__ && !__x86_64__
 	return 0;
 #endif
 }
 
 
+static uint32
+init_simd()
+{
+	uint32 flags = detect_simd();
+	select_span_blenders(flags);
+	select_bitmap_scalers(flags);
+	return flags;
+}
+
+
 // Gradients and strings don't use patterns, but we want the special handling
 // we have for solid patterns in certain modes to get the expected results for
 // border antialiasing.
@@ -218,9 +253,9 @@ Painter::Painter()
 	fMiterLimit(B_DEFAULT_MITER_LIMIT),
 
 	fPatternHandler(),
-	fTextRenderer(fSubpixRenderer, fRenderer, fRendererBin, fUnpackedScanline,
-		fSubpixUnpackedScanline, fSubpixRasterizer, fMaskedUnpackedScanline,
-		fTransform),
+	fTextRenderer(fBaseRenderer, fSubpixRenderer, fRenderer, fRendererBin,
+		fUnpackedScanline, fSubpixUnpackedScanline, fSubpixRasterizer,
+		fMaskedUnpackedScanline, fTransform),
 	fInternal(fPatternHandler)
 {
 	fPixelFormat.SetDrawingMode(fDrawingMode, fAlphaSrcMode, fAlphaFncMode);
@@ -43,11 +43,6 @@ class ServerBitmap;
 class ServerFont;
 
 
-// Defines for SIMD support.
-#define APPSERVER_SIMD_MMX	(1 << 0)
-#define APPSERVER_SIMD_SSE	(1 << 1)
-
-
 class Painter {
 public:
 								Painter();
@@ -13,6 +13,7 @@
 #include <agg_pixfmt_rgba.h>
 #include <agg_span_image_filter_rgba.h>
 
+#include "DrawBitmapAreaAverage.h"
 #include "DrawBitmapBilinear.h"
 #include "DrawBitmapGeneric.h"
 #include "DrawBitmapNearestNeighbor.h"
@@ -137,6 +138,35 @@ Painter::BitmapPainter::Draw(const BRect& sourceRect,
 			}
 		}
 
+		// area-average downscaled, OP_COPY and OP_ALPHA with pixel alpha
+		if ((fOptions & B_FILTER_BITMAP_AREA_AVERAGE) != 0 && _IsDownscale()
+			&& !_HasAffineTransform() && !_HasAlphaMask()) {
+			if (fPainter->fDrawingMode == B_OP_COPY) {
+				DrawBitmapAreaAverage<AreaAverageRgb, DrawModeCopy> drawAverage;
+				drawAverage.Draw(fPainter, fPainter->fInternal,
+					fBitmap, fOffset, fScaleX, fScaleY, fDestinationRect);
+				return;
+			}
+			if (fPainter->fDrawingMode == B_OP_ALPHA
+				&& fPainter->fAlphaSrcMode == B_PIXEL_ALPHA
+				&& fPainter->fAlphaFncMode == B_ALPHA_OVERLAY) {
+				DrawBitmapAreaAverage<AreaAverageRgba, DrawModeAlphaOverlay>
+					drawAverage;
+				drawAverage.Draw(fPainter, fPainter->fInternal,
+					fBitmap, fOffset, fScaleX, fScaleY, fDestinationRect);
+				return;
+			}
+			if (fPainter->fDrawingMode == B_OP_ALPHA
+				&& fPainter->fAlphaSrcMode == B_PIXEL_ALPHA
+				&& fPainter->fAlphaFncMode == B_ALPHA_COMPOSITE) {
+				DrawBitmapAreaAverage<AreaAverageRgba, DrawModeAlphaComposite>
+					drawAverage;
+				drawAverage.Draw(fPainter, fPainter->fInternal,
+					fBitmap, fOffset, fScaleX, fScaleY, fDestinationRect);
+				return;
+			}
+		}
+
 		// bilinear and nearest-neighbor scaled, OP_COPY only
 		if (fPainter->fDrawingMode == B_OP_COPY
 			&& !_HasAffineTransform() && !_HasAlphaMask()) {
@@ -241,6 +271,13 @@ Painter::BitmapPainter::_HasScale()
 }
 
 
+bool
+Painter::BitmapPainter::_IsDownscale()
+{
+	return fScaleX <= 1.0 && fScaleY <= 1.0 && _HasScale();
+}
+
+
 bool
 Painter::BitmapPainter::_HasAffineTransform()
 {
@@ -0,0 +1,349 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Row kernels for scaling B_RGB32 and B_RGBA32 bitmaps. The SIMD versions
+ * produce exactly the same results as the scalar ones, which use the
+ * interpolation and blending code of the bilinear bitmap painter.
+ *
+ */
+
+#include "BitmapScaling.h"
+
+#include <math.h>
+
+#include "drawing_support.h"
+
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 5 \
+	&& !defined(__clang__)
+#	define BITMAP_SCALING_X86 1
+#	include <immintrin.h>
+#endif
+
+
+using BitmapPainterPrivate::ColorTypeRgb;
+using BitmapPainterPrivate::ColorTypeRgba;
+using BitmapPainterPrivate::DrawModeAlphaOverlay;
+using BitmapPainterPrivate::DrawModeCopy;
+using BitmapPainterPrivate::FilterInfo;
+
+
+// #pragma mark - scalar
+
+
+template<class ColorType, class DrawMode>
+static inline void
+bilinear_row(uint8* d, const uint8* top, uint32 bytesPerRow,
+	const FilterInfo* weights, uint32 count, uint16 wTop)
+{
+	const uint16 wBottom = 255 - wTop;
+
+	for (; count > 0; count--, weights++) {
+		const uint16 wLeft = weights->weight;
+		const uint16 wRight = 255 - wLeft;
+
+		uint32 t[4];
+		ColorType::Interpolate(&t[0], top + weights->index, bytesPerRow,
+			wLeft, wTop, wRight, wBottom);
+		DrawMode::Blend(d, &t[0]);
+	}
+}
+
+
+static void
+bilinear_copy_row_scalar(uint8* d, const uint8* top, uint32 bytesPerRow,
+	const FilterInfo* weights, uint32 count, uint16 wTop)
+{
+	bilinear_row<ColorTypeRgb, DrawModeCopy>(d, top, bytesPerRow, weights,
+		count, wTop);
+}
+
+
+static void
+bilinear_alpha_row_scalar(uint8* d, const uint8* top, uint32 bytesPerRow,
+	const FilterInfo* weights, uint32 count, uint16 wTop)
+{
+	bilinear_row<ColorTypeRgba, DrawModeAlphaOverlay>(d, top, bytesPerRow,
+		weights, count, wTop);
+}
+
+
+static const bitmap_scalers kScalarBitmapScalers = {
+	bilinear_copy_row_scalar,
+	bilinear_alpha_row_scalar,
+	false
+};
+
+
+#ifdef BITMAP_SCALING_X86
+
+
+// #pragma mark - SSE2
+
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+namespace sse2 {
+
+typedef __m128i vector;
+static const uint32 kPixels = 4;
+
+static inline vector v_zero() { return _mm_setzero_si128(); }
+static inline vector v_set1_16(uint16 value)
+	{ return _mm_set1_epi16((short)value); }
+static inline vector v_set1_32(uint32 value)
+	{ return _mm_set1_epi32((int)value); }
+static inline vector v_load(const void* p)
+	{ return _mm_loadu_si128((const __m128i*)p); }
+static inline void v_store(void* p, vector v)
+	{ _mm_storeu_si128((__m128i*)p, v); }
+
+static inline vector
+v_load_neighbours(const uint8* row, const FilterInfo* weights)
+{
+	// the left pixels of weights[0] and weights[1] in the low half, their
+	// right neighbours in the high half
+	return _mm_unpacklo_epi32(
+		_mm_loadl_epi64((const __m128i*)(row + weights[0].index)),
+		_mm_loadl_epi64((const __m128i*)(row + weights[1].index)));
+}
+
+static inline vector
+v_load_weights(const FilterInfo* weights)
+{
+	// replicate the weights of weights[0] and weights[1] into the four
+	// words of their pixel
+	vector v = _mm_loadl_epi64((const __m128i*)weights);
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 1, 1));
+	return _mm_unpacklo_epi32(v, v);
+}
+
+static inline vector v_unpacklo8(vector a, vector b)
+	{ return _mm_unpacklo_epi8(a, b); }
+static inline vector v_unpackhi8(vector a, vector b)
+	{ return _mm_unpackhi_epi8(a, b); }
+static inline vector v_packus16(vector a, vector b)
+	{ return _mm_packus_epi16(a, b); }
+static inline vector v_add16(vector a, vector b)
+	{ return _mm_add_epi16(a, b); }
+static inline vector v_sub16(vector a, vector b)
+	{ return _mm_sub_epi16(a, b); }
+static inline vector v_mullo16(vector a, vector b)
+	{ return _mm_mullo_epi16(a, b); }
+static inline vector v_mulhi_u16(vector a, vector b)
+	{ return _mm_mulhi_epu16(a, b); }
+static inline vector v_srli16_8(vector a)
+	{ return _mm_srli_epi16(a, 8); }
+static inline vector v_cmpeq16(vector a, vector b)
+	{ return _mm_cmpeq_epi16(a, b); }
+static inline vector v_cmpgt16(vector a, vector b)
+	{ return _mm_cmpgt_epi16(a, b); }
+static inline vector v_and(vector a, vector b)
+	{ return _mm_and_si128(a, b); }
+static inline vector v_andnot(vector a, vector b)
+	{ return _mm_andnot_si128(a, b); }
+static inline vector v_or(vector a, vector b)
+	{ return _mm_or_si128(a, b); }
+static inline vector v_xor(vector a, vector b)
+	{ return _mm_xor_si128(a, b); }
+
+static inline vector
+v_broadcast_alpha16(vector v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+	return _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+#include "BitmapScalingSIMD.h"
+
+}	// namespace sse2
+
+#pragma GCC pop_options
+
+
+// #pragma mark - AVX2
+
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace avx2 {
+
+typedef __m256i vector;
+static const uint32 kPixels = 8;
+
+static inline vector v_zero() { return _mm256_setzero_si256(); }
+static inline vector v_set1_16(uint16 value)
+	{ return _mm256_set1_epi16((short)value); }
+static inline vector v_set1_32(uint32 value)
+	{ return _mm256_set1_epi32((int)value); }
+static inline vector v_load(const void* p)
+	{ return _mm256_loadu_si256((const __m256i*)p); }
+static inline void v_store(void* p, vector v)
+	{ _mm256_storeu_si256((__m256i*)p, v); }
+
+static inline __m128i
+load_neighbours(const uint8* row, const FilterInfo* weights)
+{
+	return _mm_unpacklo_epi32(
+		_mm_loadl_epi64((const __m128i*)(row + weights[0].index)),
+		_mm_loadl_epi64((const __m128i*)(row + weights[1].index)));
+}
+
+static inline vector
+v_load_neighbours(const uint8* row, const FilterInfo* weights)
+{
+	// the pixels of weights[0] and weights[1] in the low lane, and the
+	// ones of weights[4] and weights[5] in the high lane, so that packing
+	// two of these vectors puts all pixels in order
+	return _mm256_inserti128_si256(
+		_mm256_castsi128_si256(load_neighbours(row, weights)),
+		load_neighbours(row, weights + 4), 1);
+}
+
+static inline __m128i
+load_weights(const FilterInfo* weights)
+{
+	__m128i v = _mm_loadl_epi64((const __m128i*)weights);
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 1, 1));
+	return _mm_unpacklo_epi32(v, v);
+}
+
+static inline vector
+v_load_weights(const FilterInfo* weights)
+{
+	return _mm256_inserti128_si256(
+		_mm256_castsi128_si256(load_weights(weights)),
+		load_weights(weights + 4), 1);
+}
+
+static inline vector v_unpacklo8(vector a, vector b)
+	{ return _mm256_unpacklo_epi8(a, b); }
+static inline vector v_unpackhi8(vector a, vector b)
+	{ return _mm256_unpackhi_epi8(a, b); }
+static inline vector v_packus16(vector a, vector b)
+	{ return _mm256_packus_epi16(a, b); }
+static inline vector v_add16(vector a, vector b)
+	{ return _mm256_add_epi16(a, b); }
+static inline vector v_sub16(vector a, vector b)
+	{ return _mm256_sub_epi16(a, b); }
+static inline vector v_mullo16(vector a, vector b)
+	{ return _mm256_mullo_epi16(a, b); }
+static inline vector v_mulhi_u16(vector a, vector b)
+	{ return _mm256_mulhi_epu16(a, b); }
+static inline vector v_srli16_8(vector a)
+	{ return _mm256_srli_epi16(a, 8); }
+static inline vector v_cmpeq16(vector a, vector b)
+	{ return _mm256_cmpeq_epi16(a, b); }
+static inline vector v_cmpgt16(vector a, vector b)
+	{ return _mm256_cmpgt_epi16(a, b); }
+static inline vector v_and(vector a, vector b)
+	{ return _mm256_and_si256(a, b); }
+static inline vector v_andnot(vector a, vector b)
+	{ return _mm256_andnot_si256(a, b); }
+static inline vector v_or(vector a, vector b)
+	{ return _mm256_or_si256(a, b); }
+static inline vector v_xor(vector a, vector b)
+	{ return _mm256_xor_si256(a, b); }
+
+static inline vector
+v_broadcast_alpha16(vector v)
+{
+	v = _mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+	return _mm256_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+#include "BitmapScalingSIMD.h"
+
+}	// namespace avx2
+
+#pragma GCC pop_options
+
+
+static const bitmap_scalers kSSE2BitmapScalers = {
+	sse2::bilinear_copy_row,
+	sse2::bilinear_alpha_row,
+	true
+};
+
+
+static const bitmap_scalers kAVX2BitmapScalers = {
+	avx2::bilinear_copy_row,
+	avx2::bilinear_alpha_row,
+	true
+};
+
+
+#endif	// BITMAP_SCALING_X86
+
+
+// #pragma mark - linear light
+
+
+static uint16 sSRGBToLinear[256];
+static uint8 sLinearToSRGB[16384];
+
+
+static const uint16*
+init_linear_light_tables()
+{
+	for (int32 i = 0; i < 256; i++) {
+		double value = i / 255.0;
+		if (value <= 0.04045)
+			value /= 12.92;
+		else
+			value = pow((value + 0.055) / 1.055, 2.4);
+		sSRGBToLinear[i] = (uint16)(value * 65535.0 + 0.5);
+	}
+
+	for (int32 i = 0; i < 16384; i++) {
+		// the center of the range of linear values that map to this entry
+		double value = (i * 4 + 1.5) / 65535.0;
+		if (value <= 0.0031308)
+			value *= 12.92;
+		else
+			value = 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+		sLinearToSRGB[i] = (uint8)min_c(value * 255.0 + 0.5, 255.0);
+	}
+
+	return sSRGBToLinear;
+}
+
+
+const uint16* gSRGBToLinear = init_linear_light_tables();
+const uint8* gLinearToSRGB = sLinearToSRGB;
+
+
+// #pragma mark -
+
+
+// This is statically initialized, so that select_bitmap_scalers() can be used
+// from other static initializers.
+bitmap_scalers gBitmapScalers = {
+	bilinear_copy_row_scalar,
+	bilinear_alpha_row_scalar,
+	false
+};
+
+
+const bitmap_scalers*
+bitmap_scalers_for(uint32 simdFlags)
+{
+#ifdef BITMAP_SCALING_X86
+	if ((simdFlags & APPSERVER_SIMD_AVX2) != 0)
+		return &kAVX2BitmapScalers;
+	if ((simdFlags & APPSERVER_SIMD_SSE2) != 0)
+		return &kSSE2BitmapScalers;
+#endif
+
+	return &kScalarBitmapScalers;
+}
+
+
+void
+select_bitmap_scalers(uint32 simdFlags)
+{
+	gBitmapScalers = *bitmap_scalers_for(simdFlags);
+}
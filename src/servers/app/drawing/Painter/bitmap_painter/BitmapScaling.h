@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Row kernels for scaling B_RGB32 and B_RGBA32 bitmaps, with SIMD
+ * implementations that are selected at runtime, and the tables for
+ * filtering in linear light.
+ *
+ */
+
+#ifndef BITMAP_SCALING_H
+#define BITMAP_SCALING_H
+
+#include <SupportDefs.h>
+
+
+namespace BitmapPainterPrivate {
+
+
+struct FilterInfo {
+	uint16 index;	// index into source bitmap row/column
+	uint16 weight;	// weight of the pixel at index [0..255]
+};
+
+
+struct ColorTypeRgb {
+	static void
+	Interpolate(uint32* t, const uint8* s, uint32 sourceBytesPerRow,
+		uint16 wLeft, uint16 wTop, uint16 wRight, uint16 wBottom)
+	{
+		// left and right of top row
+		t[0] = (s[0] * wLeft + s[4] * wRight) * wTop;
+		t[1] = (s[1] * wLeft + s[5] * wRight) * wTop;
+		t[2] = (s[2] * wLeft + s[6] * wRight) * wTop;
+
+		// left and right of bottom row
+		s += sourceBytesPerRow;
+		t[0] += (s[0] * wLeft + s[4] * wRight) * wBottom;
+		t[1] += (s[1] * wLeft + s[5] * wRight) * wBottom;
+		t[2] += (s[2] * wLeft + s[6] * wRight) * wBottom;
+
+		t[0] >>= 16;
+		t[1] >>= 16;
+		t[2] >>= 16;
+	}
+
+	static void
+	InterpolateLastColumn(uint32* t, const uint8* s, const uint8* sBottom,
+		uint16 wTop, uint16 wBottom)
+	{
+		t[0] = (s[0] * wTop + sBottom[0] * wBottom) >> 8;
+		t[1] = (s[1] * wTop + sBottom[1] * wBottom) >> 8;
+		t[2] = (s[2] * wTop + sBottom[2] * wBottom) >> 8;
+	}
+
+	static void
+	InterpolateLastRow(uint32* t, const uint8* s, uint16 wLeft,
+		uint16 wRight)
+	{
+		t[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
+		t[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
+		t[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
+	}
+};
+
+
+struct ColorTypeRgba {
+	static void
+	Interpolate(uint32* t, const uint8* s, uint32 sourceBytesPerRow,
+		uint16 wLeft, uint16 wTop, uint16 wRight, uint16 wBottom)
+	{
+		// left and right of top row
+		t[0] = (s[0] * wLeft + s[4] * wRight) * wTop;
+		t[1] = (s[1] * wLeft + s[5] * wRight) * wTop;
+		t[2] = (s[2] * wLeft + s[6] * wRight) * wTop;
+		t[3] = (s[3] * wLeft + s[7] * wRight) * wTop;
+
+		// left and right of bottom row
+		s += sourceBytesPerRow;
+
+		t[0] += (s[0] * wLeft + s[4] * wRight) * wBottom;
+		t[1] += (s[1] * wLeft + s[5] * wRight) * wBottom;
+		t[2] += (s[2] * wLeft + s[6] * wRight) * wBottom;
+		t[3] += (s[3] * wLeft + s[7] * wRight) * wBottom;
+
+		t[0] >>= 16;
+		t[1] >>= 16;
+		t[2] >>= 16;
+		t[3] >>= 16;
+	}
+
+	static void
+	InterpolateLastColumn(uint32* t, const uint8* s, const uint8* sBottom,
+		uint16 wTop, uint16 wBottom)
+	{
+		t[0] = (s[0] * wTop + sBottom[0] * wBottom) >> 8;
+		t[1] = (s[1] * wTop + sBottom[1] * wBottom) >> 8;
+		t[2] = (s[2] * wTop + sBottom[2] * wBottom) >> 8;
+		t[3] = (s[3] * wTop + sBottom[3] * wBottom) >> 8;
+	}
+
+	static void
+	InterpolateLastRow(uint32* t, const uint8* s, uint16 wLeft,
+		uint16 wRight)
+	{
+		t[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
+		t[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
+		t[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
+		t[3] = (s[3] * wLeft + s[7] * wRight) >> 8;
+	}
+};
+
+
+struct DrawModeCopy {
+	static void
+	Blend(uint8*& d, uint32* t)
+	{
+		d[0] = t[0];
+		d[1] = t[1];
+		d[2] = t[2];
+		d += 4;
+	}
+};
+
+
+struct DrawModeAlphaOverlay {
+	static void
+	Blend(uint8*& d, uint32* t)
+	{
+		uint8 t0 = t[0];
+		uint8 t1 = t[1];
+		uint8 t2 = t[2];
+		uint8 t3 = t[3];
+
+		if (t3 == 255) {
+			d[0] = t0;
+			d[1] = t1;
+			d[2] = t2;
+		} else {
+			d[0] = ((t0 - d[0]) * t3 + (d[0] << 8)) >> 8;
+			d[1] = ((t1 - d[1]) * t3 + (d[1] << 8)) >> 8;
+			d[2] = ((t2 - d[2]) * t3 + (d[2] << 8)) >> 8;
+		}
+
+		d += 4;
+	}
+};
+
+
+} // namespace BitmapPainterPrivate
+
+
+// Both kernels interpolate "count" destination pixels of a row from the
+// source rows at "top" and "top + bytesPerRow", using the horizontal
+// "weights" and the weight "wTop" of the top row. Every pixel needs its
+// right neighbour in the source, so the last column of the source, which
+// has a weight of 255, must not be passed.
+// The destination alpha is left alone, exactly like in
+// ColorTypeRgb/DrawModeCopy and ColorTypeRgba/DrawModeAlphaOverlay.
+typedef void (*bilinear_row_function)(uint8* d, const uint8* top,
+	uint32 bytesPerRow, const BitmapPainterPrivate::FilterInfo* weights,
+	uint32 count, uint16 wTop);
+
+struct bitmap_scalers {
+	bilinear_row_function	bilinear_copy_row;
+	bilinear_row_function	bilinear_alpha_row;
+	bool					accelerated;
+};
+
+
+// The kernels in use, initialized to the scalar versions.
+extern bitmap_scalers gBitmapScalers;
+
+// Returns the fastest kernels supported by the given APPSERVER_SIMD_* flags.
+const bitmap_scalers* bitmap_scalers_for(uint32 simdFlags);
+
+// Makes gBitmapScalers use the kernels for the given flags.
+void select_bitmap_scalers(uint32 simdFlags);
+
+
+// Convert between sRGB encoded 8 bit values and 16 bit linear light. The
+// linear values are looked up with a precision of 14 bits, which keeps the
+// round trip exact.
+extern const uint16* gSRGBToLinear;
+extern const uint8* gLinearToSRGB;
+
+
+static inline uint8
+linear_to_srgb(uint16 value)
+{
+	return gLinearToSRGB[value >> 2];
+}
+
+
+#endif // BITMAP_SCALING_H
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * The bilinear row kernels, written against a small set of vector
+ * primitives. This file is included once per instruction set by
+ * BitmapScaling.cpp, which defines the "vector" type, "kPixels" (the pixels
+ * per vector) and the v_*() primitives in the enclosing namespace.
+ *
+ * A row is processed in blocks of kPixels pixels, which are interpolated as
+ * two halves of 16 bit words per channel. v_load_neighbours() and
+ * v_load_weights() of "weights" and "weights + 2" return the halves in the
+ * order in which v_packus16() puts them together again.
+ *
+ */
+
+
+// (a * wa + b * wb) >> 16, computed from the high and low words of both
+// products. The result must fit into 16 bits.
+static inline vector
+weighted_sum16(vector a, vector wa, vector b, vector wb)
+{
+	vector low1 = v_mullo16(a, wa);
+	vector low = v_add16(low1, v_mullo16(b, wb));
+
+	// the sum of the low words overflowed if it is below one of them
+	vector bias = v_set1_16(0x8000);
+	vector carry = v_cmpgt16(v_xor(low1, bias), v_xor(low, bias));
+
+	return v_sub16(v_add16(v_mulhi_u16(a, wa), v_mulhi_u16(b, wb)), carry);
+}
+
+
+// Equals ColorType::Interpolate() for all four channels of half a block.
+static inline vector
+interpolate_half(const uint8* top, uint32 bytesPerRow,
+	const FilterInfo* weights, vector wTop, vector wBottom)
+{
+	const vector zero = v_zero();
+	vector wLeft = v_load_weights(weights);
+	vector wRight = v_sub16(v_set1_16(255), wLeft);
+
+	// left * wLeft + right * wRight cannot overflow 16 bits, since the
+	// weights add up to 255
+	vector t = v_load_neighbours(top, weights);
+	vector hTop = v_add16(v_mullo16(v_unpacklo8(t, zero), wLeft),
+		v_mullo16(v_unpackhi8(t, zero), wRight));
+
+	vector b = v_load_neighbours(top + bytesPerRow, weights);
+	vector hBottom = v_add16(v_mullo16(v_unpacklo8(b, zero), wLeft),
+		v_mullo16(v_unpackhi8(b, zero), wRight));
+
+	return weighted_sum16(hTop, wTop, hBottom, wBottom);
+}
+
+
+// Equals DrawModeAlphaOverlay::Blend(), as (t * a + d * (256 - a)) >> 8,
+// which cannot overflow 16 bits.
+static inline vector
+blend_alpha_overlay(vector source, vector dest)
+{
+	vector alpha = v_broadcast_alpha16(source);
+	vector result = v_srli16_8(v_add16(v_mullo16(source, alpha),
+		v_mullo16(dest, v_sub16(v_set1_16(256), alpha))));
+
+	vector assign = v_cmpeq16(alpha, v_set1_16(255));
+	return v_or(v_and(assign, source), v_andnot(assign, result));
+}
+
+
+static void
+bilinear_copy_row(uint8* d, const uint8* top, uint32 bytesPerRow,
+	const FilterInfo* weights, uint32 count, uint16 wTop)
+{
+	const vector top16 = v_set1_16(wTop);
+	const vector bottom16 = v_set1_16(255 - wTop);
+	const vector alphaMask = v_set1_32(0xff000000);
+
+	for (; count >= kPixels; count -= kPixels, d += kPixels * 4,
+			weights += kPixels) {
+		vector lo = interpolate_half(top, bytesPerRow, weights, top16,
+			bottom16);
+		vector hi = interpolate_half(top, bytesPerRow, weights + 2, top16,
+			bottom16);
+
+		// keep the alpha of the destination
+		v_store(d, v_or(v_andnot(alphaMask, v_packus16(lo, hi)),
+			v_and(alphaMask, v_load(d))));
+	}
+
+	if (count > 0) {
+		bilinear_copy_row_scalar(d, top, bytesPerRow, weights, count,
+			wTop);
+	}
+}
+
+
+static void
+bilinear_alpha_row(uint8* d, const uint8* top, uint32 bytesPerRow,
+	const FilterInfo* weights, uint32 count, uint16 wTop)
+{
+	const vector zero = v_zero();
+	const vector top16 = v_set1_16(wTop);
+	const vector bottom16 = v_set1_16(255 - wTop);
+	const vector alphaMask = v_set1_32(0xff000000);
+
+	for (; count >= kPixels; count -= kPixels, d += kPixels * 4,
+			weights += kPixels) {
+		vector lo = interpolate_half(top, bytesPerRow, weights, top16,
+			bottom16);
+		vector hi = interpolate_half(top, bytesPerRow, weights + 2, top16,
+			bottom16);
+
+		vector dest = v_load(d);
+		lo = blend_alpha_overlay(lo, v_unpacklo8(dest, zero));
+		hi = blend_alpha_overlay(hi, v_unpackhi8(dest, zero));
+
+		// keep the alpha of the destination
+		v_store(d, v_or(v_andnot(alphaMask, v_packus16(lo, hi)),
+			v_and(alphaMask, dest)));
+	}
+
+	if (count > 0) {
+		bilinear_alpha_row_scalar(d, top, bytesPerRow, weights, count,
+			wTop);
+	}
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef DRAW_BITMAP_AREA_AVERAGE_H
+#define DRAW_BITMAP_AREA_AVERAGE_H
+
+#include "Painter.h"
+
+#include <string.h>
+
+#include <AutoDeleter.h>
+
+#include "BitmapScaling.h"
+
+
+namespace BitmapPainterPrivate {
+
+
+// The source pixels covered by a destination pixel, along one axis. The
+// weights are the coverage of a source pixel in 1/256th, only the first and
+// the last pixel may be partially covered.
+struct AreaInfo {
+	uint32 first;		// first source pixel of the area
+	uint32 count;		// number of source pixels in the area
+	uint16 firstWeight;	// weight of the first pixel [1..256]
+	uint16 lastWeight;	// weight of the last pixel [1..256]
+	uint32 total;		// sum of all weights
+};
+
+
+static inline uint32
+area_weight(const AreaInfo& area, uint32 i)
+{
+	if (i == 0)
+		return area.firstWeight;
+	if (i == area.count - 1)
+		return area.lastWeight;
+	return 256;
+}
+
+
+static inline void
+compute_areas(AreaInfo* areas, uint32 count, uint32 indexOffset,
+	int32 bitmapShift, double scale, uint32 sourceSize)
+{
+	const uint32 limit = sourceSize << 8;
+
+	for (uint32 i = 0; i < count; i++) {
+		// the edges of the destination pixel in the source, in 1/256th
+		double left = ((i + indexOffset) / scale + bitmapShift) * 256;
+		double right = ((i + indexOffset + 1) / scale + bitmapShift) * 256;
+		uint32 start = (uint32)max_c(left + 0.5, 0.0);
+		uint32 end = (uint32)max_c(right + 0.5, 0.0);
+		start = min_c(start, limit - 1);
+		end = min_c(max_c(end, start + 1), limit);
+
+		AreaInfo& area = areas[i];
+		area.first = start >> 8;
+		area.count = ((end - 1) >> 8) - area.first + 1;
+		area.total = end - start;
+		if (area.count == 1) {
+			area.firstWeight = area.total;
+			area.lastWeight = area.total;
+		} else {
+			area.firstWeight = 256 - (start & 0xff);
+			area.lastWeight = end - ((end - 1) & ~(uint32)0xff);
+		}
+	}
+}
+
+
+// Averages opaque pixels, the source alpha is ignored. The column sums hold
+// the linear light of the blue, green and red channel.
+struct AreaAverageRgb {
+	static void
+	AccumulateRow(uint64* sums, const uint8* s, uint32 count, uint32 weight)
+	{
+		for (; count > 0; count--, sums += 4, s += 4) {
+			sums[0] += gSRGBToLinear[s[0]] * weight;
+			sums[1] += gSRGBToLinear[s[1]] * weight;
+			sums[2] += gSRGBToLinear[s[2]] * weight;
+		}
+	}
+
+	static void
+	NormalizeColumns(uint64* sums, uint32 count, uint32 total)
+	{
+		for (; count > 0; count--, sums += 4) {
+			sums[0] /= total;
+			sums[1] /= total;
+			sums[2] /= total;
+		}
+	}
+
+	static void
+	Resolve(uint32* t, const uint64* sums, const AreaInfo& area)
+	{
+		uint64 b = 0;
+		uint64 g = 0;
+		uint64 r = 0;
+		for (uint32 i = 0; i < area.count; i++, sums += 4) {
+			const uint32 weight = area_weight(area, i);
+			b += sums[0] * weight;
+			g += sums[1] * weight;
+			r += sums[2] * weight;
+		}
+
+		t[0] = linear_to_srgb(b / area.total);
+		t[1] = linear_to_srgb(g / area.total);
+		t[2] = linear_to_srgb(r / area.total);
+		t[3] = 255;
+	}
+};
+
+
+// Averages pixels weighted by their alpha, so that the color of transparent
+// pixels does not bleed into the result. The column sums hold the alpha
+// weighted linear light of the blue, green and red channel, and the alpha.
+struct AreaAverageRgba {
+	static void
+	AccumulateRow(uint64* sums, const uint8* s, uint32 count, uint32 weight)
+	{
+		for (; count > 0; count--, sums += 4, s += 4) {
+			const uint64 alpha = s[3] * weight;
+			sums[0] += gSRGBToLinear[s[0]] * alpha;
+			sums[1] += gSRGBToLinear[s[1]] * alpha;
+			sums[2] += gSRGBToLinear[s[2]] * alpha;
+			sums[3] += alpha;
+		}
+	}
+
+	static void
+	NormalizeColumns(uint64* sums, uint32 count, uint32 total)
+	{
+		// keeps the sums small enough to be weighted again in Resolve(),
+		// the alpha keeps 8 bits of fractional precision
+		for (; count > 0; count--, sums += 4) {
+			sums[0] /= total;
+			sums[1] /= total;
+			sums[2] /= total;
+			sums[3] = (sums[3] << 8) / total;
+		}
+	}
+
+	static void
+	Resolve(uint32* t, const uint64* sums, const AreaInfo& area)
+	{
+		uint64 b = 0;
+		uint64 g = 0;
+		uint64 r = 0;
+		uint64 a = 0;
+		for (uint32 i = 0; i < area.count; i++, sums += 4) {
+			const uint32 weight = area_weight(area, i);
+			b += sums[0] * weight;
+			g += sums[1] * weight;
+			r += sums[2] * weight;
+			a += sums[3] * weight;
+		}
+
+		if (a == 0) {
+			t[0] = t[1] = t[2] = t[3] = 0;
+			return;
+		}
+
+		t[0] = linear_to_srgb(min_c((b << 8) / a, 65535));
+		t[1] = linear_to_srgb(min_c((g << 8) / a, 65535));
+		t[2] = linear_to_srgb(min_c((r << 8) / a, 65535));
+		t[3] = (a + ((uint64)area.total << 7)) / ((uint64)area.total << 8);
+	}
+};
+
+
+// Implements B_OP_ALPHA with B_PIXEL_ALPHA and B_ALPHA_COMPOSITE, like the
+// BLEND_COMPOSITE macro.
+struct DrawModeAlphaComposite {
+	static void
+	Blend(uint8*& d, uint32* t)
+	{
+		const uint8 t0 = t[0];
+		const uint8 t1 = t[1];
+		const uint8 t2 = t[2];
+		const uint8 alpha = t[3];
+
+		if (alpha == 255) {
+			d[0] = t0;
+			d[1] = t1;
+			d[2] = t2;
+			d[3] = 255;
+		} else if (alpha > 0) {
+			if (d[3] == 255) {
+				d[0] = ((t0 - d[0]) * alpha + (d[0] << 8)) >> 8;
+				d[1] = ((t1 - d[1]) * alpha + (d[1] << 8)) >> 8;
+				d[2] = ((t2 - d[2]) * alpha + (d[2] << 8)) >> 8;
+			} else if (d[3] == 0) {
+				d[0] = t0;
+				d[1] = t1;
+				d[2] = t2;
+				d[3] = alpha;
+			} else {
+				uint8 alphaRest = 255 - alpha;
+				uint32 alphaTemp = 65025 - alphaRest * (255 - d[3]);
+				uint32 alphaDest = d[3] * alphaRest;
+				uint32 alphaSrc = 255 * alpha;
+				d[0] = (d[0] * alphaDest + t0 * alphaSrc) / alphaTemp;
+				d[1] = (d[1] * alphaDest + t1 * alphaSrc) / alphaTemp;
+				d[2] = (d[2] * alphaDest + t2 * alphaSrc) / alphaTemp;
+				d[3] = alphaTemp / 255;
+			}
+		}
+
+		d += 4;
+	}
+};
+
+
+// Downscales by averaging all source pixels covered by a destination pixel,
+// in linear light. Unlike bilinear filtering, every source pixel contributes,
+// so that large reductions do not alias.
+template<class ColorType, class DrawMode>
+struct DrawBitmapAreaAverage {
+	void
+	Draw(const Painter* painter, PainterAggInterface& aggInterface,
+		agg::rendering_buffer& bitmap, BPoint offset,
+		double scaleX, double scaleY, BRect destinationRect)
+	{
+		uint32 dstWidth = destinationRect.IntegerWidth() + 1;
+		uint32 dstHeight = destinationRect.IntegerHeight() + 1;
+
+		// Do not calculate more areas than necessary
+		const BRegion& clippingRegion = *painter->ClippingRegion();
+		if (clippingRegion.Frame().IntegerWidth() + 1 < (int32)dstWidth)
+			dstWidth = clippingRegion.Frame().IntegerWidth() + 1;
+		if (clippingRegion.Frame().IntegerHeight() + 1 < (int32)dstHeight)
+			dstHeight = clippingRegion.Frame().IntegerHeight() + 1;
+
+		// When calculating less areas than specified by destinationRect, we
+		// need to compensate the offset.
+		uint32 indexOffsetX = 0;
+		uint32 indexOffsetY = 0;
+		if (clippingRegion.Frame().left > destinationRect.left) {
+			indexOffsetX = (int32)(clippingRegion.Frame().left
+				- destinationRect.left);
+		}
+		if (clippingRegion.Frame().top > destinationRect.top) {
+			indexOffsetY = (int32)(clippingRegion.Frame().top
+				- destinationRect.top);
+		}
+
+		AreaInfo* areasX = new(std::nothrow) AreaInfo[dstWidth];
+		AreaInfo* areasY = new(std::nothrow) AreaInfo[dstHeight];
+		ArrayDeleter<AreaInfo> areasXDeleter(areasX);
+		ArrayDeleter<AreaInfo> areasYDeleter(areasY);
+		if (areasX == NULL || areasY == NULL)
+			return;
+
+		// Extract the cropping information for the source bitmap,
+		// If only a part of the source bitmap is to be drawn with scale,
+		// the offset will be different from the destinationRect left top
+		// corner.
+		const int32 xBitmapShift = (int32)(destinationRect.left - offset.x);
+		const int32 yBitmapShift = (int32)(destinationRect.top - offset.y);
+
+		compute_areas(areasX, dstWidth, indexOffsetX, xBitmapShift, scaleX,
+			bitmap.width());
+		compute_areas(areasY, dstHeight, indexOffsetY, yBitmapShift, scaleY,
+			bitmap.height());
+
+		// the column sums of one destination row, for all source columns
+		// any of the areas touch
+		const uint32 columnBase = areasX[0].first;
+		const uint32 columnCount = areasX[dstWidth - 1].first
+			+ areasX[dstWidth - 1].count - columnBase;
+		uint64* columns = new(std::nothrow) uint64[columnCount * 4];
+		ArrayDeleter<uint64> columnsDeleter(columns);
+		if (columns == NULL)
+			return;
+
+		const int32 left = (int32)destinationRect.left;
+		const int32 top = (int32)destinationRect.top;
+		const int32 right = (int32)destinationRect.right;
+		const int32 bottom = (int32)destinationRect.bottom;
+
+		renderer_base& baseRenderer = aggInterface.fBaseRenderer;
+
+		// iterate over clipping boxes
+		baseRenderer.first_clip_box();
+		do {
+			const int32 x1 = max_c(baseRenderer.xmin(), left);
+			const int32 x2 = min_c(baseRenderer.xmax(), right);
+			if (x1 > x2)
+				continue;
+
+			const int32 y1 = max_c(baseRenderer.ymin(), top);
+			const int32 y2 = min_c(baseRenderer.ymax(), bottom);
+			if (y1 > y2)
+				continue;
+
+			// x and y are needed as indices into the area arrays
+			const int32 xIndexL = x1 - left - indexOffsetX;
+			const int32 xIndexR = x2 - left - indexOffsetX;
+			const int32 yIndexT = y1 - top - indexOffsetY;
+			const int32 yIndexB = y2 - top - indexOffsetY;
+
+			const uint32 firstColumn = areasX[xIndexL].first;
+			const uint32 count = areasX[xIndexR].first + areasX[xIndexR].count
+				- firstColumn;
+			uint64* sums = columns + (firstColumn - columnBase) * 4;
+
+			uint8* destination = aggInterface.fBuffer.row_ptr(y1) + x1 * 4;
+
+			for (int32 y = yIndexT; y <= yIndexB; y++) {
+				const AreaInfo& areaY = areasY[y];
+
+				memset(sums, 0, count * 4 * sizeof(uint64));
+				for (uint32 i = 0; i < areaY.count; i++) {
+					ColorType::AccumulateRow(sums,
+						bitmap.row_ptr(areaY.first + i) + firstColumn * 4,
+						count, area_weight(areaY, i));
+				}
+				ColorType::NormalizeColumns(sums, count, areaY.total);
+
+				uint8* d = destination;
+				for (int32 x = xIndexL; x <= xIndexR; x++) {
+					const AreaInfo& areaX = areasX[x];
+
+					uint32 t[4];
+					ColorType::Resolve(&t[0],
+						columns + (areaX.first - columnBase) * 4, areaX);
+					DrawMode::Blend(d, &t[0]);
+				}
+
+				destination += aggInterface.fBuffer.stride();
+			}
+		} while (baseRenderer.next_clip_box());
+	}
+};
+
+
+} // namespace BitmapPainterPrivate
+
+
+#endif // DRAW_BITMAP_AREA_AVERAGE_H
@@ -12,6 +12,8 @@
 
 #include <typeinfo>
 
+#include "BitmapScaling.h"
+
 
 // Prototypes for assembler routines
 extern "C" {
@@ -26,12 +28,6 @@ extern uint32 gSIMDFlags;
 namespace BitmapPainterPrivate {
 
 
-struct FilterInfo {
-	uint16 index;	// index into source bitmap row/column
-	uint16 weight;	// weight of the pixel at index [0..255]
-};
-
-
 struct FilterData {
 	FilterInfo* fWeightsX;
 	FilterInfo* fWeightsY;
@@ -101,126 +97,27 @@ protected:
 };
 
 
-struct ColorTypeRgb {
-	static void
-	Interpolate(uint32* t, const uint8* s, uint32 sourceBytesPerRow,
-		uint16 wLeft, uint16 wTop, uint16 wRight, uint16 wBottom)
-	{
-		// left and right of top row
-		t[0] = (s[0] * wLeft + s[4] * wRight) * wTop;
-		t[1] = (s[1] * wLeft + s[5] * wRight) * wTop;
-		t[2] = (s[2] * wLeft + s[6] * wRight) * wTop;
-
-		// left and right of bottom row
-		s += sourceBytesPerRow;
-		t[0] += (s[0] * wLeft + s[4] * wRight) * wBottom;
-		t[1] += (s[1] * wLeft + s[5] * wRight) * wBottom;
-		t[2] += (s[2] * wLeft + s[6] * wRight) * wBottom;
-
-		t[0] >>= 16;
-		t[1] >>= 16;
-		t[2] >>= 16;
-	}
-
-	static void
-	InterpolateLastColumn(uint32* t, const uint8* s, const uint8* sBottom,
-		uint16 wTop, uint16 wBottom)
-	{
-		t[0] = (s[0] * wTop + sBottom[0] * wBottom) >> 8;
-		t[1] = (s[1] * wTop + sBottom[1] * wBottom) >> 8;
-		t[2] = (s[2] * wTop + sBottom[2] * wBottom) >> 8;
-	}
-
-	static void
-	InterpolateLastRow(uint32* t, const uint8* s, uint16 wLeft,
-		uint16 wRight)
-	{
-		t[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
-		t[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
-		t[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
-	}
-};
-
-
-struct ColorTypeRgba {
-	static void
-	Interpolate(uint32* t, const uint8* s, uint32 sourceBytesPerRow,
-		uint16 wLeft, uint16 wTop, uint16 wRight, uint16 wBottom)
-	{
-		// left and right of top row
-		t[0] = (s[0] * wLeft + s[4] * wRight) * wTop;
-		t[1] = (s[1] * wLeft + s[5] * wRight) * wTop;
-		t[2] = (s[2] * wLeft + s[6] * wRight) * wTop;
-		t[3] = (s[3] * wLeft + s[7] * wRight) * wTop;
-
-		// left and right of bottom row
-		s += sourceBytesPerRow;
-
-		t[0] += (s[0] * wLeft + s[4] * wRight) * wBottom;
-		t[1] += (s[1] * wLeft + s[5] * wRight) * wBottom;
-		t[2] += (s[2] * wLeft + s[6] * wRight) * wBottom;
-		t[3] += (s[3] * wLeft + s[7] * wRight) * wBottom;
-
-		t[0] >>= 16;
-		t[1] >>= 16;
-		t[2] >>= 16;
-		t[3] >>= 16;
-	}
-
-	static void
-	InterpolateLastColumn(uint32* t, const uint8* s, const uint8* sBottom,
-		uint16 wTop, uint16 wBottom)
-	{
-		t[0] = (s[0] * wTop + sBottom[0] * wBottom) >> 8;
-		t[1] = (s[1] * wTop + sBottom[1] * wBottom) >> 8;
-		t[2] = (s[2] * wTop + sBottom[2] * wBottom) >> 8;
-		t[3] = (s[3] * wTop + sBottom[3] * wBottom) >> 8;
-	}
-
-	static void
-	InterpolateLastRow(uint32* t, const uint8* s, uint16 wLeft,
-		uint16 wRight)
-	{
-		t[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
-		t[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
-		t[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
-		t[3] = (s[3] * wLeft + s[7] * wRight) >> 8;
-	}
-};
+// The row kernel that implements the inner loop of BilinearDefault.
+template<class ColorType, class DrawMode>
+struct BilinearRow;
 
 
-struct DrawModeCopy {
-	static void
-	Blend(uint8*& d, uint32* t)
+template<>
+struct BilinearRow<ColorTypeRgb, DrawModeCopy> {
+	static bilinear_row_function
+	Function()
 	{
-		d[0] = t[0];
-		d[1] = t[1];
-		d[2] = t[2];
-		d += 4;
+		return gBitmapScalers.bilinear_copy_row;
 	}
 };
 
 
-struct DrawModeAlphaOverlay {
-	static void
-	Blend(uint8*& d, uint32* t)
+template<>
+struct BilinearRow<ColorTypeRgba, DrawModeAlphaOverlay> {
+	static bilinear_row_function
+	Function()
 	{
-		uint8 t0 = t[0];
-		uint8 t1 = t[1];
-		uint8 t2 = t[2];
-		uint8 t3 = t[3];
-
-		if (t3 == 255) {
-			d[0] = t0;
-			d[1] = t1;
-			d[2] = t2;
-		} else {
-			d[0] = ((t0 - d[0]) * t3 + (d[0] << 8)) >> 8;
-			d[1] = ((t1 - d[1]) * t3 + (d[1] << 8)) >> 8;
-			d[2] = ((t2 - d[2]) * t3 + (d[2] << 8)) >> 8;
-		}
-
-		d += 4;
+		return gBitmapScalers.bilinear_alpha_row;
 	}
 };
 
@@ -244,6 +141,9 @@ struct BilinearDefault :
 		if (this->fWeightsX[xIndexMax].weight == 255)
 			xIndexMax--;
 
+		const bilinear_row_function rowFunction
+			= BilinearRow<ColorType, DrawMode>::Function();
+
 		for (; y1 <= yMax; y1++) {
 			// cache the weight of the top and bottom row
 			const uint16 wTop = this->fWeightsY[y1].weight;
@@ -257,23 +157,25 @@ struct BilinearDefault :
 			// pixel
 			uint8* d = this->fDestination;
 
-			for (int32 x = xIndexL; x <= xIndexMax; x++) {
-				const uint8* s = src + this->fWeightsX[x].index;
-
-				// calculate the weighted sum of all four
-				// interpolated pixels
-				const uint16 wLeft = this->fWeightsX[x].weight;
-				const uint16 wRight = 255 - wLeft;
-
-				uint32 t[4];
+			if (this->fSource->height() > 1) {
+				// calculate the weighted sum of all four interpolated
+				// pixels
+				if (xIndexMax >= xIndexL) {
+					const uint32 count = xIndexMax - xIndexL + 1;
+					rowFunction(d, src, this->fSourceBytesPerRow,
+						this->fWeightsX + xIndexL, count, wTop);
+					d += count * 4;
+				}
+			} else {
+				for (int32 x = xIndexL; x <= xIndexMax; x++) {
+					const uint8* s = src + this->fWeightsX[x].index;
+					const uint16 wLeft = this->fWeightsX[x].weight;
+					const uint16 wRight = 255 - wLeft;
 
-				if (this->fSource->height() > 1) {
-					ColorType::Interpolate(&t[0], s, this->fSourceBytesPerRow,
-						wLeft, wTop, wRight, wBottom);
-				} else {
+					uint32 t[4];
 					ColorType::InterpolateLastRow(&t[0], s,  wLeft, wRight);
+					DrawMode::Blend(d, &t[0]);
 				}
-				DrawMode::Blend(d, &t[0]);
 			}
 			// last column of pixels if necessary
 			if (xIndexMax < xIndexR && this->fSource->height() > 1) {
@@ -597,12 +499,19 @@ struct DrawBitmapBilinear {
 
 		int codeSelect = kUseDefaultVersion;
 
+		// The default version uses the SSE2 or AVX2 row kernels if
+		// available, which beat both alternatives.
 		if (typeid(ColorType) == typeid(ColorTypeRgb)
-			&& typeid(DrawMode) == typeid(DrawModeCopy)) {
+			&& typeid(DrawMode) == typeid(DrawModeCopy)
+			&& !gBitmapScalers.accelerated) {
+#ifdef __i386__
+			// the SIMD version is implemented in x86 assembly only
 			uint32 neededSIMDFlags = APPSERVER_SIMD_MMX | APPSERVER_SIMD_SSE;
 			if ((gSIMDFlags & neededSIMDFlags) == neededSIMDFlags)
 				codeSelect = kUseSIMDVersion;
-			else {
+			else
+#endif
+			{
 				if (scaleX == scaleY && (scaleX == 1.5 || scaleX == 2.0
 					|| scaleX == 2.5 || scaleX == 3.0)) {
 					codeSelect = kOptimizeForLowFilterRatio;
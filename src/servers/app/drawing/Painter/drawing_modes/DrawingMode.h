@@ -14,6 +14,7 @@
 
 #include "PatternHandler.h"
 #include "PixelFormat.h"
+#include "SpanBlending.h"
 
 class PatternHandler;
 
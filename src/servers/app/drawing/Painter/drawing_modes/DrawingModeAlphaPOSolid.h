@@ -69,19 +69,8 @@ blend_solid_hspan_alpha_po_solid(int x, int y, unsigned len,
 						 		 agg_buffer* buffer, const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
-	do {
-		uint16 alpha = c.a * *covers;
-		if (alpha) {
-			if(alpha == 255 * 255) {
-				ASSIGN_ALPHA_PO(p, c.r, c.g, c.b);
-			} else {
-				BLEND_ALPHA_PO(p, c.r, c.g, c.b, alpha);
-			}
-		}
-		covers++;
-		p += 4;
-		x++;
-	} while(--len);
+	gSpanBlenders.blend_solid_hspan16(p, len, span_blending_color(c), c.a,
+		covers);
 }
 
 
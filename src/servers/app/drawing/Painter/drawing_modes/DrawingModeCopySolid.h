@@ -45,11 +45,7 @@ blend_hline_copy_solid(int x, int y, unsigned len,
 		} while(--len);
 	} else {
 		uint8* p = buffer->row_ptr(y) + (x << 2);
-		do {
-			BLEND_OVER(p, c.r, c.g, c.b, cover);
-			x++;
-			p += 4;
-		} while(--len);
+		gSpanBlenders.blend_solid_hline(p, len, span_blending_color(c), cover);
 	}
 }
 
@@ -61,18 +57,7 @@ blend_solid_hspan_copy_solid(int x, int y, unsigned len,
 							 const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
-	do {
-		if (*covers) {
-			if (*covers == 255) {
-				ASSIGN_OVER(p, c.r, c.g, c.b);
-			} else {
-				BLEND_OVER(p, c.r, c.g, c.b, *covers);
-			}
-		}
-		covers++;
-		p += 4;
-		x++;
-	} while(--len);
+	gSpanBlenders.blend_solid_hspan(p, len, span_blending_color(c), covers);
 }
 
 
@@ -111,34 +96,10 @@ blend_color_hspan_copy_solid(int x, int y, unsigned len,
 	uint8* p = buffer->row_ptr(y) + (x << 2);
 	if (covers) {
 		// non-solid opacity
-		do {
-				if (*covers) {
-				if (*covers == 255) {
-					ASSIGN_OVER(p, colors->r, colors->g, colors->b);
-				} else {
-					BLEND_OVER(p, colors->r, colors->g, colors->b, *covers);
-				}
-			}
-			covers++;
-			p += 4;
-			++colors;
-		} while(--len);
+		gSpanBlenders.blend_color_hspan(p, len, colors, covers, false);
 	} else {
-		// solid full opcacity
-		if (cover == 255) {
-			do {
-				ASSIGN_OVER(p, colors->r, colors->g, colors->b);
-				p += 4;
-				++colors;
-			} while(--len);
-		// solid partial opacity
-		} else if (cover) {
-			do {
-				BLEND_OVER(p, colors->r, colors->g, colors->b, cover);
-				p += 4;
-				++colors;
-			} while(--len);
-		}
+		// solid opacity
+		gSpanBlenders.blend_color_hline(p, len, colors, cover, false);
 	}
 }
 
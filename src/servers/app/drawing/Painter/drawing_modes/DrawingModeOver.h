@@ -137,38 +137,10 @@ blend_color_hspan_over(int x, int y, unsigned len,
 	uint8* p = buffer->row_ptr(y) + (x << 2);
 	if (covers) {
 		// non-solid opacity
-		do {
-			if (*covers && colors->a > 0) {
-				if (*covers == 255) {
-					ASSIGN_OVER(p, colors->r, colors->g, colors->b);
-				} else {
-					BLEND_OVER(p, colors->r, colors->g, colors->b, *covers);
-				}
-			}
-			covers++;
-			p += 4;
-			++colors;
-		} while(--len);
+		gSpanBlenders.blend_color_hspan(p, len, colors, covers, true);
 	} else {
-		// solid full opcacity
-		if (cover == 255) {
-			do {
-				if (colors->a > 0) {
-					ASSIGN_OVER(p, colors->r, colors->g, colors->b);
-				}
-				p += 4;
-				++colors;
-			} while(--len);
-		// solid partial opacity
-		} else if (cover) {
-			do {
-				if (colors->a > 0) {
-					BLEND_OVER(p, colors->r, colors->g, colors->b, cover);
-				}
-				p += 4;
-				++colors;
-			} while(--len);
-		}
+		// solid opacity
+		gSpanBlenders.blend_color_hline(p, len, colors, cover, true);
 	}
 }
 
@@ -51,11 +51,7 @@ blend_hline_over_solid(int x, int y, unsigned len,
 		} while(--len);
 	} else {
 		uint8* p = buffer->row_ptr(y) + (x << 2);
-		do {
-			BLEND_OVER(p, c.r, c.g, c.b, cover);
-			x++;
-			p += 4;
-		} while(--len);
+		gSpanBlenders.blend_solid_hline(p, len, span_blending_color(c), cover);
 	}
 }
 
@@ -69,18 +65,7 @@ blend_solid_hspan_over_solid(int x, int y, unsigned len,
 		return;
 
 	uint8* p = buffer->row_ptr(y) + (x << 2);
-	do {
-		if (*covers) {
-			if (*covers == 255) {
-				ASSIGN_OVER(p, c.r, c.g, c.b);
-			} else {
-				BLEND_OVER(p, c.r, c.g, c.b, *covers);
-			}
-		}
-		covers++;
-		p += 4;
-		x++;
-	} while(--len);
+	gSpanBlenders.blend_solid_hspan(p, len, span_blending_color(c), covers);
 }
 
 // blend_solid_vspan_over_solid
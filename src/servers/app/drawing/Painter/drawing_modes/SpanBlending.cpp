@@ -0,0 +1,387 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Row kernels for the most common span blending operations on B_RGBA32.
+ * The SIMD versions produce exactly the same results as the scalar ones,
+ * which mirror the BLEND and BLEND16 macros used by the drawing modes.
+ *
+ */
+
+#include "SpanBlending.h"
+
+#include <string.h>
+
+#include "drawing_support.h"
+
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 5 \
+	&& !defined(__clang__)
+#	define SPAN_BLENDING_X86 1
+#	include <immintrin.h>
+#endif
+
+
+// #pragma mark - scalar
+
+
+static inline void
+blend_pixel(uint8* p, uint8 r, uint8 g, uint8 b, uint8 cover)
+{
+	if (cover == 0)
+		return;
+
+	if (cover == 255) {
+		p[0] = b;
+		p[1] = g;
+		p[2] = r;
+		p[3] = 255;
+		return;
+	}
+
+	pixel32 _p;
+	_p.data32 = *(uint32*)p;
+	p[0] = (((b - _p.data8[0]) * cover) + (_p.data8[0] << 8)) >> 8;
+	p[1] = (((g - _p.data8[1]) * cover) + (_p.data8[1] << 8)) >> 8;
+	p[2] = (((r - _p.data8[2]) * cover) + (_p.data8[2] << 8)) >> 8;
+	p[3] = 255;
+}
+
+
+static inline void
+blend_pixel16(uint8* p, uint8 r, uint8 g, uint8 b, uint16 alpha)
+{
+	if (alpha == 0)
+		return;
+
+	if (alpha == 255 * 255) {
+		p[0] = b;
+		p[1] = g;
+		p[2] = r;
+		p[3] = 255;
+		return;
+	}
+
+	pixel32 _p;
+	_p.data32 = *(uint32*)p;
+	p[0] = (((b - _p.data8[0]) * alpha) + (_p.data8[0] << 16)) >> 16;
+	p[1] = (((g - _p.data8[1]) * alpha) + (_p.data8[1] << 16)) >> 16;
+	p[2] = (((r - _p.data8[2]) * alpha) + (_p.data8[2] << 16)) >> 16;
+	p[3] = 255;
+}
+
+
+static void
+blend_solid_hspan_scalar(uint8* p, unsigned len, uint32 color,
+	const uint8* covers)
+{
+	const uint8* c = (const uint8*)&color;
+	for (; len > 0; len--, p += 4, covers++)
+		blend_pixel(p, c[2], c[1], c[0], *covers);
+}
+
+
+static void
+blend_solid_hline_scalar(uint8* p, unsigned len, uint32 color, uint8 cover)
+{
+	const uint8* c = (const uint8*)&color;
+	for (; len > 0; len--, p += 4)
+		blend_pixel(p, c[2], c[1], c[0], cover);
+}
+
+
+static void
+blend_color_hspan_scalar(uint8* p, unsigned len, const agg::rgba8* colors,
+	const uint8* covers, bool skipTransparent)
+{
+	for (; len > 0; len--, p += 4, colors++, covers++) {
+		if (!skipTransparent || colors->a > 0)
+			blend_pixel(p, colors->r, colors->g, colors->b, *covers);
+	}
+}
+
+
+static void
+blend_color_hline_scalar(uint8* p, unsigned len, const agg::rgba8* colors,
+	uint8 cover, bool skipTransparent)
+{
+	for (; len > 0; len--, p += 4, colors++) {
+		if (!skipTransparent || colors->a > 0)
+			blend_pixel(p, colors->r, colors->g, colors->b, cover);
+	}
+}
+
+
+static void
+blend_solid_hspan16_scalar(uint8* p, unsigned len, uint32 color, uint8 alpha,
+	const uint8* covers)
+{
+	const uint8* c = (const uint8*)&color;
+	for (; len > 0; len--, p += 4, covers++)
+		blend_pixel16(p, c[2], c[1], c[0], alpha * *covers);
+}
+
+
+static void
+blend_color_hspan16_scalar(uint8* p, unsigned len, const agg::rgba8* colors,
+	const uint8* covers)
+{
+	for (; len > 0; len--, p += 4, colors++, covers++) {
+		blend_pixel16(p, colors->r, colors->g, colors->b,
+			colors->a * *covers);
+	}
+}
+
+
+static void
+blend_color_hline16_scalar(uint8* p, unsigned len, const agg::rgba8* colors,
+	uint16 alpha)
+{
+	for (; len > 0; len--, p += 4, colors++)
+		blend_pixel16(p, colors->r, colors->g, colors->b, alpha);
+}
+
+
+static const span_blenders kScalarSpanBlenders = {
+	blend_solid_hspan_scalar,
+	blend_solid_hline_scalar,
+	blend_color_hspan_scalar,
+	blend_color_hline_scalar,
+	blend_solid_hspan16_scalar,
+	blend_color_hspan16_scalar,
+	blend_color_hline16_scalar
+};
+
+
+#ifdef SPAN_BLENDING_X86
+
+
+// #pragma mark - SSE2
+
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+namespace sse2 {
+
+typedef __m128i vector;
+typedef uint32 cover_block;
+static const unsigned kPixels = 4;
+
+static inline vector v_zero() { return _mm_setzero_si128(); }
+static inline vector v_set1_16(uint16 value)
+	{ return _mm_set1_epi16((short)value); }
+static inline vector v_set1_32(uint32 value)
+	{ return _mm_set1_epi32((int)value); }
+static inline vector v_load(const void* p)
+	{ return _mm_loadu_si128((const __m128i*)p); }
+static inline void v_store(void* p, vector v)
+	{ _mm_storeu_si128((__m128i*)p, v); }
+
+static inline vector
+v_load_covers(const uint8* covers)
+{
+	// replicate each cover into the four bytes of its pixel
+	int32 value;
+	memcpy(&value, covers, sizeof(value));
+	vector v = _mm_cvtsi32_si128(value);
+	v = _mm_unpacklo_epi8(v, v);
+	return _mm_unpacklo_epi16(v, v);
+}
+
+static inline vector v_unpacklo8(vector a, vector b)
+	{ return _mm_unpacklo_epi8(a, b); }
+static inline vector v_unpackhi8(vector a, vector b)
+	{ return _mm_unpackhi_epi8(a, b); }
+static inline vector v_packus16(vector a, vector b)
+	{ return _mm_packus_epi16(a, b); }
+static inline vector v_packs16(vector a, vector b)
+	{ return _mm_packs_epi16(a, b); }
+static inline vector v_add16(vector a, vector b)
+	{ return _mm_add_epi16(a, b); }
+static inline vector v_sub16(vector a, vector b)
+	{ return _mm_sub_epi16(a, b); }
+static inline vector v_mullo16(vector a, vector b)
+	{ return _mm_mullo_epi16(a, b); }
+static inline vector v_mulhi_u16(vector a, vector b)
+	{ return _mm_mulhi_epu16(a, b); }
+static inline vector v_srli16_8(vector a)
+	{ return _mm_srli_epi16(a, 8); }
+static inline vector v_srai16_15(vector a)
+	{ return _mm_srai_epi16(a, 15); }
+static inline vector v_cmpeq16(vector a, vector b)
+	{ return _mm_cmpeq_epi16(a, b); }
+static inline vector v_and(vector a, vector b)
+	{ return _mm_and_si128(a, b); }
+static inline vector v_andnot(vector a, vector b)
+	{ return _mm_andnot_si128(a, b); }
+static inline vector v_or(vector a, vector b)
+	{ return _mm_or_si128(a, b); }
+static inline vector v_xor(vector a, vector b)
+	{ return _mm_xor_si128(a, b); }
+
+static inline vector
+v_swap_rb16(vector v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 1, 2));
+	return _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+static inline vector
+v_broadcast_alpha16(vector v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+	return _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+#include "SpanBlendingSIMD.h"
+
+}	// namespace sse2
+
+#pragma GCC pop_options
+
+
+// #pragma mark - AVX2
+
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace avx2 {
+
+typedef __m256i vector;
+typedef uint64 cover_block;
+static const unsigned kPixels = 8;
+
+static inline vector v_zero() { return _mm256_setzero_si256(); }
+static inline vector v_set1_16(uint16 value)
+	{ return _mm256_set1_epi16((short)value); }
+static inline vector v_set1_32(uint32 value)
+	{ return _mm256_set1_epi32((int)value); }
+static inline vector v_load(const void* p)
+	{ return _mm256_loadu_si256((const __m256i*)p); }
+static inline void v_store(void* p, vector v)
+	{ _mm256_storeu_si256((__m256i*)p, v); }
+
+static inline vector
+v_load_covers(const uint8* covers)
+{
+	// replicate each cover into the four bytes of its pixel
+	vector v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)covers));
+	return _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+		0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12,
+		0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12));
+}
+
+static inline vector v_unpacklo8(vector a, vector b)
+	{ return _mm256_unpacklo_epi8(a, b); }
+static inline vector v_unpackhi8(vector a, vector b)
+	{ return _mm256_unpackhi_epi8(a, b); }
+static inline vector v_packus16(vector a, vector b)
+	{ return _mm256_packus_epi16(a, b); }
+static inline vector v_packs16(vector a, vector b)
+	{ return _mm256_packs_epi16(a, b); }
+static inline vector v_add16(vector a, vector b)
+	{ return _mm256_add_epi16(a, b); }
+static inline vector v_sub16(vector a, vector b)
+	{ return _mm256_sub_epi16(a, b); }
+static inline vector v_mullo16(vector a, vector b)
+	{ return _mm256_mullo_epi16(a, b); }
+static inline vector v_mulhi_u16(vector a, vector b)
+	{ return _mm256_mulhi_epu16(a, b); }
+static inline vector v_srli16_8(vector a)
+	{ return _mm256_srli_epi16(a, 8); }
+static inline vector v_srai16_15(vector a)
+	{ return _mm256_srai_epi16(a, 15); }
+static inline vector v_cmpeq16(vector a, vector b)
+	{ return _mm256_cmpeq_epi16(a, b); }
+static inline vector v_and(vector a, vector b)
+	{ return _mm256_and_si256(a, b); }
+static inline vector v_andnot(vector a, vector b)
+	{ return _mm256_andnot_si256(a, b); }
+static inline vector v_or(vector a, vector b)
+	{ return _mm256_or_si256(a, b); }
+static inline vector v_xor(vector a, vector b)
+	{ return _mm256_xor_si256(a, b); }
+
+static inline vector
+v_swap_rb16(vector v)
+{
+	v = _mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 1, 2));
+	return _mm256_shufflehi_epi16(v, _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+static inline vector
+v_broadcast_alpha16(vector v)
+{
+	v = _mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+	return _mm256_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+#include "SpanBlendingSIMD.h"
+
+}	// namespace avx2
+
+#pragma GCC pop_options
+
+
+static const span_blenders kSSE2SpanBlenders = {
+	sse2::blend_solid_hspan,
+	sse2::blend_solid_hline,
+	sse2::blend_color_hspan,
+	sse2::blend_color_hline,
+	sse2::blend_solid_hspan16,
+	sse2::blend_color_hspan16,
+	sse2::blend_color_hline16
+};
+
+
+static const span_blenders kAVX2SpanBlenders = {
+	avx2::blend_solid_hspan,
+	avx2::blend_solid_hline,
+	avx2::blend_color_hspan,
+	avx2::blend_color_hline,
+	avx2::blend_solid_hspan16,
+	avx2::blend_color_hspan16,
+	avx2::blend_color_hline16
+};
+
+
+#endif	// SPAN_BLENDING_X86
+
+
+// #pragma mark -
+
+
+// This is statically initialized, so that select_span_blenders() can be used
+// from other static initializers.
+span_blenders gSpanBlenders = {
+	blend_solid_hspan_scalar,
+	blend_solid_hline_scalar,
+	blend_color_hspan_scalar,
+	blend_color_hline_scalar,
+	blend_solid_hspan16_scalar,
+	blend_color_hspan16_scalar,
+	blend_color_hline16_scalar
+};
+
+
+const span_blenders*
+span_blenders_for(uint32 simdFlags)
+{
+#ifdef SPAN_BLENDING_X86
+	if ((simdFlags & APPSERVER_SIMD_AVX2) != 0)
+		return &kAVX2SpanBlenders;
+	if ((simdFlags & APPSERVER_SIMD_SSE2) != 0)
+		return &kSSE2SpanBlenders;
+#endif
+
+	return &kScalarSpanBlenders;
+}
+
+
+void
+select_span_blenders(uint32 simdFlags)
+{
+	gSpanBlenders = *span_blenders_for(simdFlags);
+}
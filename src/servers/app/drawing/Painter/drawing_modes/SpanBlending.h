@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Row kernels for the most common span blending operations on B_RGBA32,
+ * with SIMD implementations that are selected at runtime.
+ *
+ */
+
+#ifndef SPAN_BLENDING_H
+#define SPAN_BLENDING_H
+
+#include <SupportDefs.h>
+
+#include <agg_color_rgba.h>
+
+
+// All kernels work on "len" consecutive B_RGBA32 pixels starting at "p".
+// Solid colors are passed as B_RGBA32 pixel value, color spans in the
+// agg::rgba8 layout.
+//
+// The 8 bit kernels implement BLEND (as used by B_OP_COPY and B_OP_OVER):
+// a cover of 0 leaves the pixel alone, 255 assigns the color. If
+// "skipTransparent" is true, pixels whose source alpha is 0 are left alone,
+// too.
+// The 16 bit kernels implement BLEND16 (as used by B_OP_ALPHA with
+// B_PIXEL_ALPHA and B_ALPHA_OVERLAY) with alpha = source alpha * cover: an
+// alpha of 0 leaves the pixel alone, 255 * 255 assigns the color.
+// Every pixel that is touched ends up with an alpha of 255, exactly like in
+// the scalar drawing mode implementations.
+struct span_blenders {
+	void	(*blend_solid_hspan)(uint8* p, unsigned len, uint32 color,
+				const uint8* covers);
+	void	(*blend_solid_hline)(uint8* p, unsigned len, uint32 color,
+				uint8 cover);
+	void	(*blend_color_hspan)(uint8* p, unsigned len,
+				const agg::rgba8* colors, const uint8* covers,
+				bool skipTransparent);
+	void	(*blend_color_hline)(uint8* p, unsigned len,
+				const agg::rgba8* colors, uint8 cover, bool skipTransparent);
+
+	void	(*blend_solid_hspan16)(uint8* p, unsigned len, uint32 color,
+				uint8 alpha, const uint8* covers);
+	void	(*blend_color_hspan16)(uint8* p, unsigned len,
+				const agg::rgba8* colors, const uint8* covers);
+	void	(*blend_color_hline16)(uint8* p, unsigned len,
+				const agg::rgba8* colors, uint16 alpha);
+};
+
+
+// The kernels in use, initialized to the scalar versions.
+extern span_blenders gSpanBlenders;
+
+// Returns the fastest kernels supported by the given APPSERVER_SIMD_* flags.
+const span_blenders* span_blenders_for(uint32 simdFlags);
+
+// Makes gSpanBlenders use the kernels for the given flags.
+void select_span_blenders(uint32 simdFlags);
+
+
+static inline uint32
+span_blending_color(const agg::rgba8& c)
+{
+	uint32 color;
+	uint8* p = (uint8*)&color;
+	p[0] = c.b;
+	p[1] = c.g;
+	p[2] = c.r;
+	p[3] = 255;
+	return color;
+}
+
+
+#endif // SPAN_BLENDING_H
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * The span blending kernels, written against a small set of vector
+ * primitives. This file is included once per instruction set by
+ * SpanBlending.cpp, which defines the "vector" type, "kPixels" (the pixels
+ * per vector), "cover_block" (an integer covering kPixels covers) and the
+ * v_*() primitives in the enclosing namespace.
+ *
+ * Pixels are widened to 16 bit words per channel; the "lo" and "hi" halves
+ * of a vector are processed separately and packed together again.
+ *
+ */
+
+
+// Turns 8 bit covers into BLEND factors, where a cover of 255 becomes 256 to
+// assign the source exactly.
+static inline vector
+factors8(vector covers)
+{
+	return v_sub16(covers, v_cmpeq16(covers, v_set1_16(255)));
+}
+
+
+// (s * a + d * (256 - a)) >> 8, which equals BLEND for a in [0, 255] and
+// cannot overflow 16 bits.
+static inline vector
+blend_words8(vector source, vector dest, vector factors)
+{
+	return v_srli16_8(v_add16(v_mullo16(source, factors),
+		v_mullo16(dest, v_sub16(v_set1_16(256), factors))));
+}
+
+
+// d + floor((s - d) * a / 65536), which equals BLEND16, and s for
+// a == 255 * 255.
+static inline vector
+blend_words16(vector source, vector dest, vector alpha)
+{
+	vector delta = v_sub16(source, dest);
+	vector negative = v_srai16_15(delta);
+	vector absDelta = v_sub16(v_xor(delta, negative), negative);
+
+	vector high = v_mulhi_u16(absDelta, alpha);
+	vector low = v_mullo16(absDelta, alpha);
+	// round negative results towards negative infinity
+	high = v_sub16(high, v_andnot(v_cmpeq16(low, v_zero()), negative));
+	vector result = v_add16(dest, v_sub16(v_xor(high, negative), negative));
+
+	vector assign = v_cmpeq16(alpha, v_set1_16(255 * 255));
+	return v_or(v_and(assign, source), v_andnot(assign, result));
+}
+
+
+// Packs the blended halves and sets the alpha of every pixel with a non-zero
+// factor to 255. Pixels with a zero factor have been blended to their
+// original value already.
+static inline vector
+pack_pixels(vector lo, vector hi, vector factorsLo, vector factorsHi)
+{
+	vector zero = v_zero();
+	vector untouched = v_packs16(v_cmpeq16(factorsLo, zero),
+		v_cmpeq16(factorsHi, zero));
+	return v_or(v_packus16(lo, hi),
+		v_andnot(untouched, v_set1_32(0xff000000)));
+}
+
+
+static inline bool
+covers_are(const uint8* covers, uint8 value)
+{
+	cover_block block;
+	memcpy(&block, covers, sizeof(block));
+	cover_block expected;
+	memset(&expected, value, sizeof(expected));
+	return block == expected;
+}
+
+
+static inline void
+fill_pixels(uint8* p, uint32 color)
+{
+	v_store(p, v_set1_32(color | 0xff000000));
+}
+
+
+static inline void
+assign_colors(uint8* p, vector colors)
+{
+	vector zero = v_zero();
+	vector lo = v_swap_rb16(v_unpacklo8(colors, zero));
+	vector hi = v_swap_rb16(v_unpackhi8(colors, zero));
+	v_store(p, v_or(v_packus16(lo, hi), v_set1_32(0xff000000)));
+}
+
+
+// #pragma mark - 8 bit
+
+
+static void
+blend_solid_hspan(uint8* p, unsigned len, uint32 color, const uint8* covers)
+{
+	const vector zero = v_zero();
+	const vector source = v_unpacklo8(v_set1_32(color), zero);
+
+	for (; len >= kPixels; len -= kPixels, p += kPixels * 4,
+			covers += kPixels) {
+		if (covers_are(covers, 0))
+			continue;
+		if (covers_are(covers, 255)) {
+			fill_pixels(p, color);
+			continue;
+		}
+
+		vector c = v_load_covers(covers);
+		vector d = v_load(p);
+		vector aLo = factors8(v_unpacklo8(c, zero));
+		vector aHi = factors8(v_unpackhi8(c, zero));
+		vector lo = blend_words8(source, v_unpacklo8(d, zero), aLo);
+		vector hi = blend_words8(source, v_unpackhi8(d, zero), aHi);
+		v_store(p, pack_pixels(lo, hi, aLo, aHi));
+	}
+
+	if (len > 0)
+		blend_solid_hspan_scalar(p, len, color, covers);
+}
+
+
+static void
+blend_solid_hline(uint8* p, unsigned len, uint32 color, uint8 cover)
+{
+	if (cover == 0)
+		return;
+
+	if (cover == 255) {
+		for (; len >= kPixels; len -= kPixels, p += kPixels * 4)
+			fill_pixels(p, color);
+	} else {
+		const vector zero = v_zero();
+		const vector source = v_unpacklo8(v_set1_32(color), zero);
+		const vector a = v_set1_16(cover);
+
+		for (; len >= kPixels; len -= kPixels, p += kPixels * 4) {
+			vector d = v_load(p);
+			vector lo = blend_words8(source, v_unpacklo8(d, zero), a);
+			vector hi = blend_words8(source, v_unpackhi8(d, zero), a);
+			v_store(p, pack_pixels(lo, hi, a, a));
+		}
+	}
+
+	if (len > 0)
+		blend_solid_hline_scalar(p, len, color, cover);
+}
+
+
+static void
+blend_color_hspan(uint8* p, unsigned len, const agg::rgba8* colors,
+	const uint8* covers, bool skipTransparent)
+{
+	const vector zero = v_zero();
+
+	for (; len >= kPixels; len -= kPixels, p += kPixels * 4,
+			colors += kPixels, covers += kPixels) {
+		if (covers_are(covers, 0))
+			continue;
+
+		vector s = v_load(colors);
+		vector sLo = v_unpacklo8(s, zero);
+		vector sHi = v_unpackhi8(s, zero);
+
+		vector c = v_load_covers(covers);
+		vector aLo = factors8(v_unpacklo8(c, zero));
+		vector aHi = factors8(v_unpackhi8(c, zero));
+		if (skipTransparent) {
+			aLo = v_andnot(v_cmpeq16(v_broadcast_alpha16(sLo), zero), aLo);
+			aHi = v_andnot(v_cmpeq16(v_broadcast_alpha16(sHi), zero), aHi);
+		}
+
+		vector d = v_load(p);
+		vector lo = blend_words8(v_swap_rb16(sLo), v_unpacklo8(d, zero), aLo);
+		vector hi = blend_words8(v_swap_rb16(sHi), v_unpackhi8(d, zero), aHi);
+		v_store(p, pack_pixels(lo, hi, aLo, aHi));
+	}
+
+	if (len > 0)
+		blend_color_hspan_scalar(p, len, colors, covers, skipTransparent);
+}
+
+
+static void
+blend_color_hline(uint8* p, unsigned len, const agg::rgba8* colors,
+	uint8 cover, bool skipTransparent)
+{
+	if (cover == 0)
+		return;
+
+	const vector zero = v_zero();
+	const vector a = factors8(v_set1_16(cover));
+
+	for (; len >= kPixels; len -= kPixels, p += kPixels * 4,
+			colors += kPixels) {
+		vector s = v_load(colors);
+		if (cover == 255 && !skipTransparent) {
+			assign_colors(p, s);
+			continue;
+		}
+
+		vector sLo = v_unpacklo8(s, zero);
+		vector sHi = v_unpackhi8(s, zero);
+		vector aLo = a;
+		vector aHi = a;
+		if (skipTransparent) {
+			aLo = v_andnot(v_cmpeq16(v_broadcast_alpha16(sLo), zero), aLo);
+			aHi = v_andnot(v_cmpeq16(v_broadcast_alpha16(sHi), zero), aHi);
+		}
+
+		vector d = v_load(p);
+		vector lo = blend_words8(v_swap_rb16(sLo), v_unpacklo8(d, zero), aLo);
+		vector hi = blend_words8(v_swap_rb16(sHi), v_unpackhi8(d, zero), aHi);
+		v_store(p, pack_pixels(lo, hi, aLo, aHi));
+	}
+
+	if (len > 0)
+		blend_color_hline_scalar(p, len, colors, cover, skipTransparent);
+}
+
+
+// #pragma mark - 16 bit
+
+
+static void
+blend_solid_hspan16(uint8* p, unsigned len, uint32 color, uint8 alpha,
+	const uint8* covers)
+{
+	if (alpha == 0)
+		return;
+
+	const vector zero = v_zero();
+	const vector source = v_unpacklo8(v_set1_32(color), zero);
+	const vector sourceAlpha = v_set1_16(alpha);
+
+	for (; len >= kPixels; len -= kPixels, p += kPixels * 4,
+			covers += kPixels) {
+		if (covers_are(covers, 0))
+			continue;
+		if (alpha == 255 && covers_are(covers, 255)) {
+			fill_pixels(p, color);
+			continue;
+		}
+
+		vector c = v_load_covers(covers);
+		vector d = v_load(p);
+		vector aLo = v_mullo16(v_unpacklo8(c, zero), sourceAlpha);
+		vector aHi = v_mullo16(v_unpackhi8(c, zero), sourceAlpha);
+		vector lo = blend_words16(source, v_unpacklo8(d, zero), aLo);
+		vector hi = blend_words16(source, v_unpackhi8(d, zero), aHi);
+		v_store(p, pack_pixels(lo, hi, aLo, aHi));
+	}
+
+	if (len > 0)
+		blend_solid_hspan16_scalar(p, len, color, alpha, covers);
+}
+
+
+static void
+blend_color_hspan16(uint8* p, unsigned len, const agg::rgba8* colors,
+	const uint8* covers)
+{
+	const vector zero = v_zero();
+
+	for (; len >= kPixels; len -= kPixels, p += kPixels * 4,
+			colors += kPixels, covers += kPixels) {
+		if (covers_are(covers, 0))
+			continue;
+
+		vector s = v_load(colors);
+		vector sLo = v_unpacklo8(s, zero);
+		vector sHi = v_unpackhi8(s, zero);
+
+		vector c = v_load_covers(covers);
+		vector aLo = v_mullo16(v_unpacklo8(c, zero),
+			v_broadcast_alpha16(sLo));
+		vector aHi = v_mullo16(v_unpackhi8(c, zero),
+			v_broadcast_alpha16(sHi));
+
+		vector d = v_load(p);
+		vector lo = blend_words16(v_swap_rb16(sLo), v_unpacklo8(d, zero), aLo);
+		vector hi = blend_words16(v_swap_rb16(sHi), v_unpackhi8(d, zero), aHi);
+		v_store(p, pack_pixels(lo, hi, aLo, aHi));
+	}
+
+	if (len > 0)
+		blend_color_hspan16_scalar(p, len, colors, covers);
+}
+
+
+static void
+blend_color_hline16(uint8* p, unsigned len, const agg::rgba8* colors,
+	uint16 alpha)
+{
+	if (alpha == 0)
+		return;
+
+	const vector zero = v_zero();
+	const vector a = v_set1_16(alpha);
+
+	for (; len >= kPixels; len -= kPixels, p += kPixels * 4,
+			colors += kPixels) {
+		vector s = v_load(colors);
+		if (alpha == 255 * 255) {
+			assign_colors(p, s);
+			continue;
+		}
+
+		vector d = v_load(p);
+		vector lo = blend_words16(v_swap_rb16(v_unpacklo8(s, zero)),
+			v_unpacklo8(d, zero), a);
+		vector hi = blend_words16(v_swap_rb16(v_unpackhi8(s, zero)),
+			v_unpackhi8(d, zero), a);
+		v_store(p, pack_pixels(lo, hi, a, a));
+	}
+
+	if (len > 0)
+		blend_color_hline16_scalar(p, len, colors, alpha);
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "TileWorkerPool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <new>
+
+
+TileWorkerPool::TileWorkerPool()
+	:
+	fLock("tile worker pool"),
+	fWorkers(NULL),
+	fWorkerCount(0),
+	fStartSemaphore(-1),
+	fDoneSemaphore(-1),
+	fQuitting(false),
+	fTiles(NULL),
+	fTileCapacity(0),
+	fTileCount(0),
+	fNextTile(0),
+	fFunction(NULL),
+	fCookie(NULL)
+{
+}
+
+
+TileWorkerPool::~TileWorkerPool()
+{
+	fQuitting = true;
+	delete_sem(fStartSemaphore);
+
+	for (int32 i = 0; i < fWorkerCount; i++) {
+		status_t result;
+		wait_for_thread(fWorkers[i], &result);
+	}
+
+	delete_sem(fDoneSemaphore);
+	delete[] fWorkers;
+	free(fTiles);
+}
+
+
+status_t
+TileWorkerPool::Init(int32 workerCount)
+{
+	if (workerCount <= 0)
+		return B_BAD_VALUE;
+
+	fWorkers = new(std::nothrow) thread_id[workerCount];
+	if (fWorkers == NULL)
+		return B_NO_MEMORY;
+
+	fStartSemaphore = create_sem(0, "tile workers start");
+	if (fStartSemaphore < 0)
+		return fStartSemaphore;
+
+	fDoneSemaphore = create_sem(0, "tile workers done");
+	if (fDoneSemaphore < 0)
+		return fDoneSemaphore;
+
+	for (int32 i = 0; i < workerCount; i++) {
+		char name[B_OS_NAME_LENGTH];
+		snprintf(name, sizeof(name), "tile worker %" B_PRId32, i);
+
+		thread_id thread = spawn_thread(_WorkerEntry, name,
+			B_URGENT_DISPLAY_PRIORITY, this);
+		if (thread < 0)
+			return fWorkerCount > 0 ? B_OK : thread;
+
+		fWorkers[fWorkerCount++] = thread;
+		resume_thread(thread);
+	}
+
+	return B_OK;
+}
+
+
+/*!	Calls \a function for every tile of \a region, spread over the workers
+	and the calling thread, and returns when all tiles are done. Returns
+	\c false without calling anything if the region isn't worth splitting,
+	or if the pool is busy with another caller; the caller is then expected
+	to do the work itself.
+*/
+bool
+TileWorkerPool::Run(const BRegion& region, int32 minTilePixels,
+	tile_function function, void* cookie)
+{
+	if (fWorkerCount == 0 || fLock.LockWithTimeout(0) != B_OK)
+		return false;
+
+	if (!_SplitIntoTiles(region, minTilePixels) || fTileCount < 2) {
+		fLock.Unlock();
+		return false;
+	}
+
+	fFunction = function;
+	fCookie = cookie;
+	fNextTile = 0;
+
+	int32 helpers = min_c(fWorkerCount, fTileCount - 1);
+	release_sem_etc(fStartSemaphore, helpers, B_DO_NOT_RESCHEDULE);
+
+	_ProcessTiles();
+
+	status_t status;
+	do {
+		status = acquire_sem_etc(fDoneSemaphore, helpers, 0, 0);
+	} while (status == B_INTERRUPTED);
+
+	fLock.Unlock();
+	return true;
+}
+
+
+bool
+TileWorkerPool::_SplitIntoTiles(const BRegion& region, int32 minTilePixels)
+{
+	fTileCount = 0;
+
+	int32 count = region.CountRects();
+	for (int32 i = 0; i < count; i++) {
+		clipping_rect rect = region.RectAtInt(i);
+		int32 width = rect.right - rect.left + 1;
+		int32 rows = max_c(1, minTilePixels / max_c(1, width));
+
+		for (int32 top = rect.top; top <= rect.bottom; top += rows) {
+			if (fTileCount == fTileCapacity) {
+				int32 capacity = max_c(32, fTileCapacity * 2);
+				clipping_rect* tiles = (clipping_rect*)realloc(fTiles,
+					capacity * sizeof(clipping_rect));
+				if (tiles == NULL)
+					return false;
+
+				fTiles = tiles;
+				fTileCapacity = capacity;
+			}
+
+			clipping_rect& tile = fTiles[fTileCount++];
+			tile.left = rect.left;
+			tile.top = top;
+			tile.right = rect.right;
+			tile.bottom = min_c(top + rows - 1, rect.bottom);
+		}
+	}
+
+	return true;
+}
+
+
+void
+TileWorkerPool::_ProcessTiles()
+{
+	while (true) {
+		int32 index = atomic_add(&fNextTile, 1);
+		if (index >= fTileCount)
+			break;
+
+		fFunction(fCookie, fTiles[index]);
+	}
+}
+
+
+/*static*/ status_t
+TileWorkerPool::_WorkerEntry(void* data)
+{
+	((TileWorkerPool*)data)->_Work();
+	return B_OK;
+}
+
+
+void
+TileWorkerPool::_Work()
+{
+	while (true) {
+		status_t status = acquire_sem(fStartSemaphore);
+		if (status == B_INTERRUPTED)
+			continue;
+		if (status != B_OK || fQuitting)
+			break;
+
+		_ProcessTiles();
+		release_sem(fDoneSemaphore);
+	}
+}
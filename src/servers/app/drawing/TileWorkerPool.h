@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef TILE_WORKER_POOL_H
+#define TILE_WORKER_POOL_H
+
+
+#include <Locker.h>
+#include <OS.h>
+#include <Region.h>
+
+
+typedef void (*tile_function)(void* cookie, const clipping_rect& tile);
+
+
+/*!	A small set of threads that process the tiles of a region in parallel,
+	together with the calling thread. Tiles are horizontal bands of the
+	rectangles of the region. They never overlap, but the tiles of two
+	rectangles next to each other may cover parts of the same rows, so the
+	tile function must not touch anything outside of its tile.
+*/
+class TileWorkerPool {
+public:
+								TileWorkerPool();
+								~TileWorkerPool();
+
+			status_t			Init(int32 workerCount);
+
+			int32				CountWorkers() const
+									{ return fWorkerCount; }
+
+			bool				Run(const BRegion& region,
+									int32 minTilePixels,
+									tile_function function, void* cookie);
+
+private:
+			bool				_SplitIntoTiles(const BRegion& region,
+									int32 minTilePixels);
+			void				_ProcessTiles();
+
+	static	status_t			_WorkerEntry(void* data);
+			void				_Work();
+
+private:
+			BLocker				fLock;
+			thread_id*			fWorkers;
+			int32				fWorkerCount;
+			sem_id				fStartSemaphore;
+			sem_id				fDoneSemaphore;
+			bool				fQuitting;
+
+			clipping_rect*		fTiles;
+			int32				fTileCapacity;
+			int32				fTileCount;
+			int32				fNextTile;
+			tile_function		fFunction;
+			void*				fCookie;
+};
+
+
+#endif	// TILE_WORKER_POOL_H
@@ -15,6 +15,13 @@
 class BRect;
 
 
+// Defines for SIMD support.
+#define APPSERVER_SIMD_MMX	(1 << 0)
+#define APPSERVER_SIMD_SSE	(1 << 1)
+#define APPSERVER_SIMD_SSE2	(1 << 2)
+#define APPSERVER_SIMD_AVX2	(1 << 3)
+
+
 // gfxset32
 // * numBytes is expected to be a multiple of 4
 static inline void
@@ -9,6 +9,7 @@
 #include "NetReceiver.h"
 #include "RemoteMessage.h"
 
+#include "StreamCompression.h"
 #include "StreamingRingBuffer.h"
 
 #include <NetEndpoint.h>
@@ -21,6 +22,28 @@
 #define TRACE_ERROR(x...)	debug_printf("NetReceiver: " x)
 
 
+class RingBufferOutput : public BDataIO {
+public:
+	RingBufferOutput(StreamingRingBuffer *target)
+		:
+		fTarget(target)
+	{
+	}
+
+	virtual ssize_t Write(const void *buffer, size_t size)
+	{
+		status_t result = fTarget->Write(buffer, size);
+		if (result != B_OK)
+			return result;
+
+		return size;
+	}
+
+private:
+	StreamingRingBuffer *	fTarget;
+};
+
+
 NetReceiver::NetReceiver(BNetEndpoint *listener, StreamingRingBuffer *target,
 	NewConnectionCallback newConnectionCallback, void *newConnectionCookie)
 	:
@@ -97,6 +120,10 @@ NetReceiver::_Transfer()
 {
 	int32 errorCount = 0;
 
+	// a new connection starts out uncompressed
+	RingBufferOutput output(fTarget);
+	StreamDecoder decoder(&output);
+
 	while (!fStopThread) {
 		uint8 buffer[4096];
 		int32 readSize = fEndpoint->Receive(buffer, sizeof(buffer));
@@ -119,7 +146,7 @@ NetReceiver::_Transfer()
 		}
 
 		errorCount = 0;
-		status_t result = fTarget->Write(buffer, readSize);
+		status_t result = decoder.Write(buffer, readSize);
 		if (result != B_OK) {
 			TRACE_ERROR("writing to ring buffer failed: %s\n",
 				strerror(result));
@@ -12,6 +12,7 @@
 
 #include <NetEndpoint.h>
 
+#include <new>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,13 +21,39 @@
 #define TRACE_ERROR(x...)	debug_printf("NetSender: " x)
 
 
+static const size_t kSendBufferSize = 64 * 1024;
+
+
+class NetSender::EndpointOutput : public BDataIO {
+public:
+	EndpointOutput(BNetEndpoint *endpoint)
+		:
+		fEndpoint(endpoint)
+	{
+	}
+
+	virtual ssize_t Write(const void *buffer, size_t size)
+	{
+		return fEndpoint->Send(buffer, size);
+	}
+
+private:
+	BNetEndpoint *	fEndpoint;
+};
+
+
 NetSender::NetSender(BNetEndpoint *endpoint, StreamingRingBuffer *source)
 	:
 	fEndpoint(endpoint),
 	fSource(source),
+	fOutput(new(std::nothrow) EndpointOutput(endpoint)),
+	fEncoder(NULL),
 	fSenderThread(-1),
 	fStopThread(false)
 {
+	if (fOutput.IsSet())
+		fEncoder.SetTo(new(std::nothrow) StreamEncoder(fOutput.Get()));
+
 	fSenderThread = spawn_thread(_NetworkSenderEntry, "network sender",
 		B_NORMAL_PRIORITY, this);
 	resume_thread(fSenderThread);
@@ -42,6 +69,17 @@ NetSender::~NetSender()
 }
 
 
+/*!	Compresses everything sent after the next complete message. The client
+	finds out about it through an RP_ENABLE_STREAM_COMPRESSION message.
+*/
+void
+NetSender::EnableCompression()
+{
+	if (fEncoder.IsSet())
+		fEncoder->RequestCompression();
+}
+
+
 int32
 NetSender::_NetworkSenderEntry(void *data)
 {
@@ -52,23 +90,25 @@ NetSender::_NetworkSenderEntry(void *data)
 status_t
 NetSender::_NetworkSender()
 {
+	if (!fEncoder.IsSet())
+		return B_NO_MEMORY;
+
+	ArrayDeleter<uint8> buffer(new(std::nothrow) uint8[kSendBufferSize]);
+	if (!buffer.IsSet())
+		return B_NO_MEMORY;
+
 	while (!fStopThread) {
-		uint8 buffer[4096];
-		int32 readSize = fSource->Read(buffer, sizeof(buffer), true);
+		int32 readSize = fSource->Read(buffer.Get(), kSendBufferSize, true);
 		if (readSize < 0) {
 			TRACE_ERROR("read failed, stopping sender thread: %s\n",
 				strerror(readSize));
 			return readSize;
 		}
 
-		while (readSize > 0) {
-			int32 sendSize = fEndpoint->Send(buffer, readSize);
-			if (sendSize < 0) {
-				TRACE_ERROR("sending data failed: %s\n", strerror(sendSize));
-				return sendSize;
-			}
-
-			readSize -= sendSize;
+		status_t result = fEncoder->Write(buffer.Get(), readSize);
+		if (result != B_OK) {
+			TRACE_ERROR("sending data failed: %s\n", strerror(result));
+			return result;
 		}
 	}
 
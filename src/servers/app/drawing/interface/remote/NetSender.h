@@ -8,6 +8,8 @@
 #ifndef NET_SENDER_H
 #define NET_SENDER_H
 
+#include "StreamCompression.h"
+
 #include <OS.h>
 #include <SupportDefs.h>
 
@@ -20,13 +22,22 @@ public:
 									StreamingRingBuffer *source);
 								~NetSender();
 
+		void					EnableCompression();
+
 private:
+		class EndpointOutput;
+
 static	int32					_NetworkSenderEntry(void *data);
 		status_t				_NetworkSender();
 
 		BNetEndpoint *			fEndpoint;
 		StreamingRingBuffer *	fSource;
 
+		ObjectDeleter<EndpointOutput>
+								fOutput;
+		ObjectDeleter<StreamEncoder>
+								fEncoder;
+
 		thread_id				fSenderThread;
 		bool					fStopThread;
 };
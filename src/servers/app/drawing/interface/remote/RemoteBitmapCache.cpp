@@ -0,0 +1,273 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "RemoteBitmapCache.h"
+
+#include "RemoteMessage.h"
+#include "ServerBitmap.h"
+
+#include <Autolock.h>
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const int32 kSlotCount = RP_BITMAP_DELTA_SLOT_COUNT;
+static const size_t kMaxCachedBytes = 32 * 1024 * 1024;
+
+// changes are detected and sent in tiles of this size
+static const int32 kTileWidth = 64;
+static const int32 kTileHeight = 16;
+
+
+struct RemoteBitmapCache::slot {
+	int32			token;
+	int32			width;
+	int32			height;
+	color_space		colorSpace;
+	uint32			lastUse;
+	uint8*			bits;
+		// the contents the client has, in rows of width * 4 bytes
+};
+
+
+RemoteBitmapCache::RemoteBitmapCache()
+	:
+	fLock("remote bitmap cache"),
+	fSlots(new(std::nothrow) slot[kSlotCount]),
+	fCachedBytes(0),
+	fUseCount(0)
+{
+	if (fSlots == NULL)
+		return;
+
+	for (int32 i = 0; i < kSlotCount; i++) {
+		fSlots[i].token = -1;
+		fSlots[i].bits = NULL;
+	}
+}
+
+
+RemoteBitmapCache::~RemoteBitmapCache()
+{
+	Clear();
+	delete[] fSlots;
+}
+
+
+/*!	Forgets everything; to be called when a new client connects, which
+	starts out with empty slots.
+*/
+void
+RemoteBitmapCache::Clear()
+{
+	BAutolock locker(fLock);
+	if (fSlots == NULL)
+		return;
+
+	for (int32 i = 0; i < kSlotCount; i++)
+		_Free(&fSlots[i]);
+}
+
+
+/*!	Sends an RP_DRAW_BITMAP_DELTA message that draws \a bitmap, containing
+	only the tiles that changed since the bitmap was last sent. Returns
+	\c B_NOT_SUPPORTED if the bitmap can't be cached, in which case the
+	caller has to send it as a whole.
+*/
+status_t
+RemoteBitmapCache::DrawBitmap(StreamingRingBuffer* target, uint32 token,
+	const ServerBitmap& bitmap, const BRect& bitmapRect,
+	const BRect& viewRect, uint32 options)
+{
+	color_space colorSpace = bitmap.ColorSpace();
+	if ((colorSpace != B_RGB32 && colorSpace != B_RGBA32)
+		|| bitmap.Token() < 0) {
+		return B_NOT_SUPPORTED;
+	}
+
+	if ((size_t)bitmap.Width() * bitmap.Height() * 4 > kMaxCachedBytes / 4)
+		return B_NOT_SUPPORTED;
+
+	BAutolock locker(fLock);
+	if (fSlots == NULL)
+		return B_NOT_SUPPORTED;
+
+	bool isNew;
+	slot* entry = _SlotFor(bitmap, isNew);
+	if (entry == NULL)
+		return B_NOT_SUPPORTED;
+
+	BRegion changes;
+	if (isNew) {
+		clipping_rect bounds = { 0, 0, entry->width - 1, entry->height - 1 };
+		changes.Set(bounds);
+	} else
+		_CollectChanges(entry, bitmap, changes);
+
+	RemoteMessage message(NULL, target);
+	message.Start(RP_DRAW_BITMAP_DELTA);
+	message.Add(token);
+	message.Add(bitmapRect);
+	message.Add(viewRect);
+	message.Add(options);
+	message.Add((uint32)(entry - fSlots));
+	message.Add(entry->width);
+	message.Add(entry->height);
+	message.Add(colorSpace);
+	message.Add(bitmap.Flags());
+	_AddChanges(message, entry, changes);
+
+	// The client has to apply the changes in the same order as we made
+	// them, so the message is sent while still holding the lock
+	status_t result = message.Flush();
+	if (result != B_OK) {
+		// the client doesn't have the changes we recorded in the slot
+		_Free(entry);
+	}
+
+	return result;
+}
+
+
+RemoteBitmapCache::slot*
+RemoteBitmapCache::_SlotFor(const ServerBitmap& bitmap, bool& _isNew)
+{
+	slot* entry = NULL;
+	for (int32 i = 0; i < kSlotCount; i++) {
+		slot* candidate = &fSlots[i];
+		if (candidate->token == bitmap.Token()) {
+			if (candidate->width == bitmap.Width()
+				&& candidate->height == bitmap.Height()
+				&& candidate->colorSpace == bitmap.ColorSpace()) {
+				candidate->lastUse = ++fUseCount;
+				_isNew = false;
+				return candidate;
+			}
+
+			_Free(candidate);
+		}
+
+		if (entry == NULL || (entry->bits != NULL
+				&& (candidate->bits == NULL
+					|| candidate->lastUse < entry->lastUse))) {
+			entry = candidate;
+		}
+	}
+
+	_Free(entry);
+
+	// make room by dropping the least recently used bitmaps
+	size_t size = (size_t)bitmap.Width() * bitmap.Height() * 4;
+	while (fCachedBytes + size > kMaxCachedBytes) {
+		slot* oldest = NULL;
+		for (int32 i = 0; i < kSlotCount; i++) {
+			if (fSlots[i].bits != NULL
+				&& (oldest == NULL || fSlots[i].lastUse < oldest->lastUse)) {
+				oldest = &fSlots[i];
+			}
+		}
+
+		if (oldest == NULL)
+			return NULL;
+
+		_Free(oldest);
+	}
+
+	entry->bits = (uint8*)malloc(size);
+	if (entry->bits == NULL)
+		return NULL;
+
+	entry->token = bitmap.Token();
+	entry->width = bitmap.Width();
+	entry->height = bitmap.Height();
+	entry->colorSpace = bitmap.ColorSpace();
+	entry->lastUse = ++fUseCount;
+	fCachedBytes += size;
+
+	size_t rowLength = entry->width * 4;
+	for (int32 y = 0; y < entry->height; y++) {
+		memcpy(entry->bits + y * rowLength,
+			bitmap.Bits() + y * bitmap.BytesPerRow(), rowLength);
+	}
+
+	_isNew = true;
+	return entry;
+}
+
+
+/*!	Compares the bitmap to what the client has, tile by tile, and updates
+	the slot with the tiles that differ. Those are collected in \a changes.
+*/
+void
+RemoteBitmapCache::_CollectChanges(slot* entry, const ServerBitmap& bitmap,
+	BRegion& changes)
+{
+	const uint8* bits = bitmap.Bits();
+	int32 bytesPerRow = bitmap.BytesPerRow();
+	size_t rowLength = entry->width * 4;
+
+	for (int32 top = 0; top < entry->height; top += kTileHeight) {
+		int32 bottom = min_c(top + kTileHeight, entry->height) - 1;
+
+		for (int32 left = 0; left < entry->width; left += kTileWidth) {
+			int32 right = min_c(left + kTileWidth, entry->width) - 1;
+			size_t length = (right - left + 1) * 4;
+
+			int32 y = top;
+			for (; y <= bottom; y++) {
+				if (memcmp(entry->bits + y * rowLength + left * 4,
+						bits + y * bytesPerRow + left * 4, length) != 0) {
+					break;
+				}
+			}
+
+			if (y > bottom)
+				continue;
+
+			for (; y <= bottom; y++) {
+				memcpy(entry->bits + y * rowLength + left * 4,
+					bits + y * bytesPerRow + left * 4, length);
+			}
+
+			clipping_rect tile = { left, top, right, bottom };
+			changes.Include(tile);
+		}
+	}
+}
+
+
+void
+RemoteBitmapCache::_AddChanges(RemoteMessage& message, slot* entry,
+	const BRegion& changes)
+{
+	size_t rowLength = entry->width * 4;
+
+	int32 rectCount = changes.CountRects();
+	message.Add(rectCount);
+
+	for (int32 i = 0; i < rectCount; i++) {
+		clipping_rect rect = changes.RectAtInt(i);
+		message.Add(rect);
+
+		size_t length = (rect.right - rect.left + 1) * 4;
+		for (int32 y = rect.top; y <= rect.bottom; y++)
+			message.AddData(entry->bits + y * rowLength + rect.left * 4, length);
+	}
+}
+
+
+void
+RemoteBitmapCache::_Free(slot* entry)
+{
+	if (entry->bits != NULL) {
+		fCachedBytes -= (size_t)entry->width * entry->height * 4;
+		free(entry->bits);
+		entry->bits = NULL;
+	}
+
+	entry->token = -1;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef REMOTE_BITMAP_CACHE_H
+#define REMOTE_BITMAP_CACHE_H
+
+#include <Locker.h>
+#include <Rect.h>
+#include <Region.h>
+
+class RemoteMessage;
+class ServerBitmap;
+class StreamingRingBuffer;
+
+
+// Remembers the last contents of bitmaps sent to the client, so that drawing
+// them again only transfers the parts that changed since. The client keeps
+// the same contents in the same slots.
+class RemoteBitmapCache {
+public:
+								RemoteBitmapCache();
+								~RemoteBitmapCache();
+
+		void					Clear();
+
+		status_t				DrawBitmap(StreamingRingBuffer* target,
+									uint32 token, const ServerBitmap& bitmap,
+									const BRect& bitmapRect,
+									const BRect& viewRect, uint32 options);
+
+private:
+		struct slot;
+
+		slot*					_SlotFor(const ServerBitmap& bitmap,
+									bool& _isNew);
+		void					_CollectChanges(slot* entry,
+									const ServerBitmap& bitmap,
+									BRegion& changes);
+		void					_AddChanges(RemoteMessage& message,
+									slot* entry, const BRegion& changes);
+		void					_Free(slot* entry);
+
+		BLocker					fLock;
+		slot*					fSlots;
+		size_t					fCachedBytes;
+		uint32					fUseCount;
+};
+
+#endif // REMOTE_BITMAP_CACHE_H
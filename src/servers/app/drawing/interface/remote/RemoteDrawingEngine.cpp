@@ -380,7 +380,12 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 		return;
 	}
 
-	// TODO: we may want to cache/checksum bitmaps
+	if (fHWInterface->SupportsBitmapDeltas()
+		&& fHWInterface->BitmapCache().DrawBitmap(fHWInterface->SendBuffer(),
+			fToken, *bitmap, bitmapRect, viewRect, options) == B_OK) {
+		return;
+	}
+
 	RemoteMessage message(NULL, fHWInterface->SendBuffer());
 	message.Start(RP_DRAW_BITMAP);
 	message.Add(fToken);
@@ -1015,6 +1020,16 @@ RemoteDrawingEngine::ReadBitmap(ServerBitmap* bitmap, bool drawCursor,
 }
 
 
+status_t
+RemoteDrawingEngine::ReadRegion(const BRegion& region, ServerBitmap* bitmap,
+	BPoint origin)
+{
+	// the screen contents only exist on the remote side, so window contents
+	// cannot be retained
+	return B_UNSUPPORTED;
+}
+
+
 // #pragma mark -
 
 
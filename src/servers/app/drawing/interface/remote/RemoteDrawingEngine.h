@@ -36,6 +36,8 @@ public:
 	// for screen shots
 	virtual	status_t			ReadBitmap(ServerBitmap* bitmap,
 									bool drawCursor, BRect bounds);
+	virtual	status_t			ReadRegion(const BRegion& region,
+									ServerBitmap* bitmap, BPoint origin);
 
 	// clipping for all drawing functions, passing a NULL region
 	// will remove any clipping (drawing allowed everywhere)
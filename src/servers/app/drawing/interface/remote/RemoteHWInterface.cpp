@@ -13,6 +13,7 @@
 
 #include "NetReceiver.h"
 #include "NetSender.h"
+#include "StreamCompression.h"
 #include "StreamingRingBuffer.h"
 
 #include "SystemPalette.h"
@@ -43,6 +44,7 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 	fIsConnected(false),
 	fProtocolVersion(100),
 	fConnectionSpeed(0),
+	fClientFeatures(0),
 	fListenPort(10901),
 	fListenEndpoint(NULL),
 	fSendBuffer(NULL),
@@ -164,6 +166,13 @@ RemoteHWInterface::CreateEventStream()
 }
 
 
+bool
+RemoteHWInterface::SupportsBitmapDeltas() const
+{
+	return (fClientFeatures & RP_FEATURE_BITMAP_DELTAS) != 0;
+}
+
+
 status_t
 RemoteHWInterface::AddCallback(uint32 token, CallbackFunction callback,
 	void* cookie)
@@ -253,9 +262,29 @@ RemoteHWInterface::_EventThread()
 		switch (code) {
 			case RP_INIT_CONNECTION:
 			{
+				// older clients don't send any features
+				uint32 features = 0;
+				if (message.DataLeft() >= sizeof(uint32))
+					message.Read(features);
+
+				features &= RP_FEATURE_STREAM_COMPRESSION
+					| RP_FEATURE_BITMAP_DELTAS;
+				if ((features & RP_FEATURE_STREAM_COMPRESSION) != 0
+					&& (!fSender.IsSet()
+						|| !StreamEncoder::CompressionSupported())) {
+					features &= ~(uint32)RP_FEATURE_STREAM_COMPRESSION;
+				}
+
 				RemoteMessage reply(NULL, fSendBuffer.Get());
 				reply.Start(RP_INIT_CONNECTION);
+				reply.Add(features);
 				status_t result = reply.Flush();
+				fClientFeatures = features;
+
+				// the reply above still goes out uncompressed
+				if ((features & RP_FEATURE_STREAM_COMPRESSION) != 0)
+					fSender->EnableCompression();
+
 				(void)result;
 				TRACE("init connection result: %s\n", strerror(result));
 				reply.Start(RP_SET_CURSOR);
@@ -344,6 +373,10 @@ RemoteHWInterface::_NewConnection(BNetEndpoint &endpoint)
 
 	fSendBuffer->MakeEmpty();
 
+	// a new client has to ask for the features again, and has no bitmaps
+	fClientFeatures = 0;
+	fBitmapCache.Clear();
+
 	BNetEndpoint *sendEndpoint = new(std::nothrow) BNetEndpoint(endpoint);
 	if (sendEndpoint == NULL)
 		return B_NO_MEMORY;
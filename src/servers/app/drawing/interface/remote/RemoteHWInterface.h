@@ -9,6 +9,7 @@
 #define REMOTE_HW_INTERFACE_H
 
 #include "HWInterface.h"
+#include "RemoteBitmapCache.h"
 
 #include <AutoDeleter.h>
 #include <Locker.h>
@@ -83,6 +84,9 @@ virtual	status_t					CopyBackToFront(const BRect& frame);
 										{ return fReceiveBuffer.Get(); }
 		StreamingRingBuffer*		SendBuffer() { return fSendBuffer.Get(); }
 
+		bool						SupportsBitmapDeltas() const;
+		RemoteBitmapCache&			BitmapCache() { return fBitmapCache; }
+
 typedef bool (*CallbackFunction)(void* cookie, RemoteMessage& message);
 
 		status_t					AddCallback(uint32 token,
@@ -111,6 +115,7 @@ static	status_t					_NewConnectionCallback(void *cookie,
 		bool						fIsConnected;
 		uint32						fProtocolVersion;
 		uint32						fConnectionSpeed;
+		uint32						fClientFeatures;
 		display_mode				fFallbackMode;
 		display_mode				fCurrentMode;
 		display_mode				fClientMode;
@@ -125,6 +130,8 @@ static	status_t					_NewConnectionCallback(void *cookie,
 		ObjectDeleter<NetSender>	fSender;
 		ObjectDeleter<NetReceiver>	fReceiver;
 
+		RemoteBitmapCache			fBitmapCache;
+
 		thread_id					fEventThread;
 		ObjectDeleter<RemoteEventStream>
 									fEventStream;
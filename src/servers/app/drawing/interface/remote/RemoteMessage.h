@@ -41,6 +41,7 @@ enum {
 	RP_CLOSE_CONNECTION,
 	RP_GET_SYSTEM_PALETTE,
 	RP_GET_SYSTEM_PALETTE_RESULT,
+	RP_ENABLE_STREAM_COMPRESSION,
 
 	RP_CREATE_STATE = 20,
 	RP_DELETE_STATE,
@@ -65,6 +66,7 @@ enum {
 	RP_INVERT_RECT,
 	RP_DRAW_BITMAP,
 	RP_DRAW_BITMAP_RECTS,
+	RP_DRAW_BITMAP_DELTA,
 
 	RP_STROKE_ARC = 80,
 	RP_STROKE_BEZIER,
@@ -139,6 +141,19 @@ enum {
 };
 
 
+// features a client can ask for with RP_INIT_CONNECTION, the server replies
+// with the ones it will use
+enum {
+	RP_FEATURE_STREAM_COMPRESSION	= 0x01,
+	RP_FEATURE_BITMAP_DELTAS		= 0x02
+};
+
+// the number of bitmaps a client keeps for RP_DRAW_BITMAP_DELTA
+enum {
+	RP_BITMAP_DELTA_SLOT_COUNT		= 8
+};
+
+
 class RemoteMessage {
 public:
 								RemoteMessage(StreamingRingBuffer* source,
@@ -157,6 +172,7 @@ public:
 		void					Add(const T& value);
 
 		void					AddString(const char* string, size_t length);
+		void					AddData(const void* data, size_t length);
 		void					AddRegion(const BRegion& region);
 		void					AddGradient(const BGradient& gradient);
 		void					AddTransform(const BAffineTransform& transform);
@@ -186,6 +202,7 @@ public:
 									// sets viewstate and returns pattern
 
 		status_t				ReadString(char** _string, size_t& length);
+		status_t				ReadData(void* data, size_t length);
 		status_t				ReadBitmap(BBitmap** _bitmap,
 									bool minimal = false,
 									color_space colorSpace = B_RGB32,
@@ -289,6 +306,18 @@ RemoteMessage::AddString(const char* string, size_t length)
 }
 
 
+inline void
+RemoteMessage::AddData(const void* data, size_t length)
+{
+	if (length > fAvailable && !_MakeSpace(length))
+		return;
+
+	memcpy(fBuffer + fWriteIndex, data, length);
+	fWriteIndex += length;
+	fAvailable -= length;
+}
+
+
 inline void
 RemoteMessage::AddRegion(const BRegion& region)
 {
@@ -331,6 +360,27 @@ RemoteMessage::Read(T& value)
 }
 
 
+inline status_t
+RemoteMessage::ReadData(void* data, size_t length)
+{
+	if (fDataLeft < length)
+		return B_ERROR;
+
+	if (fSource == NULL)
+		return B_NO_INIT;
+
+	int32 readSize = fSource->Read(data, length);
+	if (readSize < 0)
+		return readSize;
+
+	if ((size_t)readSize != length)
+		return B_ERROR;
+
+	fDataLeft -= readSize;
+	return B_OK;
+}
+
+
 inline status_t
 RemoteMessage::ReadRegion(BRegion& region)
 {
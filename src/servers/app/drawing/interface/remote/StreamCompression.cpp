@@ -0,0 +1,262 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "StreamCompression.h"
+
+#include "RemoteMessage.h"
+
+#include <ZstdCompressionAlgorithm.h>
+
+#include <OS.h>
+
+#include <string.h>
+
+
+static const size_t kHeaderSize = sizeof(uint16) + sizeof(uint32);
+
+
+static status_t
+create_compressor(BDataIO* output, BDataIO*& _stream)
+{
+	// Remote sessions are interactive, so latency matters more than the
+	// last bit of compression
+	BZstdCompressionParameters parameters(B_ZSTD_COMPRESSION_FASTEST);
+	BZstdCompressionAlgorithm algorithm;
+	return algorithm.CreateCompressingOutputStream(output, &parameters,
+		_stream);
+}
+
+
+static status_t
+create_decompressor(BDataIO* output, BDataIO*& _stream)
+{
+	BZstdCompressionAlgorithm algorithm;
+	return algorithm.CreateDecompressingOutputStream(output, NULL, _stream);
+}
+
+
+// #pragma mark - MessageTracker
+
+
+MessageTracker::MessageTracker()
+	:
+	fHeaderSize(0),
+	fMessageLeft(0),
+	fLastCode(0)
+{
+}
+
+
+/*!	Follows the stream over \a data up to the end of the next message, or
+	the end of \a data, whichever comes first. Returns the number of bytes
+	passed.
+*/
+size_t
+MessageTracker::Advance(const uint8* data, size_t size)
+{
+	size_t offset = 0;
+	if (fHeaderSize < kHeaderSize) {
+		size_t length = min_c(kHeaderSize - fHeaderSize, size);
+		memcpy(fHeader + fHeaderSize, data, length);
+		fHeaderSize += length;
+		offset += length;
+		if (fHeaderSize < kHeaderSize)
+			return offset;
+
+		uint32 messageSize;
+		memcpy(&fLastCode, fHeader, sizeof(uint16));
+		memcpy(&messageSize, fHeader + sizeof(uint16), sizeof(uint32));
+		fMessageLeft = messageSize > kHeaderSize ? messageSize - kHeaderSize
+			: 0;
+	}
+
+	size_t length = min_c((size_t)fMessageLeft, size - offset);
+	fMessageLeft -= length;
+	offset += length;
+
+	if (fMessageLeft == 0)
+		fHeaderSize = 0;
+
+	return offset;
+}
+
+
+// #pragma mark - StreamEncoder
+
+
+StreamEncoder::StreamEncoder(BDataIO* output)
+	:
+	fOutput(output),
+	fCompressionRequested(0)
+{
+}
+
+
+StreamEncoder::~StreamEncoder()
+{
+}
+
+
+/*static*/ bool
+StreamEncoder::CompressionSupported()
+{
+	BMallocIO output;
+	BDataIO* stream;
+	if (create_compressor(&output, stream) != B_OK)
+		return false;
+
+	delete stream;
+	return true;
+}
+
+
+/*!	Asks for compression to start at the next message boundary. This may be
+	called from a different thread than the one writing.
+*/
+void
+StreamEncoder::RequestCompression()
+{
+	atomic_set(&fCompressionRequested, 1);
+}
+
+
+status_t
+StreamEncoder::Write(const void* _data, size_t size)
+{
+	const uint8* data = (const uint8*)_data;
+
+	size_t plainSize = 0;
+	while (plainSize < size && !fCompressor.IsSet()) {
+		if (fTracker.AtBoundary() && atomic_get(&fCompressionRequested) != 0) {
+			status_t result = fOutput->WriteExactly(data, plainSize);
+			if (result != B_OK)
+				return result;
+
+			data += plainSize;
+			size -= plainSize;
+			plainSize = 0;
+
+			result = _StartCompression();
+			if (result != B_OK)
+				return result;
+
+			continue;
+		}
+
+		plainSize += fTracker.Advance(data + plainSize, size - plainSize);
+	}
+
+	if (plainSize > 0) {
+		status_t result = fOutput->WriteExactly(data, plainSize);
+		if (result != B_OK)
+			return result;
+
+		data += plainSize;
+		size -= plainSize;
+	}
+
+	if (size == 0)
+		return B_OK;
+
+	status_t result = fCompressor->WriteExactly(data, size);
+	if (result != B_OK)
+		return result;
+
+	// Flush, so that the receiver can decompress everything written so far
+	return fCompressor->Flush();
+}
+
+
+status_t
+StreamEncoder::_StartCompression()
+{
+	atomic_set(&fCompressionRequested, 0);
+
+	BDataIO* stream;
+	if (create_compressor(fOutput, stream) != B_OK) {
+		// keep sending the stream as it is
+		return B_OK;
+	}
+
+	fCompressor.SetTo(stream);
+
+	uint8 message[kHeaderSize];
+	uint16 code = RP_ENABLE_STREAM_COMPRESSION;
+	uint32 messageSize = kHeaderSize;
+	memcpy(message, &code, sizeof(uint16));
+	memcpy(message + sizeof(uint16), &messageSize, sizeof(uint32));
+
+	return fOutput->WriteExactly(message, sizeof(message));
+}
+
+
+// #pragma mark - StreamDecoder
+
+
+StreamDecoder::StreamDecoder(BDataIO* output)
+	:
+	fOutput(output)
+{
+}
+
+
+StreamDecoder::~StreamDecoder()
+{
+}
+
+
+/*static*/ bool
+StreamDecoder::DecompressionSupported()
+{
+	BMallocIO output;
+	BDataIO* stream;
+	if (create_decompressor(&output, stream) != B_OK)
+		return false;
+
+	delete stream;
+	return true;
+}
+
+
+status_t
+StreamDecoder::Write(const void* _data, size_t size)
+{
+	const uint8* data = (const uint8*)_data;
+
+	size_t plainSize = 0;
+	while (plainSize < size && !fDecompressor.IsSet()) {
+		plainSize += fTracker.Advance(data + plainSize, size - plainSize);
+
+		if (fTracker.AtBoundary()
+			&& fTracker.LastCode() == RP_ENABLE_STREAM_COMPRESSION) {
+			BDataIO* stream;
+			status_t result = create_decompressor(fOutput, stream);
+			if (result != B_OK)
+				return result;
+
+			fDecompressor.SetTo(stream);
+		}
+	}
+
+	if (plainSize > 0) {
+		// The RP_ENABLE_STREAM_COMPRESSION message is passed on as well, so
+		// that the client knows about it
+		status_t result = fOutput->WriteExactly(data, plainSize);
+		if (result != B_OK)
+			return result;
+
+		data += plainSize;
+		size -= plainSize;
+	}
+
+	if (size == 0)
+		return B_OK;
+
+	status_t result = fDecompressor->WriteExactly(data, size);
+	if (result != B_OK)
+		return result;
+
+	return fDecompressor->Flush();
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef STREAM_COMPRESSION_H
+#define STREAM_COMPRESSION_H
+
+#include <AutoDeleter.h>
+#include <DataIO.h>
+#include <SupportDefs.h>
+
+
+// Follows the message boundaries in a stream of remote protocol messages.
+class MessageTracker {
+public:
+								MessageTracker();
+
+		size_t					Advance(const uint8* data, size_t size);
+
+		bool					AtBoundary() const
+									{ return fHeaderSize == 0; }
+		uint16					LastCode() const
+									{ return fLastCode; }
+
+private:
+		uint8					fHeader[sizeof(uint16) + sizeof(uint32)];
+		size_t					fHeaderSize;
+		uint32					fMessageLeft;
+		uint16					fLastCode;
+};
+
+
+// Writes a message stream to its output. Once compression was requested,
+// it inserts an RP_ENABLE_STREAM_COMPRESSION message at the next message
+// boundary and zstd compresses everything after it.
+class StreamEncoder {
+public:
+								StreamEncoder(BDataIO* output);
+								~StreamEncoder();
+
+static	bool					CompressionSupported();
+
+		void					RequestCompression();
+		bool					IsCompressing() const
+									{ return fCompressor.IsSet(); }
+
+		status_t				Write(const void* data, size_t size);
+
+private:
+		status_t				_StartCompression();
+
+		BDataIO*				fOutput;
+		MessageTracker			fTracker;
+		int32					fCompressionRequested;
+		ObjectDeleter<BDataIO>	fCompressor;
+};
+
+
+// Reverses what StreamEncoder did: passes the stream through until an
+// RP_ENABLE_STREAM_COMPRESSION message, and decompresses everything after.
+class StreamDecoder {
+public:
+								StreamDecoder(BDataIO* output);
+								~StreamDecoder();
+
+static	bool					DecompressionSupported();
+
+		bool					IsDecompressing() const
+									{ return fDecompressor.IsSet(); }
+
+		status_t				Write(const void* data, size_t size);
+
+private:
+		BDataIO*				fOutput;
+		MessageTracker			fTracker;
+		ObjectDeleter<BDataIO>	fDecompressor;
+};
+
+#endif // STREAM_COMPRESSION_H
@@ -26,8 +26,10 @@
 
 #include "FontCacheEntry.h"
 
+#include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <new>
 
 #include <Autolock.h>
@@ -41,6 +43,12 @@
 
 BLocker FontCacheEntry::sUsageUpdateLock("FontCacheEntry usage lock");
 
+static const size_t kCoverageAtlasPageSize = 64 * 1024;
+static const size_t kMaxGlyphCoverageSize = 8 * 1024;
+	// Glyphs whose coverage mask would be larger than this are rendered from
+	// their scanlines. Since native glyph bitmaps are only used up to a font
+	// size of 30, this is hardly ever the case.
+
 
 class FontCacheEntry::GlyphCachePool {
 	// This class needs to be defined before any inline functions, as otherwise
@@ -126,6 +134,58 @@ private:
 };
 
 
+/*!	Hands out the memory for the coverage masks of the glyphs of a
+	FontCacheEntry. The masks are packed into large pages, which keeps the
+	allocation overhead low and the masks of a string close together. The
+	memory is only freed together with the entry.
+*/
+class FontCacheEntry::CoverageAtlas {
+	struct Page {
+		Page*	next;
+	};
+public:
+	CoverageAtlas()
+		:
+		fPages(NULL),
+		fFreeSpace(0)
+	{
+	}
+
+	~CoverageAtlas()
+	{
+		while (fPages != NULL) {
+			Page* next = fPages->next;
+			free(fPages);
+			fPages = next;
+		}
+	}
+
+	uint8* Allocate(size_t size)
+	{
+		if (size > kCoverageAtlasPageSize - sizeof(Page))
+			return NULL;
+
+		if (size > fFreeSpace) {
+			Page* page = (Page*)malloc(kCoverageAtlasPageSize);
+			if (page == NULL)
+				return NULL;
+
+			page->next = fPages;
+			fPages = page;
+			fFreeSpace = kCoverageAtlasPageSize - sizeof(Page);
+		}
+
+		uint8* data = (uint8*)fPages + kCoverageAtlasPageSize - fFreeSpace;
+		fFreeSpace -= size;
+		return data;
+	}
+
+private:
+	Page*	fPages;
+	size_t	fFreeSpace;
+};
+
+
 // #pragma mark -
 
 
@@ -133,6 +193,7 @@ FontCacheEntry::FontCacheEntry()
 	:
 	MultiLocker("FontCacheEntry lock"),
 	fGlyphCache(new(std::nothrow) GlyphCachePool()),
+	fCoverageAtlas(new(std::nothrow) CoverageAtlas()),
 	fEngine(),
 	fLastUsedTime(LONGLONG_MIN),
 	fUseCounter(0)
@@ -334,14 +395,17 @@ FontCacheEntry::CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
 	}
 
 	if (engine->PrepareGlyph(glyphIndex)) {
-		glyph = fGlyphCache->CacheGlyph(glyphCode,
+		GlyphCache* newGlyph = fGlyphCache->CacheGlyph(glyphCode,
 			engine->DataSize(), engine->DataType(), engine->Bounds(),
 			engine->AdvanceX(), engine->AdvanceY(),
 			engine->PreciseAdvanceX(), engine->PreciseAdvanceY(),
 			engine->InsetLeft(), engine->InsetRight());
 
-		if (glyph != NULL)
-			engine->WriteGlyphTo(glyph->data);
+		if (newGlyph != NULL) {
+			engine->WriteGlyphTo(newGlyph->data);
+			_CreateCoverage(newGlyph);
+		}
+		glyph = newGlyph;
 	}
 
 	return glyph;
@@ -436,3 +500,93 @@ FontCacheEntry::_RenderTypeFor(const ServerFont& font, bool forceVector)
 
 	return renderingType;
 }
+
+
+/*!	Expands the scanlines of a gray8 or subpix glyph into a coverage mask,
+	which the AGGTextRenderer can blend directly, without going through the
+	scanline adaptor for every glyph drawn.
+*/
+void
+FontCacheEntry::_CreateCoverage(GlyphCache* glyph)
+{
+	int32 bytesPerPixel;
+	switch (glyph->data_type) {
+		case glyph_data_gray8:
+			bytesPerPixel = 1;
+			break;
+		case glyph_data_subpix:
+			// the spans of subpix glyphs count subpixels
+			bytesPerPixel = 3;
+			break;
+		default:
+			return;
+	}
+
+	if (!fCoverageAtlas.IsSet())
+		return;
+
+	GlyphGray8Adapter adapter(glyph->data, glyph->data_size, 0, 0);
+	GlyphGray8Scanline scanline;
+
+	// determine the extent of the spans
+	int32 left = INT32_MAX;
+	int32 top = INT32_MAX;
+	int32 right = INT32_MIN;
+	int32 bottom = INT32_MIN;
+	if (!adapter.rewind_scanlines())
+		return;
+	while (adapter.sweep_scanline(scanline)) {
+		top = std::min(top, (int32)scanline.y());
+		bottom = std::max(bottom, (int32)scanline.y());
+
+		GlyphGray8Scanline::const_iterator span = scanline.begin();
+		for (unsigned spanCount = scanline.num_spans(); ; ++span) {
+			int32 width = abs(span->len) / bytesPerPixel;
+			left = std::min(left, (int32)span->x);
+			right = std::max(right, (int32)span->x + width - 1);
+			if (--spanCount == 0)
+				break;
+		}
+	}
+
+	if (left > right || top > bottom)
+		return;
+
+	int32 width = right - left + 1;
+	int32 height = bottom - top + 1;
+	int32 bytesPerRow = width * bytesPerPixel;
+	size_t size = (size_t)bytesPerRow * height;
+	if (size > kMaxGlyphCoverageSize)
+		return;
+
+	uint8* coverage = fCoverageAtlas->Allocate(size);
+	if (coverage == NULL)
+		return;
+	memset(coverage, 0, size);
+
+	adapter.rewind_scanlines();
+	while (adapter.sweep_scanline(scanline)) {
+		uint8* row = coverage + (scanline.y() - top) * bytesPerRow;
+
+		GlyphGray8Scanline::const_iterator span = scanline.begin();
+		for (unsigned spanCount = scanline.num_spans(); ; ++span) {
+			uint8* covers = row + (span->x - left) * bytesPerPixel;
+			if (span->len < 0) {
+				int32 width = -span->len / bytesPerPixel;
+				memset(covers, *span->covers, width * bytesPerPixel);
+			} else {
+				int32 width = span->len / bytesPerPixel;
+				memcpy(covers, span->covers, width * bytesPerPixel);
+			}
+			if (--spanCount == 0)
+				break;
+		}
+	}
+
+	glyph->coverage = coverage;
+	glyph->coverage_left = left;
+	glyph->coverage_top = top;
+	glyph->coverage_width = width;
+	glyph->coverage_height = height;
+	glyph->coverage_bytes_per_row = bytesPerRow;
+}
@@ -58,6 +58,12 @@ struct GlyphCache {
 		precise_advance_y(preciseAdvanceY),
 		inset_left(insetLeft),
 		inset_right(insetRight),
+		coverage(NULL),
+		coverage_left(0),
+		coverage_top(0),
+		coverage_width(0),
+		coverage_height(0),
+		coverage_bytes_per_row(0),
 		hash_link(NULL)
 	{
 	}
@@ -79,6 +85,16 @@ struct GlyphCache {
 	float			inset_left;
 	float			inset_right;
 
+	// Pre-rasterized coverage of gray8 and subpix glyphs (3 bytes per pixel
+	// for the latter), relative to the glyph origin. The memory belongs to
+	// the FontCacheEntry's coverage atlas. NULL, if there is none.
+	const uint8*	coverage;
+	int32			coverage_left;
+	int32			coverage_top;
+	int32			coverage_width;
+	int32			coverage_height;
+	int32			coverage_bytes_per_row;
+
 	GlyphCache*		hash_link;
 };
 
@@ -143,10 +159,15 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 	static	glyph_rendering		_RenderTypeFor(const ServerFont& font,
 									bool forceVector);
 
+			void				_CreateCoverage(GlyphCache* glyph);
+
 			class GlyphCachePool;
+			class CoverageAtlas;
 
 			ObjectDeleter<GlyphCachePool>
 								fGlyphCache;
+			ObjectDeleter<CoverageAtlas>
+								fCoverageAtlas;
 			FontEngine			fEngine;
 
 	static	BLocker				sUsageUpdateLock;
@@ -13,7 +13,10 @@
 #include <grp.h>
 #include <pwd.h>
 
+#include <algorithm>
+
 #include <File.h>
+#include <OS.h>
 #include <Path.h>
 #include <SymLink.h>
 
@@ -36,6 +39,9 @@ using namespace BPackageKit::BPrivate;
 using BPackageKit::BTransactionIssue;
 
 
+static const int32 kMaxPrepareThreads = 8;
+
+
 // #pragma mark - TransactionIssueBuilder
 
 
@@ -106,6 +112,54 @@ private:
 };
 
 
+// #pragma mark - PackageToPrepare
+
+
+struct CommitTransactionHandler::PackageToPrepare {
+	BString		name;
+	Package*	package;
+	bool		isNew;
+	Exception	error;
+
+	PackageToPrepare()
+		:
+		name(),
+		package(NULL),
+		isNew(false),
+		error(B_TRANSACTION_OK)
+	{
+	}
+
+	bool Failed() const
+	{
+		return error.Error() != B_TRANSACTION_OK;
+	}
+};
+
+
+// #pragma mark - PrepareContext
+
+
+struct CommitTransactionHandler::PrepareContext {
+	CommitTransactionHandler*	handler;
+	PrepareFunction				function;
+	PackageToPrepare*			packages;
+	int32						count;
+	int32						nextIndex;
+
+	PrepareContext(CommitTransactionHandler* handler, PrepareFunction function,
+		PackageToPrepare* packages, int32 count)
+		:
+		handler(handler),
+		function(function),
+		packages(packages),
+		count(count),
+		nextIndex(0)
+	{
+	}
+};
+
+
 // #pragma mark - CommitTransactionHandler
 
 
@@ -354,9 +408,16 @@ CommitTransactionHandler::_ReadPackagesToActivate(
 			.SetSystemError(error);
 	}
 
-	// read the packages
+	ArrayDeleter<PackageToPrepare> packages(
+		new(std::nothrow) PackageToPrepare[packagesToActivateCount]);
+	if (!packages.IsSet())
+		throw Exception(B_TRANSACTION_NO_MEMORY);
+
+	// check the packages
+	int32 packagesToReadCount = 0;
 	for (int32 i = 0; i < packagesToActivateCount; i++) {
 		BString packageName = packagesToActivate.StringAt(i);
+		packages[i].name = packageName;
 		// make sure it doesn't clash with an already existing package,
 		// except in first boot mode where it should always clash.
 		Package* package = fVolumeState->FindPackage(packageName);
@@ -365,15 +426,13 @@ CommitTransactionHandler::_ReadPackagesToActivate(
 				throw Exception(B_TRANSACTION_NO_SUCH_PACKAGE)
 					.SetPackageName(packageName);
 			}
-			if (!fPackagesToActivate.AddItem(package))
-				throw Exception(B_TRANSACTION_NO_MEMORY);
+			packages[i].package = package;
 			continue;
 		} else {
 			if (package != NULL) {
 				if (fPackagesAlreadyAdded.find(package)
 						!= fPackagesAlreadyAdded.end()) {
-					if (!fPackagesToActivate.AddItem(package))
-						throw Exception(B_TRANSACTION_NO_MEMORY);
+					packages[i].package = package;
 					continue;
 				}
 
@@ -385,26 +444,168 @@ CommitTransactionHandler::_ReadPackagesToActivate(
 			}
 		}
 
-		// read the package
-		error = fPackageFileManager->CreatePackage(
-			NotOwningEntryRef(fTransactionDirectoryRef, packageName),
-			package);
-		if (error != B_OK) {
-			if (error == B_NO_MEMORY)
-				throw Exception(B_TRANSACTION_NO_MEMORY);
-			throw Exception(B_TRANSACTION_FAILED_TO_READ_PACKAGE_FILE)
-				.SetPackageName(packageName)
-				.SetPath1(_GetPath(
-					FSUtils::Entry(
-						NotOwningEntryRef(fTransactionDirectoryRef,
-							packageName)),
-					packageName))
-				.SetSystemError(error);
+		packagesToReadCount++;
+	}
+
+	// Read the new packages concurrently. Only their activation has to be
+	// serialized.
+	if (packagesToReadCount > 0) {
+		_PrepareConcurrently(packages.Get(), packagesToActivateCount,
+			&CommitTransactionHandler::_ReadPackage);
+	}
+
+	// Add all packages to the list, so that the ones we have read are deleted
+	// in case of error.
+	bool outOfMemory = false;
+	for (int32 i = 0; i < packagesToActivateCount; i++) {
+		Package* package = packages[i].package;
+		if (package == NULL)
+			continue;
+
+		if (outOfMemory || !fPackagesToActivate.AddItem(package)) {
+			if (packages[i].isNew)
+				delete package;
+			outOfMemory = true;
 		}
+	}
 
-		if (!fPackagesToActivate.AddItem(package)) {
-			delete package;
+	if (outOfMemory)
+		throw Exception(B_TRANSACTION_NO_MEMORY);
+
+	for (int32 i = 0; i < packagesToActivateCount; i++) {
+		if (packages[i].Failed())
+			throw packages[i].error;
+	}
+
+	// Extracting the global writable files of a package doesn't depend on the
+	// other packages either, so do that ahead of time, too.
+	Package* writableFilesPackage = NULL;
+	for (int32 i = 0; i < packagesToActivateCount; i++) {
+		BStringList contentPaths;
+		if (packages[i].isNew) {
+			_GetGlobalWritableFilePaths(packages[i].package, contentPaths);
+			if (!contentPaths.IsEmpty()) {
+				writableFilesPackage = packages[i].package;
+				break;
+			}
+		}
+	}
+
+	if (writableFilesPackage != NULL) {
+		_OpenWritableFilesDirectory(writableFilesPackage);
+		_PrepareConcurrently(packages.Get(), packagesToActivateCount,
+			&CommitTransactionHandler::_ExtractGlobalWritableFiles);
+
+		for (int32 i = 0; i < packagesToActivateCount; i++) {
+			if (packages[i].Failed())
+				throw packages[i].error;
+		}
+	}
+}
+
+
+void
+CommitTransactionHandler::_ReadPackage(PackageToPrepare& package)
+{
+	if (package.package != NULL)
+		return;
+
+	NotOwningEntryRef entryRef(fTransactionDirectoryRef, package.name);
+	status_t error = fPackageFileManager->CreatePackage(entryRef,
+		package.package);
+	if (error != B_OK) {
+		package.package = NULL;
+		if (error == B_NO_MEMORY)
 			throw Exception(B_TRANSACTION_NO_MEMORY);
+		throw Exception(B_TRANSACTION_FAILED_TO_READ_PACKAGE_FILE)
+			.SetPackageName(package.name)
+			.SetPath1(_GetPath(FSUtils::Entry(entryRef), package.name))
+			.SetSystemError(error);
+	}
+
+	package.isNew = true;
+}
+
+
+/*!	Extracts the global writable files of a package read by _ReadPackage(),
+	so that _AddGlobalWritableFiles() finds them already extracted later.
+	The extracted files are kept, even if the transaction fails, hence this
+	doesn't need to be part of the transaction.
+*/
+void
+CommitTransactionHandler::_ExtractGlobalWritableFiles(
+	PackageToPrepare& package)
+{
+	if (!package.isNew)
+		return;
+
+	BStringList contentPaths;
+	_GetGlobalWritableFilePaths(package.package, contentPaths);
+	if (contentPaths.IsEmpty())
+		return;
+
+	// fFSTransaction must not be used concurrently. Use one of our own to
+	// clean up after a failed extraction.
+	FSTransaction transaction;
+	BDirectory extractedFilesDirectory;
+	try {
+		_ExtractPackageContent(package.package, contentPaths,
+			fWritableFilesDirectory, extractedFilesDirectory, transaction);
+	} catch (...) {
+		transaction.RollBack();
+		throw;
+	}
+}
+
+
+void
+CommitTransactionHandler::_PrepareConcurrently(PackageToPrepare* packages,
+	int32 count, PrepareFunction function)
+{
+	PrepareContext context(this, function, packages, count);
+
+	system_info info;
+	int32 threadCount = get_system_info(&info) == B_OK
+		? (int32)info.cpu_count : 1;
+	threadCount = std::min(std::min(threadCount, kMaxPrepareThreads), count);
+
+	// the current thread does its share of the work, too
+	thread_id threads[kMaxPrepareThreads];
+	int32 spawnedCount = 0;
+	for (int32 i = 1; i < threadCount; i++) {
+		thread_id thread = spawn_thread(&_PrepareThreadEntry,
+			"prepare packages", B_NORMAL_PRIORITY, &context);
+		if (thread < 0)
+			break;
+
+		threads[spawnedCount++] = thread;
+		resume_thread(thread);
+	}
+
+	_PrepareThreadEntry(&context);
+
+	for (int32 i = 0; i < spawnedCount; i++)
+		wait_for_thread(threads[i], NULL);
+}
+
+
+/*static*/ status_t
+CommitTransactionHandler::_PrepareThreadEntry(void* data)
+{
+	PrepareContext* context = (PrepareContext*)data;
+
+	while (true) {
+		int32 index = atomic_add(&context->nextIndex, 1);
+		if (index >= context->count)
+			return B_OK;
+
+		PackageToPrepare& package = context->packages[index];
+		try {
+			(context->handler->*context->function)(package);
+		} catch (Exception& exception) {
+			package.error = exception;
+		} catch (std::bad_alloc& exception) {
+			package.error = Exception(B_TRANSACTION_NO_MEMORY);
 		}
 	}
 }
@@ -827,15 +1028,8 @@ void
 CommitTransactionHandler::_AddGlobalWritableFiles(Package* package)
 {
 	// get the list of included files
-	const BObjectList<BGlobalWritableFileInfo, true>& files
-		= package->Info().GlobalWritableFileInfos();
 	BStringList contentPaths;
-	for (int32 i = 0; const BGlobalWritableFileInfo* file = files.ItemAt(i);
-		i++) {
-		if (file->IsIncluded() && !contentPaths.Add(file->Path()))
-			throw std::bad_alloc();
-	}
-
+	_GetGlobalWritableFilePaths(package, contentPaths);
 	if (contentPaths.IsEmpty())
 		return;
 
@@ -852,28 +1046,15 @@ CommitTransactionHandler::_AddGlobalWritableFiles(Package* package)
 	}
 
 	// Open writable-files directory in the administrative directory.
-	if (fWritableFilesDirectory.InitCheck() != B_OK) {
-		RelativePath directoryPath(kAdminDirectoryName,
-			kWritableFilesDirectoryName);
-		error = _OpenPackagesSubDirectory(directoryPath, true,
-			fWritableFilesDirectory);
-
-		if (error != B_OK) {
-			throw Exception(B_TRANSACTION_FAILED_TO_OPEN_DIRECTORY)
-				.SetPath1(_GetPath(
-					FSUtils::Entry(fVolume->PackagesDirectoryRef(),
-						directoryPath.ToString()),
-					directoryPath.ToString()))
-				.SetPackageName(package->FileName())
-				.SetSystemError(error);
-		}
-	}
+	_OpenWritableFilesDirectory(package);
 
 	// extract files into a subdir of the writable-files directory
 	BDirectory extractedFilesDirectory;
 	_ExtractPackageContent(package, contentPaths,
-		fWritableFilesDirectory, extractedFilesDirectory);
+		fWritableFilesDirectory, extractedFilesDirectory, fFSTransaction);
 
+	const BObjectList<BGlobalWritableFileInfo, true>& files
+		= package->Info().GlobalWritableFileInfos();
 	for (int32 i = 0; const BGlobalWritableFileInfo* file = files.ItemAt(i);
 		i++) {
 		if (file->IsIncluded()) {
@@ -884,6 +1065,43 @@ CommitTransactionHandler::_AddGlobalWritableFiles(Package* package)
 }
 
 
+void
+CommitTransactionHandler::_OpenWritableFilesDirectory(Package* package)
+{
+	if (fWritableFilesDirectory.InitCheck() == B_OK)
+		return;
+
+	RelativePath directoryPath(kAdminDirectoryName,
+		kWritableFilesDirectoryName);
+	status_t error = _OpenPackagesSubDirectory(directoryPath, true,
+		fWritableFilesDirectory);
+
+	if (error != B_OK) {
+		throw Exception(B_TRANSACTION_FAILED_TO_OPEN_DIRECTORY)
+			.SetPath1(_GetPath(
+				FSUtils::Entry(fVolume->PackagesDirectoryRef(),
+					directoryPath.ToString()),
+				directoryPath.ToString()))
+			.SetPackageName(package->FileName())
+			.SetSystemError(error);
+	}
+}
+
+
+/*static*/ void
+CommitTransactionHandler::_GetGlobalWritableFilePaths(Package* package,
+	BStringList& _paths)
+{
+	const BObjectList<BGlobalWritableFileInfo, true>& files
+		= package->Info().GlobalWritableFileInfos();
+	for (int32 i = 0; const BGlobalWritableFileInfo* file = files.ItemAt(i);
+		i++) {
+		if (file->IsIncluded() && !_paths.Add(file->Path()))
+			throw std::bad_alloc();
+	}
+}
+
+
 void
 CommitTransactionHandler::_AddGlobalWritableFile(Package* package,
 	const BGlobalWritableFileInfo& file, const BDirectory& rootDirectory,
@@ -1124,6 +1342,40 @@ CommitTransactionHandler::_AddGlobalWritableFileRecurse(Package* package,
 		return;
 	}
 
+	// If the package didn't change the entry, keep whatever is there -- it
+	// may have been modified by the user -- and only tag it with the new
+	// package version, so that the next update compares against the right
+	// original.
+	bool unchanged;
+	if (S_ISREG(sourceStat.st_mode)) {
+		error = FSUtils::CompareFileContent(
+			FSUtils::Entry(sourceDirectory, relativeSourcePath.Leaf()),
+			FSUtils::Entry(fWritableFilesDirectory,
+				originalRelativeSourcePath),
+			unchanged);
+	} else {
+		error = FSUtils::CompareSymLinks(
+			FSUtils::Entry(sourceDirectory, relativeSourcePath.Leaf()),
+			FSUtils::Entry(fWritableFilesDirectory,
+				originalRelativeSourcePath),
+			unchanged);
+	}
+
+	if (error == B_OK && unchanged) {
+		BString packageName(package->RevisionedNameThrows());
+		FSTransaction::SetAttributeOperation retagOperation(&fFSTransaction,
+			FSUtils::Entry(targetDirectory, targetName), kPackageFileAttribute,
+			originalPackage);
+		if (BNode(&targetDirectory, targetName).WriteAttrString(
+				kPackageFileAttribute, &packageName) == B_OK) {
+			retagOperation.Finished();
+			PRINT("Volume::CommitTransactionHandler::"
+				"_AddGlobalWritableFile(): "
+				"\"%s\" unchanged by the package, retagged\n", targetName);
+			return;
+		}
+	}
+
 	if (S_ISREG(sourceStat.st_mode)) {
 		// compare file content
 		bool equal;
@@ -1512,7 +1764,7 @@ CommitTransactionHandler::_QueuePostInstallScripts()
 void
 CommitTransactionHandler::_ExtractPackageContent(Package* package,
 	const BStringList& contentPaths, BDirectory& targetDirectory,
-	BDirectory& _extractedFilesDirectory)
+	BDirectory& _extractedFilesDirectory, FSTransaction& transaction)
 {
 	// check whether the subdirectory already exists
 	BString targetName(package->RevisionedNameThrows());
@@ -1574,8 +1826,7 @@ CommitTransactionHandler::_ExtractPackageContent(Package* package,
 	}
 
 	BDirectory& subDirectory = _extractedFilesDirectory;
-	FSTransaction::CreateOperation createSubDirectoryOperation(
-		&fFSTransaction,
+	FSTransaction::CreateOperation createSubDirectoryOperation(&transaction,
 		FSUtils::Entry(targetDirectory, temporaryTargetName));
 	error = targetDirectory.CreateDirectory(temporaryTargetName,
 		&subDirectory);
@@ -65,12 +65,24 @@ private:
 			typedef FSUtils::RelativePath RelativePath;
 
 			struct TransactionIssueBuilder;
+			struct PackageToPrepare;
+			struct PrepareContext;
+
+			typedef void (CommitTransactionHandler::*PrepareFunction)(
+				PackageToPrepare& package);
 
 private:
 			void				_GetPackagesToDeactivate(
 									const BActivationTransaction& transaction);
 			void				_ReadPackagesToActivate(
 									const BActivationTransaction& transaction);
+			void				_ReadPackage(PackageToPrepare& package);
+			void				_ExtractGlobalWritableFiles(
+									PackageToPrepare& package);
+			void				_PrepareConcurrently(
+									PackageToPrepare* packages, int32 count,
+									PrepareFunction function);
+	static	status_t			_PrepareThreadEntry(void* data);
 			void				_ApplyChanges();
 			void				_CreateOldStateDirectory();
 			void				_RemovePackagesToDeactivate();
@@ -81,6 +93,9 @@ private:
 									const BString& groupName);
 			void				_AddUser(Package* package, const BUser& user);
 			void				_AddGlobalWritableFiles(Package* package);
+			void				_OpenWritableFilesDirectory(Package* package);
+	static	void				_GetGlobalWritableFilePaths(Package* package,
+									BStringList& _paths);
 			void				_AddGlobalWritableFile(Package* package,
 									const BGlobalWritableFileInfo& file,
 									const BDirectory& rootDirectory,
@@ -107,7 +122,8 @@ private:
 			void				_ExtractPackageContent(Package* package,
 									const BStringList& contentPaths,
 									BDirectory& targetDirectory,
-									BDirectory& _extractedFilesDirectory);
+									BDirectory& _extractedFilesDirectory,
+									FSTransaction& transaction);
 
 			status_t			_OpenPackagesSubDirectory(
 									const RelativePath& path, bool create,
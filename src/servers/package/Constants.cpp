@@ -7,6 +7,7 @@
 #include "Constants.h"
 
 #include <package/PackagesDirectoryDefs.h>
+#include <package/packagefs.h>
 
 
 const char* const kPackageFileNameExtension = ".hpkg";
@@ -19,3 +20,4 @@ const char* const kFirstBootProcessingNeededFileName
 const char* const kWritableFilesDirectoryName = "writable-files";
 const char* const kPackageFileAttribute = "SYS:PACKAGE";
 const char* const kQueuedScriptsDirectoryName = "queued-scripts";
+const char* const kStringTableFileName = PACKAGE_FS_STRING_TABLE_FILE_NAME;
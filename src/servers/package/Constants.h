@@ -17,6 +17,7 @@ extern const char* const kFirstBootProcessingNeededFileName;
 extern const char* const kWritableFilesDirectoryName;
 extern const char* const kPackageFileAttribute;
 extern const char* const kQueuedScriptsDirectoryName;
+extern const char* const kStringTableFileName;
 
 static const bigtime_t kHandleNodeMonitorEvents = 'nmon';
 
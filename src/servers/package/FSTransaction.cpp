@@ -7,6 +7,7 @@
 #include "FSTransaction.h"
 
 #include <Entry.h>
+#include <Node.h>
 #include <package/CommitTransactionResult.h>
 #include <Path.h>
 
@@ -26,6 +27,7 @@ public:
 		TYPE_CREATE,
 		TYPE_REMOVE,
 		TYPE_MOVE,
+		TYPE_SET_ATTRIBUTE,
 	};
 
 public:
@@ -70,6 +72,12 @@ public:
 		fEnabled = enabled;
 	}
 
+	void SetAttribute(const char* attribute, const BString& oldValue)
+	{
+		fAttribute = attribute;
+		fOldValue = oldValue.String();
+	}
+
 	status_t RollBack() const
 	{
 		switch (fType) {
@@ -118,6 +126,22 @@ public:
 				}
 				return error;
 			}
+
+			case TYPE_SET_ATTRIBUTE:
+			{
+				BNode node;
+				status_t error = node.SetTo(fFromPath.c_str());
+				if (error == B_OK) {
+					BString value(fOldValue.c_str());
+					error = node.WriteAttrString(fAttribute.c_str(), &value);
+				}
+				if (error != B_OK) {
+					ERROR("Failed to restore attribute \"%s\" of \"%s\": "
+						"%s\n", fAttribute.c_str(), fFromPath.c_str(),
+						strerror(error));
+				}
+				return error;
+			}
 		}
 
 		return B_ERROR;
@@ -127,6 +151,8 @@ private:
 	Type		fType;
 	std::string	fFromPath;
 	std::string	fToPath;
+	std::string	fAttribute;
+	std::string	fOldValue;
 	int32		fModifiedOperation;
 	bool		fEnabled;
 };
@@ -193,6 +219,18 @@ FSTransaction::MoveEntry(const Entry& fromEntry, const Entry& toEntry,
 }
 
 
+int32
+FSTransaction::SetEntryAttribute(const Entry& entry, const char* attribute,
+	const BString& oldValue, int32 modifiedOperation)
+{
+	OperationInfo operation(OperationInfo::TYPE_SET_ATTRIBUTE, _GetPath(entry),
+		std::string(), modifiedOperation);
+	operation.SetAttribute(attribute, oldValue);
+	fOperations.push_back(operation);
+	return (int32)fOperations.size() - 1;
+}
+
+
 void
 FSTransaction::RemoveOperationAt(int32 index)
 {
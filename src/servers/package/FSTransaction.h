@@ -20,6 +20,7 @@ public:
 			class CreateOperation;
 			class RemoveOperation;
 			class MoveOperation;
+			class SetAttributeOperation;
 
 public:
 								FSTransaction();
@@ -35,6 +36,10 @@ public:
 			int32				MoveEntry(const Entry& fromEntry,
 									const Entry& toEntry,
 									int32 modifiedOperation = -1);
+			int32				SetEntryAttribute(const Entry& entry,
+									const char* attribute,
+									const BString& oldValue,
+									int32 modifiedOperation = -1);
 
 			void				RemoveOperationAt(int32 index);
 
@@ -130,4 +135,18 @@ public:
 };
 
 
+class FSTransaction::SetAttributeOperation : public FSTransaction::Operation {
+public:
+	SetAttributeOperation(FSTransaction* transaction, const Entry& entry,
+		const char* attribute, const BString& oldValue,
+		int32 modifiedOperation = -1)
+		:
+		Operation(transaction,
+			transaction->SetEntryAttribute(entry, attribute, oldValue,
+				modifiedOperation))
+	{
+	}
+};
+
+
 #endif	// FS_TRANSACTION_H
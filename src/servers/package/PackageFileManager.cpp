@@ -51,6 +51,10 @@ PackageFileManager::GetPackageFile(const entry_ref& entryRef,
 		fFilesByEntryRef.Remove(file);
 	}
 
+	// Reading the package info is the expensive part. Don't hold the lock
+	// meanwhile, so that several package files can be read concurrently.
+	locker.Unlock();
+
 	file = new(std::nothrow) PackageFile;
 	if (file == NULL)
 		RETURN_ERROR(B_NO_MEMORY);
@@ -61,6 +65,20 @@ PackageFileManager::GetPackageFile(const entry_ref& entryRef,
 		return error;
 	}
 
+	locker.Lock();
+
+	// someone else may have read the same file in the meantime
+	PackageFile* otherFile = fFilesByEntryRef.Lookup(entryRef);
+	if (otherFile != NULL) {
+		if (otherFile->AcquireReference() > 0) {
+			delete file;
+			_file = otherFile;
+			return B_OK;
+		}
+
+		fFilesByEntryRef.Remove(otherFile);
+	}
+
 	fFilesByEntryRef.Insert(file);
 
 	_file = file;
@@ -365,6 +365,15 @@ Root::VolumeNodeMonitorEventOccurred(Volume* volume)
 }
 
 
+void
+Root::VolumeStringTableOutdated(Volume* volume)
+{
+	// reading all active packages takes a while, so this is not done as
+	// part of the commit
+	_QueueJob(new(std::nothrow) VolumeJob(volume, &Root::_WriteStringTable));
+}
+
+
 void
 Root::LastReferenceReleased()
 {
@@ -485,6 +494,13 @@ Root::_CommitTransaction(Volume* volume, BMessage* message)
 }
 
 
+void
+Root::_WriteStringTable(Volume* volume)
+{
+	volume->WriteStringTable();
+}
+
+
 status_t
 Root::_QueueJob(Job* job)
 {
@@ -53,6 +53,7 @@ public:
 private:
 	// Volume::Listener
 	virtual	void				VolumeNodeMonitorEventOccurred(Volume* volume);
+	virtual	void				VolumeStringTableOutdated(Volume* volume);
 
 protected:
 	virtual	void				LastReferenceReleased();
@@ -75,6 +76,7 @@ private:
 			void				_ProcessNodeMonitorEvents(Volume* volume);
 			void				_CommitTransaction(Volume* volume,
 									BMessage* message);
+			void				_WriteStringTable(Volume* volume);
 
 			status_t			_QueueJob(Job* job);
 
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "StringTableWriter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#include <Directory.h>
+#include <File.h>
+#include <Path.h>
+#include <package/hpkg/StandardErrorOutput.h>
+#include <package/hpkg/PackageContentHandler.h>
+#include <package/hpkg/PackageEntry.h>
+#include <package/hpkg/PackageEntryAttribute.h>
+#include <package/hpkg/PackageReader.h>
+
+#include <AutoDeleter.h>
+#include <package/packagefs.h>
+
+#include "DebugSupport.h"
+
+
+using namespace BPackageKit::BHPKG;
+
+
+// the offsets in the table are 32 bit
+static const uint64 kMaxStringTableSize = 0xffffffff;
+
+static const uint32 kMinBucketCount = 16;
+
+
+static inline size_t
+align_entry_offset(size_t offset)
+{
+	return (offset + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+}
+
+
+// #pragma mark - ContentHandler
+
+
+struct StringTableWriter::ContentHandler : BPackageContentHandler {
+	ContentHandler(StringTableWriter* writer)
+		:
+		fWriter(writer)
+	{
+	}
+
+	virtual status_t HandleEntry(BPackageEntry* entry)
+	{
+		status_t error = fWriter->_AddString(entry->Name());
+		if (error == B_OK && entry->SymlinkPath() != NULL)
+			error = fWriter->_AddString(entry->SymlinkPath());
+		return error;
+	}
+
+	virtual status_t HandleEntryAttribute(BPackageEntry* entry,
+		BPackageEntryAttribute* attribute)
+	{
+		return fWriter->_AddString(attribute->Name());
+	}
+
+	virtual status_t HandleEntryDone(BPackageEntry* entry)
+	{
+		return B_OK;
+	}
+
+	virtual status_t HandlePackageAttribute(
+		const BPackageInfoAttributeValue& value)
+	{
+		return B_OK;
+	}
+
+	virtual void HandleErrorOccurred()
+	{
+	}
+
+private:
+	StringTableWriter*	fWriter;
+};
+
+
+// #pragma mark - StringTableWriter
+
+
+StringTableWriter::StringTableWriter()
+	:
+	fStrings()
+{
+}
+
+
+StringTableWriter::~StringTableWriter()
+{
+}
+
+
+status_t
+StringTableWriter::AddPackage(const entry_ref& packageRef)
+{
+	BPath path;
+	status_t error = path.SetTo(&packageRef);
+	if (error != B_OK)
+		return error;
+
+	BStandardErrorOutput errorOutput;
+	BPackageReader packageReader(&errorOutput);
+	error = packageReader.Init(path.Path());
+	if (error != B_OK)
+		return error;
+
+	ContentHandler handler(this);
+	return packageReader.ParseContent(&handler);
+}
+
+
+status_t
+StringTableWriter::WriteFile(BDirectory& directory, const char* fileName)
+{
+	// compute the table layout
+	uint32 stringCount = fStrings.size();
+	uint32 bucketCount = kMinBucketCount;
+	while (bucketCount < stringCount * 2) {
+		if (bucketCount > kMaxStringTableSize / 2 / sizeof(uint32))
+			return B_BAD_VALUE;
+		bucketCount *= 2;
+	}
+
+	uint64 tableSize = align_entry_offset(sizeof(PackageFSStringTableHeader)
+		+ bucketCount * sizeof(uint32));
+	for (StringSet::const_iterator it = fStrings.begin(); it != fStrings.end();
+			++it) {
+		tableSize += align_entry_offset(sizeof(PackageFSStringTableEntry)
+			+ it->Length() + 1);
+	}
+	if (tableSize > kMaxStringTableSize)
+		return B_BAD_VALUE;
+
+	uint8* table = (uint8*)calloc(tableSize, 1);
+	if (table == NULL)
+		return B_NO_MEMORY;
+	MemoryDeleter tableDeleter(table);
+
+	PackageFSStringTableHeader* header = (PackageFSStringTableHeader*)table;
+	header->magic = PACKAGE_FS_STRING_TABLE_MAGIC;
+	header->version = PACKAGE_FS_STRING_TABLE_VERSION;
+	header->headerSize = sizeof(PackageFSStringTableHeader);
+	header->stringCount = stringCount;
+	header->bucketCount = bucketCount;
+	header->tableSize = tableSize;
+
+	// add the entries and enter them into the hash table
+	uint32* buckets = (uint32*)(header + 1);
+	uint32 bucketMask = bucketCount - 1;
+	size_t offset = align_entry_offset(sizeof(PackageFSStringTableHeader)
+		+ bucketCount * sizeof(uint32));
+	for (StringSet::const_iterator it = fStrings.begin(); it != fStrings.end();
+			++it) {
+		PackageFSStringTableEntry* entry
+			= (PackageFSStringTableEntry*)(table + offset);
+		entry->reserved = NULL;
+		entry->referenceCount = PACKAGE_FS_STRING_TABLE_STATIC_REFERENCE_COUNT;
+		entry->hash = package_fs_string_hash(it->String(), it->Length());
+		memcpy(entry->string, it->String(), it->Length() + 1);
+
+		uint32 index = entry->hash & bucketMask;
+		while (buckets[index] != 0)
+			index = (index + 1) & bucketMask;
+		buckets[index] = offset;
+
+		offset += align_entry_offset(sizeof(PackageFSStringTableEntry)
+			+ it->Length() + 1);
+	}
+
+	// Write the table to a temporary file and move that over the old one. A
+	// table packagefs has mapped must not be changed.
+	BString temporaryFileName;
+	temporaryFileName.SetToFormat("%s.tmp", fileName);
+	if (temporaryFileName.IsEmpty())
+		return B_NO_MEMORY;
+
+	BFile file;
+	status_t error = file.SetTo(&directory, temporaryFileName,
+		B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	if (error != B_OK)
+		return error;
+
+	ssize_t bytesWritten = file.Write(table, tableSize);
+	if (bytesWritten < 0)
+		error = bytesWritten;
+	else if ((uint64)bytesWritten != tableSize)
+		error = B_IO_ERROR;
+	if (error == B_OK)
+		error = file.Sync();
+	file.Unset();
+
+	BEntry entry(&directory, temporaryFileName);
+	if (error == B_OK)
+		error = entry.InitCheck();
+	if (error == B_OK)
+		error = entry.Rename(fileName, true);
+	if (error != B_OK) {
+		entry.Remove();
+		return error;
+	}
+
+	INFORM("StringTableWriter: wrote %" B_PRIu32 " strings, %" B_PRIu64
+		" bytes\n", stringCount, tableSize);
+	return B_OK;
+}
+
+
+status_t
+StringTableWriter::_AddString(const char* string)
+{
+	try {
+		fStrings.insert(string);
+	} catch (std::bad_alloc&) {
+		return B_NO_MEMORY;
+	}
+
+	return B_OK;
+}
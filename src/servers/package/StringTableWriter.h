@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef STRING_TABLE_WRITER_H
+#define STRING_TABLE_WRITER_H
+
+
+#include <set>
+
+#include <Entry.h>
+#include <String.h>
+
+
+class BDirectory;
+
+
+/*!	Collects the names of the entries and attributes of packages and writes
+	them as packagefs string table (cf. PackageFSStringTableHeader).
+*/
+class StringTableWriter {
+public:
+								StringTableWriter();
+								~StringTableWriter();
+
+			status_t			AddPackage(const entry_ref& packageRef);
+			status_t			WriteFile(BDirectory& directory,
+									const char* fileName);
+
+private:
+			struct ContentHandler;
+
+			typedef std::set<BString> StringSet;
+
+private:
+			status_t			_AddString(const char* string);
+
+private:
+			StringSet			fStrings;
+};
+
+
+#endif	// STRING_TABLE_WRITER_H
@@ -47,6 +47,7 @@
 #include "Exception.h"
 #include "PackageFileManager.h"
 #include "Root.h"
+#include "StringTableWriter.h"
 #include "VolumeState.h"
 
 
@@ -160,7 +161,8 @@ Volume::Volume(BLooper* looper)
 	fPackagesToBeActivated(),
 	fPackagesToBeDeactivated(),
 	fLocationInfoReply(B_MESSAGE_GET_INSTALLATION_LOCATION_INFO_REPLY),
-	fPendingPackageJobCount(0)
+	fPendingPackageJobCount(0),
+	fStringTableUpdatePending(false)
 {
 	looper->AddHandler(this);
 }
@@ -783,6 +785,44 @@ Volume::ClearPackageActivationChanges()
 }
 
 
+/*!	Writes the string table packagefs maps when mounting the volume. It
+	contains the entry and attribute names of all active packages. Failing to
+	write it is not fatal -- packagefs allocates the names itself, then.
+	Since all active packages have to be read, this is not done while
+	committing a transaction, but in a job of its own afterwards.
+*/
+void
+Volume::WriteStringTable()
+{
+	fStringTableUpdatePending = false;
+
+	StringTableWriter writer;
+	for (PackageFileNameHashTable::Iterator it
+			= fActiveState->ByFileNameIterator();
+		Package* package = it.Next();) {
+		if (!package->IsActive())
+			continue;
+
+		status_t error = writer.AddPackage(package->EntryRef());
+		if (error != B_OK) {
+			WARN("Volume::WriteStringTable(): failed to read package \"%s\": "
+				"%s\n", package->FileName().String(), strerror(error));
+			return;
+		}
+	}
+
+	BDirectory adminDirectory;
+	status_t error = _OpenPackagesSubDirectory(
+		RelativePath(kAdminDirectoryName), true, adminDirectory);
+	if (error == B_OK)
+		error = writer.WriteFile(adminDirectory, kStringTableFileName);
+	if (error != B_OK) {
+		WARN("Volume::WriteStringTable(): failed to write string table: %s\n",
+			strerror(error));
+	}
+}
+
+
 status_t
 Volume::CreateTransaction(BPackageInstallationLocation location,
 	BActivationTransaction& _transaction, BDirectory& _transactionDirectory)
@@ -1505,6 +1545,14 @@ Volume::_CommitTransaction(BMessage* message,
 	_result.SetError(error);
 
 	// revert on error
-	if (error != B_TRANSACTION_OK)
+	if (error != B_TRANSACTION_OK) {
 		handler.Revert();
+		return;
+	}
+
+	// let packagefs share the names of the new package set on next mount
+	if (!fStringTableUpdatePending && fListener != NULL) {
+		fStringTableUpdatePending = true;
+		fListener->VolumeStringTableOutdated(this);
+	}
 }
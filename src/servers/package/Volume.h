@@ -125,6 +125,8 @@ public:
 			bool				HasPendingPackageActivationChanges() const;
 			void				ProcessPendingPackageActivationChanges();
 			void				ClearPackageActivationChanges();
+
+			void				WriteStringTable();
 			const PackageSet&	PackagesToBeActivated() const
 									{ return fPackagesToBeActivated; }
 			const PackageSet&	PackagesToBeDeactivated() const
@@ -208,6 +210,7 @@ private:
 			BMessage			fLocationInfoReply;
 									// only accessed in the application thread
 			int32				fPendingPackageJobCount;
+			bool				fStringTableUpdatePending;
 };
 
 
@@ -217,6 +220,7 @@ public:
 
 	virtual	void				VolumeNodeMonitorEventOccurred(Volume* volume)
 									= 0;
+	virtual	void				VolumeStringTableOutdated(Volume* volume) = 0;
 };
 
 
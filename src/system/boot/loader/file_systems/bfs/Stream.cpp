@@ -292,6 +292,34 @@ Stream::FindBlockRun(off_t pos, block_run& run, off_t& offset)
 }
 
 
+/*!	Small files may keep their data in the small data section of the inode,
+	which is not loaded with the stream, so the whole inode is read here.
+*/
+status_t
+Stream::_ReadInlineData(off_t pos, uint8* buffer, size_t length)
+{
+	CachedBlock cached(fVolume);
+	const bfs_inode* node = (const bfs_inode*)cached.SetTo(inode_num);
+	if (node == NULL)
+		return B_IO_ERROR;
+
+	const small_data* smallData = node->small_data_start;
+	while (!smallData->IsLast(node)) {
+		if (*smallData->Name() == FILE_DATA_NAME
+			&& smallData->NameSize() == FILE_DATA_NAME_LENGTH) {
+			if (pos + length > smallData->DataSize())
+				return B_BAD_DATA;
+
+			memcpy(buffer, smallData->Data() + pos, length);
+			return B_OK;
+		}
+		smallData = smallData->Next();
+	}
+
+	return B_BAD_DATA;
+}
+
+
 status_t
 Stream::ReadAt(off_t pos, uint8* buffer, size_t* _length)
 {
@@ -309,6 +337,12 @@ Stream::ReadAt(off_t pos, uint8* buffer, size_t* _length)
 	if (pos + (off_t)length > data.Size())
 		length = data.Size() - pos;
 
+	if ((Flags() & INODE_INLINE_DATA) != 0) {
+		status_t status = _ReadInlineData(pos, buffer, length);
+		*_length = status == B_OK ? length : 0;
+		return status;
+	}
+
 	block_run run;
 	off_t offset;
 	if (FindBlockRun(pos, run, offset) < B_OK) {
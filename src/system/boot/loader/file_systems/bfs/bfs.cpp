@@ -88,7 +88,9 @@ Volume::InitCheck()
 bool
 Volume::IsValidSuperBlock()
 {
-	if (fSuperBlock.Magic1() != (int32)SUPER_BLOCK_MAGIC1
+	if ((fSuperBlock.Magic1() != (int32)SUPER_BLOCK_MAGIC1
+			&& fSuperBlock.Magic1() != (int32)SUPER_BLOCK_MAGIC1_FEATURES)
+		|| (fSuperBlock.Features() & ~SUPER_BLOCK_FEATURES_SUPPORTED) != 0
 		|| fSuperBlock.Magic2() != (int32)SUPER_BLOCK_MAGIC2
 		|| fSuperBlock.Magic3() != (int32)SUPER_BLOCK_MAGIC3
 		|| (int32)fSuperBlock.block_size != fSuperBlock.inode_size
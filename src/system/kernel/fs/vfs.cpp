@@ -117,6 +117,8 @@
 const static size_t kMaxPathLength = 65536;
 	// The absolute maximum path length (for getcwd() - this is not depending
 	// on PATH_MAX
+const static size_t kMaxReadDirPlusBufferSize = 64 * 1024;
+	// The maximum buffer size for _user_read_dir_plus()
 
 
 typedef DoublyLinkedList<vnode> VnodeList;
@@ -6301,6 +6303,143 @@ dir_rewind(struct file_descriptor* descriptor)
 }
 
 
+/*!	Reads the attribute \a name of \a vnode in one go, using the regular
+	attribute hooks of its file system.
+	On return, \a _length contains the full size of the attribute; if it was
+	larger than the buffer, nothing has been read.
+*/
+static status_t
+read_vnode_attribute(struct vnode* vnode, const char* name, uint32* _type,
+	void* buffer, size_t* _length)
+{
+	if (!HAS_FS_CALL(vnode, open_attr) || !HAS_FS_CALL(vnode, read_attr)
+		|| !HAS_FS_CALL(vnode, read_attr_stat)) {
+		return B_UNSUPPORTED;
+	}
+
+	void* cookie;
+	status_t status = FS_CALL(vnode, open_attr, name, O_RDONLY, &cookie);
+	if (status != B_OK)
+		return status;
+
+	struct stat stat;
+	status = FS_CALL(vnode, read_attr_stat, cookie, &stat);
+	if (status == B_OK) {
+		*_type = stat.st_type;
+
+		if ((size_t)stat.st_size <= *_length) {
+			size_t length = stat.st_size;
+			status = FS_CALL(vnode, read_attr, cookie, 0, buffer, &length);
+		}
+		*_length = stat.st_size;
+	}
+
+	if (HAS_FS_CALL(vnode, close_attr))
+		FS_CALL(vnode, close_attr, cookie);
+	FS_CALL(vnode, free_attr_cookie, cookie);
+
+	return status;
+}
+
+
+/*!	Reads directory entries, and fills in the stat and the requested
+	attributes of their nodes, as described in vfs_defs.h.
+	Every entry that has been read from the directory will be returned;
+	if there is not enough space left for an attribute, its status will be
+	set to \c B_BUFFER_OVERFLOW instead.
+*/
+static status_t
+dir_read_plus(struct io_context* ioContext,
+	struct file_descriptor* descriptor, const char* const* attributes,
+	uint32 attributeCount, void* buffer, size_t bufferSize, uint32* _count,
+	size_t* _size)
+{
+	if (descriptor->ops != &sDirectoryOps)
+		return B_NOT_A_DIRECTORY;
+
+	struct vnode* directory = descriptor->u.vnode;
+	if (!HAS_FS_CALL(directory, read_dir))
+		return B_UNSUPPORTED;
+
+	// reserve enough space for the longest possible entry, so that we never
+	// have to drop an entry already read from the directory
+	const size_t direntSize = sizeof(struct dirent) + B_FILE_NAME_LENGTH;
+	const size_t minEntrySize = DIRENT_PLUS_ALIGN(sizeof(dirent_plus))
+		+ DIRENT_PLUS_ALIGN(direntSize)
+		+ attributeCount * DIRENT_PLUS_ALIGN(sizeof(attr_plus));
+
+	if (*_count > 0 && bufferSize < minEntrySize)
+		return B_BUFFER_OVERFLOW;
+
+	uint8* position = (uint8*)buffer;
+	uint8* end = position + bufferSize;
+	uint32 count = 0;
+	status_t status = B_OK;
+
+	while (count < *_count && (size_t)(end - position) >= minEntrySize) {
+		dirent_plus* entry = (dirent_plus*)position;
+		struct dirent* dirent = dirent_plus_entry(entry);
+
+		uint32 direntCount = 1;
+		status = dir_read(ioContext, directory, descriptor->cookie, dirent,
+			direntSize, &direntCount);
+		if (status != B_OK || direntCount == 0)
+			break;
+
+		struct vnode* vnode;
+		entry->stat_status = get_vnode(dirent->d_dev, dirent->d_ino, &vnode,
+			true, false);
+		if (entry->stat_status == B_OK)
+			entry->stat_status = vfs_stat_vnode(vnode, &entry->stat);
+
+		attr_plus* attribute = dirent_plus_first_attr(entry);
+		for (uint32 i = 0; i < attributeCount; i++) {
+			uint8* data = (uint8*)attribute
+				+ DIRENT_PLUS_ALIGN(sizeof(attr_plus));
+
+			// leave room for the headers of the remaining attributes
+			size_t remaining = (attributeCount - i - 1)
+				* DIRENT_PLUS_ALIGN(sizeof(attr_plus));
+			size_t available = end - data > (ssize_t)remaining
+				? (end - data - remaining) & ~(size_t)7 : 0;
+			size_t length = available;
+
+			attribute->type = 0;
+			attribute->data_size = 0;
+			attribute->status = entry->stat_status;
+			if (attribute->status == B_OK) {
+				attribute->status = read_vnode_attribute(vnode, attributes[i],
+					&attribute->type, data, &length);
+				if (attribute->status == B_OK) {
+					attribute->data_size = length;
+					if (length > available)
+						attribute->status = B_BUFFER_OVERFLOW;
+				}
+			}
+
+			attribute->size = DIRENT_PLUS_ALIGN(sizeof(attr_plus));
+			if (attribute->status == B_OK)
+				attribute->size += DIRENT_PLUS_ALIGN(attribute->data_size);
+			attribute = dirent_plus_next_attr(attribute);
+		}
+
+		if (entry->stat_status == B_OK)
+			put_vnode(vnode);
+
+		entry->size = (uint8*)attribute - position;
+		position = (uint8*)attribute;
+		count++;
+	}
+
+	if (count == 0 && status != B_OK)
+		return status;
+
+	*_count = count;
+	*_size = position - (uint8*)buffer;
+	return B_OK;
+}
+
+
 static status_t
 dir_remove(int fd, char* path, bool kernel)
 {
@@ -8600,6 +8739,50 @@ _kern_open_dir(int fd, const char* path)
 }
 
 
+/*!	\brief Reads directory entries together with the stat data and the
+	requested attributes of their nodes.
+
+	The layout of the buffer is described in vfs_defs.h. An entry is only
+	read from the directory, if there is enough space left in the buffer to
+	hold it with a name of maximal length. Attributes that do not fit in the
+	buffer anymore are reported with \c B_BUFFER_OVERFLOW.
+
+	\param fd The FD of the directory.
+	\param attributes The names of the attributes to be read.
+	\param attributeCount The number of attributes, at most
+		   \c READ_DIR_PLUS_MAX_ATTRIBUTES.
+	\param buffer The buffer the entries are written to.
+	\param bufferSize The size of the buffer.
+	\param maxCount The maximum number of entries to read.
+	\return The number of entries read, \c B_BUFFER_OVERFLOW, if the buffer
+			cannot even hold a single entry, or another error code, if an
+			error occurs.
+*/
+ssize_t
+_kern_read_dir_plus(int fd, const char* const* attributes,
+	uint32 attributeCount, void* buffer, size_t bufferSize, uint32 maxCount)
+{
+	if (attributeCount > READ_DIR_PLUS_MAX_ATTRIBUTES
+		|| (attributeCount > 0 && attributes == NULL) || buffer == NULL) {
+		return B_BAD_VALUE;
+	}
+
+	struct io_context* ioContext = get_current_io_context(true);
+	FileDescriptorPutter descriptor(get_fd(ioContext, fd));
+	if (!descriptor.IsSet())
+		return B_FILE_ERROR;
+
+	uint32 count = maxCount;
+	size_t size;
+	status_t status = dir_read_plus(ioContext, descriptor.Get(), attributes,
+		attributeCount, buffer, bufferSize, &count, &size);
+	if (status != B_OK)
+		return status;
+
+	return count;
+}
+
+
 status_t
 _kern_fcntl(int fd, int op, size_t argument)
 {
@@ -9429,6 +9612,79 @@ _user_open_parent_dir(int fd, char* userName, size_t nameLength)
 }
 
 
+ssize_t
+_user_read_dir_plus(int fd, const char* const* userAttributes,
+	uint32 attributeCount, void* userBuffer, size_t bufferSize,
+	uint32 maxCount)
+{
+	if (maxCount == 0)
+		return 0;
+
+	if (attributeCount > READ_DIR_PLUS_MAX_ATTRIBUTES)
+		return B_BAD_VALUE;
+	if (userBuffer == NULL || !IS_USER_ADDRESS(userBuffer)
+		|| (attributeCount > 0 && (userAttributes == NULL
+			|| !IS_USER_ADDRESS(userAttributes)))) {
+		return B_BAD_ADDRESS;
+	}
+
+	// copy the attribute names
+	const char* attributeNames[READ_DIR_PLUS_MAX_ATTRIBUTES];
+	char* names = (char*)malloc(attributeCount * B_FILE_NAME_LENGTH + 1);
+	if (names == NULL)
+		return B_NO_MEMORY;
+	MemoryDeleter namesDeleter(names);
+
+	if (attributeCount > 0) {
+		status_t status = user_memcpy(attributeNames, userAttributes,
+			attributeCount * sizeof(char*));
+		if (status != B_OK)
+			return status;
+	}
+
+	for (uint32 i = 0; i < attributeCount; i++) {
+		char* name = names + i * B_FILE_NAME_LENGTH;
+		if (attributeNames[i] == NULL)
+			return B_BAD_VALUE;
+		if (!IS_USER_ADDRESS(attributeNames[i]))
+			return B_BAD_ADDRESS;
+
+		status_t status = user_copy_name(name, attributeNames[i],
+			B_FILE_NAME_LENGTH);
+		if (status != B_OK)
+			return status;
+
+		attributeNames[i] = name;
+	}
+
+	io_context* ioContext = get_current_io_context(false);
+	FileDescriptorPutter descriptor(get_fd(ioContext, fd));
+	if (!descriptor.IsSet())
+		return B_FILE_ERROR;
+
+	// restrict buffer size and allocate a heap buffer; it is cleared, since
+	// the alignment gaps between the entries are copied to userland as well
+	if (bufferSize > kMaxReadDirPlusBufferSize)
+		bufferSize = kMaxReadDirPlusBufferSize;
+	void* buffer = calloc(1, bufferSize);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+	MemoryDeleter bufferDeleter(buffer);
+
+	uint32 count = maxCount;
+	size_t size;
+	status_t status = dir_read_plus(ioContext, descriptor.Get(),
+		attributeNames, attributeCount, buffer, bufferSize, &count, &size);
+	if (status != B_OK)
+		return status;
+
+	if (user_memcpy(userBuffer, buffer, size) != B_OK)
+		return B_BAD_ADDRESS;
+
+	return count;
+}
+
+
 status_t
 _user_fcntl(int fd, int op, size_t argument)
 {
@@ -0,0 +1,76 @@
+#!/bin/sh
+
+# Checks that files that are moved out of their inodes survive a crash: the
+# test volume is copied while the files are being moved, and the copy is then
+# mounted, which replays its log, and checked.
+# Needs the bfs_inline_data_test binary, either in the current directory, or
+# given as the first argument.
+
+TEST_BIN=${1:-./bfs_inline_data_test}
+TEST_IMAGE="/var/tmp/bfs_inline_data.image"
+SNAPSHOT_IMAGE="/var/tmp/bfs_inline_data.snapshot"
+TEST_MP="/bfs_inline_data"
+SNAPSHOT_MP="/bfs_inline_data_snapshot"
+
+cleanup()
+{
+	unmount ${SNAPSHOT_MP} 2> /dev/null
+	unmount ${TEST_MP} 2> /dev/null
+	rm -f ${TEST_IMAGE} ${SNAPSHOT_IMAGE}
+	rmdir ${TEST_MP} ${SNAPSHOT_MP} 2> /dev/null
+}
+
+fail()
+{
+	echo "$1"
+	cleanup
+	exit 1
+}
+
+run_crash_test() # ${1} => block size ${2} => delay before the copy
+{
+	echo "Run test with bs=${1}, copying after ${2} seconds ..."
+
+	dd if=/dev/zero of=${TEST_IMAGE} bs=1M count=16 2> /dev/null
+	mkfs -t bfs -q -o "block_size ${1}; inline_data" ${TEST_IMAGE} Inline \
+		> /dev/null || fail "mkfs fail"
+
+	mkdir -p ${TEST_MP} ${SNAPSHOT_MP}
+	mount -t bfs ${TEST_IMAGE} ${TEST_MP} || fail "Can not mount..."
+
+	${TEST_BIN} --write ${TEST_MP} > /var/tmp/bfs_inline_data.out &
+	WRITER=$!
+	while ! grep -q written /var/tmp/bfs_inline_data.out 2> /dev/null; do
+		kill -0 ${WRITER} 2> /dev/null || fail "Writing the files failed"
+		sleep 0.1
+	done
+	sleep ${2}
+
+	# This is the crash
+	cp ${TEST_IMAGE} ${SNAPSHOT_IMAGE}
+
+	kill ${WRITER}
+	wait ${WRITER} 2> /dev/null
+	rm -f /var/tmp/bfs_inline_data.out
+
+	unmount ${TEST_MP} || fail "Can not unmount..."
+
+	mount -t bfs ${SNAPSHOT_IMAGE} ${SNAPSHOT_MP} \
+		|| fail "Can not mount the copy"
+
+	${TEST_BIN} --verify ${SNAPSHOT_MP} || fail "Verifying the copy failed"
+	checkfs -c ${SNAPSHOT_MP} || fail "checkfs fail"
+
+	unmount ${SNAPSHOT_MP} || fail "Can not unmount the copy"
+	rm -f ${TEST_IMAGE} ${SNAPSHOT_IMAGE}
+}
+
+# main()
+for BLOCK_SIZE in 1024 2048 4096; do
+	for DELAY in 0 1 5; do
+		run_crash_test ${BLOCK_SIZE} ${DELAY}
+	done
+done
+
+cleanup
+echo PASSED
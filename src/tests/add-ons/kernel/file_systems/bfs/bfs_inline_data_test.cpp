@@ -0,0 +1,284 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <SupportDefs.h>
+
+
+// Needs a BFS volume that has been initialized with the "inline_data" option.
+// Without arguments, it tests moving small files in and out of their inodes
+// in the given directory. The "--write" and "--verify" modes are used by
+// bfs_inline_data_crash_test.sh to check a copy of the volume that has been
+// taken while the files were just being moved out of their inodes.
+
+
+static const size_t kMaxSize = 16384;
+static const int32 kCrashFiles = 32;
+
+static uint8 sExpected[kMaxSize];
+static size_t sExpectedSize;
+
+
+static uint8
+pattern(int32 file, off_t offset)
+{
+	return (uint8)(file * 31 + offset * 7 + 1);
+}
+
+
+static size_t
+first_length(int32 file)
+{
+	return 100 + file;
+}
+
+
+static size_t
+second_length(int32 file)
+{
+	return 3000 + file * 64;
+}
+
+
+static void
+fail(const char* operation, const char* path)
+{
+	fprintf(stderr, "%s \"%s\" failed: %s\n", operation, path,
+		strerror(errno));
+	exit(1);
+}
+
+
+static void
+check_contents(int fd, const char* path, const char* step)
+{
+	struct stat stat;
+	if (fstat(fd, &stat) != 0)
+		fail("stat", path);
+
+	if ((size_t)stat.st_size != sExpectedSize) {
+		fprintf(stderr, "%s: \"%s\" has size %lld instead of %zu\n", step,
+			path, (long long)stat.st_size, sExpectedSize);
+		exit(1);
+	}
+
+	static uint8 buffer[kMaxSize + 1];
+	ssize_t bytesRead = pread(fd, buffer, sizeof(buffer), 0);
+	if (bytesRead < 0)
+		fail("read", path);
+
+	if ((size_t)bytesRead != sExpectedSize
+		|| memcmp(buffer, sExpected, sExpectedSize) != 0) {
+		fprintf(stderr, "%s: \"%s\" has wrong contents\n", step, path);
+		exit(1);
+	}
+}
+
+
+static void
+write_at(int fd, const char* path, off_t offset, size_t length)
+{
+	uint8 buffer[kMaxSize];
+	for (size_t i = 0; i < length; i++)
+		buffer[i] = pattern(0, offset + i) ^ (uint8)length;
+
+	if (pwrite(fd, buffer, length, offset) != (ssize_t)length)
+		fail("write", path);
+
+	if (offset > (off_t)sExpectedSize)
+		memset(sExpected + sExpectedSize, 0, offset - sExpectedSize);
+	memcpy(sExpected + offset, buffer, length);
+	if (offset + length > sExpectedSize)
+		sExpectedSize = offset + length;
+}
+
+
+static void
+truncate_to(int fd, const char* path, off_t size)
+{
+	if (ftruncate(fd, size) != 0)
+		fail("truncate", path);
+
+	if (size > (off_t)sExpectedSize)
+		memset(sExpected + sExpectedSize, 0, size - sExpectedSize);
+	sExpectedSize = size;
+}
+
+
+static void
+test_conversion(const char* directory)
+{
+	char path[PATH_MAX];
+	snprintf(path, sizeof(path), "%s/bfs_inline_data_test", directory);
+
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		fail("create", path);
+
+	sExpectedSize = 0;
+
+	// grow the file in small steps until it no longer fits into its inode
+	for (size_t length = 1; sExpectedSize + length <= 4096; length += 13) {
+		write_at(fd, path, sExpectedSize, length);
+		check_contents(fd, path, "append");
+	}
+
+	// overwrite data that has been moved out of the inode
+	write_at(fd, path, 10, 50);
+	check_contents(fd, path, "overwrite");
+
+	// shrink and grow again
+	truncate_to(fd, path, 100);
+	check_contents(fd, path, "shrink");
+	write_at(fd, path, 500, 20);
+	check_contents(fd, path, "write behind the end");
+	truncate_to(fd, path, 5000);
+	check_contents(fd, path, "grow");
+
+	truncate_to(fd, path, 0);
+	check_contents(fd, path, "empty");
+
+	// a single write that moves the data out of the inode
+	write_at(fd, path, 0, 200);
+	write_at(fd, path, 200, 8000);
+	check_contents(fd, path, "large append");
+
+	close(fd);
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		fail("open", path);
+
+	check_contents(fd, path, "reopen");
+	close(fd);
+
+	unlink(path);
+}
+
+
+static void
+write_crash_files(const char* directory)
+{
+	int fds[kCrashFiles];
+	char path[PATH_MAX];
+	uint8 buffer[kMaxSize];
+
+	for (int32 file = 0; file < kCrashFiles; file++) {
+		snprintf(path, sizeof(path), "%s/file%" B_PRId32, directory, file);
+		fds[file] = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fds[file] < 0)
+			fail("create", path);
+
+		size_t length = first_length(file);
+		for (size_t i = 0; i < length; i++)
+			buffer[i] = pattern(file, i);
+
+		if (write(fds[file], buffer, length) != (ssize_t)length)
+			fail("write", path);
+		if (fsync(fds[file]) != 0)
+			fail("sync", path);
+	}
+
+	// Append enough to move the data out of the inode; only every other
+	// file is synchronized afterwards
+	for (int32 file = 0; file < kCrashFiles; file++) {
+		snprintf(path, sizeof(path), "%s/file%" B_PRId32, directory, file);
+
+		off_t offset = first_length(file);
+		size_t length = second_length(file);
+		for (size_t i = 0; i < length; i++)
+			buffer[i] = pattern(file, offset + i);
+
+		if (write(fds[file], buffer, length) != (ssize_t)length)
+			fail("write", path);
+		if (file % 2 == 0 && fsync(fds[file]) != 0)
+			fail("sync", path);
+	}
+
+	// leave the files open, so that nothing gets written back on close
+	printf("written\n");
+	fflush(stdout);
+}
+
+
+static void
+verify_crash_files(const char* directory)
+{
+	char path[PATH_MAX];
+	uint8 buffer[kMaxSize];
+
+	for (int32 file = 0; file < kCrashFiles; file++) {
+		snprintf(path, sizeof(path), "%s/file%" B_PRId32, directory, file);
+		int fd = open(path, O_RDONLY);
+		if (fd < 0)
+			fail("open", path);
+
+		struct stat stat;
+		if (fstat(fd, &stat) != 0)
+			fail("stat", path);
+
+		size_t first = first_length(file);
+		size_t total = first + second_length(file);
+		size_t size = stat.st_size;
+
+		// The first part has been synchronized, and must never get lost;
+		// the second part only if it has been synchronized as well
+		if ((size != first || file % 2 == 0) && size != total) {
+			fprintf(stderr, "\"%s\" has size %zu, expected %zu or %zu\n",
+				path, size, first, total);
+			exit(1);
+		}
+
+		// Data that has not been synchronized may not have reached the
+		// disk, so only check what has been
+		size_t check = file % 2 == 0 ? total : first;
+		if (pread(fd, buffer, check, 0) != (ssize_t)check)
+			fail("read", path);
+
+		for (size_t i = 0; i < check; i++) {
+			if (buffer[i] != pattern(file, i)) {
+				fprintf(stderr, "\"%s\" differs at offset %zu\n", path, i);
+				exit(1);
+			}
+		}
+
+		close(fd);
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc == 3 && !strcmp(argv[1], "--write")) {
+		write_crash_files(argv[2]);
+
+		// wait until we're killed
+		while (true)
+			pause();
+	}
+
+	if (argc == 3 && !strcmp(argv[1], "--verify"))
+		verify_crash_files(argv[2]);
+	else if (argc == 2)
+		test_conversion(argv[1]);
+	else {
+		fprintf(stderr, "usage: %s [--write|--verify] <directory>\n",
+			argv[0]);
+		return 1;
+	}
+
+	printf("All tests passed.\n");
+	return 0;
+}
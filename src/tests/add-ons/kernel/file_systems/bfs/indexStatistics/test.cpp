@@ -0,0 +1,166 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+//!	Checks the index statistics after inserting and removing keys
+
+
+#include "IndexStatistics.h"
+
+
+static int sFailures = 0;
+
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, \
+				__LINE__, #condition); \
+			sFailures++; \
+		} \
+	} while (false)
+
+
+static void
+add_string(IndexStatistics& statistics, const char* key)
+{
+	statistics.Add((const uint8*)key, strlen(key));
+}
+
+
+static void
+remove_string(IndexStatistics& statistics, const char* key)
+{
+	statistics.Remove((const uint8*)key, strlen(key));
+}
+
+
+static int64
+estimate_string(IndexStatistics& statistics, const char* key)
+{
+	return statistics.EstimateEqual((const uint8*)key, strlen(key));
+}
+
+
+static void
+test_strings()
+{
+	IndexStatistics statistics(B_STRING_TYPE);
+	CHECK(statistics.CountEntries() == 0);
+	CHECK(estimate_string(statistics, "name") == 0);
+
+	char key[32];
+	for (int32 i = 0; i < 100; i++) {
+		snprintf(key, sizeof(key), "a%ld", (long)i);
+		add_string(statistics, key);
+	}
+	for (int32 i = 0; i < 20; i++)
+		add_string(statistics, "name");
+
+	CHECK(statistics.CountEntries() == 120);
+	CHECK(estimate_string(statistics, "name") >= 20);
+	CHECK(estimate_string(statistics, "name") <= 20 + 1);
+
+	// only the "a" bucket contains entries
+	CHECK(statistics.EstimateRange((const uint8*)"b", 1, (const uint8*)"m",
+		1) == 0);
+	CHECK(statistics.EstimateRange(NULL, 0, NULL, 0) == 120);
+
+	for (int32 i = 0; i < 100; i++) {
+		snprintf(key, sizeof(key), "a%ld", (long)i);
+		remove_string(statistics, key);
+	}
+	for (int32 i = 0; i < 15; i++)
+		remove_string(statistics, "name");
+
+	CHECK(statistics.CountEntries() == 5);
+	CHECK(estimate_string(statistics, "name") == 5);
+	CHECK(statistics.EstimateRange(NULL, 0, NULL, 0) == 5);
+
+	// removing more than has been added must not result in negative counts
+	for (int32 i = 0; i < 10; i++)
+		remove_string(statistics, "name");
+
+	CHECK(statistics.CountEntries() == 0);
+	CHECK(estimate_string(statistics, "name") == 0);
+	CHECK(statistics.EstimateRange(NULL, 0, NULL, 0) == 0);
+}
+
+
+static void
+test_numbers()
+{
+	IndexStatistics statistics(B_INT64_TYPE);
+
+	for (int64 value = -1000; value <= 1000; value++)
+		statistics.Add((const uint8*)&value, sizeof(value));
+
+	CHECK(statistics.CountEntries() == 2001);
+	CHECK(statistics.EstimateRange(NULL, 0, NULL, 0) == 2001);
+
+	// The range estimate must count at least all entries in the buckets
+	// fully covered, and at most all entries in the touched buckets
+	int64 lower = 0;
+	int64 upper = 1000;
+	int64 estimate = statistics.EstimateRange((const uint8*)&lower,
+		sizeof(lower), (const uint8*)&upper, sizeof(upper));
+	CHECK(estimate >= 500);
+	CHECK(estimate <= 1001);
+
+	int64 value = 42;
+	CHECK(statistics.EstimateEqual((const uint8*)&value, sizeof(value)) >= 1);
+
+	for (value = -1000; value < 0; value++)
+		statistics.Remove((const uint8*)&value, sizeof(value));
+
+	CHECK(statistics.CountEntries() == 1001);
+	upper = -1;
+	CHECK(statistics.EstimateRange(NULL, 0, (const uint8*)&upper,
+		sizeof(upper)) == 0);
+	CHECK(statistics.EstimateRange((const uint8*)&lower, sizeof(lower), NULL,
+		0) <= 1001);
+}
+
+
+static void
+test_scan()
+{
+	IndexStatistics scanned(B_STRING_TYPE);
+	add_string(scanned, "alpha");
+	add_string(scanned, "beta");
+
+	// a stand-in takes over the scan result
+	IndexStatistics statistics(B_STRING_TYPE);
+	statistics.StartScan();
+	CHECK(statistics.IsScanning());
+	CHECK(statistics.FinishScan(scanned));
+	CHECK(!statistics.IsScanning());
+	CHECK(statistics.CountEntries() == 2);
+	CHECK(estimate_string(statistics, "alpha") >= 1);
+
+	// but not if the index changed during the scan
+	IndexStatistics missed(B_STRING_TYPE);
+	missed.StartScan();
+	missed.MissedUpdate();
+	CHECK(!missed.FinishScan(scanned));
+	CHECK(missed.IsScanning());
+	CHECK(missed.CountEntries() == 0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	test_strings();
+	test_numbers();
+	test_scan();
+
+	if (sFailures != 0) {
+		fprintf(stderr, "%d checks failed.\n", sFailures);
+		return 1;
+	}
+
+	printf("All tests passed.\n");
+	return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+#include <SupportDefs.h>
+
+#include "bfs.h"
+#include "bfs_control.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <fs_info.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+
+
+// Needs a scratch BFS volume, and the rights to read its device. Resizes the
+// log of the volume the given directory is on while files are written to it,
+// and checks that the log never moves, that the file contents survive, and
+// that the block bitmap is still consistent afterwards.
+
+
+static const int32 kFileCount = 64;
+static const size_t kFileSize = 96 * 1024;
+
+static uint8 sBuffer[kFileSize];
+
+
+static void
+fail(const char* message, const char* detail)
+{
+	fprintf(stderr, "%s: %s\n", message, detail);
+	exit(1);
+}
+
+
+static uint8
+pattern(int32 file, size_t offset)
+{
+	return (uint8)(file * 13 + offset * 5 + 3);
+}
+
+
+static block_run
+read_log(const char* device)
+{
+	int fd = open(device, O_RDONLY);
+	if (fd < 0)
+		fail("Could not open device", device);
+
+	disk_super_block superBlock;
+	if (pread(fd, &superBlock, sizeof(superBlock), 512)
+			!= (ssize_t)sizeof(superBlock)) {
+		fail("Could not read super block", device);
+	}
+	close(fd);
+
+	if (superBlock.Magic2() != (int32)SUPER_BLOCK_MAGIC2
+		|| superBlock.Magic3() != (int32)SUPER_BLOCK_MAGIC3) {
+		fail("Not a BFS volume", device);
+	}
+
+	return superBlock.log_blocks;
+}
+
+
+static status_t
+resize_log(int fd, uint32 length)
+{
+	if (ioctl(fd, BFS_IOCTL_RESIZE_LOG, &length, sizeof(length)) != 0)
+		return errno;
+
+	return B_OK;
+}
+
+
+static void
+write_files(const char* directory, int32 from, int32 to)
+{
+	for (int32 file = from; file < to; file++) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/file-%" B_PRId32, directory, file);
+
+		for (size_t i = 0; i < kFileSize; i++)
+			sBuffer[i] = pattern(file, i);
+
+		int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0 || write(fd, sBuffer, kFileSize) != (ssize_t)kFileSize)
+			fail("Could not write file", path);
+		close(fd);
+	}
+}
+
+
+static void
+verify_files(const char* directory, int32 count)
+{
+	for (int32 file = 0; file < count; file++) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/file-%" B_PRId32, directory, file);
+
+		int fd = open(path, O_RDONLY);
+		if (fd < 0 || read(fd, sBuffer, kFileSize) != (ssize_t)kFileSize)
+			fail("Could not read file", path);
+		close(fd);
+
+		for (size_t i = 0; i < kFileSize; i++) {
+			if (sBuffer[i] != pattern(file, i))
+				fail("File contents differ", path);
+		}
+	}
+}
+
+
+static void
+remove_files(const char* directory, int32 count)
+{
+	for (int32 file = 0; file < count; file++) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/file-%" B_PRId32, directory, file);
+		if (unlink(path) != 0)
+			fail("Could not remove file", path);
+	}
+}
+
+
+/*!	Runs the bitmap and index check without fixing anything, and fails if
+	any block is used but not allocated, or allocated but not used.
+*/
+static void
+check_volume(int fd)
+{
+	check_control control;
+	memset(&control, 0, sizeof(control));
+	control.magic = BFS_IOCTL_CHECK_MAGIC;
+
+	if (ioctl(fd, BFS_IOCTL_START_CHECKING, &control, sizeof(control)) != 0)
+		fail("Could not start checking", strerror(errno));
+
+	while (ioctl(fd, BFS_IOCTL_CHECK_NEXT_NODE, &control,
+			sizeof(control)) == 0) {
+		if (control.errors != 0)
+			fail("Check found errors", control.name);
+	}
+
+	if (ioctl(fd, BFS_IOCTL_STOP_CHECKING, &control, sizeof(control)) != 0)
+		fail("Could not stop checking", strerror(errno));
+
+	if (control.stats.missing != 0)
+		fail("Check failed", "blocks in use are not allocated");
+	if (control.stats.already_set != 0)
+		fail("Check failed", "blocks are used twice");
+	if (control.stats.freed != 0)
+		fail("Check failed", "unused blocks are allocated");
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <directory>\n", argv[0]);
+		return 1;
+	}
+
+	const char* directory = argv[1];
+	int fd = open(directory, O_RDONLY);
+	if (fd < 0)
+		fail("Could not open directory", directory);
+
+	struct stat st;
+	fs_info info;
+	if (fstat(fd, &st) != 0 || fs_stat_dev(st.st_dev, &info) != 0)
+		fail("Could not get volume info", directory);
+	if (strcmp(info.fsh_name, "bfs") != 0)
+		fail("Not on a BFS volume", directory);
+
+	block_run originalLog = read_log(info.device_name);
+	uint32 originalLength = originalLog.Length();
+
+	// invalid sizes
+	if (resize_log(fd, 511) != B_BAD_VALUE
+		|| resize_log(fd, 65536) != B_BAD_VALUE) {
+		fail("Invalid log size", "accepted");
+	}
+	if (resize_log(fd, originalLength) != B_OK)
+		fail("Resizing to the same size", "failed");
+
+	write_files(directory, 0, kFileCount / 2);
+
+	// shrinking always works, and gives the blocks back
+	if (resize_log(fd, 512) != B_OK)
+		fail("Shrinking the log", "failed");
+
+	block_run log = read_log(info.device_name);
+	if (log.Start() != originalLog.Start() || log.Length() != 512)
+		fail("Shrinking the log", "did not resize it in place");
+
+	// the freed blocks may now be used by files
+	write_files(directory, kFileCount / 2, kFileCount);
+
+	// Growing only works into free blocks, the log must never move past
+	// any of those files.
+	status_t status = resize_log(fd, originalLength);
+	if (status != B_OK && status != B_DEVICE_FULL)
+		fail("Growing the log failed", strerror(status));
+
+	log = read_log(info.device_name);
+	if (log.Start() != originalLog.Start())
+		fail("Growing the log", "moved it");
+	if (log.Length() != (status == B_OK ? originalLength : 512))
+		fail("Growing the log", "resulted in the wrong size");
+
+	verify_files(directory, kFileCount);
+	check_volume(fd);
+
+	// all files can be removed again, wherever they ended up
+	remove_files(directory, kFileCount);
+	sync();
+	check_volume(fd);
+
+	if (resize_log(fd, originalLength) != B_OK)
+		fail("Restoring the log size", "failed");
+	if (read_log(info.device_name).Length() != originalLength)
+		fail("Restoring the log size", "resulted in the wrong size");
+
+	close(fd);
+
+	printf("All tests passed.\n");
+	return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+/*!	Checks that substring queries are answered correctly through a trigram
+	index. Needs to be run on a BFS volume.
+	There is no regular index for the attribute, so the queries can only
+	be answered through the trigram index.
+*/
+
+
+#include <set>
+#include <string>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fs_index.h>
+#include <fs_info.h>
+#include <fs_query.h>
+#include <Node.h>
+#include <TypeConstants.h>
+
+
+static const char* kAttribute = "test:trigram";
+static const char* kTrigramIndex = "BFS:trigrams:test:trigram";
+static const char* kDirectory = "_trigram_test";
+
+static const struct {
+	const char*	name;
+	const char*	value;
+} kFiles[] = {
+	{"file1", "Hello World"},
+	{"file2", "hello world"},
+	{"file3", "Yellow"},
+	{"file4", "Jello Wobble"},
+	{"file5", "xy"},
+	{"file6", ""},
+};
+static const int32 kFileCount = sizeof(kFiles) / sizeof(kFiles[0]);
+
+static int sFailures = 0;
+
+
+static std::set<std::string>
+run_query(dev_t device, const char* predicate)
+{
+	std::set<std::string> names;
+
+	DIR* query = fs_open_query(device, predicate, 0);
+	if (query == NULL) {
+		fprintf(stderr, "Could not open query \"%s\": %s\n", predicate,
+			strerror(errno));
+		sFailures++;
+		return names;
+	}
+
+	while (dirent* entry = fs_read_query(query))
+		names.insert(entry->d_name);
+
+	fs_close_query(query);
+	return names;
+}
+
+
+static void
+check_query(dev_t device, const char* pattern, const char* expected[],
+	int32 expectedCount)
+{
+	char predicate[256];
+	snprintf(predicate, sizeof(predicate), "%s==\"%s\"", kAttribute,
+		pattern);
+
+	std::set<std::string> names = run_query(device, predicate);
+	std::set<std::string> expectedNames(expected, expected + expectedCount);
+	if (names == expectedNames) {
+		printf("  %s: passed\n", predicate);
+		return;
+	}
+
+	fprintf(stderr, "  %s: got", predicate);
+	for (std::set<std::string>::iterator iterator = names.begin();
+			iterator != names.end(); iterator++) {
+		fprintf(stderr, " %s", iterator->c_str());
+	}
+	fprintf(stderr, ", expected");
+	for (int32 i = 0; i < expectedCount; i++)
+		fprintf(stderr, " %s", expected[i]);
+	fprintf(stderr, "\n");
+	sFailures++;
+}
+
+
+static status_t
+write_value(const char* path, const char* value)
+{
+	BNode node(path);
+	status_t status = node.InitCheck();
+	if (status != B_OK)
+		return status;
+
+	ssize_t written = node.WriteAttr(kAttribute, B_STRING_TYPE, 0, value,
+		strlen(value) + 1);
+	return written < 0 ? (status_t)written : B_OK;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	dev_t device = dev_for_path(".");
+
+	fs_info info;
+	if (fs_stat_dev(device, &info) != 0
+		|| strcmp(info.fsh_name, "bfs") != 0) {
+		fprintf(stderr, "%s: must be run on a BFS volume.\n", argv[0]);
+		return 1;
+	}
+
+	if (fs_create_index(device, kTrigramIndex, B_STRING_TYPE, 0) != 0
+		&& errno != B_FILE_EXISTS) {
+		fprintf(stderr, "Could not create trigram index: %s\n",
+			strerror(errno));
+		return 1;
+	}
+
+	mkdir(kDirectory, 0755);
+
+	char path[B_PATH_NAME_LENGTH];
+	for (int32 i = 0; i < kFileCount; i++) {
+		snprintf(path, sizeof(path), "%s/%s", kDirectory, kFiles[i].name);
+		close(creat(path, 0644));
+
+		status_t status = write_value(path, kFiles[i].value);
+		if (status != B_OK) {
+			fprintf(stderr, "Could not write attribute of %s: %s\n", path,
+				strerror(status));
+			sFailures++;
+		}
+	}
+
+	puts("Substring queries:");
+
+	const char* elloW[] = {"file1", "file4"};
+	check_query(device, "*ello W*", elloW, 2);
+
+	const char* hello[] = {"file1", "file2"};
+	check_query(device, "*[Hh]ello*", hello, 2);
+
+	const char* ello[] = {"file1", "file2", "file3", "file4"};
+	check_query(device, "*ello*", ello, 4);
+
+	check_query(device, "*xyz*", NULL, 0);
+
+	// changing a value must update its trigrams
+	snprintf(path, sizeof(path), "%s/%s", kDirectory, kFiles[2].name);
+	write_value(path, "Mellow World");
+
+	const char* world[] = {"file1", "file3"};
+	check_query(device, "*o World*", world, 2);
+
+	check_query(device, "*Yellow*", NULL, 0);
+
+	for (int32 i = 0; i < kFileCount; i++) {
+		snprintf(path, sizeof(path), "%s/%s", kDirectory, kFiles[i].name);
+		unlink(path);
+	}
+	rmdir(kDirectory);
+
+	check_query(device, "*ello*", NULL, 0);
+
+	fs_remove_index(device, kTrigramIndex);
+
+	if (sFailures != 0) {
+		fprintf(stderr, "%d checks failed.\n", sFailures);
+		return 1;
+	}
+
+	puts("All tests passed.");
+	return 0;
+}
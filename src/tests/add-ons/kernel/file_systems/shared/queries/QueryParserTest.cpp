@@ -95,6 +95,11 @@ struct Query::QueryPolicy {
 		return B_ERROR;
 	}
 
+	static status_t IndexSetToTrigrams(Index& index, const char* attribute)
+	{
+		return B_ERROR;
+	}
+
 	static void IndexUnset(Index& index)
 	{
 	}
@@ -104,6 +109,13 @@ struct Query::QueryPolicy {
 		return 0;
 	}
 
+	static int32 IndexEstimateMatches(Index& index, int32 op,
+		const void* value, size_t size, bool isPrefix)
+	{
+		// no statistics available
+		return -1;
+	}
+
 	static type_code IndexGetType(Index& index)
 	{
 		return 0;
@@ -145,6 +157,11 @@ struct Query::QueryPolicy {
 		return B_OK;
 	}
 
+	static ino_t IndexIteratorGetNodeID(IndexIterator* indexIterator)
+	{
+		return -1;
+	}
+
 	static void IndexIteratorSkipDuplicates(IndexIterator* indexIterator)
 	{
 	}
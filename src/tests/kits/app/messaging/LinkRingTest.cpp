@@ -0,0 +1,106 @@
+#include <LinkReceiver.h>
+#include <LinkRing.h>
+#include <LinkSender.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+
+const size_t kRingSize = sizeof(link_ring) + 4096;
+
+
+void
+check(bool condition, const char* message)
+{
+	if (!condition) {
+		fprintf(stderr, "%s\n", message);
+		exit(-1);
+	}
+}
+
+
+void
+send_wake_up(port_id port)
+{
+	check(write_port(port, kLinkRingCode, NULL, 0) == B_OK,
+		"writing the wake-up call failed!");
+}
+
+
+void
+get_next_message(BPrivate::LinkReceiver &receiver, int32 expectedCode,
+	bigtime_t timeout = B_INFINITE_TIMEOUT)
+{
+	int32 code;
+	check(receiver.GetNextMessage(code, timeout) == B_OK,
+		"get message failed!");
+	check(code == expectedCode, "code is wrong!");
+}
+
+
+int
+main()
+{
+	port_id port = create_port(100, "link ring");
+	void* ring = malloc(kRingSize);
+	check(port >= 0 && ring != NULL, "out of resources!");
+
+	BPrivate::LinkReceiver receiver(port);
+	BPrivate::LinkSender sender(port);
+	check(receiver.SetRing(ring, kRingSize) == B_OK, "setting the ring failed!");
+	check(sender.SetRing(ring, kRingSize, receiver.RingSemaphore()) == B_OK,
+		"setting the sender's ring failed!");
+
+	// a wake-up call for a batch that was already read is no message
+	send_wake_up(port);
+	check(!receiver.HasMessages(), "stale wake-up call counts as message!");
+	check(port_count(port) == 0, "stale wake-up call was not removed!");
+
+	int32 code;
+	check(receiver.GetNextMessage(code, 0) == B_WOULD_BLOCK,
+		"reading an empty ring would not block!");
+
+	// the same with a wake-up call that is left over after reading the ring
+	sender.StartMessage('tst1');
+	sender.Attach<int32>(42);
+	check(sender.Flush() == B_OK, "flushing to the ring failed!");
+	send_wake_up(port);
+
+	check(receiver.HasMessages(), "message in the ring not found!");
+	get_next_message(receiver, 'tst1');
+
+	int32 value;
+	check(receiver.Read<int32>(&value) == B_OK && value == 42,
+		"reading message failed!");
+
+	check(!receiver.HasMessages(), "stale wake-up call counts as message!");
+	check(receiver.GetNextMessage(code, 0) == B_WOULD_BLOCK,
+		"reading an empty ring would not block!");
+
+	// a batch too large for the ring still goes through the port, and must
+	// not be mistaken for a wake-up call
+	char test[3000];
+	memset(test, 'x', sizeof(test));
+	sender.StartMessage('tst2');
+	sender.Attach(test, sizeof(test));
+	check(sender.Flush() == B_OK, "flushing to the port failed!");
+
+	check(receiver.HasMessages(), "message in the port not found!");
+	get_next_message(receiver, 'tst2', 0);
+
+	// and the ring is used again once the receiver took it
+	sender.StartMessage('tst3');
+	check(sender.Flush() == B_OK, "flushing to the ring failed!");
+	send_wake_up(port);
+	get_next_message(receiver, 'tst3', 0);
+	check(!receiver.HasMessages(), "stale wake-up call counts as message!");
+
+	sender.SetRing(NULL, 0, -1);
+	receiver.SetRing(NULL, 0);
+	free(ring);
+	delete_port(port);
+
+	puts("All OK!");
+	return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Times the BRegion operations the way the app_server uses them to
+	compute the visible and dirty regions of overlapping windows.
+*/
+
+
+#include <OS.h>
+#include <Region.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const bigtime_t kMinimumTime = 200000;
+static const int32 kWindowCount = 32;
+static const int32 kScreenWidth = 1920;
+static const int32 kScreenHeight = 1080;
+
+
+static clipping_rect sWindows[kWindowCount];
+static BRegion sClipping;
+	// the part of the screen not covered by any window
+
+
+static void
+init_windows()
+{
+	srand(42);
+
+	for (int32 i = 0; i < kWindowCount; i++) {
+		clipping_rect& frame = sWindows[i];
+		frame.left = rand() % (kScreenWidth - 100);
+		frame.top = rand() % (kScreenHeight - 80);
+		frame.right = frame.left + 100 + rand() % 300;
+		frame.bottom = frame.top + 80 + rand() % 250;
+	}
+
+	clipping_rect screen = { 0, 0, kScreenWidth - 1, kScreenHeight - 1 };
+	sClipping.Set(screen);
+	for (int32 i = 0; i < kWindowCount; i++)
+		sClipping.Exclude(sWindows[i]);
+}
+
+
+static void
+include_rows()
+{
+	// as done when building a region line by line
+	BRegion region;
+	for (int32 y = 0; y < 256; y++) {
+		clipping_rect row = { y % 7, y, 256 - y % 5, y };
+		region.Include(row);
+	}
+}
+
+
+static void
+include_adjacent_rects()
+{
+	BRegion region;
+	for (int32 x = 0; x < 256; x += 8) {
+		clipping_rect rect = { x, 0, x + 7, 15 };
+		region.Include(rect);
+	}
+}
+
+
+static void
+exclude_rect_from_rect()
+{
+	for (int32 i = 0; i < kWindowCount; i++) {
+		BRegion region;
+		region.Set(sWindows[i]);
+		region.Exclude(sWindows[(i + 1) % kWindowCount]);
+	}
+}
+
+
+static void
+intersect_rect_with_rect()
+{
+	for (int32 i = 0; i < kWindowCount; i++) {
+		BRegion region;
+		region.Set(sWindows[i]);
+		BRegion other;
+		other.Set(sWindows[(i + 1) % kWindowCount]);
+		region.IntersectWith(&other);
+	}
+}
+
+
+static void
+intersect_region_with_bounds()
+{
+	// clipping a region to the screen, which covers it completely
+	clipping_rect screen = { 0, 0, kScreenWidth - 1, kScreenHeight - 1 };
+	BRegion bounds;
+	bounds.Set(screen);
+	BRegion region(sClipping);
+	region.IntersectWith(&bounds);
+}
+
+
+static void
+exclude_overlapping_windows()
+{
+	// the visible region of the bottom window
+	BRegion region;
+	region.Set(sWindows[0]);
+	for (int32 i = 1; i < kWindowCount; i++)
+		region.Exclude(sWindows[i]);
+}
+
+
+static void
+include_overlapping_windows()
+{
+	// the dirty region after moving all windows
+	BRegion region;
+	for (int32 i = 0; i < kWindowCount; i++)
+		region.Include(sWindows[i]);
+}
+
+
+static void
+contains_points()
+{
+	int32 count = 0;
+	for (int32 y = 0; y < kScreenHeight; y += 37) {
+		for (int32 x = 0; x < kScreenWidth; x += 41)
+			count += sClipping.Contains(x, y) ? 1 : 0;
+	}
+
+	if (count < 0)
+		printf("impossible\n");
+}
+
+
+static void
+intersects_rects()
+{
+	int32 count = 0;
+	for (int32 i = 0; i < kWindowCount; i++)
+		count += sClipping.Intersects(sWindows[i]) ? 1 : 0;
+
+	if (count < 0)
+		printf("impossible\n");
+}
+
+
+struct benchmark {
+	const char*	name;
+	void		(*function)();
+};
+
+
+static const benchmark kBenchmarks[] = {
+	{ "include-rows", include_rows },
+	{ "include-adjacent-rects", include_adjacent_rects },
+	{ "exclude-rect-from-rect", exclude_rect_from_rect },
+	{ "intersect-rect-with-rect", intersect_rect_with_rect },
+	{ "intersect-region-with-bounds", intersect_region_with_bounds },
+	{ "exclude-overlapping-windows", exclude_overlapping_windows },
+	{ "include-overlapping-windows", include_overlapping_windows },
+	{ "contains-points", contains_points },
+	{ "intersects-rects", intersects_rects },
+};
+static const int32 kBenchmarkCount = sizeof(kBenchmarks) / sizeof(benchmark);
+
+
+int
+main(int argc, char** argv)
+{
+	init_windows();
+
+	printf("# %" B_PRId32 " rects in the clipping region\n",
+		sClipping.CountRects());
+	printf("# name\titerations\tmean_us\n");
+
+	for (int32 i = 0; i < kBenchmarkCount; i++) {
+		const benchmark& current = kBenchmarks[i];
+		if (argc > 1 && strstr(current.name, argv[1]) == NULL)
+			continue;
+
+		current.function();
+
+		int32 iterations = 0;
+		bigtime_t start = system_time();
+		bigtime_t elapsed;
+		do {
+			for (int32 j = 0; j < 100; j++)
+				current.function();
+			iterations += 100;
+			elapsed = system_time() - start;
+		} while (elapsed < kMinimumTime);
+
+		printf("%s\t%" B_PRId32 "\t%.3f\n", current.name, iterations,
+			(double)elapsed / iterations);
+	}
+
+	return 0;
+}
@@ -97,6 +97,25 @@ RegionTestcase::RegionTestcase(std::string name) :
 		}
 		listOfRegions.AddItem(tempRegion);
 	}
+
+	// Single rectangles that cover, touch or overlap each other, for the
+	// shortcuts that avoid the general region operations
+	float theRects[][4] =
+		{
+			{0.0, 0.0, 99.0, 99.0},
+			{20.0, 20.0, 59.0, 59.0},
+			{0.0, 100.0, 99.0, 149.0},
+			{100.0, 0.0, 149.0, 99.0},
+			{50.0, 0.0, 129.0, 99.0}
+		};
+	const int numTestRects = sizeof(theRects) / sizeof(theRects[0]);
+
+	for(int rectNum = 0; rectNum < numTestRects; rectNum++) {
+		listOfRegions.AddItem(new BRegion(BRect(theRects[rectNum][0],
+		                                        theRects[rectNum][1],
+		                                        theRects[rectNum][2],
+		                                        theRects[rectNum][3])));
+	}
 }
 
 
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <package/hpkg/ErrorOutput.h>
+#include <package/hpkg/HPKGDefs.h>
+#include <package/hpkg/PackageFileHeapReader.h>
+#include <package/hpkg/PackageReaderImpl.h>
+
+
+using BPackageKit::BHPKG::BErrorOutput;
+using BPackageKit::BHPKG::B_HPKG_READER_DONT_PRINT_VERSION_MISMATCH_MESSAGE;
+using BPackageKit::BHPKG::BPrivate::PackageFileHeapReader;
+using BPackageKit::BHPKG::BPrivate::PackageReaderImpl;
+
+
+// Reads the heap of a package with and without read-ahead, and checks that
+// the same data is returned, for sequential reads of different sizes, as
+// well as when the reads jump around.
+
+
+static const size_t kMaxReadSize = 256 * 1024;
+static const char* kDefaultPackage = "/system/packages/haiku.hpkg";
+
+
+class StandardErrorOutput : public BErrorOutput {
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		vfprintf(stderr, format, args);
+	}
+};
+
+
+static void
+fail(const char* message, const char* detail)
+{
+	fprintf(stderr, "%s: %s\n", message, detail);
+	exit(1);
+}
+
+
+static void
+compare(PackageFileHeapReader* reference, PackageFileHeapReader* reader,
+	off_t offset, size_t size)
+{
+	static uint8 expected[kMaxReadSize];
+	static uint8 buffer[kMaxReadSize];
+
+	status_t status = reference->ReadData(offset, expected, size);
+	if (status != B_OK)
+		fail("Reading without read-ahead failed", strerror(status));
+
+	status = reader->ReadData(offset, buffer, size);
+	if (status != B_OK)
+		fail("Reading with read-ahead failed", strerror(status));
+
+	if (memcmp(expected, buffer, size) != 0) {
+		fprintf(stderr, "Data at %" B_PRIdOFF ", size %zu differs\n", offset,
+			size);
+		exit(1);
+	}
+}
+
+
+static void
+read_sequentially(PackageFileHeapReader* reference,
+	PackageFileHeapReader* reader, size_t readSize)
+{
+	off_t heapSize = reference->UncompressedHeapSize();
+	for (off_t offset = 0; offset < heapSize; offset += readSize) {
+		size_t size = std::min((off_t)readSize, heapSize - offset);
+		compare(reference, reader, offset, size);
+	}
+}
+
+
+static void
+read_randomly(PackageFileHeapReader* reference, PackageFileHeapReader* reader)
+{
+	off_t heapSize = reference->UncompressedHeapSize();
+	srand(42);
+
+	for (int32 i = 0; i < 200; i++) {
+		// alternate between jumps and short sequential runs, so that the
+		// read-ahead is started and dropped again
+		off_t offset = (off_t)((double)rand() / RAND_MAX * heapSize);
+		int32 runLength = rand() % 2 == 0 ? 1 : 2 + rand() % 20;
+		for (int32 j = 0; j < runLength && offset < heapSize; j++) {
+			size_t size = std::min((off_t)(1 + rand() % kMaxReadSize),
+				heapSize - offset);
+			compare(reference, reader, offset, size);
+			offset += size;
+		}
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : kDefaultPackage;
+
+	StandardErrorOutput errorOutput;
+	PackageReaderImpl referenceReader(&errorOutput);
+	PackageReaderImpl readAheadReader(&errorOutput);
+
+	status_t status = referenceReader.Init(path,
+		B_HPKG_READER_DONT_PRINT_VERSION_MISMATCH_MESSAGE);
+	if (status == B_OK) {
+		status = readAheadReader.Init(path,
+			B_HPKG_READER_DONT_PRINT_VERSION_MISMATCH_MESSAGE);
+	}
+	if (status != B_OK)
+		fail("Could not open package", path);
+
+	PackageFileHeapReader* reference = referenceReader.RawHeapReader();
+	PackageFileHeapReader* reader = readAheadReader.RawHeapReader();
+
+	static const int32 kThreadCounts[] = { 1, 4 };
+	static const size_t kReadSizes[] = { 4096, 10000, 65536, kMaxReadSize };
+
+	for (size_t i = 0; i < B_COUNT_OF(kThreadCounts); i++) {
+		status = reader->SetReadAhead(kThreadCounts[i]);
+		if (status != B_OK)
+			fail("Enabling read-ahead failed", strerror(status));
+
+		for (size_t j = 0; j < B_COUNT_OF(kReadSizes); j++)
+			read_sequentially(reference, reader, kReadSizes[j]);
+
+		read_randomly(reference, reader);
+	}
+
+	printf("All tests passed.\n");
+	return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <DataIO.h>
+#include <OS.h>
+#include <String.h>
+
+#include <package/hpkg/HPKGDefs.h>
+#include <package/hpkg/PackageWriter.h>
+
+
+using namespace BPackageKit::BHPKG;
+
+
+// Checks that a package compressed on several threads is byte-identical to
+// the same package compressed on a single one.
+
+
+static const int32 kFileCount = 12;
+
+static const char* kPackageInfo =
+	"name\t\t\tthreads_test\n"
+	"version\t\t\t1.0-1\n"
+	"architecture\tany\n"
+	"summary\t\t\t\"Test package\"\n"
+	"description\t\t\"Test package\"\n"
+	"packager\t\t\"Nobody <nobody@example.com>\"\n"
+	"vendor\t\t\t\"Haiku Project\"\n"
+	"copyrights\t\t\"2026 Haiku, Inc.\"\n"
+	"licenses\t\t\"MIT\"\n"
+	"provides {\n"
+	"\tthreads_test = 1.0-1\n"
+	"}\n";
+
+
+class WriterListener : public BPackageWriterListener {
+public:
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		vfprintf(stderr, format, args);
+	}
+
+	virtual void OnEntryAdded(const char* path)
+	{
+	}
+
+	virtual void OnTOCSizeInfo(uint64 uncompressedStringsSize,
+		uint64 uncompressedMainSize, uint64 uncompressedTOCSize)
+	{
+	}
+
+	virtual void OnPackageAttributesSizeInfo(uint32 stringCount,
+		uint32 uncompressedSize)
+	{
+	}
+
+	virtual void OnPackageSizeInfo(uint32 headerSize, uint64 heapSize,
+		uint64 tocSize, uint32 packageAttributesSize, uint64 totalSize)
+	{
+	}
+};
+
+
+static void
+fail(const char* message, const char* detail)
+{
+	fprintf(stderr, "%s: %s\n", message, detail);
+	exit(1);
+}
+
+
+static void
+write_file(const char* path, const void* data, size_t size)
+{
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+		fail("Could not create file", path);
+	if (fwrite(data, 1, size, file) != size)
+		fail("Could not write file", path);
+	fclose(file);
+}
+
+
+/*!	Creates files of different sizes and compressibility, so that the heap
+	consists of many chunks, some of which are stored uncompressed.
+*/
+static void
+create_files()
+{
+	write_file(".PackageInfo", kPackageInfo, strlen(kPackageInfo));
+
+	if (mkdir("data", 0755) != 0)
+		fail("Could not create directory", strerror(errno));
+
+	srand(42);
+	for (int32 i = 0; i < kFileCount; i++) {
+		size_t size = (i + 1) * 47 * 1024 + i * 13;
+		uint8* data = (uint8*)malloc(size);
+		if (data == NULL)
+			fail("Could not create file", "out of memory");
+
+		for (size_t j = 0; j < size; j++) {
+			// every third file is random, and thus incompressible
+			data[j] = i % 3 == 0 ? rand() & 0xff : (j / 100 + i) % 7;
+		}
+
+		BString path;
+		path.SetToFormat("data/file%" B_PRId32, i);
+		write_file(path.String(), data, size);
+		free(data);
+	}
+}
+
+
+static void
+remove_files()
+{
+	for (int32 i = 0; i < kFileCount; i++) {
+		BString path;
+		path.SetToFormat("data/file%" B_PRId32, i);
+		unlink(path.String());
+	}
+	rmdir("data");
+	unlink(".PackageInfo");
+}
+
+
+/*!	The parameters added later must not change the layout of the class, and
+	must survive copies.
+*/
+static void
+check_parameters()
+{
+	static_assert(sizeof(BPackageWriterParameters) == 3 * sizeof(uint32),
+		"BPackageWriterParameters changed its layout");
+
+	BPackageWriterParameters parameters;
+	if (parameters.SetCompressionThreadCount(4) != B_OK
+		|| parameters.SetChunkSize(16 * 1024) != B_OK) {
+		fail("Setting parameters failed", strerror(B_NO_MEMORY));
+	}
+
+	BPackageWriterParameters copy(parameters);
+	BPackageWriterParameters assigned;
+	assigned = parameters;
+
+	const BPackageWriterParameters* const kCopies[] = { &copy, &assigned };
+	for (size_t i = 0; i < B_COUNT_OF(kCopies); i++) {
+		if (kCopies[i]->InitCheck() != B_OK
+			|| kCopies[i]->CompressionThreadCount() != 4
+			|| kCopies[i]->ChunkSize() != 16 * 1024
+			|| kCopies[i]->CompressionDictionarySize() != 0) {
+			fail("Copying parameters failed", "values differ");
+		}
+	}
+
+	// and the defaults are back once the copy is overwritten
+	assigned = BPackageWriterParameters();
+	if (assigned.CompressionThreadCount() != 1
+		|| assigned.ChunkSize() != B_HPKG_DEFAULT_HEAP_CHUNK_SIZE) {
+		fail("Assigning parameters failed", "values kept");
+	}
+}
+
+
+static void
+write_package(BMallocIO& output, int32 threadCount)
+{
+	BPackageWriterParameters parameters;
+	if (parameters.SetCompressionThreadCount(threadCount) != B_OK)
+		fail("Setting the thread count failed", strerror(B_NO_MEMORY));
+
+	WriterListener listener;
+	BPackageWriter writer(&listener);
+	writer.SetCheckLicenses(false);
+
+	status_t status = writer.Init(&output, true, &parameters);
+	if (status == B_OK)
+		status = writer.AddEntry(".PackageInfo");
+	if (status == B_OK)
+		status = writer.AddEntry("data");
+	if (status == B_OK)
+		status = writer.Finish();
+	if (status != B_OK)
+		fail("Writing the package failed", strerror(status));
+}
+
+
+int
+main(int argc, char** argv)
+{
+	BString directory;
+	directory.SetToFormat("%s/package_writer_threads_test-%" B_PRId32,
+		argc > 1 ? argv[1] : "/tmp", find_thread(NULL));
+
+	if (mkdir(directory.String(), 0755) != 0 || chdir(directory.String()) != 0)
+		fail("Could not create directory", directory.String());
+
+	check_parameters();
+	create_files();
+
+	BMallocIO expected;
+	write_package(expected, 1);
+
+	static const int32 kThreadCounts[] = { 2, 3, 8 };
+	for (size_t i = 0; i < B_COUNT_OF(kThreadCounts); i++) {
+		BMallocIO output;
+		write_package(output, kThreadCounts[i]);
+
+		if (output.BufferLength() != expected.BufferLength()
+			|| memcmp(output.Buffer(), expected.Buffer(),
+				expected.BufferLength()) != 0) {
+			fprintf(stderr, "Package written with %" B_PRId32 " threads "
+				"differs\n", kThreadCounts[i]);
+			return 1;
+		}
+	}
+
+	remove_files();
+	chdir("/");
+	rmdir(directory.String());
+
+	printf("All tests passed.\n");
+	return 0;
+}
@@ -0,0 +1,344 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <Entry.h>
+#include <File.h>
+#include <OS.h>
+#include <String.h>
+
+#include <package/ChecksumAccessors.h>
+#include <package/Context.h>
+#include <package/PackageInfo.h>
+#include <package/RepositoryCache.h>
+#include <package/RepositoryDelta.h>
+#include <package/RepositoryInfo.h>
+#include <package/hpkg/RepositoryWriter.h>
+
+#include "ApplyRepositoryDeltaJob.h"
+
+
+using namespace BPackageKit;
+using BPackageKit::BHPKG::BRepositoryWriter;
+using BPackageKit::BHPKG::BRepositoryWriterListener;
+using BPackageKit::BPrivate::ApplyRepositoryDeltaJob;
+using BPackageKit::BPrivate::GeneralFileChecksumAccessor;
+using BPackageKit::BPrivate::RepositoryDelta;
+using BSupportKit::BJobStateListener;
+
+
+// Writes two versions of a local repository file, computes the delta between
+// them and checks that applying it to the old file reproduces the new one
+// exactly, both directly and through the job a client refreshing its cache
+// uses, which must fall back quietly if the server has no delta. The
+// repository files are written to a directory created in the given
+// directory, or in /tmp.
+
+
+struct PackageSpec {
+	const char*	name;
+	const char*	version;
+	const char*	checksum;
+};
+
+
+static const PackageSpec kBasePackages[] = {
+	{ "delta_a", "1.0-1", "aaaa" },
+	{ "delta_b", "1.0-1", "bbbb" },
+	{ "delta_c", "2.0-1", "cccc" },
+	{ "delta_d", "1.0-1", "dddd" },
+};
+
+static const PackageSpec kPackages[] = {
+	// unchanged
+	{ "delta_a", "1.0-1", "aaaa" },
+	// new version
+	{ "delta_b", "1.1-1", "bbbc" },
+	// same version, but rebuilt
+	{ "delta_c", "2.0-1", "cccd" },
+	// delta_d removed, delta_e added
+	{ "delta_e", "0.1-1", "eeee" },
+};
+
+
+class WriterListener : public BRepositoryWriterListener {
+public:
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		vfprintf(stderr, format, args);
+	}
+
+	virtual void OnPackageAdded(const BPackageInfo& packageInfo)
+	{
+	}
+
+	virtual void OnRepositoryInfoSectionDone(uint32 uncompressedSize)
+	{
+	}
+
+	virtual void OnPackageAttributesSectionDone(uint32 stringCount,
+		uint32 uncompressedSize)
+	{
+	}
+
+	virtual void OnRepositoryDone(uint32 headerSize, uint32 repositoryInfoSize,
+		uint32 licenseCount, uint32 packageCount, uint32 packageAttributesSize,
+		uint64 totalSize)
+	{
+	}
+};
+
+
+class FailureCounter : public BJobStateListener {
+public:
+	FailureCounter()
+		:
+		fFailures(0)
+	{
+	}
+
+	virtual void JobFailed(BSupportKit::BJob* job)
+	{
+		fFailures++;
+	}
+
+	int32 Failures() const
+	{
+		return fFailures;
+	}
+
+private:
+	int32	fFailures;
+};
+
+
+static void
+fail(const char* message, const char* detail)
+{
+	fprintf(stderr, "%s: %s\n", message, detail);
+	exit(1);
+}
+
+
+static void
+make_package_info(const PackageSpec& spec, BPackageInfo& info)
+{
+	BString config;
+	config.SetToFormat(
+		"name\t\t\t%s\n"
+		"version\t\t\t%s\n"
+		"architecture\tany\n"
+		"summary\t\t\t\"Test package\"\n"
+		"description\t\t\"Test package\"\n"
+		"packager\t\t\"Nobody <nobody@example.com>\"\n"
+		"vendor\t\t\t\"Haiku Project\"\n"
+		"copyrights\t\t\"2026 Haiku, Inc.\"\n"
+		"licenses\t\t\"MIT\"\n"
+		"provides {\n"
+		"\t%s = %s\n"
+		"}\n", spec.name, spec.version, spec.name, spec.version);
+
+	status_t status = info.ReadFromConfigString(config);
+	if (status != B_OK)
+		fail("Invalid package info", spec.name);
+
+	info.SetChecksum(spec.checksum);
+}
+
+
+/*!	Writes a repository file with the given packages. If \a reverse is
+	\c true, the packages are added in reverse order.
+*/
+static void
+write_repository(const char* path, const PackageSpec* packages, size_t count,
+	bool reverse)
+{
+	BRepositoryInfo repositoryInfo;
+	repositoryInfo.SetName("delta_test");
+	repositoryInfo.SetIdentifier("tag:haiku-os.org,2026:delta_test");
+	repositoryInfo.SetBaseURL("file:///delta_test");
+	repositoryInfo.SetVendor("Haiku Project");
+	repositoryInfo.SetSummary("Repository delta test");
+	repositoryInfo.SetPriority(1);
+	repositoryInfo.SetArchitecture(B_PACKAGE_ARCHITECTURE_X86_64);
+
+	WriterListener listener;
+	BRepositoryWriter writer(&listener, &repositoryInfo);
+	status_t status = writer.Init(path);
+	if (status != B_OK)
+		fail("Could not create repository", path);
+
+	for (size_t i = 0; i < count; i++) {
+		BPackageInfo info;
+		make_package_info(packages[reverse ? count - 1 - i : i], info);
+		if ((status = writer.AddPackageInfo(info)) != B_OK)
+			fail("Could not add package", info.Name().String());
+	}
+
+	if ((status = writer.Finish()) != B_OK)
+		fail("Could not write repository", path);
+}
+
+
+static void
+read_file(const char* path, BString& contents)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		fail("Could not open file", path);
+
+	char buffer[4096];
+	size_t bytesRead;
+	while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		contents.Append(buffer, bytesRead);
+
+	fclose(file);
+}
+
+
+static void
+compare_files(const char* path, const char* expectedPath)
+{
+	BString contents;
+	BString expected;
+	read_file(path, contents);
+	read_file(expectedPath, expected);
+
+	if (contents.Length() != expected.Length()
+		|| memcmp(contents.String(), expected.String(), contents.Length())
+			!= 0) {
+		fail("Repository file differs", path);
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	BString directory;
+	directory.SetToFormat("%s/repository_delta_test-%" B_PRId32,
+		argc > 1 ? argv[1] : "/tmp", find_thread(NULL));
+
+	if (mkdir(directory.String(), 0755) != 0 || chdir(directory.String()) != 0)
+		fail("Could not create directory", directory.String());
+
+	write_repository("base", kBasePackages, B_COUNT_OF(kBasePackages), false);
+	write_repository("repo", kPackages, B_COUNT_OF(kPackages), false);
+
+	// the file must not depend on the order the packages are added in
+	write_repository("reversed", kPackages, B_COUNT_OF(kPackages), true);
+	compare_files("reversed", "repo");
+
+	RepositoryDelta delta;
+	status_t status = delta.SetTo(BEntry("base"), BEntry("repo"));
+	if (status != B_OK)
+		fail("Computing the delta failed", strerror(status));
+
+	// delta_b (old version), delta_c, and delta_d are removed, delta_b (new
+	// version), delta_c, and delta_e are added
+	if (delta.CountRemovedPackages() != 3 || delta.CountAddedPackages() != 3)
+		fail("Unexpected delta", "wrong number of packages");
+
+	if ((status = delta.WriteToFile(BEntry("delta"))) != B_OK)
+		fail("Writing the delta failed", strerror(status));
+
+	// apply the delta the way a client refreshing its cache does
+	BRepositoryCache repositoryCache;
+	if ((status = repositoryCache.SetTo(BEntry("base"))) != B_OK)
+		fail("Could not open repository", strerror(status));
+
+	status = repositoryCache.ApplyDelta(BEntry("delta"), BEntry("applied"));
+	if (status != B_OK)
+		fail("Applying the delta failed", strerror(status));
+
+	compare_files("applied", "repo");
+
+	// a delta must not apply to any other repository file
+	RepositoryDelta readDelta;
+	if ((status = readDelta.SetTo(BEntry("delta"))) != B_OK)
+		fail("Reading the delta failed", strerror(status));
+
+	status = readDelta.Apply(BEntry("repo"), BEntry("mismatch"));
+	if (status != B_MISMATCHED_VALUES)
+		fail("Delta applied to the wrong file", strerror(status));
+
+	// without a delta on the server, the job must neither fail nor report
+	// a failed job, as that is fatal to pkgman
+	BDecisionProvider decisionProvider;
+	FailureCounter failureCounter;
+	BContext context(decisionProvider, failureCounter);
+	if ((status = context.InitCheck()) != B_OK)
+		fail("Could not create context", strerror(status));
+
+	if (mkdir("server", 0755) != 0)
+		fail("Could not create directory", "server");
+
+	BString checksum;
+	status = GeneralFileChecksumAccessor(BEntry("repo")).GetChecksum(checksum);
+	if (status != B_OK)
+		fail("Could not compute checksum", strerror(status));
+
+	BFile checksumFile("checksum", B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	if (checksumFile.Write(checksum.String(), checksum.Length())
+			!= checksum.Length()) {
+		fail("Could not write checksum file", "checksum");
+	}
+
+	BString baseURL;
+	baseURL.SetToFormat("file://%s/server", directory.String());
+
+	ApplyRepositoryDeltaJob noDeltaJob(context, "delta", baseURL,
+		BEntry("base"), BEntry("checksum"), BEntry("fetched"));
+	if ((status = noDeltaJob.Run()) != B_OK)
+		fail("Job failed without a delta", strerror(status));
+	if (noDeltaJob.DeltaApplied() || BEntry("fetched").Exists())
+		fail("Job applied a delta", "there is none");
+	if (failureCounter.Failures() != 0)
+		fail("Missing delta reported", "as failed job");
+
+	// and with one, it must produce the current repository file
+	BString baseChecksum;
+	status = GeneralFileChecksumAccessor(BEntry("base")).GetChecksum(
+		baseChecksum);
+	if (status != B_OK)
+		fail("Could not compute checksum", strerror(status));
+
+	BString deltaPath = BString("server/deltas/") << baseChecksum;
+	if (mkdir("server/deltas", 0755) != 0
+		|| rename("delta", deltaPath.String()) != 0) {
+		fail("Could not publish delta", deltaPath.String());
+	}
+
+	ApplyRepositoryDeltaJob deltaJob(context, "delta", baseURL,
+		BEntry("base"), BEntry("checksum"), BEntry("fetched"));
+	if ((status = deltaJob.Run()) != B_OK)
+		fail("Job failed with a delta", strerror(status));
+	if (!deltaJob.DeltaApplied())
+		fail("Job did not apply delta", deltaPath.String());
+
+	compare_files("fetched", "repo");
+
+	static const char* const kFiles[] = {
+		"base", "repo", "reversed", "delta", "applied", "mismatch",
+		"checksum", "fetched"
+	};
+	for (size_t i = 0; i < B_COUNT_OF(kFiles); i++)
+		unlink(kFiles[i]);
+	unlink(deltaPath.String());
+	rmdir("server/deltas");
+	rmdir("server");
+	chdir("/");
+	rmdir(directory.String());
+
+	printf("All tests passed.\n");
+	return 0;
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "BenchmarkCase.h"
+
+
+BenchmarkCase::BenchmarkCase(const char* name)
+	:
+	fName(name)
+{
+}
+
+
+BenchmarkCase::~BenchmarkCase()
+{
+}
+
+
+void
+BenchmarkCase::Prepare(benchmark_context& context)
+{
+}
+
+
+void
+BenchmarkCase::Cleanup(benchmark_context& context)
+{
+}
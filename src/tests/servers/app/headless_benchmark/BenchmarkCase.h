@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef BENCHMARK_CASE_H
+#define BENCHMARK_CASE_H
+
+
+#include <ObjectList.h>
+#include <Rect.h>
+#include <Region.h>
+#include <String.h>
+
+
+class DrawingEngine;
+class Painter;
+
+
+struct benchmark_context {
+	DrawingEngine*	engine;
+	Painter*		painter;
+		// attached to its own buffer, for the cases that bypass the
+		// DrawingEngine
+	BRect			bounds;
+	const BRegion*	clipping;
+		// covers the bounds, the clipping to go back to
+};
+
+
+// A single measurement. Run() is timed, Prepare() and Cleanup() are not.
+class BenchmarkCase {
+public:
+								BenchmarkCase(const char* name);
+	virtual						~BenchmarkCase();
+
+			const char*			Name() const { return fName.String(); }
+
+	virtual	void				Prepare(benchmark_context& context);
+	virtual	void				Run(benchmark_context& context) = 0;
+	virtual	void				Cleanup(benchmark_context& context);
+
+private:
+			BString				fName;
+};
+
+
+typedef BObjectList<BenchmarkCase, true> BenchmarkCaseList;
+
+
+void add_drawing_mode_cases(BenchmarkCaseList& cases);
+void add_text_cases(BenchmarkCaseList& cases);
+void add_bitmap_cases(BenchmarkCaseList& cases);
+void add_gradient_cases(BenchmarkCaseList& cases);
+void add_clipping_cases(BenchmarkCaseList& cases);
+void add_painter_cases(BenchmarkCaseList& cases);
+
+
+#endif // BENCHMARK_CASE_H
@@ -0,0 +1,612 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "BenchmarkCase.h"
+
+#include <GradientConic.h>
+#include <GradientDiamond.h>
+#include <GradientLinear.h>
+#include <GradientRadial.h>
+#include <GradientRadialFocus.h>
+#include <Region.h>
+
+#include <new>
+#include <string.h>
+
+#include "DrawingEngine.h"
+#include "DrawingModeToString.h"
+#include "GlobalFontManager.h"
+#include "Painter.h"
+#include "ServerBitmap.h"
+#include "ServerFont.h"
+
+
+static const int32 kLineCount = 200;
+static const int32 kTextLineCount = 20;
+static const char* kText
+	= "The quick brown fox jumps over the lazy dog. 0123456789";
+
+static const drawing_mode kDrawingModes[] = {
+	B_OP_COPY, B_OP_OVER, B_OP_ERASE, B_OP_INVERT, B_OP_ADD, B_OP_SUBTRACT,
+	B_OP_BLEND, B_OP_MIN, B_OP_MAX, B_OP_SELECT, B_OP_ALPHA
+};
+static const int32 kDrawingModeCount
+	= sizeof(kDrawingModes) / sizeof(kDrawingModes[0]);
+
+
+/*!	A simple generator, so that every run and every platform draws the very
+	same things.
+*/
+class RandomSequence {
+public:
+	RandomSequence()
+		:
+		fState(0x12345678)
+	{
+	}
+
+	uint32 Next()
+	{
+		fState = fState * 1103515245 + 12345;
+		return fState >> 8;
+	}
+
+	float Between(float from, float to)
+	{
+		return from + (to - from) * (Next() & 0xffff) / 65535.0f;
+	}
+
+private:
+	uint32	fState;
+};
+
+
+static BString
+case_name(const char* group, drawing_mode mode, const char* suffix = NULL)
+{
+	const char* modeName = "unknown";
+	ToString(mode, modeName);
+
+	BString name(group);
+	name << "/" << modeName;
+	if (suffix != NULL)
+		name << "/" << suffix;
+	return name;
+}
+
+
+static void
+reset_drawing_state(benchmark_context& context)
+{
+	DrawingEngine* engine = context.engine;
+	engine->SetDrawingMode(B_OP_COPY);
+	engine->SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_OVERLAY);
+	engine->SetHighColor(make_color(0, 0, 0));
+	engine->SetLowColor(make_color(255, 255, 255));
+	engine->SetPenSize(1.0f);
+	engine->FillRect(context.bounds, make_color(255, 255, 255));
+}
+
+
+static void
+add_color_stops(BGradient& gradient)
+{
+	gradient.AddColor(make_color(255, 0, 0), 0);
+	gradient.AddColor(make_color(0, 255, 0, 128), 128);
+	gradient.AddColor(make_color(0, 0, 255), 255);
+}
+
+
+// #pragma mark - drawing modes
+
+
+class DrawingModeCase : public BenchmarkCase {
+public:
+	DrawingModeCase(const char* name, drawing_mode mode,
+		source_alpha sourceAlpha = B_PIXEL_ALPHA,
+		alpha_function alphaFunction = B_ALPHA_OVERLAY)
+		:
+		BenchmarkCase(name),
+		fMode(mode),
+		fSourceAlpha(sourceAlpha),
+		fAlphaFunction(alphaFunction)
+	{
+	}
+
+	virtual void Prepare(benchmark_context& context)
+	{
+		reset_drawing_state(context);
+		context.engine->SetDrawingMode(fMode);
+		context.engine->SetBlendingMode(fSourceAlpha, fAlphaFunction);
+		context.engine->SetHighColor(make_color(51, 102, 204, 160));
+		context.engine->SetLowColor(make_color(240, 200, 20, 96));
+	}
+
+protected:
+	drawing_mode	fMode;
+	source_alpha	fSourceAlpha;
+	alpha_function	fAlphaFunction;
+};
+
+
+class FillRectCase : public DrawingModeCase {
+public:
+	FillRectCase(const char* name, drawing_mode mode,
+		source_alpha sourceAlpha = B_PIXEL_ALPHA,
+		alpha_function alphaFunction = B_ALPHA_OVERLAY)
+		:
+		DrawingModeCase(name, mode, sourceAlpha, alphaFunction)
+	{
+	}
+
+	virtual void Run(benchmark_context& context)
+	{
+		context.engine->FillRect(context.bounds.InsetByCopy(16, 16));
+	}
+};
+
+
+class RandomLinesCase : public DrawingModeCase {
+public:
+	RandomLinesCase(const char* name, drawing_mode mode,
+		source_alpha sourceAlpha = B_PIXEL_ALPHA,
+		alpha_function alphaFunction = B_ALPHA_OVERLAY)
+		:
+		DrawingModeCase(name, mode, sourceAlpha, alphaFunction)
+	{
+	}
+
+	virtual void Run(benchmark_context& context)
+	{
+		RandomSequence random;
+		BRect bounds = context.bounds;
+		float middle = (bounds.top + bounds.bottom) / 2;
+
+		for (int32 i = 0; i < kLineCount; i++) {
+			BPoint a(random.Between(bounds.left, bounds.right),
+				random.Between(bounds.top, middle));
+			BPoint b(random.Between(bounds.left, bounds.right),
+				random.Between(middle, bounds.bottom));
+			context.engine->StrokeLine(a, b);
+		}
+	}
+};
+
+
+void
+add_drawing_mode_cases(BenchmarkCaseList& cases)
+{
+	for (int32 i = 0; i < kDrawingModeCount; i++) {
+		drawing_mode mode = kDrawingModes[i];
+		cases.AddItem(new FillRectCase(case_name("fill-rect", mode).String(),
+			mode));
+		cases.AddItem(new RandomLinesCase(case_name("lines", mode).String(),
+			mode));
+	}
+
+	// the other blending modes of B_OP_ALPHA
+	cases.AddItem(new FillRectCase(
+		case_name("fill-rect", B_OP_ALPHA, "constant-overlay").String(),
+		B_OP_ALPHA, B_CONSTANT_ALPHA, B_ALPHA_OVERLAY));
+	cases.AddItem(new FillRectCase(
+		case_name("fill-rect", B_OP_ALPHA, "pixel-composite").String(),
+		B_OP_ALPHA, B_PIXEL_ALPHA, B_ALPHA_COMPOSITE));
+	cases.AddItem(new FillRectCase(
+		case_name("fill-rect", B_OP_ALPHA, "constant-composite").String(),
+		B_OP_ALPHA, B_CONSTANT_ALPHA, B_ALPHA_COMPOSITE));
+}
+
+
+// #pragma mark - text
+
+
+class TextCase : public BenchmarkCase {
+public:
+	TextCase(const char* name, float size, uint32 flags)
+		:
+		BenchmarkCase(name),
+		fSize(size),
+		fFlags(flags)
+	{
+	}
+
+	virtual void Prepare(benchmark_context& context)
+	{
+		reset_drawing_state(context);
+
+		ServerFont font(*gFontManager->DefaultPlainFont());
+		font.SetSize(fSize);
+		font.SetFlags(fFlags);
+		context.engine->SetFont(font);
+		context.engine->SetDrawingMode(B_OP_OVER);
+	}
+
+	virtual void Run(benchmark_context& context)
+	{
+		int32 length = strlen(kText);
+		float lineHeight = ceilf(fSize * 1.2f);
+
+		BPoint where(4, lineHeight);
+		for (int32 i = 0; i < kTextLineCount; i++) {
+			context.engine->DrawString(kText, length, where);
+
+			where.y += lineHeight;
+			if (where.y > context.bounds.bottom)
+				where.y = lineHeight;
+		}
+	}
+
+private:
+	float	fSize;
+	uint32	fFlags;
+};
+
+
+void
+add_text_cases(BenchmarkCaseList& cases)
+{
+	static const float kSizes[] = { 9, 12, 18, 36, 72 };
+
+	for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); i++) {
+		BString name("text/");
+		name << (int32)kSizes[i];
+		cases.AddItem(new TextCase(name.String(), kSizes[i], 0));
+	}
+
+	cases.AddItem(new TextCase("text/12/aliased", 12,
+		B_DISABLE_ANTIALIASING));
+}
+
+
+// #pragma mark - bitmaps
+
+
+class BitmapCase : public BenchmarkCase {
+public:
+	BitmapCase(const char* name, float scale, uint32 options,
+		drawing_mode mode)
+		:
+		BenchmarkCase(name),
+		fScale(scale),
+		fOptions(options),
+		fMode(mode),
+		fBitmap(NULL)
+	{
+	}
+
+	virtual void Prepare(benchmark_context& context)
+	{
+		reset_drawing_state(context);
+		context.engine->SetDrawingMode(fMode);
+
+		fBitmap = new(std::nothrow) UtilityBitmap(BRect(0, 0, 255, 255),
+			B_RGBA32, 0);
+		if (fBitmap != NULL && !fBitmap->IsValid()) {
+			fBitmap->ReleaseReference();
+			fBitmap = NULL;
+		}
+		if (fBitmap == NULL)
+			return;
+
+		// a smooth picture with varying alpha, so that filtering and
+		// blending have something to do
+		uint8* row = fBitmap->Bits();
+		for (int32 y = 0; y < 256; y++) {
+			uint8* pixel = row;
+			for (int32 x = 0; x < 256; x++) {
+				pixel[0] = x;
+				pixel[1] = y;
+				pixel[2] = (x ^ y) & 0xff;
+				pixel[3] = (x + y) / 2;
+				pixel += 4;
+			}
+			row += fBitmap->BytesPerRow();
+		}
+	}
+
+	virtual void Run(benchmark_context& context)
+	{
+		if (fBitmap == NULL)
+			return;
+
+		BRect source = fBitmap->Bounds();
+		BRect destination(16, 16, 16 + floorf(256 * fScale) - 1,
+			16 + floorf(256 * fScale) - 1);
+		context.engine->DrawBitmap(fBitmap, source, destination, fOptions);
+	}
+
+	virtual void Cleanup(benchmark_context& context)
+	{
+		if (fBitmap != NULL)
+			fBitmap->ReleaseReference();
+		fBitmap = NULL;
+	}
+
+private:
+	float			fScale;
+	uint32			fOptions;
+	drawing_mode	fMode;
+	UtilityBitmap*	fBitmap;
+};
+
+
+void
+add_bitmap_cases(BenchmarkCaseList& cases)
+{
+	static const struct {
+		const char*	name;
+		float		scale;
+	} kScales[] = {
+		{ "1x", 1.0f },
+		{ "0.5x", 0.5f },
+		{ "0.73x", 0.73f },
+		{ "0.125x", 0.125f },
+		{ "1.37x", 1.37f },
+		{ "2x", 2.0f }
+	};
+	static const struct {
+		const char*	name;
+		uint32		options;
+	} kFilters[] = {
+		{ "nearest", 0 },
+		{ "bilinear", B_FILTER_BITMAP_BILINEAR },
+		{ "area-average",
+			B_FILTER_BITMAP_BILINEAR | B_FILTER_BITMAP_AREA_AVERAGE }
+	};
+	static const drawing_mode kModes[] = { B_OP_COPY, B_OP_ALPHA };
+
+	for (size_t filter = 0; filter < sizeof(kFilters) / sizeof(kFilters[0]);
+			filter++) {
+		for (size_t scale = 0; scale < sizeof(kScales) / sizeof(kScales[0]);
+				scale++) {
+			for (size_t mode = 0; mode < 2; mode++) {
+				BString group("bitmap/");
+				group << kFilters[filter].name << "/" << kScales[scale].name;
+				BString name = case_name(group.String(), kModes[mode]);
+				cases.AddItem(new BitmapCase(name.String(),
+					kScales[scale].scale, kFilters[filter].options,
+					kModes[mode]));
+			}
+		}
+	}
+}
+
+
+// #pragma mark - gradients
+
+
+class GradientCase : public BenchmarkCase {
+public:
+	GradientCase(const char* name, BGradient* gradient)
+		:
+		BenchmarkCase(name),
+		fGradient(gradient)
+	{
+		add_color_stops(*fGradient);
+	}
+
+	virtual ~GradientCase()
+	{
+		delete fGradient;
+	}
+
+	virtual void Prepare(benchmark_context& context)
+	{
+		reset_drawing_state(context);
+	}
+
+	virtual void Run(benchmark_context& context)
+	{
+		context.engine->FillRect(BRect(16, 16, 415, 415), *fGradient);
+	}
+
+private:
+	BGradient*	fGradient;
+};
+
+
+void
+add_gradient_cases(BenchmarkCaseList& cases)
+{
+	BPoint center(216, 216);
+
+	cases.AddItem(new GradientCase("gradient/linear-vertical",
+		new BGradientLinear(BPoint(0, 16), BPoint(0, 415))));
+	cases.AddItem(new GradientCase("gradient/linear-horizontal",
+		new BGradientLinear(BPoint(16, 0), BPoint(415, 0))));
+	cases.AddItem(new GradientCase("gradient/linear-diagonal",
+		new BGradientLinear(BPoint(16, 16), BPoint(415, 415))));
+	cases.AddItem(new GradientCase("gradient/radial",
+		new BGradientRadial(center, 200)));
+	cases.AddItem(new GradientCase("gradient/radial-focus",
+		new BGradientRadialFocus(center, 200, BPoint(150, 150))));
+	cases.AddItem(new GradientCase("gradient/diamond",
+		new BGradientDiamond(center)));
+	cases.AddItem(new GradientCase("gradient/conic",
+		new BGradientConic(center, 0)));
+}
+
+
+// #pragma mark - clipping
+
+
+/*!	Runs another case with the clipping constrained to a grid of
+	\a gridSize by \a gridSize rectangles, like a complex window layout.
+*/
+class ClippingCase : public BenchmarkCase {
+public:
+	ClippingCase(const char* name, int32 gridSize, BenchmarkCase* other)
+		:
+		BenchmarkCase(name),
+		fGridSize(gridSize),
+		fOther(other)
+	{
+	}
+
+	virtual ~ClippingCase()
+	{
+		delete fOther;
+	}
+
+	virtual void Prepare(benchmark_context& context)
+	{
+		fOther->Prepare(context);
+
+		BRect bounds = context.bounds;
+		float width = (bounds.Width() + 1) / fGridSize;
+		float height = (bounds.Height() + 1) / fGridSize;
+
+		fRegion.MakeEmpty();
+		for (int32 y = 0; y < fGridSize; y++) {
+			for (int32 x = 0; x < fGridSize; x++) {
+				BRect cell(bounds.left + x * width, bounds.top + y * height,
+					bounds.left + (x + 1) * width - 1,
+					bounds.top + (y + 1) * height - 1);
+				if (fGridSize > 1)
+					cell.InsetBy(1, 1);
+				fRegion.Include(cell);
+			}
+		}
+
+		// the engine doesn't copy the region
+		context.engine->ConstrainClippingRegion(&fRegion);
+	}
+
+	virtual void Run(benchmark_context& context)
+	{
+		fOther->Run(context);
+	}
+
+	virtual void Cleanup(benchmark_context& context)
+	{
+		context.engine->ConstrainClippingRegion(context.clipping);
+
+		fOther->Cleanup(context);
+	}
+
+private:
+	int32			fGridSize;
+	BenchmarkCase*	fOther;
+	BRegion			fRegion;
+};
+
+
+void
+add_clipping_cases(BenchmarkCaseList& cases)
+{
+	static const int32 kGridSizes[] = { 1, 4, 16, 32 };
+
+	for (size_t i = 0; i < sizeof(kGridSizes) / sizeof(kGridSizes[0]); i++) {
+		int32 gridSize = kGridSizes[i];
+		BString prefix("clipping/");
+		prefix << gridSize * gridSize << "/";
+
+		BString name = prefix;
+		name << "fill-rect";
+		cases.AddItem(new ClippingCase(name.String(), gridSize,
+			new FillRectCase("", B_OP_COPY)));
+
+		name = prefix;
+		name << "lines";
+		cases.AddItem(new ClippingCase(name.String(), gridSize,
+			new RandomLinesCase("", B_OP_COPY)));
+
+		name = prefix;
+		name << "text";
+		cases.AddItem(new ClippingCase(name.String(), gridSize,
+			new TextCase("", 12, 0)));
+	}
+}
+
+
+// #pragma mark - Painter
+
+
+class PainterCase : public BenchmarkCase {
+public:
+	enum kind {
+		FILL_RECT,
+		FILL_RECT_NO_CLIPPING,
+		FILL_RECT_VERTICAL_GRADIENT,
+		STROKE_LINES
+	};
+
+	PainterCase(const char* name, kind what)
+		:
+		BenchmarkCase(name),
+		fKind(what),
+		fGradient(BPoint(0, 16), BPoint(0, 415))
+	{
+		add_color_stops(fGradient);
+	}
+
+	virtual void Prepare(benchmark_context& context)
+	{
+		Painter* painter = context.painter;
+		painter->SetDrawingMode(B_OP_COPY);
+		painter->SetPenSize(1.0f);
+		painter->SetHighColor(make_color(51, 102, 204));
+	}
+
+	virtual void Run(benchmark_context& context)
+	{
+		Painter* painter = context.painter;
+		BRect rect = context.bounds.InsetByCopy(16, 16);
+
+		switch (fKind) {
+			case FILL_RECT:
+				painter->FillRect(rect);
+				break;
+
+			case FILL_RECT_NO_CLIPPING:
+			{
+				clipping_rect clipped = {
+					(int32)rect.left, (int32)rect.top,
+					(int32)rect.right, (int32)rect.bottom };
+				painter->FillRectNoClipping(clipped,
+					make_color(51, 102, 204));
+				break;
+			}
+
+			case FILL_RECT_VERTICAL_GRADIENT:
+				painter->FillRectVerticalGradient(BRect(16, 16, 415, 415),
+					fGradient);
+				break;
+
+			case STROKE_LINES:
+			{
+				RandomSequence random;
+				BRect bounds = context.bounds;
+				for (int32 i = 0; i < kLineCount; i++) {
+					painter->StrokeLine(
+						BPoint(random.Between(bounds.left, bounds.right),
+							random.Between(bounds.top, bounds.bottom)),
+						BPoint(random.Between(bounds.left, bounds.right),
+							random.Between(bounds.top, bounds.bottom)));
+				}
+				break;
+			}
+		}
+	}
+
+private:
+	kind			fKind;
+	BGradientLinear	fGradient;
+};
+
+
+void
+add_painter_cases(BenchmarkCaseList& cases)
+{
+	cases.AddItem(new PainterCase("painter/fill-rect",
+		PainterCase::FILL_RECT));
+	cases.AddItem(new PainterCase("painter/fill-rect-no-clipping",
+		PainterCase::FILL_RECT_NO_CLIPPING));
+	cases.AddItem(new PainterCase("painter/fill-rect-vertical-gradient",
+		PainterCase::FILL_RECT_VERTICAL_GRADIENT));
+	cases.AddItem(new PainterCase("painter/lines",
+		PainterCase::STROKE_LINES));
+}
@@ -0,0 +1,324 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Times the app_server drawing code without a running app_server: the
+	cases draw through a BitmapDrawingEngine, and through a Painter attached
+	to a bitmap, so that neither windows nor a screen are involved.
+
+	The timings are printed as tab separated values, one case per line. A
+	previous run can be passed as baseline, any case that got slower by more
+	than the threshold is then reported, and the exit status is 1.
+*/
+
+
+#include "BenchmarkCase.h"
+
+#include <OS.h>
+#include <Region.h>
+
+#include <errno.h>
+#include <getopt.h>
+#include <map>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BitmapBuffer.h"
+#include "BitmapDrawingEngine.h"
+#include "GlobalFontManager.h"
+#include "Painter.h"
+#include "ServerBitmap.h"
+
+
+typedef std::map<BString, bigtime_t> TimingMap;
+
+
+static const bigtime_t kDefaultMinimumTime = 200000;
+static const int32 kMinimumIterations = 5;
+static const float kDefaultThreshold = 10.0f;
+
+
+struct timing {
+	int32		iterations;
+	bigtime_t	mean;
+	bigtime_t	best;
+};
+
+
+extern const char* __progname;
+static const char* kProgramName = __progname;
+
+
+static void
+usage(int status)
+{
+	fprintf(stderr, "Usage: %s [options] [filter ...]\n"
+		"Times the app_server drawing code on a bitmap, and prints the\n"
+		"results as tab separated values. Only the cases whose name contains\n"
+		"one of the filters are run.\n\n"
+		"  -l, --list              Only list the names of the cases.\n"
+		"  -t, --time <ms>         Minimum time spent on each case, default\n"
+		"                          %" B_PRId64 " ms.\n"
+		"  -s, --size <w>x<h>      Size of the drawing area, default\n"
+		"                          1024x768.\n"
+		"  -b, --baseline <file>   Compare to the output of a previous run.\n"
+		"  -r, --threshold <%%>     Slow down that counts as a regression,\n"
+		"                          default %g%%.\n"
+		"  -h, --help              Show this help.\n",
+		kProgramName, kDefaultMinimumTime / 1000, kDefaultThreshold);
+
+	exit(status);
+}
+
+
+static bool
+matches_filter(const char* name, char** filters, int32 filterCount)
+{
+	if (filterCount == 0)
+		return true;
+
+	for (int32 i = 0; i < filterCount; i++) {
+		if (strstr(name, filters[i]) != NULL)
+			return true;
+	}
+
+	return false;
+}
+
+
+static timing
+run_case(BenchmarkCase* benchmark, benchmark_context& context,
+	bigtime_t minimumTime)
+{
+	benchmark->Prepare(context);
+
+	// warm up caches, and the font cache in particular
+	benchmark->Run(context);
+
+	timing result = { 0, 0, B_INFINITE_TIMEOUT };
+	bigtime_t total = 0;
+	while (total < minimumTime || result.iterations < kMinimumIterations) {
+		bigtime_t start = system_time();
+		benchmark->Run(context);
+		bigtime_t elapsed = system_time() - start;
+
+		total += elapsed;
+		if (elapsed < result.best)
+			result.best = elapsed;
+		result.iterations++;
+	}
+
+	result.mean = total / result.iterations;
+
+	benchmark->Cleanup(context);
+	return result;
+}
+
+
+/*!	Reads the best times of a previous run; lines starting with '#' are
+	ignored.
+*/
+static status_t
+read_baseline(const char* path, TimingMap& baseline)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+		return errno;
+
+	char line[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		char* name = strtok(line, "\t\n");
+		char* iterations = strtok(NULL, "\t\n");
+		char* mean = strtok(NULL, "\t\n");
+		char* best = strtok(NULL, "\t\n");
+		if (name == NULL || iterations == NULL || mean == NULL
+			|| best == NULL) {
+			continue;
+		}
+
+		baseline[name] = strtoll(best, NULL, 10);
+	}
+
+	fclose(file);
+	return B_OK;
+}
+
+
+/*!	Runs the cases that match the filters, and returns how many of them
+	regressed compared to the \a baseline, or -1 on error.
+*/
+static int32
+run_benchmarks(BenchmarkCaseList& cases, char** filters, int32 filterCount,
+	int32 width, int32 height, bigtime_t minimumTime,
+	const TimingMap& baseline, float threshold)
+{
+	BitmapDrawingEngine engine(B_RGB32);
+	status_t status = engine.SetSize(width, height);
+	if (status != B_OK) {
+		fprintf(stderr, "%s: Could not create the drawing engine: %s\n",
+			kProgramName, strerror(status));
+		return -1;
+	}
+
+	BRect bounds(0, 0, width - 1, height - 1);
+	BReference<UtilityBitmap> painterBitmap(
+		new(std::nothrow) UtilityBitmap(bounds, B_RGB32, 0), true);
+	if (painterBitmap.Get() == NULL || !painterBitmap->IsValid()) {
+		fprintf(stderr, "%s: Could not create the Painter bitmap\n",
+			kProgramName);
+		return -1;
+	}
+
+	// both the engine and the Painter keep a pointer to their clipping
+	BRegion clipping(bounds);
+	BitmapBuffer painterBuffer(painterBitmap.Get());
+	Painter painter;
+	painter.AttachToBuffer(&painterBuffer);
+	painter.ConstrainClipping(&clipping);
+	engine.ConstrainClippingRegion(&clipping);
+
+	benchmark_context context;
+	context.engine = &engine;
+	context.painter = &painter;
+	context.bounds = bounds;
+	context.clipping = &clipping;
+
+	printf("# size %" B_PRId32 "x%" B_PRId32 "\n", width, height);
+	printf("# name\titerations\tmean_us\tbest_us\n");
+
+	int32 regressions = 0;
+	for (int32 i = 0; i < cases.CountItems(); i++) {
+		BenchmarkCase* benchmark = cases.ItemAt(i);
+		if (!matches_filter(benchmark->Name(), filters, filterCount))
+			continue;
+
+		timing result = run_case(benchmark, context, minimumTime);
+		printf("%s\t%" B_PRId32 "\t%" B_PRId64 "\t%" B_PRId64 "\n",
+			benchmark->Name(), result.iterations, result.mean, result.best);
+		fflush(stdout);
+
+		TimingMap::const_iterator found = baseline.find(benchmark->Name());
+		if (found == baseline.end() || found->second <= 0)
+			continue;
+
+		float change = 100.0f * (result.best - found->second) / found->second;
+		if (change > threshold) {
+			fprintf(stderr, "%s: %s regressed by %.1f%% (%" B_PRId64 " us, "
+				"was %" B_PRId64 " us)\n", kProgramName, benchmark->Name(),
+				change, result.best, found->second);
+			regressions++;
+		}
+	}
+
+	return regressions;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	static struct option const kLongOptions[] = {
+		{"list", no_argument, 0, 'l'},
+		{"time", required_argument, 0, 't'},
+		{"size", required_argument, 0, 's'},
+		{"baseline", required_argument, 0, 'b'},
+		{"threshold", required_argument, 0, 'r'},
+		{"help", no_argument, 0, 'h'},
+		{NULL}
+	};
+
+	bool listOnly = false;
+	bigtime_t minimumTime = kDefaultMinimumTime;
+	int32 width = 1024;
+	int32 height = 768;
+	const char* baselinePath = NULL;
+	float threshold = kDefaultThreshold;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "lt:s:b:r:h", kLongOptions, NULL))
+			!= -1) {
+		switch (c) {
+			case 0:
+				break;
+			case 'l':
+				listOnly = true;
+				break;
+			case 't':
+				minimumTime = strtol(optarg, NULL, 0) * 1000LL;
+				break;
+			case 's':
+				if (sscanf(optarg, "%" B_SCNd32 "x%" B_SCNd32, &width,
+						&height) != 2 || width < 1 || height < 1) {
+					usage(1);
+				}
+				break;
+			case 'b':
+				baselinePath = optarg;
+				break;
+			case 'r':
+				threshold = strtod(optarg, NULL);
+				break;
+			case 'h':
+				usage(0);
+				break;
+			default:
+				usage(1);
+				break;
+		}
+	}
+
+	char** filters = argv + optind;
+	int32 filterCount = argc - optind;
+
+	BenchmarkCaseList allCases(64);
+	add_drawing_mode_cases(allCases);
+	add_text_cases(allCases);
+	add_bitmap_cases(allCases);
+	add_gradient_cases(allCases);
+	add_clipping_cases(allCases);
+	add_painter_cases(allCases);
+
+	if (listOnly) {
+		for (int32 i = 0; i < allCases.CountItems(); i++) {
+			const char* name = allCases.ItemAt(i)->Name();
+			if (matches_filter(name, filters, filterCount))
+				printf("%s\n", name);
+		}
+		return 0;
+	}
+
+	TimingMap baseline;
+	if (baselinePath != NULL) {
+		status_t status = read_baseline(baselinePath, baseline);
+		if (status != B_OK) {
+			fprintf(stderr, "%s: Could not read baseline \"%s\": %s\n",
+				kProgramName, baselinePath, strerror(status));
+			return 1;
+		}
+	}
+
+	gFontManager = new GlobalFontManager;
+	if (gFontManager->InitCheck() != B_OK) {
+		fprintf(stderr, "%s: Could not initialize the font manager: %s\n",
+			kProgramName, strerror(gFontManager->InitCheck()));
+		return 1;
+	}
+
+	int32 regressions = run_benchmarks(allCases, filters, filterCount,
+		width, height, minimumTime, baseline, threshold);
+
+	// the cases may still refer to fonts
+	allCases.MakeEmpty();
+
+	gFontManager->Lock();
+	gFontManager->Quit();
+
+	return regressions != 0 ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "BitmapScaling.h"
+#include "drawing_support.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <TestSuiteAddon.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+
+using BitmapPainterPrivate::FilterInfo;
+
+
+static const uint32 kSourceWidth = 48;
+static const uint32 kSourceBytesPerRow = kSourceWidth * 4 + 12;
+static const uint32 kMaxRowLength = 67;
+static const int32 kIterations = 2000;
+
+
+class BitmapScalingTest : public CppUnit::TestFixture {
+	CPPUNIT_TEST_SUITE(BitmapScalingTest);
+	CPPUNIT_TEST(SSE2MatchesScalar);
+	CPPUNIT_TEST(AVX2MatchesScalar);
+	CPPUNIT_TEST(LinearLightRoundTrip);
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void SSE2MatchesScalar()
+	{
+#if defined(__i386__) || defined(__x86_64__)
+		if (__builtin_cpu_supports("sse2"))
+			_CompareWithScalar(bitmap_scalers_for(APPSERVER_SIMD_SSE2));
+#endif
+	}
+
+	void AVX2MatchesScalar()
+	{
+#if defined(__i386__) || defined(__x86_64__)
+		if (__builtin_cpu_supports("avx2"))
+			_CompareWithScalar(bitmap_scalers_for(APPSERVER_SIMD_AVX2));
+#endif
+	}
+
+	void LinearLightRoundTrip()
+	{
+		for (int32 i = 0; i < 256; i++) {
+			CPPUNIT_ASSERT(linear_to_srgb(gSRGBToLinear[i]) == i);
+			if (i > 0)
+				CPPUNIT_ASSERT(gSRGBToLinear[i] > gSRGBToLinear[i - 1]);
+		}
+
+		CPPUNIT_ASSERT(gSRGBToLinear[255] == 65535);
+		CPPUNIT_ASSERT(linear_to_srgb(0) == 0);
+		CPPUNIT_ASSERT(linear_to_srgb(65535) == 255);
+	}
+
+private:
+	void _CompareWithScalar(const bitmap_scalers* scalers)
+	{
+		const bitmap_scalers* scalar = bitmap_scalers_for(0);
+		srand(42);
+
+		for (int32 i = 0; i < kIterations; i++) {
+			uint32 count = 1 + rand() % kMaxRowLength;
+			uint16 wTop = _RandomWeight();
+			_Randomize(count);
+
+			_Reset();
+			scalar->bilinear_copy_row(fExpected, fSource, kSourceBytesPerRow,
+				fWeights, count, wTop);
+			scalers->bilinear_copy_row(fResult, fSource, kSourceBytesPerRow,
+				fWeights, count, wTop);
+			_Check(count);
+
+			_Reset();
+			scalar->bilinear_alpha_row(fExpected, fSource, kSourceBytesPerRow,
+				fWeights, count, wTop);
+			scalers->bilinear_alpha_row(fResult, fSource, kSourceBytesPerRow,
+				fWeights, count, wTop);
+			_Check(count);
+		}
+	}
+
+	void _Randomize(uint32 count)
+	{
+		// Opaque and transparent pixels are common in bitmaps drawn with
+		// B_OP_ALPHA, so make sure they occur.
+		for (uint32 i = 0; i < sizeof(fSource); i++) {
+			if (i % 4 == 3)
+				fSource[i] = _RandomWeight();
+			else
+				fSource[i] = rand() & 0xff;
+		}
+
+		for (uint32 i = 0; i < count; i++) {
+			// every pixel needs its right neighbour
+			fWeights[i].index = (rand() % (kSourceWidth - 1)) * 4;
+			fWeights[i].weight = _RandomWeight();
+		}
+
+		for (uint32 i = 0; i < sizeof(fDestination); i++)
+			fDestination[i] = rand() & 0xff;
+	}
+
+	void _Reset()
+	{
+		memcpy(fExpected, fDestination, sizeof(fDestination));
+		memcpy(fResult, fDestination, sizeof(fDestination));
+	}
+
+	void _Check(uint32 count)
+	{
+		CPPUNIT_ASSERT(memcmp(fExpected, fResult, count * 4) == 0);
+	}
+
+	static uint16 _RandomWeight()
+	{
+		switch (rand() % 4) {
+			case 0:
+				return 0;
+			case 1:
+				return 255;
+			default:
+				return rand() & 0xff;
+		}
+	}
+
+private:
+	uint8		fSource[kSourceBytesPerRow * 2];
+	FilterInfo	fWeights[kMaxRowLength];
+	uint8		fDestination[kMaxRowLength * 4];
+	uint8		fExpected[kMaxRowLength * 4];
+	uint8		fResult[kMaxRowLength * 4];
+};
+
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(BitmapScalingTest, getTestSuiteName());
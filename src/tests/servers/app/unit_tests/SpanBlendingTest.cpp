@@ -0,0 +1,169 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "SpanBlending.h"
+#include "drawing_support.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <TestSuiteAddon.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+
+static const unsigned kMaxSpanLength = 67;
+static const int32 kIterations = 2000;
+
+
+class SpanBlendingTest : public CppUnit::TestFixture {
+	CPPUNIT_TEST_SUITE(SpanBlendingTest);
+	CPPUNIT_TEST(SSE2MatchesScalar);
+	CPPUNIT_TEST(AVX2MatchesScalar);
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void SSE2MatchesScalar()
+	{
+#if defined(__i386__) || defined(__x86_64__)
+		if (__builtin_cpu_supports("sse2"))
+			_CompareWithScalar(span_blenders_for(APPSERVER_SIMD_SSE2));
+#endif
+	}
+
+	void AVX2MatchesScalar()
+	{
+#if defined(__i386__) || defined(__x86_64__)
+		if (__builtin_cpu_supports("avx2"))
+			_CompareWithScalar(span_blenders_for(APPSERVER_SIMD_AVX2));
+#endif
+	}
+
+private:
+	void _CompareWithScalar(const span_blenders* blenders)
+	{
+		const span_blenders* scalar = span_blenders_for(0);
+		srand(42);
+
+		for (int32 i = 0; i < kIterations; i++) {
+			unsigned len = 1 + rand() % kMaxSpanLength;
+			uint32 color = span_blending_color(_RandomColor());
+			uint8 cover = _RandomCover();
+			uint8 alpha = _RandomCover();
+			uint16 alpha16 = _RandomAlpha16();
+			bool skipTransparent = (rand() & 1) != 0;
+			_RandomizeSpan(len);
+
+			_Reset();
+			scalar->blend_solid_hspan(fExpected, len, color, fCovers);
+			blenders->blend_solid_hspan(fResult, len, color, fCovers);
+			_Check(len);
+
+			_Reset();
+			scalar->blend_solid_hline(fExpected, len, color, cover);
+			blenders->blend_solid_hline(fResult, len, color, cover);
+			_Check(len);
+
+			_Reset();
+			scalar->blend_color_hspan(fExpected, len, fColors, fCovers,
+				skipTransparent);
+			blenders->blend_color_hspan(fResult, len, fColors, fCovers,
+				skipTransparent);
+			_Check(len);
+
+			_Reset();
+			scalar->blend_color_hline(fExpected, len, fColors, cover,
+				skipTransparent);
+			blenders->blend_color_hline(fResult, len, fColors, cover,
+				skipTransparent);
+			_Check(len);
+
+			_Reset();
+			scalar->blend_solid_hspan16(fExpected, len, color, alpha,
+				fCovers);
+			blenders->blend_solid_hspan16(fResult, len, color, alpha,
+				fCovers);
+			_Check(len);
+
+			_Reset();
+			scalar->blend_color_hspan16(fExpected, len, fColors, fCovers);
+			blenders->blend_color_hspan16(fResult, len, fColors, fCovers);
+			_Check(len);
+
+			_Reset();
+			scalar->blend_color_hline16(fExpected, len, fColors, alpha16);
+			blenders->blend_color_hline16(fResult, len, fColors, alpha16);
+			_Check(len);
+		}
+	}
+
+	void _RandomizeSpan(unsigned len)
+	{
+		// Runs of fully transparent and fully opaque covers take shortcuts
+		// in the SIMD versions, so make sure they occur.
+		int coverMode = rand() % 3;
+		for (unsigned i = 0; i < len; i++) {
+			for (int j = 0; j < 4; j++)
+				fDestination[i * 4 + j] = rand() & 0xff;
+			fColors[i] = _RandomColor();
+			if (coverMode == 0)
+				fCovers[i] = _RandomCover();
+			else
+				fCovers[i] = i < len / 2 ? 0 : 255;
+		}
+	}
+
+	void _Reset()
+	{
+		memcpy(fExpected, fDestination, sizeof(fDestination));
+		memcpy(fResult, fDestination, sizeof(fDestination));
+	}
+
+	void _Check(unsigned len)
+	{
+		CPPUNIT_ASSERT(memcmp(fExpected, fResult, len * 4) == 0);
+	}
+
+	static uint8 _RandomCover()
+	{
+		switch (rand() % 4) {
+			case 0:
+				return 0;
+			case 1:
+				return 255;
+			default:
+				return rand() & 0xff;
+		}
+	}
+
+	static uint16 _RandomAlpha16()
+	{
+		switch (rand() % 4) {
+			case 0:
+				return 0;
+			case 1:
+				return 255 * 255;
+			default:
+				return rand() % (255 * 255);
+		}
+	}
+
+	static agg::rgba8 _RandomColor()
+	{
+		return agg::rgba8(rand() & 0xff, rand() & 0xff, rand() & 0xff,
+			_RandomCover());
+	}
+
+private:
+	uint8		fDestination[kMaxSpanLength * 4];
+	uint8		fExpected[kMaxSpanLength * 4];
+	uint8		fResult[kMaxSpanLength * 4];
+	agg::rgba8	fColors[kMaxSpanLength];
+	uint8		fCovers[kMaxSpanLength];
+};
+
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(SpanBlendingTest, getTestSuiteName());
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "RemoteMessage.h"
+#include "StreamCompression.h"
+
+#include <DataIO.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <TestSuiteAddon.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+
+static const size_t kHeaderSize = sizeof(uint16) + sizeof(uint32);
+static const int32 kMessageCount = 200;
+static const size_t kMaxPayload = 3000;
+static const size_t kMaxChunk = 700;
+
+
+// Runs a message stream through a StreamEncoder and a StreamDecoder, the
+// way it goes from the app_server to a remote client.
+class StreamCompressionTest : public CppUnit::TestFixture {
+	CPPUNIT_TEST_SUITE(StreamCompressionTest);
+	CPPUNIT_TEST(PlainStreamPassesThrough);
+	CPPUNIT_TEST(CompressedStreamRoundTrips);
+	CPPUNIT_TEST(CompressionStartsAtMessageBoundary);
+	CPPUNIT_TEST(CompressedMessagesArriveWithoutDelay);
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void PlainStreamPassesThrough()
+	{
+		BMallocIO stream;
+		_CreateMessages(stream, 0, kMessageCount);
+
+		BMallocIO wire;
+		StreamEncoder encoder(&wire);
+		_Write(encoder, stream, 0, stream.BufferLength());
+		CPPUNIT_ASSERT(!encoder.IsCompressing());
+		_AssertEqual(wire, stream);
+
+		BMallocIO output;
+		StreamDecoder decoder(&output);
+		_Write(decoder, wire);
+		CPPUNIT_ASSERT(!decoder.IsDecompressing());
+		_AssertEqual(output, stream);
+	}
+
+	void CompressedStreamRoundTrips()
+	{
+		if (!StreamEncoder::CompressionSupported()
+			|| !StreamDecoder::DecompressionSupported()) {
+			return;
+		}
+
+		BMallocIO stream;
+		size_t split = _CreateMessages(stream, 0, kMessageCount / 2);
+		_CreateMessages(stream, kMessageCount / 2, kMessageCount);
+
+		BMallocIO wire;
+		StreamEncoder encoder(&wire);
+		_Write(encoder, stream, 0, split);
+		encoder.RequestCompression();
+		_Write(encoder, stream, split, stream.BufferLength());
+		CPPUNIT_ASSERT(encoder.IsCompressing());
+
+		// every third message compresses well
+		CPPUNIT_ASSERT(memcmp(wire.Buffer(), stream.Buffer(), split) == 0);
+		CPPUNIT_ASSERT(wire.BufferLength() < stream.BufferLength());
+
+		BMallocIO output;
+		StreamDecoder decoder(&output);
+		_Write(decoder, wire);
+		CPPUNIT_ASSERT(decoder.IsDecompressing());
+
+		BMallocIO expected;
+		_CreateExpected(expected, stream, split);
+		_AssertEqual(output, expected);
+	}
+
+	void CompressionStartsAtMessageBoundary()
+	{
+		if (!StreamEncoder::CompressionSupported()
+			|| !StreamDecoder::DecompressionSupported()) {
+			return;
+		}
+
+		BMallocIO stream;
+		size_t first = _CreateMessages(stream, 0, 1);
+		_CreateMessages(stream, 1, kMessageCount);
+
+		// ask for compression in the middle of the first message
+		BMallocIO wire;
+		StreamEncoder encoder(&wire);
+		_Write(encoder, stream, 0, first / 2);
+		encoder.RequestCompression();
+		_Write(encoder, stream, first / 2, stream.BufferLength());
+		CPPUNIT_ASSERT(encoder.IsCompressing());
+
+		BMallocIO output;
+		StreamDecoder decoder(&output);
+		_Write(decoder, wire);
+
+		BMallocIO expected;
+		_CreateExpected(expected, stream, first);
+		_AssertEqual(output, expected);
+	}
+
+	void CompressedMessagesArriveWithoutDelay()
+	{
+		if (!StreamEncoder::CompressionSupported()
+			|| !StreamDecoder::DecompressionSupported()) {
+			return;
+		}
+
+		BMallocIO stream;
+		_CreateMessages(stream, 0, kMessageCount);
+
+		BMallocIO wire;
+		StreamEncoder encoder(&wire);
+		encoder.RequestCompression();
+
+		BMallocIO output;
+		StreamDecoder decoder(&output);
+
+		// The client must be able to handle every message as soon as it was
+		// sent, without waiting for the next one to push it through.
+		const uint8* buffer = (const uint8*)stream.Buffer();
+		MessageTracker tracker;
+		size_t sent = 0;
+		size_t received = 0;
+		while (sent < stream.BufferLength()) {
+			size_t length = 0;
+			do {
+				length += tracker.Advance(buffer + sent + length,
+					stream.BufferLength() - sent - length);
+			} while (!tracker.AtBoundary());
+
+			CPPUNIT_ASSERT_EQUAL(B_OK, encoder.Write(buffer + sent, length));
+			sent += length;
+
+			CPPUNIT_ASSERT_EQUAL(B_OK, decoder.Write(
+				(const uint8*)wire.Buffer() + received,
+				wire.BufferLength() - received));
+			received = wire.BufferLength();
+
+			// the output has the RP_ENABLE_STREAM_COMPRESSION message in front
+			CPPUNIT_ASSERT_EQUAL(sent + kHeaderSize, output.BufferLength());
+		}
+
+		BMallocIO expected;
+		_CreateExpected(expected, stream, 0);
+		_AssertEqual(output, expected);
+	}
+
+private:
+	//! Appends messages with random payloads, returns the stream length.
+	static size_t _CreateMessages(BMallocIO& stream, int32 from, int32 to)
+	{
+		srand(42 + from);
+
+		uint8 payload[kMaxPayload];
+		for (int32 i = from; i < to; i++) {
+			uint16 code = RP_FILL_RECT + i % 8;
+			uint32 size = kHeaderSize + rand() % kMaxPayload;
+			for (size_t j = 0; j < size - kHeaderSize; j++)
+				payload[j] = i % 3 == 0 ? j & 0xff : rand() & 0xff;
+
+			stream.Write(&code, sizeof(code));
+			stream.Write(&size, sizeof(size));
+			stream.Write(payload, size - kHeaderSize);
+		}
+
+		return stream.BufferLength();
+	}
+
+	//! The stream as the decoder passes it on, including the marker.
+	static void _CreateExpected(BMallocIO& expected, const BMallocIO& stream,
+		size_t split)
+	{
+		uint16 code = RP_ENABLE_STREAM_COMPRESSION;
+		uint32 size = kHeaderSize;
+		expected.Write(stream.Buffer(), split);
+		expected.Write(&code, sizeof(code));
+		expected.Write(&size, sizeof(size));
+		expected.Write((const uint8*)stream.Buffer() + split,
+			stream.BufferLength() - split);
+	}
+
+	//! Writes the given part of \a data in randomly sized chunks.
+	template<typename Target>
+	static void _Write(Target& target, const BMallocIO& data, size_t from,
+		size_t to)
+	{
+		const uint8* buffer = (const uint8*)data.Buffer();
+		while (from < to) {
+			size_t chunk = min_c(1 + (size_t)rand() % kMaxChunk, to - from);
+			CPPUNIT_ASSERT_EQUAL(B_OK, target.Write(buffer + from, chunk));
+			from += chunk;
+		}
+	}
+
+	template<typename Target>
+	static void _Write(Target& target, const BMallocIO& data)
+	{
+		_Write(target, data, 0, data.BufferLength());
+	}
+
+	static void _AssertEqual(const BMallocIO& result, const BMallocIO& expected)
+	{
+		CPPUNIT_ASSERT_EQUAL(expected.BufferLength(), result.BufferLength());
+		CPPUNIT_ASSERT(memcmp(result.Buffer(), expected.Buffer(),
+			expected.BufferLength()) == 0);
+	}
+};
+
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(StreamCompressionTest,
+	getTestSuiteName());
@@ -0,0 +1,306 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <Entry.h>
+#include <Locker.h>
+#include <OS.h>
+#include <String.h>
+
+#include <package/hpkg/PackageWriter.h>
+
+#include "Package.h"
+#include "PackageFileManager.h"
+
+
+using namespace BPackageKit::BHPKG;
+
+
+// Checks that the package daemon reads the new packages of a transaction
+// correctly when it does so on several threads at once: every thread gets
+// the package file with the right package info, all threads asking for the
+// same file get the same object, and the file is dropped once the last
+// reference to it is gone. The packages are written to a directory created
+// in the given directory, or in /tmp.
+
+
+static const int32 kPackageCount = 16;
+static const int32 kThreadCount = 8;
+static const int32 kRounds = 20;
+
+
+class WriterListener : public BPackageWriterListener {
+public:
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		vfprintf(stderr, format, args);
+	}
+
+	virtual void OnEntryAdded(const char* path)
+	{
+	}
+
+	virtual void OnTOCSizeInfo(uint64 uncompressedStringsSize,
+		uint64 uncompressedMainSize, uint64 uncompressedTOCSize)
+	{
+	}
+
+	virtual void OnPackageAttributesSizeInfo(uint32 stringCount,
+		uint32 uncompressedSize)
+	{
+	}
+
+	virtual void OnPackageSizeInfo(uint32 headerSize, uint64 heapSize,
+		uint64 tocSize, uint32 packageAttributesSize, uint64 totalSize)
+	{
+	}
+};
+
+
+struct ThreadData {
+	PackageFileManager*	manager;
+	entry_ref*			refs;
+	int32				index;
+	PackageFile*		files[kPackageCount];
+	status_t			status;
+};
+
+
+static void
+fail(const char* message, const char* detail)
+{
+	fprintf(stderr, "%s: %s\n", message, detail);
+	exit(1);
+}
+
+
+static BString
+package_name(int32 index)
+{
+	return BString().SetToFormat("prepare_test_%" B_PRId32, index);
+}
+
+
+static BString
+package_file_name(int32 index)
+{
+	return BString().SetToFormat("%s-1.0-1-any.hpkg",
+		package_name(index).String());
+}
+
+
+static void
+write_package(int32 index)
+{
+	BString name = package_name(index);
+	BString packageInfo;
+	packageInfo.SetToFormat(
+		"name\t\t\t%s\n"
+		"version\t\t\t1.0-1\n"
+		"architecture\tany\n"
+		"summary\t\t\t\"Test package\"\n"
+		"description\t\t\"Test package\"\n"
+		"packager\t\t\"Nobody <nobody@example.com>\"\n"
+		"vendor\t\t\t\"Haiku Project\"\n"
+		"copyrights\t\t\"2026 Haiku, Inc.\"\n"
+		"licenses\t\t\"MIT\"\n"
+		"provides {\n"
+		"\t%s = 1.0-1\n"
+		"}\n", name.String(), name.String());
+
+	FILE* file = fopen(".PackageInfo", "wb");
+	if (file == NULL
+		|| fwrite(packageInfo.String(), 1, packageInfo.Length(), file)
+			!= (size_t)packageInfo.Length()) {
+		fail("Could not write file", ".PackageInfo");
+	}
+	fclose(file);
+
+	WriterListener listener;
+	BPackageWriter writer(&listener);
+	writer.SetCheckLicenses(false);
+
+	BString fileName = package_file_name(index);
+	status_t status = writer.Init(fileName.String());
+	if (status == B_OK)
+		status = writer.AddEntry(".PackageInfo");
+	if (status == B_OK)
+		status = writer.Finish();
+	if (status != B_OK)
+		fail("Writing the package failed", fileName.String());
+
+	unlink(".PackageInfo");
+}
+
+
+/*!	Gets all package files, each thread starting with a different one, and
+	checks their package info.
+*/
+static status_t
+get_package_files(void* _data)
+{
+	ThreadData* data = (ThreadData*)_data;
+	data->status = B_OK;
+
+	for (int32 i = 0; i < kPackageCount; i++) {
+		int32 index = (i + data->index) % kPackageCount;
+
+		PackageFile* file;
+		status_t status = data->manager->GetPackageFile(data->refs[index],
+			file);
+		if (status != B_OK) {
+			data->status = status;
+			return status;
+		}
+
+		data->files[index] = file;
+		if (file->Info().Name() != package_name(index))
+			data->status = B_BAD_DATA;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Creates and deletes packages over and over, so that package files are
+	dropped while other threads are reading them again.
+*/
+static status_t
+create_packages(void* _data)
+{
+	ThreadData* data = (ThreadData*)_data;
+	data->status = B_OK;
+
+	for (int32 round = 0; round < kRounds; round++) {
+		int32 index = (round + data->index) % kPackageCount;
+
+		Package* package;
+		status_t status = data->manager->CreatePackage(data->refs[index],
+			package);
+		if (status != B_OK) {
+			data->status = status;
+			return status;
+		}
+
+		if (package->Info().Name() != package_name(index))
+			data->status = B_BAD_DATA;
+
+		delete package;
+	}
+
+	return B_OK;
+}
+
+
+static void
+run_threads(thread_func function, ThreadData* data)
+{
+	thread_id threads[kThreadCount];
+	for (int32 i = 0; i < kThreadCount; i++) {
+		threads[i] = spawn_thread(function, "prepare package",
+			B_NORMAL_PRIORITY, &data[i]);
+		if (threads[i] < 0)
+			fail("Could not spawn thread", strerror(threads[i]));
+	}
+
+	// start them all at once
+	for (int32 i = 0; i < kThreadCount; i++)
+		resume_thread(threads[i]);
+
+	for (int32 i = 0; i < kThreadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+		if (data[i].status != B_OK)
+			fail("Reading package files failed", strerror(data[i].status));
+	}
+}
+
+
+static void
+check_package_files(ThreadData* data, const entry_ref* refs)
+{
+	// all threads share the same package file objects
+	for (int32 i = 0; i < kPackageCount; i++) {
+		PackageFile* file = data[0].files[i];
+		for (int32 j = 1; j < kThreadCount; j++) {
+			if (data[j].files[i] != file)
+				fail("Package file read twice", refs[i].name);
+		}
+
+		if (file->CountReferences() != kThreadCount)
+			fail("Package file has wrong reference count", refs[i].name);
+	}
+}
+
+
+static void
+release_package_files(ThreadData* data)
+{
+	for (int32 j = 0; j < kThreadCount; j++) {
+		for (int32 i = 0; i < kPackageCount; i++)
+			data[j].files[i]->ReleaseReference();
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	BString directory;
+	directory.SetToFormat("%s/package_file_manager_test-%" B_PRId32,
+		argc > 1 ? argv[1] : "/tmp", find_thread(NULL));
+
+	if (mkdir(directory.String(), 0755) != 0 || chdir(directory.String()) != 0)
+		fail("Could not create directory", directory.String());
+
+	entry_ref refs[kPackageCount];
+	for (int32 i = 0; i < kPackageCount; i++) {
+		write_package(i);
+
+		BString fileName = package_file_name(i);
+		if (BEntry(fileName.String()).GetRef(&refs[i]) != B_OK)
+			fail("Could not get entry ref", fileName.String());
+	}
+
+	BLocker lock("package file manager test");
+	PackageFileManager manager(lock);
+	status_t status = manager.Init();
+	if (status != B_OK)
+		fail("Could not init package file manager", strerror(status));
+
+	ThreadData data[kThreadCount];
+	for (int32 i = 0; i < kThreadCount; i++) {
+		data[i].manager = &manager;
+		data[i].refs = refs;
+		data[i].index = i;
+	}
+
+	run_threads(&get_package_files, data);
+	check_package_files(data, refs);
+	release_package_files(data);
+
+	// releasing the last references removed the files from the manager, so
+	// they are read again
+	run_threads(&get_package_files, data);
+	check_package_files(data, refs);
+	release_package_files(data);
+
+	run_threads(&create_packages, data);
+
+	for (int32 i = 0; i < kPackageCount; i++)
+		unlink(package_file_name(i).String());
+	chdir("/");
+	rmdir(directory.String());
+
+	printf("All tests passed.\n");
+	return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <File.h>
+#include <Node.h>
+#include <OS.h>
+#include <String.h>
+
+#include "FSTransaction.h"
+#include "FSUtils.h"
+
+
+// Checks the steps the package daemon takes when a package update brings a
+// global writable file: the originals of both package versions are compared
+// by their content only, whatever attributes they carry, and retagging the
+// installed file, which the user may have modified, is undone when the
+// transaction is rolled back. The files are written to a directory created
+// in the given directory, or in /tmp.
+
+
+static const char* const kPackageAttribute = "SYS:PACKAGE";
+
+
+static void
+fail(const char* message, const char* detail)
+{
+	fprintf(stderr, "%s: %s\n", message, detail);
+	exit(1);
+}
+
+
+static void
+write_file(const char* path, const char* content)
+{
+	BFile file(path, B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	ssize_t length = strlen(content);
+	if (file.InitCheck() != B_OK || file.Write(content, length) != length)
+		fail("Could not write file", path);
+}
+
+
+static void
+write_attribute(const char* path, const char* attribute, const char* value)
+{
+	BString string(value);
+	if (BNode(path).WriteAttrString(attribute, &string) != B_OK)
+		fail("Could not write attribute", path);
+}
+
+
+static BString
+read_attribute(const char* path, const char* attribute)
+{
+	BString value;
+	if (BNode(path).ReadAttrString(attribute, &value) != B_OK)
+		fail("Could not read attribute", path);
+	return value;
+}
+
+
+static bool
+files_equal(const char* path1, const char* path2)
+{
+	bool equal;
+	status_t error = FSUtils::CompareFileContent(FSUtils::Entry(path1),
+		FSUtils::Entry(path2), equal);
+	if (error != B_OK)
+		fail("Comparing files failed", strerror(error));
+	return equal;
+}
+
+
+static bool
+symlinks_equal(const char* path1, const char* path2)
+{
+	bool equal;
+	status_t error = FSUtils::CompareSymLinks(FSUtils::Entry(path1),
+		FSUtils::Entry(path2), equal);
+	if (error != B_OK)
+		fail("Comparing symlinks failed", strerror(error));
+	return equal;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	BString directory;
+	directory.SetToFormat("%s/writable_file_update_test-%" B_PRId32,
+		argc > 1 ? argv[1] : "/tmp", find_thread(NULL));
+
+	if (mkdir(directory.String(), 0755) != 0 || chdir(directory.String()) != 0)
+		fail("Could not create directory", directory.String());
+
+	// the originals of the old and the new package version, and the
+	// installed file, modified by the user
+	write_file("old_original", "setting = 1\n");
+	write_file("new_original", "setting = 1\n");
+	write_file("installed", "setting = 2\n");
+	write_attribute("installed", kPackageAttribute, "test-1.0-1");
+
+	// unchanged by the package
+	if (!files_equal("old_original", "new_original"))
+		fail("Unchanged original", "reported as changed");
+
+	// changed by the package, even though the originals claim otherwise
+	write_file("new_original", "setting = 1\nother = 1\n");
+	write_attribute("old_original", "SYS:PACKAGE_CHECKSUM", "forged");
+	write_attribute("new_original", "SYS:PACKAGE_CHECKSUM", "forged");
+	if (files_equal("old_original", "new_original"))
+		fail("Changed original", "reported as unchanged");
+
+	// same size, different content
+	write_file("new_original", "setting = 3\n");
+	if (files_equal("old_original", "new_original"))
+		fail("Changed original", "reported as unchanged");
+
+	// the same for symlinks
+	if (symlink("target", "old_link") != 0
+		|| symlink("target", "new_link") != 0
+		|| symlink("other_target", "changed_link") != 0) {
+		fail("Could not create symlinks", directory.String());
+	}
+	if (!symlinks_equal("old_link", "new_link"))
+		fail("Unchanged symlink", "reported as changed");
+	if (symlinks_equal("old_link", "changed_link"))
+		fail("Changed symlink", "reported as unchanged");
+
+	// retagging the installed file is part of the transaction
+	{
+		FSTransaction transaction;
+		FSTransaction::SetAttributeOperation retagOperation(&transaction,
+			FSUtils::Entry("installed"), kPackageAttribute,
+			BString("test-1.0-1"));
+		write_attribute("installed", kPackageAttribute, "test-1.0-2");
+		retagOperation.Finished();
+
+		if (read_attribute("installed", kPackageAttribute) != "test-1.0-2")
+			fail("Retagging failed", "installed");
+
+		transaction.RollBack();
+	}
+
+	if (read_attribute("installed", kPackageAttribute) != "test-1.0-1")
+		fail("Retagging not rolled back", "installed");
+
+	// an unfinished operation is not rolled back
+	{
+		FSTransaction transaction;
+		{
+			FSTransaction::SetAttributeOperation retagOperation(&transaction,
+				FSUtils::Entry("installed"), kPackageAttribute,
+				BString("test-0.9-1"));
+		}
+		transaction.RollBack();
+	}
+
+	if (read_attribute("installed", kPackageAttribute) != "test-1.0-1")
+		fail("Unfinished retagging rolled back", "installed");
+
+	// the user's modifications are kept in any case
+	if (files_equal("installed", "old_original"))
+		fail("Installed file", "was overwritten");
+
+	static const char* const kFiles[] = {
+		"old_original", "new_original", "installed", "old_link", "new_link",
+		"changed_link"
+	};
+	for (size_t i = 0; i < B_COUNT_OF(kFiles); i++)
+		unlink(kFiles[i]);
+	chdir("/");
+	rmdir(directory.String());
+
+	printf("All tests passed.\n");
+	return 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <fs_attr.h>
+#include <OS.h>
+#include <TypeConstants.h>
+
+#include <syscalls.h>
+#include <vfs_defs.h>
+
+
+// Tests _kern_read_dir_plus() on a directory it creates in the given
+// directory, or in /tmp.
+
+
+static const int32 kFileCount = 10;
+static const size_t kLargeAttributeSize = 2000;
+static const char* kAttributeName = "read_dir_plus:test";
+
+
+static void
+fail(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+	fputc('\n', stderr);
+	exit(1);
+}
+
+
+static bool
+has_attribute(int32 file)
+{
+	return file != 0;
+}
+
+
+static size_t
+attribute_size(int32 file)
+{
+	return file == 4 ? kLargeAttributeSize : 4 + file;
+}
+
+
+static void
+fill_attribute(int32 file, uint8* buffer)
+{
+	for (size_t i = 0; i < attribute_size(file); i++)
+		buffer[i] = (uint8)(file + i * 3);
+}
+
+
+static void
+create_files(const char* directory)
+{
+	uint8 data[kLargeAttributeSize];
+
+	for (int32 file = 0; file < kFileCount; file++) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/file%" B_PRId32, directory, file);
+
+		int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			fail("Could not create \"%s\": %s", path, strerror(errno));
+
+		// use the file size to identify the file in the stat
+		if (ftruncate(fd, file * 100) != 0)
+			fail("Could not resize \"%s\": %s", path, strerror(errno));
+
+		if (has_attribute(file)) {
+			fill_attribute(file, data);
+			if (fs_write_attr(fd, kAttributeName, B_RAW_TYPE, 0, data,
+					attribute_size(file)) != (ssize_t)attribute_size(file)) {
+				fail("Could not write attribute of \"%s\": %s", path,
+					strerror(errno));
+			}
+		}
+
+		close(fd);
+	}
+}
+
+
+static void
+remove_files(const char* directory)
+{
+	for (int32 file = 0; file < kFileCount; file++) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/file%" B_PRId32, directory, file);
+		unlink(path);
+	}
+	rmdir(directory);
+}
+
+
+/*!	Checks a single entry, and returns the index of the file, or -1 if it
+	is not one of ours.
+*/
+static int32
+check_entry(dirent_plus* entry, bool expectOverflow)
+{
+	struct dirent* dirent = dirent_plus_entry(entry);
+	if (strncmp(dirent->d_name, "file", 4) != 0)
+		return -1;
+
+	int32 file = atol(dirent->d_name + 4);
+	if (file < 0 || file >= kFileCount)
+		fail("Unexpected entry \"%s\"", dirent->d_name);
+
+	if (entry->stat_status != B_OK) {
+		fail("Stat of \"%s\" failed: %s", dirent->d_name,
+			strerror(entry->stat_status));
+	}
+	if (entry->stat.st_ino != dirent->d_ino
+		|| entry->stat.st_size != file * 100) {
+		fail("Wrong stat for \"%s\"", dirent->d_name);
+	}
+
+	attr_plus* attribute = dirent_plus_first_attr(entry);
+	if ((uint8*)dirent_plus_next_attr(attribute)
+			!= (uint8*)entry + entry->size) {
+		fail("Wrong entry size for \"%s\"", dirent->d_name);
+	}
+
+	if (!has_attribute(file)) {
+		if (attribute->status != B_ENTRY_NOT_FOUND) {
+			fail("Missing attribute of \"%s\" reported as: %s",
+				dirent->d_name, strerror(attribute->status));
+		}
+		return file;
+	}
+
+	if (attribute->data_size != attribute_size(file))
+		fail("Wrong attribute size for \"%s\"", dirent->d_name);
+
+	if (expectOverflow && attribute_size(file) == kLargeAttributeSize) {
+		if (attribute->status != B_BUFFER_OVERFLOW) {
+			fail("Attribute of \"%s\" did not overflow: %s", dirent->d_name,
+				strerror(attribute->status));
+		}
+		return file;
+	}
+
+	if (attribute->status != B_OK) {
+		fail("Reading attribute of \"%s\" failed: %s", dirent->d_name,
+			strerror(attribute->status));
+	}
+	if (attribute->type != B_RAW_TYPE)
+		fail("Wrong attribute type for \"%s\"", dirent->d_name);
+
+	uint8 expected[kLargeAttributeSize];
+	fill_attribute(file, expected);
+	const uint8* data = (uint8*)attribute
+		+ DIRENT_PLUS_ALIGN(sizeof(attr_plus));
+	if (memcmp(data, expected, attribute_size(file)) != 0)
+		fail("Wrong attribute contents for \"%s\"", dirent->d_name);
+
+	return file;
+}
+
+
+/*!	Reads the whole directory with buffers of \a bufferSize bytes, and
+	checks that all files are returned exactly once.
+*/
+static void
+read_directory(const char* directory, size_t bufferSize, bool expectOverflow)
+{
+	int fd = open(directory, O_RDONLY | O_DIRECTORY);
+	if (fd < 0)
+		fail("Could not open \"%s\": %s", directory, strerror(errno));
+
+	const char* attributes[] = { kAttributeName };
+	uint8* buffer = (uint8*)malloc(bufferSize);
+	if (buffer == NULL)
+		fail("Out of memory");
+
+	bool seen[kFileCount] = {};
+	while (true) {
+		ssize_t count = _kern_read_dir_plus(fd, attributes, 1, buffer,
+			bufferSize, UINT_MAX);
+		if (count < 0) {
+			fail("Reading the directory failed: %s",
+				strerror((status_t)count));
+		}
+		if (count == 0)
+			break;
+
+		dirent_plus* entry = (dirent_plus*)buffer;
+		for (ssize_t i = 0; i < count; i++) {
+			if ((uint8*)entry + entry->size > buffer + bufferSize)
+				fail("Entry exceeds the buffer");
+
+			int32 file = check_entry(entry, expectOverflow);
+			if (file >= 0) {
+				if (seen[file])
+					fail("file%" B_PRId32 " was returned twice", file);
+				seen[file] = true;
+			}
+			entry = dirent_plus_next(entry);
+		}
+	}
+
+	for (int32 file = 0; file < kFileCount; file++) {
+		if (!seen[file])
+			fail("file%" B_PRId32 " was not returned", file);
+	}
+
+	free(buffer);
+	close(fd);
+}
+
+
+static void
+test_buffer_overflow(const char* directory, size_t minEntrySize)
+{
+	int fd = open(directory, O_RDONLY | O_DIRECTORY);
+	if (fd < 0)
+		fail("Could not open \"%s\": %s", directory, strerror(errno));
+
+	const char* attributes[] = { kAttributeName };
+	uint8 buffer[64];
+	if (minEntrySize <= sizeof(buffer))
+		fail("Test buffer is too large");
+
+	ssize_t count = _kern_read_dir_plus(fd, attributes, 1, buffer,
+		sizeof(buffer), UINT_MAX);
+	if (count != B_BUFFER_OVERFLOW) {
+		fail("Too small buffer returned %zd instead of B_BUFFER_OVERFLOW",
+			count);
+	}
+
+	close(fd);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	char directory[PATH_MAX];
+	snprintf(directory, sizeof(directory), "%s/read_dir_plus_test-%" B_PRId32,
+		argc > 1 ? argv[1] : "/tmp", find_thread(NULL));
+
+	if (mkdir(directory, 0755) != 0)
+		fail("Could not create \"%s\": %s", directory, strerror(errno));
+
+	create_files(directory);
+
+	// the same as in the kernel: room for one entry with a name of maximal
+	// length, and the header of the attribute
+	const size_t minEntrySize = DIRENT_PLUS_ALIGN(sizeof(dirent_plus))
+		+ DIRENT_PLUS_ALIGN(sizeof(struct dirent) + B_FILE_NAME_LENGTH)
+		+ DIRENT_PLUS_ALIGN(sizeof(attr_plus));
+
+	read_directory(directory, 64 * 1024, false);
+	read_directory(directory, minEntrySize, true);
+	test_buffer_overflow(directory, minEntrySize);
+
+	remove_files(directory);
+
+	printf("All tests passed.\n");
+	return 0;
+}
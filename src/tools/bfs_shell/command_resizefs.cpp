@@ -5,6 +5,7 @@
 
 
 #include "fssh_stdio.h"
+#include "fssh_string.h"
 #include "syscalls.h"
 
 #include "bfs.h"
@@ -17,13 +18,15 @@ namespace FSShell {
 fssh_status_t
 command_resizefs(int argc, const char* const* argv)
 {
-	if (argc != 2) {
-		fssh_dprintf("Usage: %s <new size>\n", argv[0]);
+	bool resizeLog = argc == 3 && fssh_strcmp(argv[1], "--log") == 0;
+	if (argc != 2 && !resizeLog) {
+		fssh_dprintf("Usage: %s <new size>\n"
+			"       %s --log <new log size in blocks>\n", argv[0], argv[0]);
 		return B_ERROR;
 	}
 
 	uint64 newSize;
-	if (fssh_sscanf(argv[1], "%" B_SCNu64, &newSize) < 1) {
+	if (fssh_sscanf(argv[argc - 1], "%" B_SCNu64, &newSize) < 1) {
 		fssh_dprintf("Unknown argument or invalid size\n");
 		return B_ERROR;
 	}
@@ -34,8 +37,15 @@ command_resizefs(int argc, const char* const* argv)
 		return rootDir;
 	}
 
-	status_t status = _kern_ioctl(rootDir, BFS_IOCTL_RESIZE,
-		&newSize, sizeof(newSize));
+	status_t status;
+	if (resizeLog) {
+		uint32 logSize = newSize;
+		status = _kern_ioctl(rootDir, BFS_IOCTL_RESIZE_LOG, &logSize,
+			sizeof(logSize));
+	} else {
+		status = _kern_ioctl(rootDir, BFS_IOCTL_RESIZE, &newSize,
+			sizeof(newSize));
+	}
 
 	_kern_close(rootDir);
 
@@ -44,7 +54,10 @@ command_resizefs(int argc, const char* const* argv)
 		return status;
 	}
 
-	fssh_dprintf("File system successfully resized!\n");
+	if (resizeLog)
+		fssh_dprintf("Log successfully resized!\n");
+	else
+		fssh_dprintf("File system successfully resized!\n");
 	return B_OK;
 }
 
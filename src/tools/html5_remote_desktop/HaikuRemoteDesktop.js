@@ -5,6 +5,7 @@ const RP_UPDATE_DISPLAY_MODE = 2;
 const RP_CLOSE_CONNECTION = 3;
 const RP_GET_SYSTEM_PALETTE = 4;
 const RP_GET_SYSTEM_PALETTE_RESULT = 5;
+const RP_ENABLE_STREAM_COMPRESSION = 6;
 
 const RP_CREATE_STATE = 20;
 const RP_DELETE_STATE = 21;
@@ -29,6 +30,7 @@ const RP_COPY_RECT_NO_CLIPPING = 61;
 const RP_INVERT_RECT = 62;
 const RP_DRAW_BITMAP = 63;
 const RP_DRAW_BITMAP_RECTS = 64;
+const RP_DRAW_BITMAP_DELTA = 65;
 
 const RP_STROKE_ARC = 80;
 const RP_STROKE_BEZIER = 81;
@@ -91,6 +93,10 @@ const RP_UNMAPPED_KEY_DOWN = 242;
 const RP_UNMAPPED_KEY_UP = 243;
 const RP_MODIFIERS_CHANGED = 244;
 
+// features requested with RP_INIT_CONNECTION
+const RP_FEATURE_STREAM_COMPRESSION = 0x01;
+const RP_FEATURE_BITMAP_DELTAS = 0x02;
+
 
 // drawing_mode
 const B_OP_COPY = 0;
@@ -775,6 +781,107 @@ RemoteBitmap.prototype.readFrom = function(remoteMessage, unsetAlpha,
 }
 
 
+// Holds the contents of a bitmap the server sends only the changed parts of
+// with RP_DRAW_BITMAP_DELTA.
+function RemoteBitmapSlot()
+{
+	this.width = 0;
+	this.height = 0;
+	this.colorSpace = B_NO_COLOR_SPACE;
+	this.canvas = document.createElement('canvas');
+	this.context = null;
+	this.imageData = null;
+	this.pixels = null;
+		// As sent by the server, to convert again if unsetAlpha changes.
+	this.unsetAlpha = undefined;
+}
+
+
+RemoteBitmapSlot.prototype.readFrom = function(remoteMessage, unsetAlpha)
+{
+	var width = remoteMessage.dataView.readInt32();
+	var height = remoteMessage.dataView.readInt32();
+	var colorSpace = remoteMessage.dataView.readUint32();
+	var flags = remoteMessage.dataView.readUint32();
+
+	if (width != this.width || height != this.height
+		|| colorSpace != this.colorSpace || this.imageData == null) {
+		this.width = width;
+		this.height = height;
+		this.colorSpace = colorSpace;
+		this.canvas.width = width;
+		this.canvas.height = height;
+		this.context = this.canvas.getContext('2d');
+		this.imageData = this.context.createImageData(width, height);
+		this.pixels = new Uint32Array(width * height);
+		this.unsetAlpha = undefined;
+	}
+
+	var convertAll = unsetAlpha !== this.unsetAlpha;
+	this.unsetAlpha = unsetAlpha;
+
+	var rectCount = remoteMessage.dataView.readUint32();
+	var rects = [];
+	for (var i = 0; i < rectCount; i++) {
+		var left = remoteMessage.dataView.readInt32();
+		var top = remoteMessage.dataView.readInt32();
+		var right = remoteMessage.dataView.readInt32();
+		var bottom = remoteMessage.dataView.readInt32();
+		var length = right - left + 1;
+
+		for (var y = top; y <= bottom; y++) {
+			var start = y * width + left;
+			remoteMessage.dataView.readInto(new Uint8Array(this.pixels.buffer,
+				start * 4, length * 4));
+
+			if (!convertAll)
+				this.convert(start, start + length);
+		}
+
+		rects.push([left, top, length, bottom - top + 1]);
+	}
+
+	if (convertAll) {
+		this.convert(0, width * height);
+		this.context.putImageData(this.imageData, 0, 0);
+		return this;
+	}
+
+	for (var i = 0; i < rects.length; i++) {
+		this.context.putImageData(this.imageData, 0, 0, rects[i][0],
+			rects[i][1], rects[i][2], rects[i][3]);
+	}
+
+	return this;
+}
+
+
+RemoteBitmapSlot.prototype.convert = function(start, end)
+{
+	var output = new Uint32Array(this.imageData.data.buffer);
+	var input = this.pixels;
+
+	if (this.colorSpace == B_RGBA32) {
+		for (var i = start; i < end; i++) {
+			output[i] = (input[i] & 0xff) << 16 | (input[i] >> 16 & 0xff)
+				| (input[i] & 0xff00ff00);
+			if (this.unsetAlpha)
+				output[i] |= 0xff000000;
+		}
+
+		return;
+	}
+
+	for (var i = start; i < end; i++) {
+		output[i] = (input[i] & 0xff) << 16 | (input[i] >> 16 & 0xff)
+			| (input[i] & 0xff00) | 0xff000000;
+
+		if (!this.unsetAlpha && output[i] == B_TRANSPARENT_MAGIC_RGBA32)
+			output[i] &= 0x00ffffff;
+	}
+}
+
+
 function RemotePattern(remoteMessage)
 {
 	this.data = new Uint8Array(8);
@@ -1304,6 +1411,28 @@ RemoteState.prototype.messageReceived = function(remoteMessage, reply)
 				viewRect.top, viewRect.width(), viewRect.height());
 			break;
 
+		case RP_DRAW_BITMAP_DELTA:
+			this.applyContext();
+
+			var bitmapRect = new RemoteRect(remoteMessage);
+			var viewRect = new RemoteRect(remoteMessage);
+			var options = remoteMessage.dataView.readUint32();
+				// TODO: Implement options.
+
+			if (options != 0)
+				console.warn('bitmap options not supported: ' + options);
+
+			var slot = remoteMessage.dataView.readUint32();
+			var bitmap = this.session.bitmapSlots[slot];
+			if (!bitmap)
+				bitmap = this.session.bitmapSlots[slot] = new RemoteBitmapSlot();
+
+			bitmap.readFrom(remoteMessage, this.unsetAlpha);
+			context.drawImage(bitmap.canvas, bitmapRect.left, bitmapRect.top,
+				bitmapRect.width(), bitmapRect.height(), viewRect.left,
+				viewRect.top, viewRect.width(), viewRect.height());
+			break;
+
 		case RP_DRAW_BITMAP_RECTS:
 			this.applyContext();
 
@@ -1803,6 +1932,9 @@ function RemoteDesktopSession(targetElement, width, height, targetAddress,
 	this.states = new Object();
 	this.modifiers = 0;
 
+	this.bitmapSlots = [];
+	this.decompressor = null;
+
 	this.canvas.onmousemove = this.onMouseMove.bind(this);
 	this.canvas.onmousedown = this.onMouseDown.bind(this);
 	this.canvas.onmouseup = this.onMouseUp.bind(this);
@@ -1831,17 +1963,31 @@ RemoteDesktopSession.prototype.onOpen = function(open)
 
 RemoteDesktopSession.prototype.onMessage = function(message)
 {
-	var data = message.data;
+	var data = new Uint8Array(message.data);
+	if (this.decompressor) {
+		this.decompressor.push(data);
+		return;
+	}
+
+	this.processData(data);
+}
+
+
+RemoteDesktopSession.prototype.processData = function(data)
+{
 	if (this.messageRemainder) {
 		var combined = new Uint8Array(this.messageRemainder.byteLength
 			+ data.byteLength);
-		combined.set(new Uint8Array(this.messageRemainder), 0);
-		combined.set(new Uint8Array(data), this.messageRemainder.byteLength);
+		combined.set(this.messageRemainder, 0);
+		combined.set(data, this.messageRemainder.byteLength);
 		data = combined;
 
 		this.messageRemainder = null;
-	} else
-		data = new Uint8Array(data);
+	} else if (data.byteOffset != 0
+		|| data.byteLength != data.buffer.byteLength) {
+		// The messages are read relative to the start of the buffer.
+		data = data.slice();
+	}
 
 	var byteOffset = 0;
 	while (true) {
@@ -1855,6 +2001,13 @@ RemoteDesktopSession.prototype.onMessage = function(message)
 			return;
 		}
 
+		if (this.receiveMessage.code() == RP_ENABLE_STREAM_COMPRESSION) {
+			// Everything after this message is compressed.
+			byteOffset += this.receiveMessage.size();
+			this.enableDecompression(data.subarray(byteOffset));
+			return;
+		}
+
 		try {
 			this.messageReceived(this.receiveMessage, this.sendMessage);
 		} catch (exception) {
@@ -1869,6 +2022,19 @@ RemoteDesktopSession.prototype.onMessage = function(message)
 }
 
 
+RemoteDesktopSession.prototype.enableDecompression = function(data)
+{
+	console.log('stream compression enabled');
+
+	this.decompressor = new fzstd.Decompress(function(chunk) {
+			this.processData(chunk);
+		}.bind(this));
+
+	if (data.byteLength > 0)
+		this.decompressor.push(data.slice());
+}
+
+
 RemoteDesktopSession.prototype.messageReceived = function(remoteMessage, reply)
 {
 	switch (remoteMessage.code()) {
@@ -2047,7 +2213,13 @@ RemoteDesktopSession.prototype.removeClipping = function()
 
 RemoteDesktopSession.prototype.init = function()
 {
+	// Compression needs the optional fzstd decompressor to be loaded.
+	var features = RP_FEATURE_BITMAP_DELTAS;
+	if (typeof fzstd !== 'undefined')
+		features |= RP_FEATURE_STREAM_COMPRESSION;
+
 	this.sendMessage.start(RP_INIT_CONNECTION);
+	this.sendMessage.dataView.writeUint32(features);
 	this.sendMessage.flush();
 }
 